@@ -0,0 +1,136 @@
+#!/usr/bin/env python
+#
+#      Copyright (C) 2016 Team Kodi
+#      http://kodi.tv
+#
+#  This Program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This Program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with XBMC; see the file COPYING.  If not, see
+#  <http://www.gnu.org/licenses/>.
+#
+
+# Converts a playback trace written by CTraceRecorder (kodi-trace.trc in the
+# log folder) to the Chrome trace format, to be opened in chrome://tracing,
+# or to CSV.
+#
+#   kodi-trace.py [--csv] kodi-trace.trc [output]
+
+import json, struct, sys
+
+DVD_TIME_BASE = 1000000.0
+NOPTS = -(1 << 52)
+
+HEADER = struct.Struct("<8sIIqQII")
+EVENT = struct.Struct("<QQddHHi")
+
+STREAMS = { 0: "none", 1: "audio", 2: "video", 3: "data", 4: "subtitle", 5: "teletext", 6: "radiords" }
+
+# name, track, names of arg/value1/value2, values that are player times
+EVENTS = {
+  0: ("marker",            "markers", (None, None, None), ()),
+  1: ("packet demuxed",    "demuxer", ("size", "dts", "pts"), (1, 2)),
+  2: ("picture decoded",   "decoder", ("flags", "pts", "duration"), (1, 2)),
+  3: ("picture queued",    "render",  ("queued", "pts", "presenttime"), (1,)),
+  4: ("picture presented", "render",  ("buffer", "pts", "late"), (1,)),
+  5: ("picture dropped",   "render",  ("renderer", "pts", None), (1,)),
+  6: ("audio written",     "audio",   ("frames", "ptsms", "delay"), ()),
+  7: ("clock adjusted",    "clock",   ("speedadjust", "clock", "error"), (1, 2)),
+  8: ("cache level",       "cache",   ("queuedms", "level", "ahead"), ())
+}
+
+TRACKS = [ "markers", "demuxer", "decoder", "render", "audio", "clock", "cache" ]
+
+def read_trace(path):
+  with open(path, "rb") as f:
+    data = f.read()
+  magic, version, size, start, dumped, count, reasonsize = HEADER.unpack_from(data, 0)
+  if magic.rstrip(b"\0") != b"KODITRC" or version != 1 or size != EVENT.size:
+    raise ValueError("%s is not a playback trace this tool knows" % path)
+  offset = HEADER.size
+  reason = data[offset:offset + reasonsize].decode("utf-8", "replace")
+  offset += reasonsize
+  events = []
+  for i in range(count):
+    events.append(EVENT.unpack_from(data, offset + i * size))
+  return { "start": start, "dumped": dumped, "reason": reason, "events": events }
+
+def player_time(value):
+  if value <= NOPTS or value != value:
+    return None
+  return value / DVD_TIME_BASE
+
+def describe(event):
+  time, thread, value1, value2, type, stream, arg = event
+  name, track, labels, playertimes = EVENTS.get(type, ("unknown %d" % type, "markers", ("arg", "value1", "value2"), ()))
+  values = [ arg, value1, value2 ]
+  # the clock value of a speed adjust is the adjust itself
+  if type != 7 or arg == 0:
+    for i in playertimes:
+      values[i] = player_time(values[i])
+  args = {}
+  for label, value in zip(labels, values):
+    if label is not None:
+      args[label] = value
+  if type == 1:
+    args["stream"] = STREAMS.get(stream, str(stream))
+    name = "%s %s" % (args["stream"], name)
+  return name, track, args
+
+def to_chrome(trace):
+  out = []
+  for tid, track in enumerate(TRACKS):
+    out.append({ "name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": { "name": track } })
+  out.append({ "name": "process_name", "ph": "M", "pid": 1, "args": { "name": "Kodi playback (%s)" % trace["reason"] } })
+
+  for event in trace["events"]:
+    name, track, args = describe(event)
+    ts = event[0] / 1000.0
+    tid = TRACKS.index(track)
+    args["thread"] = "%x" % event[1]
+    out.append({ "name": name, "ph": "i", "s": "t", "ts": ts, "pid": 1, "tid": tid, "args": args })
+
+    type = event[4]
+    if type == 8:
+      out.append({ "name": "cache level", "ph": "C", "ts": ts, "pid": 1, "args": { "level": args["level"] } })
+    elif type == 6:
+      out.append({ "name": "audio delay", "ph": "C", "ts": ts, "pid": 1, "args": { "delay": args["delay"] } })
+    elif type == 4:
+      out.append({ "name": "frame lateness", "ph": "C", "ts": ts, "pid": 1, "args": { "late": args["late"] } })
+    elif type == 3:
+      out.append({ "name": "render queue", "ph": "C", "ts": ts, "pid": 1, "args": { "queued": args["queued"] } })
+
+  return json.dumps({ "traceEvents": out, "displayTimeUnit": "ms" }, indent=1)
+
+def to_csv(trace):
+  lines = [ "time_ns,thread,event,stream,arg,value1,value2" ]
+  for event in trace["events"]:
+    time, thread, value1, value2, type, stream, arg = event
+    name = EVENTS.get(type, ("unknown %d" % type,))[0]
+    lines.append("%d,%x,%s,%s,%d,%r,%r" % (time, thread, name, STREAMS.get(stream, str(stream)) if type == 1 else "", arg, value1, value2))
+  return "\n".join(lines) + "\n"
+
+def main(argv):
+  args = [ a for a in argv[1:] if a != "--csv" ]
+  if len(args) < 1 or len(args) > 2:
+    sys.stderr.write("usage: %s [--csv] kodi-trace.trc [output]\n" % argv[0])
+    return 1
+  trace = read_trace(args[0])
+  text = to_csv(trace) if "--csv" in argv else to_chrome(trace)
+  if len(args) == 2:
+    with open(args[1], "w") as f:
+      f.write(text)
+  else:
+    sys.stdout.write(text)
+  return 0
+
+if __name__ == "__main__":
+  sys.exit(main(sys.argv))
@@ -27,6 +27,7 @@
 #else
 #define platform_stricmp stricmp
 #endif
+#include <algorithm>
 #include <cerrno>
 #include <dirent.h>
 #include <map>
@@ -58,6 +59,13 @@ using namespace std;
 #define FLAGS_USE_LZO     1
 #define FLAGS_ALLOW_YCOCG 2
 #define FLAGS_USE_DXT     4
+#define FLAGS_USE_ATLAS   8
+
+#define ATLAS_PAGE_SIZE      1024
+#define ATLAS_MAX_IMAGE_SIZE 128
+// images are surrounded by copies of their edges so filtering doesn't pick up
+// their neighbours, 4 pixels keep the images on DXT block boundaries
+#define ATLAS_GUTTER         4
 
 #define DIR_SEPARATOR "/"
 
@@ -280,6 +288,136 @@ CXBTFFrame createXBTFFrame(RGBAImage &image, CXBTFWriter& writer, double maxMSE,
   return frame;
 }
 
+struct AtlasImage
+{
+  size_t file;                 // index into the files of the bundle
+  std::vector<char> pixels;    // copy of the decoded frame, pitch is width * 4
+  int width;
+  int height;
+  unsigned int page;           // 1 based
+  int x;
+  int y;
+};
+
+static bool CompareAtlasImages(const AtlasImage *a, const AtlasImage *b)
+{
+  return a->height > b->height || (a->height == b->height && a->width > b->width);
+}
+
+static int AtlasCellSize(int size)
+{
+  return (size + 2 * ATLAS_GUTTER + 3) & ~3;
+}
+
+/* Pack the images into pages row by row, tallest first. Returns the number of pages and
+   the size of each page, which is only as high as needed. */
+static unsigned int PackAtlasImages(std::vector<AtlasImage> &images, std::vector<std::pair<int, int> > &pageSizes)
+{
+  std::vector<AtlasImage*> sorted;
+  for (size_t i = 0; i < images.size(); i++)
+    sorted.push_back(&images[i]);
+  std::stable_sort(sorted.begin(), sorted.end(), CompareAtlasImages);
+
+  int x = 0, y = 0, rowHeight = 0;
+  for (size_t i = 0; i < sorted.size(); i++)
+  {
+    AtlasImage &image = *sorted[i];
+    int cellWidth = AtlasCellSize(image.width);
+    int cellHeight = AtlasCellSize(image.height);
+    if (x + cellWidth > ATLAS_PAGE_SIZE)
+    { // next row
+      x = 0;
+      y += rowHeight;
+      rowHeight = 0;
+    }
+    if (pageSizes.empty() || y + cellHeight > ATLAS_PAGE_SIZE)
+    { // next page
+      pageSizes.push_back(std::make_pair(0, 0));
+      x = y = rowHeight = 0;
+    }
+    image.page = pageSizes.size();
+    image.x = x + ATLAS_GUTTER;
+    image.y = y + ATLAS_GUTTER;
+    x += cellWidth;
+    rowHeight = std::max(rowHeight, cellHeight);
+    pageSizes.back().first = std::max(pageSizes.back().first, x);
+    pageSizes.back().second = std::max(pageSizes.back().second, y + rowHeight);
+  }
+  return pageSizes.size();
+}
+
+static void CopyToAtlasPage(const AtlasImage &image, char *page, int pitch)
+{
+  for (int y = -ATLAS_GUTTER; y < image.height + ATLAS_GUTTER; y++)
+  {
+    int srcY = std::min(std::max(y, 0), image.height - 1);
+    char *dest = page + (image.y + y) * pitch + (image.x - ATLAS_GUTTER) * 4;
+    for (int x = -ATLAS_GUTTER; x < image.width + ATLAS_GUTTER; x++, dest += 4)
+    {
+      int srcX = std::min(std::max(x, 0), image.width - 1);
+      memcpy(dest, &image.pixels[(srcY * image.width + srcX) * 4], 4);
+    }
+  }
+}
+
+/* Write the atlas pages and point the frames of the atlased files at them. */
+static void createAtlas(CXBTFWriter &writer, std::vector<CXBTFFile> &files, std::vector<AtlasImage> &images, double maxMSE, unsigned int flags)
+{
+  std::vector<std::pair<int, int> > pageSizes;
+  unsigned int pages = PackAtlasImages(images, pageSizes);
+
+  for (unsigned int page = 1; page <= pages; page++)
+  {
+    RGBAImage pageImage;
+    pageImage.width = pageSizes[page - 1].first;
+    pageImage.height = pageSizes[page - 1].second;
+    pageImage.bbp = 32;
+    pageImage.pitch = pageImage.width * 4;
+    std::vector<char> pixels(pageImage.pitch * pageImage.height, 0);
+    pageImage.pixels = &pixels[0];
+
+    unsigned int count = 0;
+    for (size_t i = 0; i < images.size(); i++)
+    {
+      if (images[i].page == page)
+      {
+        CopyToAtlasPage(images[i], pageImage.pixels, pageImage.pitch);
+        count++;
+      }
+    }
+
+    CXBTFFile file;
+    file.SetPath(CXBTFFile::GetAtlasPagePath(page));
+    printf("%s\n", file.GetPath().c_str());
+    printf("    %4u images                                      ", count);
+    CXBTFFrame pageFrame = createXBTFFrame(pageImage, writer, maxMSE, flags);
+    file.GetFrames().push_back(pageFrame);
+    file.SetLoop(0);
+    writer.AddFile(file);
+    printf("%s%c (%d,%d @ %" PRIu64 " bytes)\n", GetFormatString(pageFrame.GetFormat()), pageFrame.HasAlpha() ? ' ' : '*',
+      pageFrame.GetWidth(), pageFrame.GetHeight(), pageFrame.GetUnpackedSize());
+
+    for (size_t i = 0; i < images.size(); i++)
+    {
+      AtlasImage &image = images[i];
+      if (image.page != page)
+        continue;
+
+      // no data of its own, the frame is a rectangle of the page
+      CXBTFFrame frame;
+      frame.SetWidth(image.width);
+      frame.SetHeight(image.height);
+      bool hasAlpha = HasAlpha((unsigned char *)&image.pixels[0], image.width, image.height);
+      frame.SetFormat(hasAlpha ? pageFrame.GetFormat() : pageFrame.GetFormat() | XB_FMT_OPAQUE);
+      frame.SetAtlas(page, image.x, image.y);
+
+      CXBTFFile& atlased = files[image.file];
+      atlased.GetFrames().push_back(frame);
+      writer.UpdateFile(atlased);
+    }
+  }
+}
+
 void Usage()
 {
   puts("Usage:");
@@ -290,6 +428,7 @@ void Usage()
   puts("  -use_lzo         Use lz0 packing.     Default: on");
   puts("  -use_dxt         Use DXT compression. Default: on");
   puts("  -use_none        Use No  compression. Default: off");
+  puts("  -atlas           Pack small single frame images into shared atlas pages. Default: off");
 }
 
 static bool checkDupe(struct MD5Context* ctx,
@@ -333,6 +472,7 @@ int createBundle(const std::string& InputDir, const std::string& OutputFile, dou
   CreateSkeletonHeader(writer, InputDir);
 
   std::vector<CXBTFFile> files = writer.GetFiles();
+  std::vector<AtlasImage> atlasImages;
   dupes.resize(files.size());
   if (!dupecheck)
   {
@@ -382,6 +522,25 @@ int createBundle(const std::string& InputDir, const std::string& OutputFile, dou
       }
     }
 
+    if (!skip && (flags & FLAGS_USE_ATLAS) && frames.frameList.size() == 1 &&
+        frames.frameList[0].rgbaImage.width <= ATLAS_MAX_IMAGE_SIZE &&
+        frames.frameList[0].rgbaImage.height <= ATLAS_MAX_IMAGE_SIZE)
+    { // packed into a page once all images are loaded
+      const RGBAImage &first = frames.frameList[0].rgbaImage;
+      AtlasImage image;
+      image.file = i;
+      image.width = first.width;
+      image.height = first.height;
+      image.page = 0;
+      image.x = image.y = 0;
+      image.pixels.resize(first.width * first.height * 4);
+      for (int y = 0; y < first.height; y++)
+        memcpy(&image.pixels[y * first.width * 4], first.pixels + y * first.pitch, first.width * 4);
+      atlasImages.push_back(image);
+      printf("    atlas\n");
+      skip = true;
+    }
+
     if (!skip)
     {
       for (unsigned int j = 0; j < frames.frameList.size(); j++)
@@ -400,6 +559,33 @@ int createBundle(const std::string& InputDir, const std::string& OutputFile, dou
     writer.UpdateFile(file);
   }
 
+  if (!atlasImages.empty())
+  {
+    createAtlas(writer, files, atlasImages, maxMSE, flags);
+
+    // duplicates of atlased images were seen before their frames existed
+    for (size_t i = 0; i < files.size(); i++)
+    {
+      if (dupes[i] != i && files[i].GetFrames().empty())
+      {
+        files[i].GetFrames() = files[dupes[i]].GetFrames();
+        writer.UpdateFile(files[i]);
+      }
+    }
+
+    // the pages are new files of the bundle, so the indices of the duplicates change
+    std::vector<CXBTFFile> allFiles = writer.GetFiles();
+    map<string, unsigned int> indices;
+    for (size_t i = 0; i < allFiles.size(); i++)
+      indices[allFiles[i].GetPath()] = i;
+    vector<unsigned int> allDupes(allFiles.size());
+    for (size_t i = 0; i < allFiles.size(); i++)
+      allDupes[i] = i;
+    for (size_t i = 0; i < files.size(); i++)
+      allDupes[indices[files[i].GetPath()]] = indices[files[dupes[i]].GetPath()];
+    dupes.swap(allDupes);
+  }
+
   if (!writer.UpdateHeader(dupes))
   {
     fprintf(stderr, "Error writing header to file\n");
@@ -474,6 +660,10 @@ int main(int argc, char* argv[])
     {
       flags |= FLAGS_USE_DXT;
     }
+    else if (!platform_stricmp(args[i], "-atlas"))
+    {
+      flags |= FLAGS_USE_ATLAS;
+    }
 #ifdef USE_LZO_PACKING
     else if (!platform_stricmp(args[i], "-use_lzo"))
     {
@@ -149,6 +149,9 @@ bool CXBTFWriter::UpdateHeader(const std::vector<unsigned int>& dupes)
       WRITE_U64(frame.GetUnpackedSize(), m_file);
       WRITE_U32(frame.GetDuration(), m_file);
       WRITE_U64(frame.GetOffset(), m_file);
+      WRITE_U32(frame.GetAtlasPage(), m_file);
+      WRITE_U32(frame.GetAtlasX(), m_file);
+      WRITE_U32(frame.GetAtlasY(), m_file);
     }
   }
 
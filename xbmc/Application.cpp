@@ -47,6 +47,7 @@
 #include "playlists/PlayListFactory.h"
 #include "guilib/GUIFontManager.h"
 #include "guilib/GUIColorManager.h"
+#include "guilib/GUIXMLCache.h"
 #include "guilib/StereoscopicsManager.h"
 #include "addons/LanguageResource.h"
 #include "addons/Skin.h"
@@ -607,6 +608,8 @@ bool CApplication::Create()
 
   g_powerManager.Initialize();
 
+  CAnnouncementManager::GetInstance().Start();
+
   // Load the AudioEngine before settings as they need to query the engine
   if (!CAEFactory::LoadEngine())
   {
@@ -1679,6 +1682,7 @@ bool CApplication::LoadSkin(const SkinPtr& skin)
   g_localizeStrings.LoadSkinStrings(langPath, CSettings::GetInstance().GetString(CSettings::SETTING_LOCALE_LANGUAGE));
 
   g_SkinInfo->LoadIncludes();
+  CGUIXMLCache::GetInstance().Load();
 
   int64_t start;
   start = CurrentHostCounter();
@@ -1768,6 +1772,8 @@ void CApplication::UnloadSkin(bool forReload /* = false */)
 
   g_colorManager.Clear();
 
+  CGUIXMLCache::GetInstance().Clear();
+
   g_infoManager.Clear();
 
 //  The g_SkinInfo shared_ptr ought to be reset here
@@ -1971,6 +1977,10 @@ void CApplication::Render()
   if (!m_skipGuiRender)
   {
     dirtyRegions = g_windowManager.GetDirty();
+    // nothing outside of the dirty regions is drawn unless video or the regions themselves are
+    if (!g_graphicsContext.GetStereoMode() && !m_pPlayer->IsPlayingVideo() &&
+        !g_advancedSettings.m_guiVisualizeDirtyRegions)
+      g_Windowing.SetDamageRegion(dirtyRegions);
     if (g_graphicsContext.GetStereoMode())
     {
       g_graphicsContext.SetStereoView(RENDER_STEREO_VIEW_LEFT);
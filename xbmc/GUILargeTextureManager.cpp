@@ -29,13 +29,18 @@
 #include "utils/log.h"
 #include "TextureCache.h"
 
+#include <algorithm>
 #include <cassert>
 
-CImageLoader::CImageLoader(const std::string &path, const bool useCache):
+#define PREVIEW_SCALE 4
+
+CImageLoader::CImageLoader(const std::string &path, const bool useCache, const bool preview):
   m_path(path)
 {
   m_texture = NULL;
   m_use_cache = useCache;
+  m_preview = preview;
+  m_final = true;
 }
 
 CImageLoader::~CImageLoader()
@@ -56,15 +61,27 @@ bool CImageLoader::DoWork()
 
   if (!loadPath.empty())
   {
+    unsigned int width = g_graphicsContext.GetWidth();
+    unsigned int height = g_graphicsContext.GetHeight();
+    if (m_preview)
+    { // a smaller decode is a lot cheaper, the full image is loaded later on
+      width /= PREVIEW_SCALE;
+      height /= PREVIEW_SCALE;
+    }
+
     // direct route - load the image
     unsigned int start = XbmcThreads::SystemClockMillis();
-    m_texture = CBaseTexture::LoadFromFile(loadPath, g_graphicsContext.GetWidth(), g_graphicsContext.GetHeight());
+    m_texture = CBaseTexture::LoadFromFile(loadPath, width, height);
 
     if (XbmcThreads::SystemClockMillis() - start > 100)
       CLog::Log(LOGDEBUG, "%s - took %u ms to load %s", __FUNCTION__, XbmcThreads::SystemClockMillis() - start, loadPath.c_str());
 
     if (m_texture)
     {
+      // small images are at full quality already
+      m_final = !m_preview || (m_texture->GetWidth() >= m_texture->GetOriginalWidth() &&
+                               m_texture->GetHeight() >= m_texture->GetOriginalHeight());
+
       if (needsChecking)
         CTextureCache::GetInstance().BackgroundCacheImage(texturePath);
 
@@ -83,17 +100,25 @@ bool CImageLoader::DoWork()
   return (m_texture != NULL);
 }
 
-CGUILargeTextureManager::CLargeTexture::CLargeTexture(const std::string &path):
+CGUILargeTextureManager::CLargeTexture::CLargeTexture(const std::string &path, bool useCache):
   m_path(path)
 {
   m_refCount = 1;
   m_timeToDelete = 0;
+  m_useCache = useCache;
+  m_loaded = false;
+  m_final = false;
+  m_jobID = 0;
+  m_demand = DEMAND_VISIBLE;
+  m_demandTime = 0;
+  m_sequence = 0;
 }
 
 CGUILargeTextureManager::CLargeTexture::~CLargeTexture()
 {
   assert(m_refCount == 0);
   m_texture.Free();
+  m_preview.Free();
 }
 
 void CGUILargeTextureManager::CLargeTexture::AddRef()
@@ -107,34 +132,45 @@ bool CGUILargeTextureManager::CLargeTexture::DecrRef(bool deleteImmediately)
   m_refCount--;
   if (m_refCount == 0)
   {
-    if (deleteImmediately)
-      delete this;
-    else
-      m_timeToDelete = CTimeUtils::GetFrameTime() + TIME_TO_DELETE;
+    m_timeToDelete = deleteImmediately ? 0 : CTimeUtils::GetFrameTime() + TIME_TO_DELETE;
     return true;
   }
   return false;
 }
 
-bool CGUILargeTextureManager::CLargeTexture::DeleteIfRequired(bool deleteImmediately)
+bool CGUILargeTextureManager::CLargeTexture::IsExpired() const
 {
-  if (m_refCount == 0 && (deleteImmediately || m_timeToDelete < CTimeUtils::GetFrameTime()))
-  {
-    delete this;
-    return true;
-  }
-  return false;
+  return m_refCount == 0 && m_timeToDelete < CTimeUtils::GetFrameTime();
 }
 
-void CGUILargeTextureManager::CLargeTexture::SetTexture(CBaseTexture* texture)
+void CGUILargeTextureManager::CLargeTexture::SetTexture(CBaseTexture* texture, bool final)
 {
-  assert(!m_texture.size());
   if (texture)
+  {
+    if (m_texture.size())
+    { // upgrade of the preview
+      assert(!m_preview.size());
+      m_preview = m_texture;
+      m_texture.Reset();
+    }
     m_texture.Set(texture, texture->GetWidth(), texture->GetHeight());
+  }
+  m_loaded = true;
+  m_final = final || !texture; // don't retry failed loads
+}
+
+void CGUILargeTextureManager::CLargeTexture::SetDemand(TEXTURE_DEMAND demand, unsigned int time, unsigned int sequence)
+{
+  if (demand != m_demand || IsStale(time))
+    m_sequence = sequence;
+  m_demand = demand;
+  m_demandTime = time;
 }
 
 CGUILargeTextureManager::CGUILargeTextureManager()
 {
+  m_demand = DEMAND_VISIBLE;
+  m_sequence = 0;
 }
 
 CGUILargeTextureManager::~CGUILargeTextureManager()
@@ -145,12 +181,16 @@ void CGUILargeTextureManager::CleanupUnusedImages(bool immediately)
 {
   CSingleLock lock(m_listSection);
   // check for items to remove from allocated list, and remove
-  listIterator it = m_allocated.begin();
-  while (it != m_allocated.end())
+  imageIterator it = m_images.begin();
+  while (it != m_images.end())
   {
-    CLargeTexture *image = *it;
-    if (image->DeleteIfRequired(immediately))
-      it = m_allocated.erase(it);
+    CLargeTexture *image = it->second;
+    if (image->IsUnused() && (immediately || image->IsExpired()))
+    {
+      CancelJob(image);
+      delete image;
+      it = m_images.erase(it);
+    }
     else
       ++it;
   }
@@ -158,88 +198,157 @@ void CGUILargeTextureManager::CleanupUnusedImages(bool immediately)
 
 // if available, increment reference count, and return the image.
 // else, add to the queue list if appropriate.
-bool CGUILargeTextureManager::GetImage(const std::string &path, CTextureArray &texture, bool firstRequest, const bool useCache)
+bool CGUILargeTextureManager::GetImage(const std::string &path, CTextureArray &texture, bool firstRequest, const bool useCache, bool *preview)
 {
   CSingleLock lock(m_listSection);
-  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  if (preview)
+    *preview = false;
+
+  imageIterator it = m_images.find(path);
+  if (it == m_images.end())
   {
-    CLargeTexture *image = *it;
-    if (image->GetPath() == path)
-    {
-      if (firstRequest)
-        image->AddRef();
-      texture = image->GetTexture();
-      return texture.size() > 0;
-    }
+    if (firstRequest)
+      QueueImage(path, useCache);
+    return true;
   }
 
+  CLargeTexture *image = it->second;
   if (firstRequest)
-    QueueImage(path, useCache);
+    image->AddRef();
+
+  // every poll keeps the request fresh, re-sort if the demand went up
+  TEXTURE_DEMAND demand = image->GetDemand();
+  image->SetDemand(m_demand, CTimeUtils::GetFrameTime(), ++m_sequence);
+  if (image->NeedsLoading() && (firstRequest || m_demand < demand))
+    ScheduleJobs();
 
-  return true;
+  texture = image->GetTexture();
+  if (!image->IsLoaded())
+    return true; // not ready as yet
+
+  if (preview)
+    *preview = !image->IsFinal();
+  return texture.size() > 0;
 }
 
 void CGUILargeTextureManager::ReleaseImage(const std::string &path, bool immediately)
 {
   CSingleLock lock(m_listSection);
-  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
-  {
-    CLargeTexture *image = *it;
-    if (image->GetPath() == path)
-    {
-      if (image->DecrRef(immediately) && immediately)
-        m_allocated.erase(it);
-      return;
-    }
-  }
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  imageIterator it = m_images.find(path);
+  if (it == m_images.end())
+    return;
+
+  CLargeTexture *image = it->second;
+  if (!image->DecrRef(immediately))
+    return;
+
+  // nobody wants this one anymore, cancel any load in progress
+  CancelJob(image);
+  if (immediately || !image->GetTexture().size())
   {
-    unsigned int id = it->first;
-    CLargeTexture *image = it->second;
-    if (image->GetPath() == path && image->DecrRef(true))
-    {
-      // cancel this job
-      CJobManager::GetInstance().CancelJob(id);
-      m_queued.erase(it);
-      return;
-    }
+    delete image;
+    m_images.erase(it);
   }
+  ScheduleJobs();
 }
 
 // queue the image, and start the background loader if necessary
 void CGUILargeTextureManager::QueueImage(const std::string &path, bool useCache)
 {
   CSingleLock lock(m_listSection);
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  CLargeTexture *image = new CLargeTexture(path, useCache);
+  image->SetDemand(m_demand, CTimeUtils::GetFrameTime(), ++m_sequence);
+  m_images.insert(std::make_pair(path, image));
+  ScheduleJobs();
+}
+
+bool CGUILargeTextureManager::IsMoreImportant(const CLargeTexture *image, const CLargeTexture *other, unsigned int time) const
+{
+  // fresh requests first, then by demand
+  bool stale = image->IsStale(time);
+  if (stale != other->IsStale(time))
+    return !stale;
+  if (image->GetDemand() != other->GetDemand())
+    return image->GetDemand() < other->GetDemand();
+
+  // something is better than nothing, previews before upgrades
+  if (image->IsLoaded() != other->IsLoaded())
+    return !image->IsLoaded();
+
+  // the latest requests are the ones which scrolled in last
+  return image->GetSequence() > other->GetSequence();
+}
+
+void CGUILargeTextureManager::ScheduleJobs()
+{
+  unsigned int time = CTimeUtils::GetFrameTime();
+
+  while (true)
   {
-    CLargeTexture *image = it->second;
-    if (image->GetPath() == path)
+    // find the most important request waiting and count the on screen ones
+    CLargeTexture *next = NULL;
+    unsigned int visibleWaiting = 0;
+    for (imageIterator it = m_images.begin(); it != m_images.end(); ++it)
+    {
+      CLargeTexture *image = it->second;
+      if (!image->NeedsLoading())
+        continue;
+      if (!image->IsLoaded() && image->GetDemand() == DEMAND_VISIBLE && !image->IsStale(time))
+        visibleWaiting++;
+      if (!next || IsMoreImportant(image, next, time))
+        next = image;
+    }
+    if (!next)
+      return;
+
+    if (m_loading.size() >= MAX_LOADING_JOBS)
     {
-      image->AddRef();
-      return; // already queued
+      // make room by cancelling a stale load in favour of a fresh request
+      if (next->IsStale(time))
+        return;
+      std::vector<CLargeTexture *>::iterator stale = m_loading.begin();
+      while (stale != m_loading.end() && !(*stale)->IsStale(time))
+        ++stale;
+      if (stale == m_loading.end())
+        return;
+      CancelJob(*stale);
     }
+
+    // while more on screen images are waiting, get a preview of each up first
+    bool preview = !next->IsLoaded() && next->GetDemand() == DEMAND_VISIBLE && visibleWaiting > 1;
+    CJob::PRIORITY priority = next->GetDemand() == DEMAND_VISIBLE ? CJob::PRIORITY_NORMAL : CJob::PRIORITY_LOW;
+    next->m_jobID = CJobManager::GetInstance().AddJob(new CImageLoader(next->GetPath(), next->UseCache(), preview), this, priority);
+    if (!next->m_jobID)
+      return; // shutting down
+    m_loading.push_back(next);
   }
+}
 
-  // queue the item
-  CLargeTexture *image = new CLargeTexture(path);
-  unsigned int jobID = CJobManager::GetInstance().AddJob(new CImageLoader(path, useCache), this, CJob::PRIORITY_NORMAL);
-  m_queued.push_back(std::make_pair(jobID, image));
+void CGUILargeTextureManager::CancelJob(CLargeTexture *image)
+{
+  if (!image->m_jobID)
+    return;
+
+  CJobManager::GetInstance().CancelJob(image->m_jobID);
+  image->m_jobID = 0;
+  m_loading.erase(std::remove(m_loading.begin(), m_loading.end(), image), m_loading.end());
 }
 
 void CGUILargeTextureManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 {
   // see if we still have this job id
   CSingleLock lock(m_listSection);
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  for (std::vector<CLargeTexture *>::iterator it = m_loading.begin(); it != m_loading.end(); ++it)
   {
-    if (it->first == jobID)
+    CLargeTexture *image = *it;
+    if (image->m_jobID == jobID)
     { // found our job
       CImageLoader *loader = (CImageLoader *)job;
-      CLargeTexture *image = it->second;
-      image->SetTexture(loader->m_texture);
+      image->SetTexture(loader->m_texture, loader->m_final);
       loader->m_texture = NULL; // we want to keep the texture, and jobs are auto-deleted.
-      m_queued.erase(it);
-      m_allocated.push_back(image);
+      image->m_jobID = 0;
+      m_loading.erase(it);
+      ScheduleJobs();
       return;
     }
   }
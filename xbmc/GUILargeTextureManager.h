@@ -20,6 +20,7 @@
  *
  */
 
+#include <unordered_map>
 #include <utility>
 
 #include "guilib/TextureManager.h"
@@ -37,7 +38,7 @@
 class CImageLoader : public CJob
 {
 public:
-  CImageLoader(const std::string &path, const bool useCache);
+  CImageLoader(const std::string &path, const bool useCache, const bool preview = false);
   virtual ~CImageLoader();
 
   /*!
@@ -46,6 +47,8 @@ public:
   virtual bool DoWork();
 
   bool          m_use_cache; ///< Whether or not to use any caching with this image
+  bool          m_preview; ///< Whether a reduced size variant is requested
+  bool          m_final; ///< Whether the loaded texture is the full quality image
   std::string    m_path; ///< path of image to load
   CBaseTexture *m_texture; ///< Texture object to load the image into \sa CBaseTexture.
 };
@@ -57,11 +60,25 @@ public:
  Used to load textures for the user interface asynchronously, allowing fluid framerates
  while background loading textures.
 
+ Requests are not handed to the job manager in the order they arrive. Only a few loader jobs
+ are in flight at any time, the next one is picked by demand: images on screen come first,
+ followed by the ones prefetched in the scroll direction and then the ones kept around the
+ visible area. Requests which haven't been polled for a while are considered stale and give
+ way to fresh ones. While on screen images are waiting, they are loaded as a reduced size
+ preview first and upgraded to the full quality image afterwards.
+
  \sa IJobCallback, CGUITexture
  */
 class CGUILargeTextureManager : public IJobCallback
 {
 public:
+  enum TEXTURE_DEMAND
+  {
+    DEMAND_VISIBLE = 0, ///< on screen
+    DEMAND_PREFETCH,    ///< next page in the scroll direction
+    DEMAND_NEAR         ///< cached around the visible area
+  };
+
   CGUILargeTextureManager();
   virtual ~CGUILargeTextureManager();
 
@@ -85,10 +102,23 @@ public:
    \param texture texture object to hold the resulting texture
    \param orientation orientation of resulting texture
    \param firstRequest true if this is the first time we are requesting this texture
+   \param preview if not NULL, set to true when the returned texture is a reduced size variant
+                  which is going to be upgraded, the caller should keep polling until it is false.
    \return true if the image exists, else false.
-   \sa CGUITextureArray and CGUITexture
+   \sa CGUITextureArray and CGUITexture, SetDemand
+   */
+  bool GetImage(const std::string &path, CTextureArray &texture, bool firstRequest, bool useCache = true, bool *preview = NULL);
+
+  /*!
+   \brief Set the demand for images requested from now on.
+
+   Containers set the demand while processing their items, so that the images on screen
+   are loaded before the ones only cached. Requests outside of a container are on screen.
+   Must only be called from the GUI thread, which is the one calling GetImage().
+
+   \param demand demand of the following requests
    */
-  bool GetImage(const std::string &path, CTextureArray &texture, bool firstRequest, bool useCache = true);
+  void SetDemand(TEXTURE_DEMAND demand) { m_demand = demand; };
 
   /*!
    \brief Request a texture to be unloaded.
@@ -118,32 +148,66 @@ private:
   class CLargeTexture
   {
   public:
-    CLargeTexture(const std::string &path);
+    CLargeTexture(const std::string &path, bool useCache);
     virtual ~CLargeTexture();
 
     void AddRef();
     bool DecrRef(bool deleteImmediately);
-    bool DeleteIfRequired(bool deleteImmediately = false);
-    void SetTexture(CBaseTexture* texture);
+    bool IsUnused() const { return m_refCount == 0; };
+    bool IsExpired() const;
+    void SetTexture(CBaseTexture* texture, bool final);
 
     const std::string &GetPath() const { return m_path; };
     const CTextureArray &GetTexture() const { return m_texture; };
+    bool UseCache() const { return m_useCache; };
+
+    bool IsLoaded() const { return m_loaded; };
+    bool IsFinal() const { return m_final; };
+    bool NeedsLoading() const { return m_refCount > 0 && !m_final && m_jobID == 0; };
+
+    void SetDemand(TEXTURE_DEMAND demand, unsigned int time, unsigned int sequence);
+    TEXTURE_DEMAND GetDemand() const { return m_demand; };
+    bool IsStale(unsigned int time) const { return m_demandTime + TIME_TO_STALE < time; };
+    unsigned int GetSequence() const { return m_sequence; };
+
+    unsigned int m_jobID;
 
   private:
     static const unsigned int TIME_TO_DELETE = 2000;
+    static const unsigned int TIME_TO_STALE = 500;
 
     unsigned int m_refCount;
     std::string m_path;
     CTextureArray m_texture;
+    CTextureArray m_preview; ///< kept until deleted, GUI textures may still reference it
     unsigned int m_timeToDelete;
+    bool m_useCache;
+    bool m_loaded;
+    bool m_final;
+
+    TEXTURE_DEMAND m_demand;
+    unsigned int m_demandTime;
+    unsigned int m_sequence;
   };
 
+  static const size_t MAX_LOADING_JOBS = 4;
+
   void QueueImage(const std::string &path, bool useCache = true);
 
-  std::vector< std::pair<unsigned int, CLargeTexture *> > m_queued;
-  std::vector<CLargeTexture *> m_allocated;
-  typedef std::vector<CLargeTexture *>::iterator listIterator;
-  typedef std::vector< std::pair<unsigned int, CLargeTexture *> >::iterator queueIterator;
+  /*!
+   \brief Hand the most important waiting requests to the job manager.
+   */
+  void ScheduleJobs();
+  bool IsMoreImportant(const CLargeTexture *image, const CLargeTexture *other, unsigned int time) const;
+  void CancelJob(CLargeTexture *image);
+
+  typedef std::unordered_map<std::string, CLargeTexture *> imageMap;
+  typedef imageMap::iterator imageIterator;
+  imageMap m_images;
+  std::vector<CLargeTexture *> m_loading;
+
+  TEXTURE_DEMAND m_demand;
+  unsigned int m_sequence;
 
   CCriticalSection m_listSection;
 };
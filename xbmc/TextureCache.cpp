@@ -18,11 +18,14 @@
  *
  */
 
+#include <algorithm>
+
 #include "TextureCache.h"
 #include "TextureCacheJob.h"
 #include "filesystem/File.h"
 #include "profiles/ProfilesManager.h"
 #include "threads/SingleLock.h"
+#include "utils/CPUInfo.h"
 #include "utils/Crc32.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/log.h"
@@ -38,7 +41,9 @@ CTextureCache &CTextureCache::GetInstance()
   return s_cache;
 }
 
-CTextureCache::CTextureCache() : CJobQueue(false, 1, CJob::PRIORITY_LOW_PAUSABLE)
+// images are decoded in parallel, pausable jobs get at most two workers anyway
+CTextureCache::CTextureCache() : CJobQueue(false, std::max(1, std::min(g_cpuInfo.getCPUCount(), 2)), CJob::PRIORITY_LOW_PAUSABLE),
+  m_ddsJobs(false, 1, CJob::PRIORITY_LOW_PAUSABLE)
 {
 }
 
@@ -56,6 +61,7 @@ void CTextureCache::Initialize()
 void CTextureCache::Deinitialize()
 {
   CancelJobs();
+  m_ddsJobs.CancelJobs();
   CSingleLock lock(m_databaseSection);
   m_database.Close();
 }
@@ -115,13 +121,23 @@ std::string CTextureCache::CheckCachedImage(const std::string &url, bool returnD
       if (CFile::Exists(ddsPath))
         return ddsPath;
       if (g_advancedSettings.m_useDDSFanart)
-        AddJob(new CTextureDDSJob(path));
+        AddDDSJob(new CTextureDDSJob(path));
     }
     return path;
   }
   return "";
 }
 
+std::string CTextureCache::CheckCachedImage(const std::string &url, CTextureDetails &details)
+{
+  return GetCachedImage(url, details, true);
+}
+
+void CTextureCache::AddDDSJob(CTextureDDSJob *job)
+{
+  m_ddsJobs.AddJob(job);
+}
+
 void CTextureCache::BackgroundCacheImage(const std::string &url)
 {
   CTextureDetails details;
@@ -283,8 +299,6 @@ void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
   m_completeEvent.Set();
 
   // TODO: call back to the UI indicating that it can update it's image...
-  if (success && g_advancedSettings.m_useDDSFanart && !job->m_details.file.empty())
-    AddJob(new CTextureDDSJob(GetCachedPath(job->m_details.file)));
 }
 
 void CTextureCache::OnJobComplete(unsigned int jobID, bool success, CJob *job)
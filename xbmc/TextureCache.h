@@ -29,6 +29,7 @@
 
 class CURL;
 class CBaseTexture;
+class CTextureDDSJob;
 
 /*!
  \ingroup textures
@@ -71,6 +72,14 @@ public:
    */ 
   std::string CheckCachedImage(const std::string &image, bool returnDDS, bool &needsRecaching);
 
+  /*! \brief Check whether we already have this image cached, returning the details of the cached texture
+   \param image url of the image to check
+   \param details [out] details of the cached texture (e.g. its size)
+   \return cached url of this image, empty if it isn't cached
+   \sa CheckCachedImage
+   */
+  std::string CheckCachedImage(const std::string &image, CTextureDetails &details);
+
   /*! \brief Cache image (if required) using a background job
 
    Checks firstly whether an image is already cached, and return URL if so [see CheckCacheImage]
@@ -82,6 +91,16 @@ public:
    */
   void BackgroundCacheImage(const std::string &image);
 
+  /*! \brief Create the .dds version of a cached image in the background
+
+   The .dds jobs are run one at a time in a queue of their own, so they neither hold up caching
+   nor pile up in the job manager.
+
+   \param job the job to queue, taken over
+   \sa CTextureDDSJob
+   */
+  void AddDDSJob(CTextureDDSJob *job);
+
   /*! \brief Cache an image to image cache, optionally return the texture
 
    Caches the given image, returning the texture if the caller wants it.
@@ -228,5 +247,6 @@ private:
   CEvent               m_completeEvent; ///< Set whenever a job has finished
   std::vector<CTextureDetails> m_useCounts; ///< Use count tracking
   CCriticalSection             m_useCountSection;
+  CJobQueue                    m_ddsJobs; ///< queue of the jobs creating .dds versions
 };
 
@@ -18,10 +18,13 @@
  *
  */
 
+#include <atomic>
+
 #include "TextureCacheJob.h"
 #include "TextureCache.h"
 #include "guilib/Texture.h"
 #include "guilib/DDSImage.h"
+#include "guilib/JpegIO.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "utils/log.h"
@@ -33,10 +36,16 @@
 #include "FileItem.h"
 #include "music/MusicThumbLoader.h"
 #include "music/tags/MusicInfoTag.h"
+#include "windowing/WindowingFactory.h"
 #if defined(HAS_OMXPLAYER)
 #include "cores/omxplayer/OMXImage.h"
 #endif
 
+// decoded textures kept by .dds jobs waiting to run, the others load the cached texture
+#define DDS_MAX_TEXTURES_TAKEN 4
+
+static std::atomic<int> s_texturesTaken(0);
+
 CTextureCacheJob::CTextureCacheJob(const std::string &url, const std::string &oldHash):
   m_url(url),
   m_oldHash(oldHash),
@@ -71,7 +80,32 @@ bool CTextureCacheJob::DoWork()
   std::string path(CTextureCache::GetInstance().CheckCachedImage(m_url, false, needsRecaching));
   if (!path.empty() && !needsRecaching)
     return false;
-  return CacheTexture();
+
+  bool dds = g_advancedSettings.m_useDDSFanart;
+  CBaseTexture *texture = NULL;
+  if (!CacheTexture(dds && CTextureDDSJob::CanTakeTexture() ? &texture : NULL))
+    return false;
+
+  // compress the fresh thumb in a job of its own, the compression (ETC1 in particular) is too slow
+  // to hold up caching. The decoded texture is handed over if it is what was cached.
+  if (dds && !m_details.file.empty())
+  {
+    std::string cachedFile = CTextureCache::GetCachedPath(m_details.file);
+    std::string ddsFile = URIUtils::ReplaceExtension(cachedFile, ".dds");
+    if (XFILE::CFile::Exists(ddsFile))
+      XFILE::CFile::Delete(ddsFile);
+
+    if (texture && (texture->GetWidth() != m_details.width || texture->GetHeight() != m_details.height ||
+                    texture->GetOrientation()))
+    {
+      delete texture;
+      texture = NULL;
+    }
+    CTextureCache::GetInstance().AddDDSJob(new CTextureDDSJob(cachedFile, texture));
+    texture = NULL;
+  }
+  delete texture;
+  return true;
 }
 
 bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
@@ -103,7 +137,7 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
     return true;
   }
 #endif
-  CBaseTexture *texture = LoadImage(image, width, height, additional_info, true);
+  CBaseTexture *texture = LoadImage(image, width, height, additional_info, true, true);
   if (texture)
   {
     if (texture->HasAlpha())
@@ -192,13 +226,23 @@ std::string CTextureCacheJob::DecodeImageURL(const std::string &url, unsigned in
   return image;
 }
 
-CBaseTexture *CTextureCacheJob::LoadImage(const std::string &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels)
+static bool IsJpeg(const std::string &mimeType)
+{
+  // same types ImageFactory hands to CJpegIO
+  return mimeType == "image/jpeg" || mimeType == "image/jpg" || mimeType == "image/tbn";
+}
+
+CBaseTexture *CTextureCacheJob::LoadImage(const std::string &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels, bool fitToCache)
 {
   if (additional_info == "music")
   { // special case for embedded music images
     MUSIC_INFO::EmbeddedArt art;
     if (CMusicThumbLoader::GetEmbeddedThumb(image, art))
+    {
+      if (fitToCache && IsJpeg(art.mime))
+        GetDecodeSize(&art.data[0], art.size, width, height);
       return CBaseTexture::LoadFromFileInMemory(&art.data[0], art.size, art.mime, width, height);
+    }
   }
 
   // Validate file URL to see if it is an image
@@ -208,7 +252,19 @@ CBaseTexture *CTextureCacheJob::LoadImage(const std::string &image, unsigned int
       && !StringUtils::StartsWithNoCase(file.GetMimeType(), "image/") && !StringUtils::EqualsNoCase(file.GetMimeType(), "application/octet-stream")) // ignore non-pictures
     return NULL;
 
-  CBaseTexture *texture = CBaseTexture::LoadFromFile(image, width, height, requirePixels, file.GetMimeType());
+  CBaseTexture *texture = NULL;
+  if (fitToCache && IsJpeg(file.GetMimeType()))
+  { // the decode size depends on the image size, so we need the file first
+    XFILE::CFile jpeg;
+    XFILE::auto_buffer buf;
+    if (jpeg.LoadFile(image, buf) <= 0)
+      return NULL;
+
+    GetDecodeSize((unsigned char *)buf.get(), buf.size(), width, height);
+    texture = CBaseTexture::LoadFromFileInMemory((unsigned char *)buf.get(), buf.size(), file.GetMimeType(), width, height);
+  }
+  else
+    texture = CBaseTexture::LoadFromFile(image, width, height, requirePixels, file.GetMimeType());
   if (!texture)
     return NULL;
 
@@ -221,6 +277,19 @@ CBaseTexture *CTextureCacheJob::LoadImage(const std::string &image, unsigned int
   return texture;
 }
 
+void CTextureCacheJob::GetDecodeSize(unsigned char *buffer, size_t size, unsigned int &width, unsigned int &height)
+{
+  unsigned int imageWidth, imageHeight;
+  if (!CJpegIO::GetImageSize(buffer, size, imageWidth, imageHeight) || !imageWidth || !imageHeight)
+    return;
+
+  // CJpegIO picks the smallest IDCT scale at least as large as this
+  uint32_t cacheWidth = width, cacheHeight = height;
+  CPicture::GetCacheSize(imageWidth, imageHeight, cacheWidth, cacheHeight);
+  width = cacheWidth;
+  height = cacheHeight;
+}
+
 bool CTextureCacheJob::UpdateableURL(const std::string &url) const
 {
   // we don't constantly check online images
@@ -249,9 +318,26 @@ std::string CTextureCacheJob::GetImageHash(const std::string &url)
   return "";
 }
 
-CTextureDDSJob::CTextureDDSJob(const std::string &original):
-  m_original(original)
+CTextureDDSJob::CTextureDDSJob(const std::string &original, CBaseTexture *texture /* = NULL */):
+  m_original(original),
+  m_texture(texture)
 {
+  if (m_texture)
+    s_texturesTaken++;
+}
+
+CTextureDDSJob::~CTextureDDSJob()
+{
+  if (m_texture)
+  {
+    delete m_texture;
+    s_texturesTaken--;
+  }
+}
+
+bool CTextureDDSJob::CanTakeTexture()
+{
+  return s_texturesTaken < DDS_MAX_TEXTURES_TAKEN;
 }
 
 bool CTextureDDSJob::operator==(const CJob* job) const
@@ -269,12 +355,29 @@ bool CTextureDDSJob::DoWork()
 {
   if (URIUtils::HasExtension(m_original, ".dds"))
     return false;
-  CBaseTexture *texture = CBaseTexture::LoadFromFile(m_original);
+  CBaseTexture *texture = m_texture;
   if (texture)
-  { // convert to DDS
+  {
+    m_texture = NULL;
+    s_texturesTaken--;
+  }
+  else
+    texture = CBaseTexture::LoadFromFile(m_original);
+  if (texture)
+  { // convert to DDS, using the format the GPU can sample from
+    unsigned int format = XB_FMT_DXT1;
+    if (!g_Windowing.SupportsDXT() && g_Windowing.SupportsETC1())
+    {
+      if (texture->HasAlpha())
+      { // ETC1 has no alpha channel, keep using the png
+        delete texture;
+        return false;
+      }
+      format = XB_FMT_ETC1;
+    }
     CDDSImage dds;
     CLog::Log(LOGDEBUG, "Creating DDS version of: %s", m_original.c_str());
-    bool ret = dds.Create(URIUtils::ReplaceExtension(m_original, ".dds"), texture->GetWidth(), texture->GetHeight(), texture->GetPitch(), texture->GetPixels(), 40);
+    bool ret = dds.Create(URIUtils::ReplaceExtension(m_original, ".dds"), texture->GetWidth(), texture->GetHeight(), texture->GetPitch(), texture->GetPixels(), 40, format);
     delete texture;
     return ret;
   }
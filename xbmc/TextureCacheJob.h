@@ -81,6 +81,24 @@ public:
 
   static bool ResizeTexture(const std::string &url, uint8_t* &result, size_t &result_size);
 
+  /*! \brief Load an image at a given target size and orientation.
+
+   Doesn't necessarily load the image at the desired size - the loader *may* decide to load it slightly larger
+   or smaller than the desired size for speed reasons.
+
+   \param image the URL of the image file.
+   \param width the desired maximum width.
+   \param height the desired maximum height.
+   \param additional_info extra info for loading, such as whether to flip horizontally.
+   \param requirePixels whether the pixels are needed rather than just a texture.
+   \param fitToCache decode JPEGs only as large as needed for the cached version, which libjpeg does
+                     a lot faster than decoding the full image (scaled IDCT). Implies requirePixels.
+   \return a pointer to a CBaseTexture object, NULL if failed.
+   \sa CPicture::GetCacheSize
+   */
+  static CBaseTexture *LoadImage(const std::string &image, unsigned int width, unsigned int height, const std::string &additional_info,
+                                 bool requirePixels = false, bool fitToCache = false);
+
   std::string m_url;
   std::string m_oldHash;
   CTextureDetails m_details;
@@ -111,18 +129,13 @@ private:
    */
   static std::string DecodeImageURL(const std::string &url, unsigned int &width, unsigned int &height, CPictureScalingAlgorithm::Algorithm& scalingAlgorithm, std::string &additional_info);
 
-  /*! \brief Load an image at a given target size and orientation.
-
-   Doesn't necessarily load the image at the desired size - the loader *may* decide to load it slightly larger
-   or smaller than the desired size for speed reasons.
-
-   \param image the URL of the image file.
-   \param width the desired maximum width.
-   \param height the desired maximum height.
-   \param additional_info extra info for loading, such as whether to flip horizontally.
-   \return a pointer to a CBaseTexture object, NULL if failed.
+  /*! \brief Reduce the size a JPEG is decoded at to the size it is going to be cached at
+   \param buffer the JPEG file
+   \param size size of the JPEG file
+   \param width [in/out] maximum width of the cached version - replaced with the size to decode at
+   \param height [in/out] maximum height of the cached version - replaced with the size to decode at
    */
-  static CBaseTexture *LoadImage(const std::string &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels = false);
+  static void GetDecodeSize(unsigned char *buffer, size_t size, unsigned int &width, unsigned int &height);
 
   std::string    m_cachePath;
 };
@@ -132,13 +145,25 @@ private:
 class CTextureDDSJob : public CJob
 {
 public:
-  CTextureDDSJob(const std::string &original);
+  /*!
+   \brief create the .dds version of a cached texture
+   \param original path of the cached texture
+   \param texture the decoded cached texture, the job takes it over. The cached texture is loaded if NULL.
+   */
+  CTextureDDSJob(const std::string &original, CBaseTexture *texture = NULL);
+  virtual ~CTextureDDSJob();
 
   virtual const char* GetType() const { return kJobTypeDDSCompress; };
   virtual bool operator==(const CJob *job) const;
   virtual bool DoWork();
 
+  /*!
+   \brief whether another decoded texture may be handed to a job, as they are kept until the job runs
+   */
+  static bool CanTakeTexture();
+
   std::string m_original;
+  CBaseTexture *m_texture;
 };
 
 /* \brief Job class for storing the use count of textures
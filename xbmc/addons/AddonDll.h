@@ -235,7 +235,8 @@ ADDON_STATUS CAddonDll<TheDll, TheStruct, TheProps>::Create()
     if (status == ADDON_STATUS_OK)
     {
       m_initialized = true;
-      ANNOUNCEMENT::CAnnouncementManager::GetInstance().AddAnnouncer(this);
+      // the dll is unloaded right after the add-on removed itself, it mustn't be called anymore then
+      ANNOUNCEMENT::CAnnouncementManager::GetInstance().AddAnnouncer(this, true);
     }
     else if ((status == ADDON_STATUS_NEED_SETTINGS) || (status == ADDON_STATUS_NEED_SAVEDSETTINGS))
     {
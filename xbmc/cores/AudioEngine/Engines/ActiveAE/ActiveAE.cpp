@@ -36,6 +36,7 @@ using namespace ActiveAE;
 #define MAX_CACHE_LEVEL 0.4   // total cache time of stream in seconds
 #define MAX_WATER_LEVEL 0.2   // buffered time after stream stages in seconds
 #define MAX_BUFFER_TIME 0.1   // max time of a buffer in seconds
+#define ENCODER_LOOKAHEAD 3   // frames being encoded ahead of the sink
 
 void CEngineStats::Reset(unsigned int sampleRate)
 {
@@ -409,7 +410,8 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
             m_extTimeout = 0;
             return;
           }
-          if (!m_sinkBuffers->m_inputSamples.empty() || !m_sinkBuffers->m_outputSamples.empty())
+          if (!m_sinkBuffers->m_inputSamples.empty() || !m_sinkBuffers->m_outputSamples.empty() ||
+              (m_encoderBuffers && m_encoderBuffers->IsEncoding()))
           {
             m_extTimeout = 100;
             return;
@@ -832,6 +834,9 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
           {
             ClearDiscardedBuffers();
             m_extTimeout = 100;
+            // poll for frames the encoder is working on
+            if (m_encoderBuffers && m_encoderBuffers->IsEncoding())
+              m_extTimeout = 5;
             return;
           }
           m_extTimeout = 0;
@@ -1051,14 +1056,15 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
     bool streaming = false;
     m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::STREAMING, &streaming, sizeof(bool));
 
-    delete m_encoder;
-    m_encoder = NULL;
-
     if (m_encoderBuffers)
     {
+      m_encoderBuffers->Flush();
       m_discardBufferPools.push_back(m_encoderBuffers);
       m_encoderBuffers = NULL;
     }
+
+    delete m_encoder;
+    m_encoder = NULL;
     if (m_vizBuffers)
     {
       m_discardBufferPools.push_back(m_vizBuffers);
@@ -1116,12 +1122,13 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
         format.m_encodedRate = m_encoderFormat.m_sampleRate;
         if (m_encoderBuffers && initSink)
         {
+          m_encoderBuffers->Flush();
           m_discardBufferPools.push_back(m_encoderBuffers);
           m_encoderBuffers = NULL;
         }
         if (!m_encoderBuffers)
         {
-          m_encoderBuffers = new CActiveAEBufferPool(format);
+          m_encoderBuffers = new CActiveAEBufferPoolEncode(format, m_encoder, ENCODER_LOOKAHEAD);
           m_encoderBuffers->Create(MAX_WATER_LEVEL*1000);
         }
       }
@@ -1216,8 +1223,8 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
         m_vizBuffersInput = new CActiveAEBufferPool(m_internalFormat);
         m_vizBuffersInput->Create(2000);
 
-        // resample buffers
-        m_vizBuffers = new CActiveAEBufferPoolResample(m_internalFormat, vizFormat, m_settings.resampleQuality);
+        // resample buffers, visualisation does not benefit from a long filter
+        m_vizBuffers = new CActiveAEBufferPoolResample(m_internalFormat, vizFormat, AE_QUALITY_LOW);
         // TODO use cache of sync + water level
         m_vizBuffers->Create(2000, false, false);
         m_vizInitialized = false;
@@ -1365,6 +1372,8 @@ void CActiveAE::FlushEngine()
     m_sinkBuffers->Flush();
   if (m_vizBuffers)
     m_vizBuffers->Flush();
+  if (m_encoderBuffers)
+    m_encoderBuffers->Flush();
 
   // send message to sink
   Message *reply;
@@ -1397,6 +1406,11 @@ void CActiveAE::ClearDiscardedBuffers()
     {
       rbuf->Flush();
     }
+    CActiveAEBufferPoolEncode *ebuf = dynamic_cast<CActiveAEBufferPoolEncode*>(*it);
+    if (ebuf)
+    {
+      ebuf->Flush();
+    }
     // if all buffers have returned, we can delete the buffer pool
     if ((*it)->m_allSamples.size() == (*it)->m_freeSamples.size())
     {
@@ -1797,7 +1811,7 @@ bool CActiveAE::RunStages()
   }
 
   if (m_stats.GetWaterLevel() < MAX_WATER_LEVEL &&
-     (m_mode != MODE_TRANSCODE || (m_encoderBuffers && !m_encoderBuffers->m_freeSamples.empty())))
+     (m_mode != MODE_TRANSCODE || (m_encoderBuffers && m_encoderBuffers->AcceptsSamples())))
   {
     // mix streams and sounds sounds
     if (m_mode != MODE_RAW)
@@ -2067,21 +2081,6 @@ bool CActiveAE::RunStages()
         if (!m_sinkHasVolume || m_muted)
           Deamplify(*(out->pkt));
 
-        if (m_mode == MODE_TRANSCODE && m_encoder)
-        {
-          CSampleBuffer *buf = m_encoderBuffers->GetFreeBuffer();
-          m_encoder->Encode(out->pkt->data[0], out->pkt->planes*out->pkt->linesize,
-                            buf->pkt->data[0], buf->pkt->planes*buf->pkt->linesize);
-          buf->pkt->nb_samples = buf->pkt->max_nb_samples;
-
-          // set pts of last sample
-          buf->pkt_start_offset = buf->pkt->nb_samples;
-          buf->timestamp = out->timestamp;
-          buf->clockId = out->clockId;
-
-          out->Return();
-          out = buf;
-        }
         busy = true;
       }
 
@@ -2089,7 +2088,12 @@ bool CActiveAE::RunStages()
       if(out)
       {
         m_stats.AddSamples(out->pkt->nb_samples, m_streams);
-        m_sinkBuffers->m_inputSamples.push_back(out);
+
+        // encoded frames are picked up below once the worker is done
+        if (m_mode == MODE_TRANSCODE && m_encoderBuffers)
+          m_encoderBuffers->m_inputSamples.push_back(out);
+        else
+          m_sinkBuffers->m_inputSamples.push_back(out);
       }
     }
     // pass through
@@ -2110,6 +2114,17 @@ bool CActiveAE::RunStages()
     }
   }
 
+  // collect encoded frames
+  if (m_mode == MODE_TRANSCODE && m_encoderBuffers)
+  {
+    busy |= m_encoderBuffers->EncodeBuffers();
+    while (!m_encoderBuffers->m_outputSamples.empty())
+    {
+      m_sinkBuffers->m_inputSamples.push_back(m_encoderBuffers->m_outputSamples.front());
+      m_encoderBuffers->m_outputSamples.pop_front();
+    }
+  }
+
   // serve sink buffers
   busy |= m_sinkBuffers->ResampleBuffers();
   while(!m_sinkBuffers->m_outputSamples.empty())
@@ -2133,6 +2148,8 @@ bool CActiveAE::HasWork()
     return true;
   if (!m_sinkBuffers->m_outputSamples.empty())
     return true;
+  if (m_encoderBuffers && (!m_encoderBuffers->m_inputSamples.empty() || m_encoderBuffers->IsEncoding()))
+    return true;
 
   std::list<CActiveAEStream*>::iterator it;
   for (it = m_streams.begin(); it != m_streams.end(); ++it)
@@ -2349,7 +2366,7 @@ bool CActiveAE::HasHDAudioChannelCount()
 
 bool CActiveAE::SupportsQualityLevel(enum AEQuality level)
 {
-  if (level == AE_QUALITY_LOW || level == AE_QUALITY_MID || level == AE_QUALITY_HIGH)
+  if (level == AE_QUALITY_LOW || level == AE_QUALITY_MID || level == AE_QUALITY_HIGH || level == AE_QUALITY_REALLYHIGH)
     return true;
 #if defined(TARGET_RASPBERRY_PI)
   if (level == AE_QUALITY_GPU)
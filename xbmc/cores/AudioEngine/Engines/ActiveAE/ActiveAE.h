@@ -352,7 +352,7 @@ protected:
   CActiveAEBufferPoolResample *m_vizBuffers;
   CActiveAEBufferPool *m_vizBuffersInput;
   CActiveAEBufferPool *m_silenceBuffers;  // needed to drive gui sounds if we have no streams
-  CActiveAEBufferPool *m_encoderBuffers;
+  CActiveAEBufferPoolEncode *m_encoderBuffers;
 
   // streams
   std::list<CActiveAEStream*> m_streams;
@@ -24,6 +24,8 @@
 #include "cores/AudioEngine/Engines/ActiveAE/ActiveAE.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/AudioEngine/AEResampleFactory.h"
+#include "cores/AudioEngine/Interfaces/AEEncoder.h"
+#include "threads/SingleLock.h"
 
 using namespace ActiveAE;
 
@@ -586,3 +588,148 @@ void CActiveAEBufferPoolResample::Flush()
   if (m_resampler)
     ChangeResampler();
 }
+
+//-----------------------------------------------------------------------------
+
+CActiveAEBufferPoolEncode::CActiveAEBufferPoolEncode(AEAudioFormat format, IAEEncoder *encoder, unsigned int lookahead)
+  : CActiveAEBufferPool(format), CThread("ActiveAEEncode")
+{
+  m_encoder = encoder;
+  m_lookahead = lookahead;
+  m_inFlight = 0;
+  m_encoding = false;
+}
+
+CActiveAEBufferPoolEncode::~CActiveAEBufferPoolEncode()
+{
+  StopThread();
+}
+
+bool CActiveAEBufferPoolEncode::Create(unsigned int totaltime)
+{
+  CActiveAEBufferPool::Create(totaltime);
+  CThread::Create();
+  SetPriority(THREAD_PRIORITY_ABOVE_NORMAL);
+  return true;
+}
+
+bool CActiveAEBufferPoolEncode::EncodeBuffers()
+{
+  bool busy = false;
+
+  // hand over mixed samples, bounded by look-ahead and free output frames
+  while (!m_inputSamples.empty() && m_inFlight < m_lookahead && !m_freeSamples.empty())
+  {
+    EncodeJob job;
+    job.in = m_inputSamples.front();
+    job.out = GetFreeBuffer();
+    m_inputSamples.pop_front();
+    {
+      CSingleLock lock(m_jobLock);
+      m_pendingJobs.push_back(job);
+    }
+    m_inFlight++;
+    m_jobEvent.Set();
+    busy = true;
+  }
+
+  std::deque<EncodeJob> finished;
+  {
+    CSingleLock lock(m_jobLock);
+    finished.swap(m_finishedJobs);
+  }
+
+  for (std::deque<EncodeJob>::iterator it = finished.begin(); it != finished.end(); ++it)
+  {
+    CSampleBuffer *out = it->out;
+    out->pkt->nb_samples = out->pkt->max_nb_samples;
+
+    // set pts of last sample
+    out->pkt_start_offset = out->pkt->nb_samples;
+    out->timestamp = it->in->timestamp;
+    out->clockId = it->in->clockId;
+
+    it->in->Return();
+    m_outputSamples.push_back(out);
+    m_inFlight--;
+    busy = true;
+  }
+
+  return busy;
+}
+
+void CActiveAEBufferPoolEncode::Flush()
+{
+  std::deque<EncodeJob> jobs;
+  {
+    CSingleLock lock(m_jobLock);
+    jobs.swap(m_pendingJobs);
+  }
+
+  // let the worker finish the frame it is on, the encoder must not be used after flush
+  while (true)
+  {
+    {
+      CSingleLock lock(m_jobLock);
+      if (!m_encoding)
+      {
+        jobs.insert(jobs.end(), m_finishedJobs.begin(), m_finishedJobs.end());
+        m_finishedJobs.clear();
+        break;
+      }
+    }
+    m_doneEvent.WaitMSec(100);
+  }
+
+  for (std::deque<EncodeJob>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+  {
+    it->in->Return();
+    it->out->Return();
+  }
+  m_inFlight = 0;
+
+  while (!m_inputSamples.empty())
+  {
+    m_inputSamples.front()->Return();
+    m_inputSamples.pop_front();
+  }
+  while (!m_outputSamples.empty())
+  {
+    m_outputSamples.front()->Return();
+    m_outputSamples.pop_front();
+  }
+}
+
+void CActiveAEBufferPoolEncode::Process()
+{
+  while (!m_bStop)
+  {
+    EncodeJob job;
+    bool haveJob;
+    {
+      CSingleLock lock(m_jobLock);
+      haveJob = m_encoding = !m_pendingJobs.empty();
+      if (haveJob)
+      {
+        job = m_pendingJobs.front();
+        m_pendingJobs.pop_front();
+      }
+    }
+
+    if (!haveJob)
+    {
+      AbortableWait(m_jobEvent);
+      continue;
+    }
+
+    m_encoder->Encode(job.in->pkt->data[0], job.in->pkt->planes*job.in->pkt->linesize,
+                      job.out->pkt->data[0], job.out->pkt->planes*job.out->pkt->linesize);
+
+    {
+      CSingleLock lock(m_jobLock);
+      m_finishedJobs.push_back(job);
+      m_encoding = false;
+    }
+    m_doneEvent.Set();
+  }
+}
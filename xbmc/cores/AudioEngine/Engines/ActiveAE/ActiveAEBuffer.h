@@ -22,6 +22,9 @@
 #include "cores/AudioEngine/Utils/AEAudioFormat.h"
 #include "cores/AudioEngine/Interfaces/AE.h"
 #include "cores/AudioEngine/DSPAddons/ActiveAEDSP.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
 #include <deque>
 
 extern "C" {
@@ -29,6 +32,8 @@ extern "C" {
 #include "libswresample/swresample.h"
 }
 
+class IAEEncoder;
+
 namespace ActiveAE
 {
 
@@ -134,4 +139,42 @@ public:
   int m_Profile;
 };
 
+/**
+ * Encodes mixed samples on a worker thread. Input buffers are queued in
+ * m_inputSamples and encoded frames show up in m_outputSamples, in order.
+ * Buffers are only acquired and returned on the calling (engine) thread,
+ * the worker just fills packet data.
+ */
+class CActiveAEBufferPoolEncode : public CActiveAEBufferPool, private CThread
+{
+public:
+  CActiveAEBufferPoolEncode(AEAudioFormat format, IAEEncoder *encoder, unsigned int lookahead);
+  virtual ~CActiveAEBufferPoolEncode();
+  virtual bool Create(unsigned int totaltime);
+  bool EncodeBuffers();
+  bool IsEncoding() { return m_inFlight > 0; }
+  bool AcceptsSamples() { return m_inputSamples.empty() && !m_freeSamples.empty(); }
+  void Flush();
+  std::deque<CSampleBuffer*> m_inputSamples;
+  std::deque<CSampleBuffer*> m_outputSamples;
+
+protected:
+  virtual void Process();
+
+  struct EncodeJob
+  {
+    CSampleBuffer *in;
+    CSampleBuffer *out;
+  };
+  IAEEncoder *m_encoder;
+  unsigned int m_lookahead;
+  unsigned int m_inFlight;
+  bool m_encoding;
+  std::deque<EncodeJob> m_pendingJobs;
+  std::deque<EncodeJob> m_finishedJobs;
+  CCriticalSection m_jobLock;
+  CEvent m_jobEvent;
+  CEvent m_doneEvent;
+};
+
 }
@@ -34,6 +34,8 @@ CActiveAEResampleFFMPEG::CActiveAEResampleFFMPEG()
 {
   m_pContext = NULL;
   m_loaded = true;
+  m_bypass = false;
+  m_compensated = false;
 }
 
 CActiveAEResampleFFMPEG::~CActiveAEResampleFFMPEG()
@@ -75,22 +77,7 @@ bool CActiveAEResampleFFMPEG::Init(uint64_t dst_chan_layout, int dst_channels, i
     return false;
   }
 
-  if(quality == AE_QUALITY_HIGH)
-  {
-    av_opt_set_double(m_pContext, "cutoff", 1.0, 0);
-    av_opt_set_int(m_pContext,"filter_size", 256, 0);
-  }
-  else if(quality == AE_QUALITY_MID)
-  {
-    // 0.97 is default cutoff so use (1.0 - 0.97) / 2.0 + 0.97
-    av_opt_set_double(m_pContext, "cutoff", 0.985, 0);
-    av_opt_set_int(m_pContext,"filter_size", 64, 0);
-  }
-  else if(quality == AE_QUALITY_LOW)
-  {
-    av_opt_set_double(m_pContext, "cutoff", 0.97, 0);
-    av_opt_set_int(m_pContext,"filter_size", 32, 0);
-  }
+  SetQualityOptions(quality);
 
   if (m_dst_fmt == AV_SAMPLE_FMT_S32 || m_dst_fmt == AV_SAMPLE_FMT_S32P)
   {
@@ -173,16 +160,81 @@ bool CActiveAEResampleFFMPEG::Init(uint64_t dst_chan_layout, int dst_channels, i
 
   if(swr_init(m_pContext) < 0)
   {
-    CLog::Log(LOGERROR, "CActiveAEResampleFFMPEG::Init - init resampler failed");
-    return false;
+    // soxr is optional in ffmpeg, fall back to the internal polyphase resampler
+    if (quality == AE_QUALITY_REALLYHIGH)
+    {
+      CLog::Log(LOGWARNING, "CActiveAEResampleFFMPEG::Init - soxr not available, falling back to high quality");
+      SetQualityOptions(AE_QUALITY_HIGH);
+    }
+    if (quality != AE_QUALITY_REALLYHIGH || swr_init(m_pContext) < 0)
+    {
+      CLog::Log(LOGERROR, "CActiveAEResampleFFMPEG::Init - init resampler failed");
+      return false;
+    }
   }
+
+  // if input already matches output, samples can be copied as long as no
+  // compensation is requested. swr is kept for the time this changes.
+  m_bypass = !remapLayout &&
+             m_src_chan_layout == m_dst_chan_layout &&
+             m_src_channels == m_dst_channels &&
+             m_src_rate == m_dst_rate &&
+             m_src_fmt == m_dst_fmt &&
+             m_src_bits == m_dst_bits &&
+             m_src_dither_bits == m_dst_dither_bits;
+  m_compensated = false;
+
   return true;
 }
 
+void CActiveAEResampleFFMPEG::SetQualityOptions(AEQuality quality)
+{
+  av_opt_set_int(m_pContext, "resampler", SWR_ENGINE_SWR, 0);
+  av_opt_set_int(m_pContext, "linear_interp", 0, 0);
+
+  if(quality == AE_QUALITY_REALLYHIGH)
+  {
+    // band limited sinc from libsoxr
+    av_opt_set_int(m_pContext, "resampler", SWR_ENGINE_SOXR, 0);
+    av_opt_set_int(m_pContext, "precision", 28, 0);
+    av_opt_set_double(m_pContext, "cutoff", 0.98, 0);
+  }
+  else if(quality == AE_QUALITY_HIGH)
+  {
+    av_opt_set_double(m_pContext, "cutoff", 1.0, 0);
+    av_opt_set_int(m_pContext,"filter_size", 256, 0);
+  }
+  else if(quality == AE_QUALITY_MID)
+  {
+    // 0.97 is default cutoff so use (1.0 - 0.97) / 2.0 + 0.97
+    av_opt_set_double(m_pContext, "cutoff", 0.985, 0);
+    av_opt_set_int(m_pContext,"filter_size", 64, 0);
+  }
+  else if(quality == AE_QUALITY_LOW)
+  {
+    // short polyphase filter with interpolation between phases, a smaller
+    // phase table keeps the filter bank in cache
+    av_opt_set_double(m_pContext, "cutoff", 0.97, 0);
+    av_opt_set_int(m_pContext,"filter_size", 16, 0);
+    av_opt_set_int(m_pContext, "phase_shift", 8, 0);
+    av_opt_set_int(m_pContext, "linear_interp", 1, 0);
+  }
+}
+
 int CActiveAEResampleFFMPEG::Resample(uint8_t **dst_buffer, int dst_samples, uint8_t **src_buffer, int src_samples, double ratio)
 {
+  // samples swr holds back from an earlier call have to come out first
+  if (m_bypass && !m_compensated && ratio == 1.0 &&
+      src_buffer && src_samples <= dst_samples &&
+      swr_get_delay(m_pContext, m_src_rate) == 0)
+  {
+    av_samples_copy(dst_buffer, src_buffer, 0, 0, src_samples, m_dst_channels, m_dst_fmt);
+    return src_samples;
+  }
+
   if (ratio != 1.0)
   {
+    m_compensated = true;
     if (swr_set_compensation(m_pContext,
                              (dst_samples*ratio-dst_samples)*m_dst_rate/m_src_rate,
                              dst_samples*m_dst_rate/m_src_rate) < 0)
@@ -49,6 +49,7 @@ public:
   int GetDstBufferSize(int samples);
 
 protected:
+  void SetQualityOptions(AEQuality quality);
   bool m_loaded;
   uint64_t m_src_chan_layout, m_dst_chan_layout;
   int m_src_rate, m_dst_rate;
@@ -56,6 +57,8 @@ protected:
   AVSampleFormat m_src_fmt, m_dst_fmt;
   int m_src_bits, m_dst_bits;
   int m_src_dither_bits, m_dst_dither_bits;
+  bool m_bypass;
+  bool m_compensated;
   SwrContext *m_pContext;
   double m_rematrix[AE_CH_MAX][AE_CH_MAX];
 };
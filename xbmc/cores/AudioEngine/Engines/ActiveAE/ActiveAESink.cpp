@@ -28,6 +28,7 @@
 
 #include "settings/Settings.h"
 #include "utils/log.h"
+#include "utils/TraceRecorder.h"
 
 #include <new> // for std::bad_alloc
 #include <algorithm>
@@ -857,6 +858,7 @@ unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
         pts = 0;
     }
     m_stats->UpdateSinkDelay(status, samples->pool ? written : 0, pts, samples->clockId);
+    CTraceRecorder::GetInstance().Record(TRACE_AUDIO_WRITTEN, 0, written, (double)pts, status.delay);
   }
   return status.delay * 1000;
 }
@@ -0,0 +1,226 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEResampleFFMPEG.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+extern "C" {
+#include "libavutil/channel_layout.h"
+#include "libswresample/swresample.h"
+}
+
+using namespace ActiveAE;
+
+namespace
+{
+
+const int PERIOD = 1024;
+
+struct ResampleBuffer
+{
+  ResampleBuffer(int channels, int samples, AVSampleFormat fmt)
+  {
+    int planes = av_sample_fmt_is_planar(fmt) ? channels : 1;
+    int size = av_samples_get_buffer_size(NULL, channels, samples, fmt, 1) / planes;
+    data.resize(planes);
+    ptr.resize(planes);
+    for (int i = 0; i < planes; i++)
+    {
+      data[i].resize(size);
+      ptr[i] = &data[i][0];
+    }
+  }
+  std::vector<std::vector<uint8_t> > data;
+  std::vector<uint8_t*> ptr;
+};
+
+/* feeds a second of audio through the resampler and checks that all of it comes out */
+void ResampleSecond(int srcRate, int dstRate, uint64_t srcLayout, uint64_t dstLayout, AEQuality quality)
+{
+  int srcChannels = av_get_channel_layout_nb_channels(srcLayout);
+  int dstChannels = av_get_channel_layout_nb_channels(dstLayout);
+
+  CActiveAEResampleFFMPEG resampler;
+  ASSERT_TRUE(resampler.Init(dstLayout, dstChannels, dstRate, AV_SAMPLE_FMT_FLTP, 32, 0,
+                             srcLayout, srcChannels, srcRate, AV_SAMPLE_FMT_FLTP, 32, 0,
+                             srcChannels == 2, true, NULL, quality, false));
+
+  int dstSamples = resampler.CalcDstSampleCount(PERIOD, dstRate, srcRate) * 2;
+  ResampleBuffer src(srcChannels, PERIOD, AV_SAMPLE_FMT_FLTP);
+  ResampleBuffer dst(dstChannels, dstSamples, AV_SAMPLE_FMT_FLTP);
+  for (int c = 0; c < srcChannels; c++)
+  {
+    float *samples = (float*)src.ptr[c];
+    for (int i = 0; i < PERIOD; i++)
+      samples[i] = (float)((i * (c + 1)) % 200 - 100) / 100.0f;
+  }
+
+  int64_t produced = 0;
+  for (int64_t consumed = 0; consumed < srcRate; consumed += PERIOD)
+  {
+    int ret = resampler.Resample(&dst.ptr[0], dstSamples, &src.ptr[0], PERIOD, 1.0);
+    ASSERT_GE(ret, 0);
+    produced += ret;
+  }
+
+  // allow for the samples held back by the filter
+  EXPECT_NEAR((double)produced, (double)dstRate, dstRate * 0.01 + PERIOD);
+}
+
+/* feeds a second of audio through the resampler, or through swresample with its default settings
+ * if no quality is given, and returns the time spent in us */
+int Benchmark(int srcRate, int dstRate, uint64_t srcLayout, uint64_t dstLayout, const AEQuality *quality)
+{
+  int srcChannels = av_get_channel_layout_nb_channels(srcLayout);
+  int dstChannels = av_get_channel_layout_nb_channels(dstLayout);
+
+  CActiveAEResampleFFMPEG resampler;
+  SwrContext *context = NULL;
+  if (quality)
+  {
+    if (!resampler.Init(dstLayout, dstChannels, dstRate, AV_SAMPLE_FMT_FLTP, 32, 0,
+                        srcLayout, srcChannels, srcRate, AV_SAMPLE_FMT_FLTP, 32, 0,
+                        srcChannels == 2, true, NULL, *quality, false))
+      return -1;
+  }
+  else
+  {
+    context = swr_alloc_set_opts(NULL, dstLayout, AV_SAMPLE_FMT_FLTP, dstRate,
+                                 srcLayout, AV_SAMPLE_FMT_FLTP, srcRate, 0, NULL);
+    if (!context || swr_init(context) < 0)
+    {
+      swr_free(&context);
+      return -1;
+    }
+  }
+
+  int dstSamples = resampler.CalcDstSampleCount(PERIOD, dstRate, srcRate) * 2;
+  ResampleBuffer src(srcChannels, PERIOD, AV_SAMPLE_FMT_FLTP);
+  ResampleBuffer dst(dstChannels, dstSamples, AV_SAMPLE_FMT_FLTP);
+
+  int64_t start = CurrentHostCounter();
+  for (int64_t consumed = 0; consumed < srcRate; consumed += PERIOD)
+  {
+    if (quality)
+      resampler.Resample(&dst.ptr[0], dstSamples, &src.ptr[0], PERIOD, 1.0);
+    else
+      swr_convert(context, &dst.ptr[0], dstSamples, (const uint8_t**)&src.ptr[0], PERIOD);
+  }
+  int64_t elapsed = CurrentHostCounter() - start;
+
+  swr_free(&context);
+  return (int)(elapsed * 1000000 / CurrentHostFrequency());
+}
+
+}
+
+TEST(TestActiveAEResample, Bypass)
+{
+  CActiveAEResampleFFMPEG resampler;
+  ASSERT_TRUE(resampler.Init(AV_CH_LAYOUT_STEREO, 2, 48000, AV_SAMPLE_FMT_S16, 16, 0,
+                             AV_CH_LAYOUT_STEREO, 2, 48000, AV_SAMPLE_FMT_S16, 16, 0,
+                             false, true, NULL, AE_QUALITY_MID, true));
+
+  ResampleBuffer src(2, PERIOD, AV_SAMPLE_FMT_S16);
+  ResampleBuffer dst(2, PERIOD, AV_SAMPLE_FMT_S16);
+  for (size_t i = 0; i < src.data[0].size(); i++)
+    src.data[0][i] = (uint8_t)i;
+
+  EXPECT_EQ(PERIOD, resampler.Resample(&dst.ptr[0], PERIOD, &src.ptr[0], PERIOD, 1.0));
+  EXPECT_TRUE(src.data[0] == dst.data[0]);
+  EXPECT_EQ(0, resampler.GetBufferedSamples());
+
+  // once the clock asks for compensation the samples have to go through swr
+  EXPECT_LE(0, resampler.Resample(&dst.ptr[0], PERIOD, &src.ptr[0], PERIOD, 1.001));
+}
+
+TEST(TestActiveAEResample, BypassAfterSwr)
+{
+  CActiveAEResampleFFMPEG resampler;
+  ASSERT_TRUE(resampler.Init(AV_CH_LAYOUT_STEREO, 2, 48000, AV_SAMPLE_FMT_S16, 16, 0,
+                             AV_CH_LAYOUT_STEREO, 2, 48000, AV_SAMPLE_FMT_S16, 16, 0,
+                             false, true, NULL, AE_QUALITY_MID, true));
+
+  ResampleBuffer src(2, PERIOD, AV_SAMPLE_FMT_S16);
+  ResampleBuffer dst(2, PERIOD, AV_SAMPLE_FMT_S16);
+  int16_t *in = (int16_t*)src.ptr[0];
+  int16_t *out = (int16_t*)dst.ptr[0];
+  for (int i = 0; i < PERIOD * 2; i++)
+    in[i] = (int16_t)(i / 2);
+
+  // less room than samples, swr keeps the rest
+  int ret = resampler.Resample(&dst.ptr[0], PERIOD / 2, &src.ptr[0], PERIOD, 1.0);
+  ASSERT_EQ(PERIOD / 2, ret);
+  EXPECT_EQ(PERIOD / 2, resampler.GetBufferedSamples());
+
+  // the kept samples come out before the new ones
+  for (int i = 0; i < PERIOD * 2; i++)
+    in[i] = (int16_t)(PERIOD + i / 2);
+  ret = resampler.Resample(&dst.ptr[0], PERIOD, &src.ptr[0], PERIOD, 1.0);
+  ASSERT_EQ(PERIOD, ret);
+  for (int i = 0; i < ret; i++)
+    EXPECT_EQ(PERIOD / 2 + i, out[i * 2]);
+}
+
+TEST(TestActiveAEResample, Qualities)
+{
+  static const AEQuality qualities[] = { AE_QUALITY_LOW, AE_QUALITY_MID, AE_QUALITY_HIGH, AE_QUALITY_REALLYHIGH };
+
+  for (unsigned int i = 0; i < sizeof(qualities) / sizeof(qualities[0]); i++)
+  {
+    ResampleSecond(44100, 48000, AV_CH_LAYOUT_STEREO, AV_CH_LAYOUT_STEREO, qualities[i]);
+    ResampleSecond(192000, 48000, AV_CH_LAYOUT_7POINT1, AV_CH_LAYOUT_7POINT1, qualities[i]);
+    ResampleSecond(48000, 48000, AV_CH_LAYOUT_STEREO, AV_CH_LAYOUT_7POINT1, qualities[i]);
+  }
+}
+
+// run with --gtest_also_run_disabled_tests, the time spent on a second of audio is reported in us as test properties
+TEST(TestActiveAEResample, DISABLED_Benchmark)
+{
+  static const AEQuality qualities[] = { AE_QUALITY_LOW, AE_QUALITY_MID, AE_QUALITY_HIGH, AE_QUALITY_REALLYHIGH };
+  static const char *names[] = { "low", "mid", "high", "reallyhigh" };
+  static const struct
+  {
+    const char *name;
+    int srcRate;
+    int dstRate;
+    uint64_t srcLayout;
+    uint64_t dstLayout;
+  } conversions[] = {
+    { "44k1_48k_2.0",       44100,  48000, AV_CH_LAYOUT_STEREO,  AV_CH_LAYOUT_STEREO },
+    { "192k_48k_7.1",       192000, 48000, AV_CH_LAYOUT_7POINT1, AV_CH_LAYOUT_7POINT1 },
+    { "48k_2.0_7.1_upmix",  48000,  48000, AV_CH_LAYOUT_STEREO,  AV_CH_LAYOUT_7POINT1 },
+    { "48k_7.1_bypass",     48000,  48000, AV_CH_LAYOUT_7POINT1, AV_CH_LAYOUT_7POINT1 }
+  };
+
+  for (unsigned int i = 0; i < sizeof(conversions) / sizeof(conversions[0]); i++)
+  {
+    RecordProperty(StringUtils::Format("%s_swr", conversions[i].name).c_str(),
+                   Benchmark(conversions[i].srcRate, conversions[i].dstRate, conversions[i].srcLayout, conversions[i].dstLayout, NULL));
+    for (unsigned int j = 0; j < sizeof(qualities) / sizeof(qualities[0]); j++)
+      RecordProperty(StringUtils::Format("%s_%s", conversions[i].name, names[j]).c_str(),
+                     Benchmark(conversions[i].srcRate, conversions[i].dstRate, conversions[i].srcLayout, conversions[i].dstLayout, &qualities[j]));
+  }
+}
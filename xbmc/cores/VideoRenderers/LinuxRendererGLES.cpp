@@ -32,6 +32,7 @@
 #include "guilib/MatrixGLES.h"
 #include "LinuxRendererGLES.h"
 #include "utils/MathUtils.h"
+#include "utils/CPUInfo.h"
 #include "utils/GLUtils.h"
 #include "utils/log.h"
 #include "settings/AdvancedSettings.h"
@@ -54,10 +55,6 @@ extern "C" {
 #include "libswscale/swscale.h"
 }
 
-#if defined(__ARM_NEON__)
-#include "yuv2rgb.neon.h"
-#include "utils/CPUInfo.h"
-#endif
 #ifdef HAVE_VIDEOTOOLBOXDECODER
 #include "DVDCodecs/Video/DVDVideoCodecVideoToolBox.h"
 #include <CoreVideo/CoreVideo.h>
@@ -100,6 +97,10 @@ CLinuxRendererGLES::YUVBUFFER::YUVBUFFER()
   memset(&fields, 0, sizeof(fields));
   memset(&image , 0, sizeof(image));
   flipindex = 0;
+  rgbBuffer = NULL;
+  rgbBufferSize = 0;
+  rgbQueued = false;
+  rgbValid = false;
 #ifdef HAVE_LIBOPENMAX
   openMaxBufferHolder = NULL;
 #endif
@@ -147,9 +148,6 @@ CLinuxRendererGLES::CLinuxRendererGLES()
   m_textureCreate = &CLinuxRendererGLES::CreateYV12Texture;
   m_textureDelete = &CLinuxRendererGLES::DeleteYV12Texture;
 
-  m_rgbBuffer = NULL;
-  m_rgbBufferSize = 0;
-
   m_sw_context = NULL;
   m_NumYV12Buffers = 0;
   m_iLastRenderBuffer = 0;
@@ -184,11 +182,7 @@ CLinuxRendererGLES::CLinuxRendererGLES()
 CLinuxRendererGLES::~CLinuxRendererGLES()
 {
   UnInit();
-
-  if (m_rgbBuffer != NULL) {
-    delete [] m_rgbBuffer;
-    m_rgbBuffer = NULL;
-  }
+  FreeRGBBuffers();
 
   ReleaseShaders();
 }
@@ -323,7 +317,17 @@ int CLinuxRendererGLES::GetImage(YV12Image *image, int source, bool readonly)
   if( readonly )
     im.flags |= IMAGE_FLAG_READING;
   else
+  {
+    // a dropped frame may still be converting from this buffer, its planes mustn't be overwritten yet
+    if (m_buffers[source].rgbQueued && !m_converter.Wait(source, 100))
+    {
+      CLog::Log(LOGDEBUG, "CLinuxRendererGLES::GetImage - buffer %d is still being converted", source);
+      return -1;
+    }
+    m_buffers[source].rgbQueued = false;
+    m_buffers[source].rgbValid = false;
     im.flags |= IMAGE_FLAG_WRITING;
+  }
 
   // copy the image - should be operator of YV12Image
   for (int p=0;p<MAX_PLANES;p++)
@@ -352,6 +356,13 @@ void CLinuxRendererGLES::ReleaseImage(int source, bool preserve)
   if( preserve )
     im.flags |= IMAGE_FLAG_RESERVED;
 
+  // start the software conversion while the buffer waits in the render queue
+  if ((m_renderMethod & RENDER_SW) && !m_buffers[source].rgbValid && !m_buffers[source].rgbQueued)
+  {
+    AllocRGBBuffer(source);
+    m_buffers[source].rgbQueued = m_converter.Convert(source, im, m_buffers[source].rgbBuffer, m_sourceWidth * 4);
+  }
+
   m_bImageReady = true;
 }
 
@@ -945,6 +956,12 @@ void CLinuxRendererGLES::LoadShaders(int field)
       }
   }
 
+  // run the software conversion on worker threads ahead of the render thread
+  if (m_renderMethod & RENDER_SW)
+    m_converter.Start(std::min(g_cpuInfo.getCPUCount(), 4));
+  else
+    m_converter.Stop();
+
   // determine whether GPU supports NPOT textures
   if (!g_Windowing.IsExtSupported("GL_TEXTURE_NPOT"))
   {
@@ -1035,12 +1052,8 @@ void CLinuxRendererGLES::UnInit()
   CLog::Log(LOGDEBUG, "LinuxRendererGL: Cleaning up GL resources");
   CSingleLock lock(g_graphicsContext);
 
-  if (m_rgbBuffer != NULL)
-  {
-    delete [] m_rgbBuffer;
-    m_rgbBuffer = NULL;
-  }
-  m_rgbBufferSize = 0;
+  m_converter.Stop();
+  FreeRGBBuffers();
 
   // YV12 textures
   for (int i = 0; i < NUM_BUFFERS; ++i)
@@ -1989,32 +2002,23 @@ void CLinuxRendererGLES::UploadYV12Texture(int source)
   // if we don't have a shader, fallback to SW YUV2RGB for now
   if (m_renderMethod & RENDER_SW)
   {
-    if(m_rgbBufferSize < m_sourceWidth * m_sourceHeight * 4)
+    if (buf.rgbQueued)
     {
-      delete [] m_rgbBuffer;
-      m_rgbBufferSize = m_sourceWidth*m_sourceHeight*4;
-      m_rgbBuffer = new BYTE[m_rgbBufferSize];
+      // normally finished long ago, the worker ran while the buffer was queued
+      if (!m_converter.Wait(source, 500))
+      {
+        CLog::Log(LOGWARNING, "CLinuxRendererGLES::UploadYV12Texture - timeout waiting for conversion of buffer %d", source);
+        return;
+      }
+      buf.rgbQueued = false;
+      buf.rgbValid = true;
     }
 
-#if defined(__ARM_NEON__)
-    if (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_NEON)
+    if (!buf.rgbValid)
     {
-      yuv420_2_rgb8888_neon(m_rgbBuffer, im->plane[0], im->plane[2], im->plane[1],
-        m_sourceWidth, m_sourceHeight, im->stride[0], im->stride[1], m_sourceWidth * 4);
-    }
-    else
-#endif
-    {
-      m_sw_context = sws_getCachedContext(m_sw_context,
-        im->width, im->height, PIX_FMT_YUV420P,
-        im->width, im->height, PIX_FMT_RGBA,
-        SWS_FAST_BILINEAR, NULL, NULL, NULL);
-
-      uint8_t *src[]  = { im->plane[0], im->plane[1], im->plane[2], 0 };
-      int srcStride[] = { int(im->stride[0]), int(im->stride[1]), int(im->stride[2]), 0 };
-      uint8_t *dst[]  = { m_rgbBuffer, 0, 0, 0 };
-      int dstStride[] = { int(m_sourceWidth*4), 0, 0, 0 };
-      sws_scale(m_sw_context, src, srcStride, 0, im->height, dst, dstStride);
+      AllocRGBBuffer(source);
+      CYUV2RGBConverter::ConvertSlice(&m_sw_context, *im, 0, im->height, buf.rgbBuffer, m_sourceWidth * 4);
+      buf.rgbValid = true;
     }
   }
 
@@ -2034,17 +2038,17 @@ void CLinuxRendererGLES::UploadYV12Texture(int source)
     {
       LoadPlane( fields[FIELD_TOP][0] , GL_RGBA, buf.flipindex
                , im->width, im->height >> 1
-               , m_sourceWidth*8, im->bpp, m_rgbBuffer );
+               , m_sourceWidth*8, im->bpp, buf.rgbBuffer );
 
       LoadPlane( fields[FIELD_BOT][0], GL_RGBA, buf.flipindex
                , im->width, im->height >> 1
-               , m_sourceWidth*8, im->bpp, m_rgbBuffer + m_sourceWidth*4);
+               , m_sourceWidth*8, im->bpp, buf.rgbBuffer + m_sourceWidth*4);
     }
     else
     {
       LoadPlane( fields[FIELD_FULL][0], GL_RGBA, buf.flipindex
                , im->width, im->height
-               , m_sourceWidth*4, im->bpp, m_rgbBuffer );
+               , m_sourceWidth*4, im->bpp, buf.rgbBuffer );
     }
   }
   else
@@ -2074,6 +2078,29 @@ void CLinuxRendererGLES::UploadYV12Texture(int source)
   glDisable(m_textureTarget);
 }
 
+void CLinuxRendererGLES::AllocRGBBuffer(int index)
+{
+  YUVBUFFER &buf = m_buffers[index];
+  if (buf.rgbBufferSize < m_sourceWidth * m_sourceHeight * 4)
+  {
+    delete [] buf.rgbBuffer;
+    buf.rgbBufferSize = m_sourceWidth * m_sourceHeight * 4;
+    buf.rgbBuffer = new BYTE[buf.rgbBufferSize];
+  }
+}
+
+void CLinuxRendererGLES::FreeRGBBuffers()
+{
+  for (int i = 0; i < NUM_BUFFERS; i++)
+  {
+    delete [] m_buffers[i].rgbBuffer;
+    m_buffers[i].rgbBuffer = NULL;
+    m_buffers[i].rgbBufferSize = 0;
+    m_buffers[i].rgbQueued = false;
+    m_buffers[i].rgbValid = false;
+  }
+}
+
 void CLinuxRendererGLES::DeleteYV12Texture(int index)
 {
   YV12Image &im     = m_buffers[index].image;
@@ -23,6 +23,8 @@
 
 #if HAS_GLES == 2
 
+#include <atomic>
+
 #include "system_gl.h"
 
 #include "xbmc/guilib/FrameBufferObject.h"
@@ -32,6 +34,7 @@
 #include "RenderFormats.h"
 #include "guilib/GraphicContext.h"
 #include "BaseRenderer.h"
+#include "YUV2RGBConverter.h"
 #include "xbmc/cores/dvdplayer/DVDCodecs/Video/DVDVideoCodec.h"
 
 class CRenderCapture;
@@ -195,6 +198,8 @@ protected:
   bool (CLinuxRendererGLES::*m_textureCreate)(int index);
 
   void UploadYV12Texture(int index);
+  void AllocRGBBuffer(int index);
+  void FreeRGBBuffers();
   void DeleteYV12Texture(int index);
   bool CreateYV12Texture(int index);
 
@@ -289,6 +294,12 @@ protected:
     YV12Image image;
     unsigned  flipindex; /* used to decide if this has been uploaded */
 
+    BYTE     *rgbBuffer;     /* software yuv2rgb result */
+    unsigned  rgbBufferSize;
+    // shared by the decoder, render and converter threads
+    std::atomic<bool> rgbQueued; /* conversion was handed to the converter */
+    std::atomic<bool> rgbValid;  /* rgbBuffer holds the current image */
+
 #ifdef HAVE_LIBOPENMAX
     OpenMaxVideoBufferHolder *openMaxBufferHolder;
 #endif
@@ -334,8 +345,7 @@ protected:
 
   // software scale libraries (fallback if required gl version is not available)
   struct SwsContext *m_sw_context;
-  BYTE	      *m_rgbBuffer;  // if software scale is used, this will hold the result image
-  unsigned int m_rgbBufferSize;
+  CYUV2RGBConverter m_converter; // converts released images ahead of the upload
   float        m_textureMatrix[16];
 };
 
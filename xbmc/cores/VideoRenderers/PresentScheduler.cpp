@@ -0,0 +1,149 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "PresentScheduler.h"
+
+#include <cmath>
+
+#include "utils/StringUtils.h"
+
+#define CADENCE_MAX_PERIOD 12
+
+CPresentScheduler::CPresentScheduler()
+{
+  m_vsynctime = 0.0;
+  Reset(0.0);
+}
+
+void CPresentScheduler::Reset(double frametime)
+{
+  m_frametime = frametime;
+  m_lastSlot = 0.0;
+  m_carry = 0.0;
+  m_judderIndex = 0;
+  m_judderCount = 0;
+  UpdateCadence();
+}
+
+void CPresentScheduler::SetVsyncInterval(double vsynctime)
+{
+  // the measured interval wobbles, only react to real refresh changes
+  if (fabs(vsynctime - m_vsynctime) <= m_vsynctime * 0.001)
+    return;
+
+  m_vsynctime = vsynctime;
+  m_lastSlot = 0.0;
+  UpdateCadence();
+}
+
+void CPresentScheduler::UpdateCadence()
+{
+  m_active = false;
+  m_ratio = 0.0;
+  m_cadence.clear();
+
+  if (m_frametime <= 0.0 || m_vsynctime <= 0.0)
+    return;
+
+  m_ratio = m_frametime / m_vsynctime;
+
+  // integer ratios are handled by centering the clock between vblanks,
+  // faster frame rates than the refresh rate can't have a cadence
+  double fraction = m_ratio - floor(m_ratio);
+  m_active = m_ratio >= 1.0 && fraction > 0.02 && fraction < 0.98;
+  if (!m_active)
+    return;
+
+  // shortest period of the repeat pattern, e.g. 2 for 3:2
+  int period = CADENCE_MAX_PERIOD;
+  for (int p = 1; p <= CADENCE_MAX_PERIOD; p++)
+  {
+    double vblanks = p * m_ratio;
+    if (fabs(vblanks - floor(vblanks + 0.5)) < 0.02 * p)
+    {
+      period = p;
+      break;
+    }
+  }
+
+  for (int i = 0; i < period; i++)
+  {
+    int vblanks = (int)(floor((i + 1) * m_ratio + 0.01) - floor(i * m_ratio + 0.01));
+    if (i > 0)
+      m_cadence += ":";
+    m_cadence += StringUtils::Format("%d", vblanks);
+  }
+}
+
+double CPresentScheduler::Schedule(double timestamp, double vblank)
+{
+  if (!m_active)
+    return timestamp;
+
+  // middle of the vblank interval the requested time falls into
+  double ideal = vblank + (floor((timestamp - vblank) / m_vsynctime) + 0.5) * m_vsynctime;
+
+  if (m_lastSlot > 0.0)
+  {
+    // m_carry is the ideal present time relative to the last slot in vblanks,
+    // rounding it forward keeps the error within half a vblank (Bresenham)
+    double vblanks = floor(m_carry + m_ratio + 0.5);
+    double slot = m_lastSlot + vblanks * m_vsynctime;
+
+    // keep the cadence as long as it stays within a vblank of the clock
+    if (fabs(slot - timestamp) <= m_vsynctime)
+    {
+      m_carry += m_ratio - vblanks;
+      m_lastSlot = slot;
+      return slot;
+    }
+  }
+
+  m_carry = (timestamp - ideal) / m_vsynctime;
+  m_lastSlot = ideal;
+  return ideal;
+}
+
+void CPresentScheduler::AddPresent(double requested, double presented)
+{
+  m_judderBuff[m_judderIndex] = presented - requested;
+  m_judderIndex = (m_judderIndex + 1) % JUDDER_FRAMES;
+  if (m_judderCount < JUDDER_FRAMES)
+    m_judderCount++;
+}
+
+double CPresentScheduler::GetJudder() const
+{
+  if (m_judderCount < 2)
+    return 0.0;
+
+  // the mean is the display latency, only the variation is visible
+  double mean = 0.0;
+  for (int i = 0; i < m_judderCount; i++)
+    mean += m_judderBuff[i];
+  mean /= m_judderCount;
+
+  double variance = 0.0;
+  for (int i = 0; i < m_judderCount; i++)
+    variance += (m_judderBuff[i] - mean) * (m_judderBuff[i] - mean);
+  variance /= m_judderCount - 1;
+
+  return sqrt(variance) * 1000.0;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#define JUDDER_FRAMES 128
+
+/*!
+ \brief Pins frames to vblanks following the optimal repeat pattern.
+
+ When the refresh rate is not an integer multiple of the frame rate, e.g.
+ 23.976 fps on a 60 Hz display, every frame has to be shown for a varying
+ number of vblanks. Rounding each present time independently lets jitter of
+ the timestamps break up that pattern. The scheduler instead distributes the
+ vblanks with an error accumulator, so the cadence is as even as possible
+ (3:2 for 24p@60), and only resyncs to the clock when the timestamps drift
+ away by more than a vblank.
+
+ All times are in seconds on the clock of CXBMCRenderManager::GetPresentTime(),
+ which advances in vblank steps when the reference clock is used.
+ */
+class CPresentScheduler
+{
+public:
+  CPresentScheduler();
+
+  void Reset(double frametime);
+
+  /*!
+   \brief update the measured vblank interval, 0 disables scheduling
+   */
+  void SetVsyncInterval(double vsynctime);
+  bool IsActive() const { return m_active; }
+
+  /*!
+   \brief return the present time for a frame requested at timestamp
+   \param vblank time of any vblank, used as phase reference
+   */
+  double Schedule(double timestamp, double vblank);
+
+  /*!
+   \brief measure the deviation of an actual present from the requested time
+   */
+  void AddPresent(double requested, double presented);
+
+  /*!
+   \brief standard deviation of the present error in milliseconds
+   */
+  double GetJudder() const;
+  std::string GetCadence() const { return m_cadence; }
+
+private:
+  void UpdateCadence();
+
+  double m_frametime;
+  double m_vsynctime;
+  double m_ratio;
+  bool m_active;
+  std::string m_cadence;
+
+  double m_lastSlot;
+  double m_carry;
+
+  double m_judderBuff[JUDDER_FRAMES];
+  int m_judderIndex;
+  int m_judderCount;
+};
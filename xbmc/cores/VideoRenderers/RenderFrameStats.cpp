@@ -0,0 +1,195 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RenderFrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "threads/SingleLock.h"
+#include "utils/StringUtils.h"
+#include "utils/Variant.h"
+
+// upper limits of the histogram bins, the last bin is open
+static const double LateLimits[FRAMESTATS_BINS - 1]   = { 0.0, 0.5, 1.0, 2.0, 3.0, 5.0 };  // frames
+static const double JitterLimits[FRAMESTATS_BINS - 1] = { 1.0, 2.0, 4.0, 8.0, 16.0, 32.0 }; // ms
+
+CRenderFrameStats::CRenderFrameStats()
+{
+  Reset(0.0, 0);
+}
+
+void CRenderFrameStats::Reset(double frametime, int buffers)
+{
+  CSingleLock lock(m_lock);
+  m_frametime = frametime;
+  m_buffers = buffers;
+
+  m_frames = 0;
+  m_late = 0;
+  m_dropped = 0;
+  std::fill(m_lateHistogram, m_lateHistogram + FRAMESTATS_BINS, 0);
+
+  m_lastPresent = 0.0;
+  m_intervals = 0;
+  m_intervalMean = 0.0;
+  m_intervalM2 = 0.0;
+  std::fill(m_jitterHistogram, m_jitterHistogram + FRAMESTATS_BINS, 0);
+
+  m_decodeToQueue = 0.0;
+  m_queueToFlip = 0.0;
+  m_flipToPresent = 0.0;
+
+  m_waits = 0;
+  m_waitTimeouts = 0;
+  m_waitTotal = 0.0;
+  m_waitMax = 0.0;
+
+  m_queueSamples = 0;
+  std::fill(m_queueHistogram, m_queueHistogram + FRAMESTATS_MAX_QUEUE + 1, 0);
+}
+
+int CRenderFrameStats::GetBin(double value, const double *limits)
+{
+  for (int i = 0; i < FRAMESTATS_BINS - 1; i++)
+  {
+    if (value < limits[i])
+      return i;
+  }
+  return FRAMESTATS_BINS - 1;
+}
+
+void CRenderFrameStats::AddFrame(const SFrameTimes &times)
+{
+  CSingleLock lock(m_lock);
+  m_frames++;
+
+  if (m_frametime > 0.0)
+  {
+    double late = (times.presented - times.target) / m_frametime;
+    m_lateHistogram[GetBin(late, LateLimits)]++;
+    if (late > 0.5)
+      m_late++;
+  }
+
+  // running mean and variance of the present interval (Welford)
+  if (m_lastPresent > 0.0)
+  {
+    double interval = times.presented - m_lastPresent;
+    m_intervals++;
+    double delta = interval - m_intervalMean;
+    m_intervalMean += delta / m_intervals;
+    m_intervalM2 += delta * (interval - m_intervalMean);
+
+    if (m_frametime > 0.0)
+      m_jitterHistogram[GetBin(fabs(interval - m_frametime) * 1000.0, JitterLimits)]++;
+  }
+  m_lastPresent = times.presented;
+
+  if (times.decoded > 0.0 && times.queued >= times.decoded)
+    m_decodeToQueue += times.queued - times.decoded;
+  if (times.flipped >= times.queued)
+    m_queueToFlip += times.flipped - times.queued;
+  if (times.presented >= times.flipped)
+    m_flipToPresent += times.presented - times.flipped;
+}
+
+void CRenderFrameStats::AddDropped(int frames)
+{
+  CSingleLock lock(m_lock);
+  m_dropped += frames;
+}
+
+void CRenderFrameStats::AddBufferWait(double waited, bool timedout)
+{
+  CSingleLock lock(m_lock);
+  m_waits++;
+  if (timedout)
+    m_waitTimeouts++;
+  m_waitTotal += waited;
+  m_waitMax = std::max(m_waitMax, waited);
+}
+
+void CRenderFrameStats::AddQueueLevel(int queued)
+{
+  CSingleLock lock(m_lock);
+  m_queueSamples++;
+  m_queueHistogram[std::min(std::max(queued, 0), FRAMESTATS_MAX_QUEUE)]++;
+}
+
+unsigned int CRenderFrameStats::GetFrames() const
+{
+  CSingleLock lock(m_lock);
+  return m_frames;
+}
+
+void CRenderFrameStats::Serialize(CVariant &value) const
+{
+  CSingleLock lock(m_lock);
+
+  value["buffers"] = m_buffers;
+  value["frames"] = m_frames;
+  value["late"] = m_late;
+  value["dropped"] = m_dropped;
+  value["latehistogram"] = CVariant(CVariant::VariantTypeArray);
+  for (int i = 0; i < FRAMESTATS_BINS; i++)
+    value["latehistogram"].push_back(m_lateHistogram[i]);
+
+  value["interval"] = m_intervalMean * 1000.0;
+  value["jitter"] = m_intervals > 1 ? sqrt(m_intervalM2 / (m_intervals - 1)) * 1000.0 : 0.0;
+  value["jitterhistogram"] = CVariant(CVariant::VariantTypeArray);
+  for (int i = 0; i < FRAMESTATS_BINS; i++)
+    value["jitterhistogram"].push_back(m_jitterHistogram[i]);
+
+  double frames = std::max(m_frames, 1u);
+  value["latency"]["decodetoqueue"] = m_decodeToQueue * 1000.0 / frames;
+  value["latency"]["queuetoflip"] = m_queueToFlip * 1000.0 / frames;
+  value["latency"]["fliptopresent"] = m_flipToPresent * 1000.0 / frames;
+
+  value["bufferwait"]["count"] = m_waits;
+  value["bufferwait"]["timeouts"] = m_waitTimeouts;
+  value["bufferwait"]["average"] = m_waits ? m_waitTotal * 1000.0 / m_waits : 0.0;
+  value["bufferwait"]["max"] = m_waitMax * 1000.0;
+
+  double queued = 0.0;
+  value["queuehistogram"] = CVariant(CVariant::VariantTypeArray);
+  for (int i = 0; i <= FRAMESTATS_MAX_QUEUE; i++)
+  {
+    value["queuehistogram"].push_back(m_queueHistogram[i]);
+    queued += (double)i * m_queueHistogram[i];
+  }
+  value["queuelevel"] = m_queueSamples ? queued / m_queueSamples : 0.0;
+}
+
+std::string CRenderFrameStats::GetDebugString() const
+{
+  CVariant stats;
+  Serialize(stats);
+
+  return StringUtils::Format("frames:%u late:%u drop:%u jitter:%.2fms wait:%.1f/%.1fms queue:%.1f/%d"
+                             , (unsigned int)stats["frames"].asUnsignedInteger()
+                             , (unsigned int)stats["late"].asUnsignedInteger()
+                             , (unsigned int)stats["dropped"].asUnsignedInteger()
+                             , stats["jitter"].asDouble()
+                             , stats["bufferwait"]["average"].asDouble()
+                             , stats["bufferwait"]["max"].asDouble()
+                             , stats["queuelevel"].asDouble()
+                             , (int)stats["buffers"].asInteger());
+}
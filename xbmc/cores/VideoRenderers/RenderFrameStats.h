@@ -0,0 +1,93 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include "threads/CriticalSection.h"
+
+class CVariant;
+
+#define FRAMESTATS_BINS      7
+#define FRAMESTATS_MAX_QUEUE 8
+
+/*!
+ \brief Timing statistics of the frames passing through the render queue.
+
+ All times are in seconds on the clock of CXBMCRenderManager::GetPresentTime().
+ Frames are late when they were presented more than half a frame after their
+ requested present time.
+ */
+class CRenderFrameStats
+{
+public:
+  struct SFrameTimes
+  {
+    double decoded;   ///< picture was added to a render buffer
+    double queued;    ///< player handed the buffer to the render queue
+    double flipped;   ///< renderer switched to the buffer
+    double presented; ///< rendering finished after waiting for the present time
+    double target;    ///< requested present time
+  };
+
+  CRenderFrameStats();
+
+  void Reset(double frametime, int buffers);
+  void AddFrame(const SFrameTimes &times);
+  void AddDropped(int frames);
+  void AddBufferWait(double waited, bool timedout);
+  void AddQueueLevel(int queued);
+
+  unsigned int GetFrames() const;
+
+  void Serialize(CVariant &value) const;
+  std::string GetDebugString() const;
+
+private:
+  static int GetBin(double value, const double *limits);
+
+  mutable CCriticalSection m_lock;
+  double m_frametime;
+  int m_buffers;
+
+  unsigned int m_frames;
+  unsigned int m_late;
+  unsigned int m_dropped;
+  unsigned int m_lateHistogram[FRAMESTATS_BINS];
+
+  double m_lastPresent;
+  unsigned int m_intervals;
+  double m_intervalMean;
+  double m_intervalM2;
+  unsigned int m_jitterHistogram[FRAMESTATS_BINS];
+
+  double m_decodeToQueue;
+  double m_queueToFlip;
+  double m_flipToPresent;
+
+  unsigned int m_waits;
+  unsigned int m_waitTimeouts;
+  double m_waitTotal;
+  double m_waitMax;
+
+  unsigned int m_queueSamples;
+  unsigned int m_queueHistogram[FRAMESTATS_MAX_QUEUE + 1];
+};
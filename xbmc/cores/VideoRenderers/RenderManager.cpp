@@ -30,6 +30,8 @@
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
+#include "utils/TraceRecorder.h"
+#include "utils/Variant.h"
 
 #include "Application.h"
 #include "messaging/ApplicationMessenger.h"
@@ -50,6 +52,9 @@
 #elif defined(HAS_SDL)
   #include "LinuxRenderer.h"
 #endif
+#if defined(HAS_GLES)
+  #include "guilib/GUIQuadBatchGLES.h"
+#endif
 
 #include "RenderCapture.h"
 
@@ -235,10 +240,15 @@ std::string CXBMCRenderManager::GetVSyncState()
                                          ,     MathUtils::round_int(m_presentcorr * 100)
                                          ,     MathUtils::round_int(avgerror      * 100)
                                          , abs(MathUtils::round_int(m_presenterr  * 100)));
+
+  CSingleLock lock(m_presentlock);
+  if (m_scheduler.IsActive())
+    state += StringUtils::Format(" cadence:%s", m_scheduler.GetCadence().c_str());
+  state += StringUtils::Format(" judder:%.1fms", m_scheduler.GetJudder());
   return state;
 }
 
-bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format, unsigned int orientation, int buffers)
+bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format, unsigned int orientation, int buffers, int renderbuffers)
 {
 
   CSingleLock    lock2(m_presentlock);
@@ -277,7 +287,10 @@ bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsi
     m_format = format;
 
     CRenderInfo info = m_pRenderer->GetRenderInfo();
-    int renderbuffers = info.optimal_buffer_size;
+    if (renderbuffers <= 0)
+      renderbuffers = info.optimal_buffer_size;
+    else
+      renderbuffers = std::max(2, std::min(renderbuffers, NUM_BUFFERS));
     m_QueueSize = renderbuffers;
     if (buffers > 0)
       m_QueueSize = std::min(buffers, renderbuffers);
@@ -299,6 +312,8 @@ bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsi
     m_presentsource = 0;
     for (int i=1; i < m_QueueSize; i++)
       m_free.push_back(i);
+    for (int i=0; i < NUM_BUFFERS; i++)
+      m_Queue[i].requested = m_Queue[i].decodetime = m_Queue[i].queuetime = m_Queue[i].fliptime = 0.0;
 
     m_bIsStarted = true;
     m_bRenderGUI = true;
@@ -310,6 +325,11 @@ bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsi
     m_presentevent.notifyAll();
     m_renderedOverlay = false;
 
+    if (m_frameStats.GetFrames() > 0)
+      CLog::Log(LOGDEBUG, "CXBMCRenderManager::Configure - previous stats %s", m_frameStats.GetDebugString().c_str());
+    m_frameStats.Reset(fps > 0.0f ? 1.0 / fps : 0.0, m_QueueSize);
+    m_scheduler.Reset(fps > 0.0f ? 1.0 / fps : 0.0);
+
     CLog::Log(LOGDEBUG, "CXBMCRenderManager::Configure - %d", m_QueueSize);
   }
 
@@ -376,6 +396,7 @@ void CXBMCRenderManager::FrameMove()
 
     if(m_presentstep == PRESENT_FLIP)
     {
+      m_Queue[m_presentsource].fliptime = GetPresentTime();
       m_pRenderer->FlipPage(m_presentsource);
       m_presentstep = PRESENT_FRAME;
       m_presentevent.notifyAll();
@@ -391,6 +412,7 @@ void CXBMCRenderManager::FrameMove()
         m_overlays.Release(*it);
         m_free.push_back(*it);
         it = m_discard.erase(it);
+        m_presentevent.notifyAll();
       }
       else
         ++it;
@@ -417,6 +439,20 @@ void CXBMCRenderManager::FrameFinish()
 
     if(m_presentstep == PRESENT_FRAME)
     {
+      CRenderFrameStats::SFrameTimes times;
+      times.decoded   = m.decodetime;
+      times.queued    = m.queuetime;
+      times.flipped   = m.fliptime;
+      times.presented = m_clock_framefinish;
+      times.target    = m.requested;
+      m_frameStats.AddFrame(times);
+      // late against the requested time, so frames the scheduler moved back count as well
+      double late = m_clock_framefinish - m.requested;
+      CTraceRecorder::GetInstance().Record(TRACE_PICTURE_PRESENTED, 0, m_presentsource, m.pts, late);
+      if (late > 0.1)
+        CTraceRecorder::GetInstance().Stutter("frame presented late");
+      m_scheduler.AddPresent(m.requested, m_clock_framefinish);
+
       if( m.presentmethod == PRESENT_METHOD_BOB
       ||  m.presentmethod == PRESENT_METHOD_WEAVE)
         m_presentstep = PRESENT_FRAME2;
@@ -740,12 +776,25 @@ void CXBMCRenderManager::FlipPage(volatile bool& bStop, double timestamp /* = 0L
     if(source < 0)
       source = m_free.front();
 
+    /* pin the frame to a vblank following the cadence of frame and refresh rate */
+    double vsynctime = 0.0;
+    CDVDClock *dvdclock = CDVDClock::GetMasterClock();
+    if (g_VideoReferenceClock.GetRefreshRate(&vsynctime) <= 0
+    || !g_graphicsContext.IsFullScreenVideo()
+    || (dvdclock != NULL && dvdclock->GetSpeedAdjust() != 0.0))
+      vsynctime = 0.0;
+    m_scheduler.SetVsyncInterval(vsynctime);
+
     SPresent& m = m_Queue[source];
-    m.timestamp     = timestamp;
+    m.requested     = timestamp;
+    m.timestamp     = m_scheduler.Schedule(timestamp, GetPresentTime());
     m.presentfield  = sync;
     m.presentmethod = presentmethod;
     m.pts           = pts;
+    m.queuetime     = GetPresentTime();
     requeue(m_queued, m_free);
+    m_frameStats.AddQueueLevel(m_queued.size());
+    CTraceRecorder::GetInstance().Record(TRACE_PICTURE_QUEUED, 0, m_queued.size(), pts, m.timestamp);
 
     /* signal to any waiters to check state */
     if(m_presentstep == PRESENT_IDLE)
@@ -808,6 +857,10 @@ void CXBMCRenderManager::Render(bool clear, DWORD flags, DWORD alpha, bool gui)
 
   if (!gui || m_pRenderer->IsGuiLayer())
   {
+#if defined(HAS_GLES)
+    // the renderers draw with their own GL state, the GUI queued so far has to be below the video
+    CGUIQuadBatchGLES::GetInstance().Flush();
+#endif
     SPresent& m = m_Queue[m_presentsource];
 
     if( m.presentmethod == PRESENT_METHOD_BOB )
@@ -967,6 +1020,7 @@ int CXBMCRenderManager::AddVideoPicture(DVDVideoPicture& pic)
     if (m_free.empty())
       return -1;
     index = m_free.front();
+    m_Queue[index].decodetime = GetPresentTime();
   }
 
   if(m_pRenderer->AddVideoPicture(&pic, index))
@@ -1120,6 +1174,7 @@ int CXBMCRenderManager::WaitForBuffer(volatile bool& bStop, int timeout)
   }
 
   XbmcThreads::EndTime endtime(timeout);
+  double waitstart = GetPresentTime();
   while(m_free.empty())
   {
     m_presentevent.wait(lock2, std::min(50, timeout));
@@ -1127,6 +1182,7 @@ int CXBMCRenderManager::WaitForBuffer(volatile bool& bStop, int timeout)
     {
       if (timeout != 0 && !bStop)
       {
+        m_frameStats.AddBufferWait(GetPresentTime() - waitstart, true);
         CLog::Log(LOGWARNING, "CRenderManager::WaitForBuffer - timeout waiting for buffer");
         m_waitForBufferCount++;
         if (m_waitForBufferCount > 2)
@@ -1139,6 +1195,7 @@ int CXBMCRenderManager::WaitForBuffer(volatile bool& bStop, int timeout)
   }
 
   m_waitForBufferCount = 0;
+  m_frameStats.AddBufferWait(GetPresentTime() - waitstart, false);
 
   // make sure overlay buffer is released, this won't happen on AddOverlay
   m_overlays.Release(m_free.front());
@@ -1147,6 +1204,21 @@ int CXBMCRenderManager::WaitForBuffer(volatile bool& bStop, int timeout)
   return m_queued.size() + m_discard.size();
 }
 
+void CXBMCRenderManager::WaitForRelease(int timeout)
+{
+  CSingleLock lock(m_presentlock);
+  m_presentevent.wait(lock, timeout);
+}
+
+void CXBMCRenderManager::SerializeFrameStats(CVariant &value)
+{
+  m_frameStats.Serialize(value);
+
+  CSingleLock lock(m_presentlock);
+  value["cadence"] = m_scheduler.IsActive() ? m_scheduler.GetCadence() : "";
+  value["judder"] = m_scheduler.GetJudder();
+}
+
 void CXBMCRenderManager::PrepareNextRender()
 {
   CSingleLock lock(m_presentlock);
@@ -1195,8 +1267,11 @@ void CXBMCRenderManager::PrepareNextRender()
     /* skip late frames */
     while(m_queued.front() != idx)
     {
+      CTraceRecorder::GetInstance().Record(TRACE_PICTURE_DROPPED, 0, 1, m_Queue[m_queued.front()].pts, 0.0);
       requeue(m_discard, m_queued);
       m_QueueSkip++;
+      m_frameStats.AddDropped(1);
+      CTraceRecorder::GetInstance().Stutter("frame skipped");
     }
 
     m_presentstep   = PRESENT_FLIP;
@@ -28,6 +28,8 @@
 #include "threads/SharedSection.h"
 #include "settings/VideoSettings.h"
 #include "OverlayRenderer.h"
+#include "RenderFrameStats.h"
+#include "PresentScheduler.h"
 #include <deque>
 #include "PlatformDefs.h"
 #include "threads/Event.h"
@@ -86,8 +88,9 @@ public:
    * @param extended_format used by DXVA
    * @param orientation
    * @param numbers of kept buffer references
+   * @param preferred number of render buffers, 0 uses the renderer's optimum
    */
-  bool Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format,  unsigned int orientation, int buffers = 0);
+  bool Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format,  unsigned int orientation, int buffers = 0, int renderbuffers = 0);
   bool IsConfigured() const;
 
   int AddVideoPicture(DVDVideoPicture& picture);
@@ -135,6 +138,8 @@ public:
   inline bool IsStarted() { return m_bIsStarted;}
   double GetDisplayLatency() { return m_displayLatency; }
   int    GetSkippedFrames()  { return m_QueueSkip; }
+  void SerializeFrameStats(CVariant &value);
+  const CRenderFrameStats& GetFrameStats() const { return m_frameStats; }
 
   bool Supports(ERENDERFEATURE feature);
   bool Supports(EDEINTERLACEMODE method);
@@ -182,6 +187,13 @@ public:
    */
   int WaitForBuffer(volatile bool& bStop, int timeout = 100);
 
+  /**
+   * Blocks until the render thread released a buffer or the timeout expired.
+   * Player calls this instead of sleeping when AddVideoPicture found the
+   * renderer still busy with all buffers.
+   */
+  void WaitForRelease(int timeout);
+
   /**
    * Can be called by player for lateness detection. This is done best by
    * looking at the end of the queue.
@@ -241,8 +253,15 @@ protected:
     double         timestamp;
     EFIELDSYNC     presentfield;
     EPRESENTMETHOD presentmethod;
+    double         requested; // timestamp before it was pinned to a vblank
+    double         decodetime;
+    double         queuetime;
+    double         fliptime;
   } m_Queue[NUM_BUFFERS];
 
+  CRenderFrameStats m_frameStats;
+  CPresentScheduler m_scheduler;
+
   std::deque<int> m_free;
   std::deque<int> m_queued;
   std::deque<int> m_discard;
@@ -0,0 +1,216 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "YUV2RGBConverter.h"
+
+#include <algorithm>
+
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+extern "C" {
+#include "libswscale/swscale.h"
+}
+
+#if defined(__ARM_NEON__)
+#include "yuv2rgb.neon.h"
+#include "utils/CPUInfo.h"
+#endif
+
+CYUV2RGBConverter::CWorker::CWorker(CYUV2RGBConverter *converter) : CThread("YUV2RGB")
+{
+  m_converter = converter;
+  m_context[0] = m_context[1] = NULL;
+}
+
+CYUV2RGBConverter::CWorker::~CWorker()
+{
+  for (int i = 0; i < 2; i++)
+  {
+    if (m_context[i])
+      sws_freeContext(m_context[i]);
+  }
+}
+
+void CYUV2RGBConverter::CWorker::Process()
+{
+  SSlice slice;
+  while (m_converter->GetSlice(slice))
+  {
+    ConvertSlice(&m_context[slice.last ? 1 : 0], slice.image, slice.y, slice.height, slice.dst, slice.dstStride);
+    m_converter->SliceDone(slice.index);
+  }
+}
+
+CYUV2RGBConverter::CYUV2RGBConverter()
+{
+  m_bStop = false;
+  std::fill(m_pending, m_pending + NUM_BUFFERS, 0);
+}
+
+CYUV2RGBConverter::~CYUV2RGBConverter()
+{
+  Stop();
+}
+
+bool CYUV2RGBConverter::Start(int threads)
+{
+  {
+    CSingleLock lock(m_lock);
+    if (!m_bStop && (int)m_workers.size() == threads)
+      return true;
+  }
+  Stop();
+
+  if (threads < 2)
+    return false;
+
+  CSingleLock lock(m_lock);
+  m_bStop = false;
+  for (int i = 0; i < threads; i++)
+  {
+    CWorker *worker = new CWorker(this);
+    worker->Create();
+    m_workers.push_back(worker);
+  }
+
+  CLog::Log(LOGDEBUG, "CYUV2RGBConverter::%s - started %d workers", __FUNCTION__, threads);
+  return true;
+}
+
+void CYUV2RGBConverter::Stop()
+{
+  std::vector<CWorker*> workers;
+  {
+    CSingleLock lock(m_lock);
+    m_bStop = true;
+    workers.swap(m_workers);
+
+    // drop slices nobody started, the ones in progress finish normally
+    for (std::deque<SSlice>::iterator it = m_slices.begin(); it != m_slices.end(); ++it)
+      m_pending[it->index]--;
+    m_slices.clear();
+
+    m_workEvent.notifyAll();
+    m_doneEvent.notifyAll();
+  }
+
+  for (std::vector<CWorker*>::iterator it = workers.begin(); it != workers.end(); ++it)
+  {
+    (*it)->StopThread();
+    delete *it;
+  }
+}
+
+bool CYUV2RGBConverter::Convert(int index, const YV12Image &image, uint8_t *dst, int dstStride)
+{
+  CSingleLock lock(m_lock);
+  if (m_workers.empty() || m_bStop)
+    return false;
+
+  // one even sized slice per worker, chroma lines must not be split
+  int height = image.height;
+  int sliceHeight = (height / m_workers.size() + 1) & ~1;
+
+  SSlice slice;
+  slice.index = index;
+  slice.image = image;
+  slice.dst = dst;
+  slice.dstStride = dstStride;
+  for (int y = 0; y < height; y += sliceHeight)
+  {
+    slice.y = y;
+    slice.height = std::min(sliceHeight, height - y);
+    slice.last = y + slice.height >= height;
+    m_slices.push_back(slice);
+    m_pending[index]++;
+  }
+
+  m_workEvent.notifyAll();
+  return true;
+}
+
+bool CYUV2RGBConverter::Wait(int index, unsigned int timeout)
+{
+  XbmcThreads::EndTime endtime(timeout);
+  CSingleLock lock(m_lock);
+  while (m_pending[index] > 0)
+  {
+    if (endtime.IsTimePast())
+      return false;
+    m_doneEvent.wait(lock, endtime.MillisLeft());
+  }
+  return true;
+}
+
+bool CYUV2RGBConverter::GetSlice(SSlice &slice)
+{
+  CSingleLock lock(m_lock);
+  while (!m_bStop && m_slices.empty())
+    m_workEvent.wait(lock);
+
+  if (m_bStop)
+    return false;
+
+  slice = m_slices.front();
+  m_slices.pop_front();
+  return true;
+}
+
+void CYUV2RGBConverter::SliceDone(int index)
+{
+  CSingleLock lock(m_lock);
+  if (--m_pending[index] <= 0)
+  {
+    m_pending[index] = 0;
+    m_doneEvent.notifyAll();
+  }
+}
+
+void CYUV2RGBConverter::ConvertSlice(SwsContext **context, const YV12Image &image, int y, int height, uint8_t *dst, int dstStride)
+{
+  uint8_t *src[] = { image.plane[0] + y * image.stride[0]
+                   , image.plane[1] + (y >> image.cshift_y) * image.stride[1]
+                   , image.plane[2] + (y >> image.cshift_y) * image.stride[2]
+                   , 0 };
+  dst += y * dstStride;
+
+#if defined(__ARM_NEON__)
+  if (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_NEON)
+  {
+    yuv420_2_rgb8888_neon(dst, src[0], src[2], src[1],
+      image.width, height, image.stride[0], image.stride[1], dstStride);
+    return;
+  }
+#endif
+
+  *context = sws_getCachedContext(*context,
+    image.width, height, PIX_FMT_YUV420P,
+    image.width, height, PIX_FMT_RGBA,
+    SWS_FAST_BILINEAR, NULL, NULL, NULL);
+  if (!*context)
+    return;
+
+  int srcStride[] = { int(image.stride[0]), int(image.stride[1]), int(image.stride[2]), 0 };
+  uint8_t *dstPlanes[] = { dst, 0, 0, 0 };
+  int dstStrides[] = { dstStride, 0, 0, 0 };
+  sws_scale(*context, src, srcStride, 0, height, dstPlanes, dstStrides);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <vector>
+
+#include "BaseRenderer.h"
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+struct SwsContext;
+
+/*!
+ \brief Software YUV 4:2:0 to RGBA conversion on a pool of worker threads.
+
+ Images are split into horizontal slices which are converted in parallel. The
+ renderer queues the conversion of a render buffer as soon as the decoder has
+ released it, the render thread only waits for the result before uploading.
+ */
+class CYUV2RGBConverter
+{
+public:
+  CYUV2RGBConverter();
+  ~CYUV2RGBConverter();
+
+  bool Start(int threads);
+  void Stop();
+
+  /*!
+   \brief queue the conversion of a render buffer
+   \return false if no workers are running, the caller has to convert itself
+   */
+  bool Convert(int index, const YV12Image &image, uint8_t *dst, int dstStride);
+
+  /*!
+   \brief wait for the queued conversion of a render buffer
+   \return false on timeout
+   */
+  bool Wait(int index, unsigned int timeout);
+
+  /*!
+   \brief convert the lines [y, y + height) of image into dst
+   */
+  static void ConvertSlice(SwsContext **context, const YV12Image &image, int y, int height, uint8_t *dst, int dstStride);
+
+private:
+  struct SSlice
+  {
+    int index;
+    YV12Image image;
+    int y;
+    int height;
+    bool last;
+    uint8_t *dst;
+    int dstStride;
+  };
+
+  class CWorker : public CThread
+  {
+  public:
+    CWorker(CYUV2RGBConverter *converter);
+    virtual ~CWorker();
+  protected:
+    virtual void Process();
+    CYUV2RGBConverter *m_converter;
+    SwsContext *m_context[2]; // regular and last slice of an image
+  };
+
+  bool GetSlice(SSlice &slice);
+  void SliceDone(int index);
+
+  std::vector<CWorker*> m_workers;
+  std::deque<SSlice> m_slices;
+  int m_pending[NUM_BUFFERS];
+  bool m_bStop;
+  CCriticalSection m_lock;
+  XbmcThreads::ConditionVariable m_workEvent;
+  XbmcThreads::ConditionVariable m_doneEvent;
+};
@@ -0,0 +1,103 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoRenderers/PresentScheduler.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+TEST(TestPresentScheduler, IntegerRatio)
+{
+  CPresentScheduler scheduler;
+  scheduler.Reset(1.0 / 30.0);
+  scheduler.SetVsyncInterval(1.0 / 60.0);
+
+  EXPECT_FALSE(scheduler.IsActive());
+  EXPECT_DOUBLE_EQ(12.345, scheduler.Schedule(12.345, 10.0));
+}
+
+TEST(TestPresentScheduler, Cadence32)
+{
+  // 23.976 fps on 59.94 Hz, exactly 2.5 vblanks per frame
+  const double frametime = 1001.0 / 24000.0;
+  const double vsynctime = 1001.0 / 60000.0;
+
+  CPresentScheduler scheduler;
+  scheduler.Reset(frametime);
+  scheduler.SetVsyncInterval(vsynctime);
+
+  EXPECT_TRUE(scheduler.IsActive());
+  EXPECT_EQ("2:3", scheduler.GetCadence());
+
+  // timestamps with +-4ms of jitter must not break the pattern
+  double last = 0.0;
+  int previous = 0;
+  for (int i = 0; i < 200; i++)
+  {
+    double jitter = ((i * 7919) % 9 - 4) / 1000.0;
+    double timestamp = 10.0 + i * frametime + jitter;
+    double slot = scheduler.Schedule(timestamp, 10.0);
+
+    EXPECT_LE(fabs(slot - timestamp), vsynctime);
+    if (i > 0)
+    {
+      int vblanks = (int)floor((slot - last) / vsynctime + 0.5);
+      EXPECT_TRUE(vblanks == 2 || vblanks == 3);
+      EXPECT_NE(previous, vblanks);
+      previous = vblanks;
+    }
+    last = slot;
+  }
+}
+
+TEST(TestPresentScheduler, Resync)
+{
+  const double frametime = 1001.0 / 24000.0;
+  const double vsynctime = 1.0 / 60.0;
+
+  CPresentScheduler scheduler;
+  scheduler.Reset(frametime);
+  scheduler.SetVsyncInterval(vsynctime);
+
+  scheduler.Schedule(10.0, 10.0);
+  scheduler.Schedule(10.0 + frametime, 10.0);
+
+  // a seek moves the timestamps far away from the cadence
+  double slot = scheduler.Schedule(20.0, 10.0);
+  EXPECT_LE(fabs(slot - 20.0), vsynctime / 2.0 + 1e-9);
+}
+
+TEST(TestPresentScheduler, Judder)
+{
+  CPresentScheduler scheduler;
+  scheduler.Reset(1.0 / 24.0);
+
+  EXPECT_DOUBLE_EQ(0.0, scheduler.GetJudder());
+
+  // a constant latency is not judder
+  for (int i = 0; i < 10; i++)
+    scheduler.AddPresent(i / 24.0, i / 24.0 + 0.02);
+  EXPECT_NEAR(0.0, scheduler.GetJudder(), 1e-6);
+
+  for (int i = 0; i < 10; i++)
+    scheduler.AddPresent(i / 24.0, i / 24.0 + (i % 2) * 0.01);
+  EXPECT_GT(scheduler.GetJudder(), 1.0);
+}
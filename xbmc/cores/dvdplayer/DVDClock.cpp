@@ -24,6 +24,7 @@
 #include "utils/MathUtils.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
+#include "utils/TraceRecorder.h"
 
 int64_t CDVDClock::m_systemOffset;
 int64_t CDVDClock::m_systemFrequency;
@@ -154,6 +155,8 @@ void CDVDClock::SetSpeed(int iSpeed)
 void CDVDClock::SetSpeedAdjust(double adjust)
 {
   CExclusiveLock lock(m_critSection);
+  if (adjust != m_speedAdjust)
+    CTraceRecorder::GetInstance().Record(TRACE_CLOCK_ADJUSTED, 0, 1, adjust, 0.0);
   m_speedAdjust = adjust;
 }
 
@@ -181,6 +184,7 @@ bool CDVDClock::Update(double clock, double absolute, double limit, const char*
   else if (error > limit)
   {
     Discontinuity(clock, absolute);
+    CTraceRecorder::GetInstance().Record(TRACE_CLOCK_ADJUSTED, 0, 0, clock, clock - was_clock);
 
     CLog::Log(LOGDEBUG, "CDVDClock::Discontinuity - %s - was:%f, should be:%f, error:%f"
                       , log
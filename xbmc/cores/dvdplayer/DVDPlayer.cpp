@@ -65,6 +65,7 @@
 #include "utils/StreamDetails.h"
 #include "pvr/PVRManager.h"
 #include "utils/StreamUtils.h"
+#include "utils/TraceRecorder.h"
 #include "utils/Variant.h"
 #include "storage/MediaManager.h"
 #include "dialogs/GUIDialogBusy.h"
@@ -1019,6 +1020,7 @@ bool CDVDPlayer::ReadPacket(DemuxPacket*& packet, CDemuxStream*& stream)
         m_SelectionStreams.Clear(STREAM_NONE, STREAM_SOURCE_DEMUX);
         m_SelectionStreams.Update(m_pInputStream, m_pDemuxer);
       }
+      CTraceRecorder::GetInstance().Record(TRACE_PACKET_DEMUXED, stream->type, packet->iSize, packet->dts, packet->pts);
     }
     return true;
   }
@@ -4658,6 +4660,7 @@ void CDVDPlayer::UpdatePlayState(double timeout)
     state.cache_level  = std::min(1.0, GetQueueTime() / 8000.0);
     state.cache_offset = GetQueueTime() / state.time_total;
   }
+  CTraceRecorder::GetInstance().Record(TRACE_CACHE_LEVEL, 0, (int)GetQueueTime(), state.cache_level, state.cache_delay);
 
   XFILE::SCacheStatus status;
   if(m_pInputStream && m_pInputStream->GetCacheStatus(&status))
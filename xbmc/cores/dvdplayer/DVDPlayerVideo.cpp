@@ -26,6 +26,7 @@
 #include "settings/Settings.h"
 #include "video/VideoReferenceClock.h"
 #include "utils/MathUtils.h"
+#include "utils/TraceRecorder.h"
 #include "DVDPlayer.h"
 #include "DVDPlayerVideo.h"
 #include "DVDCodecs/DVDFactoryCodec.h"
@@ -641,6 +642,7 @@ void CDVDPlayerVideo::Process()
           m_pVideoCodec->ClearPicture(&picture);
           if (m_pVideoCodec->GetPicture(&picture))
           {
+            CTraceRecorder::GetInstance().Record(TRACE_PICTURE_DECODED, 0, picture.iFlags, picture.pts, picture.iDuration);
             sPostProcessType.clear();
 
             if(picture.iDuration == 0.0)
@@ -1018,6 +1020,16 @@ int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
     flags |= stereo_flags;
 
     CLog::Log(LOGDEBUG,"%s - change configuration. %dx%d. framerate: %4.2f. format: %s",__FUNCTION__,pPicture->iWidth, pPicture->iHeight, config_framerate, formatstr.c_str());
+
+    // per codec render buffer count from advancedsettings, 0 lets the renderer decide
+    int renderbuffers = 0;
+    std::map<std::string, int>::const_iterator itBuffers = g_advancedSettings.m_videoRenderBuffers.find(avcodec_get_name(m_hints.codec));
+    if (itBuffers != g_advancedSettings.m_videoRenderBuffers.end())
+    {
+      renderbuffers = itBuffers->second;
+      CLog::Log(LOGDEBUG, "%s - using %d render buffers for codec %s", __FUNCTION__, renderbuffers, itBuffers->first.c_str());
+    }
+
     if(!g_renderManager.Configure(pPicture->iWidth
                                 , pPicture->iHeight
                                 , pPicture->iDisplayWidth
@@ -1027,7 +1039,8 @@ int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
                                 , pPicture->format
                                 , pPicture->extended_format
                                 , m_hints.orientation
-                                , m_pVideoCodec->GetAllowedReferences()))
+                                , m_pVideoCodec->GetAllowedReferences()
+                                , renderbuffers))
     {
       CLog::Log(LOGERROR, "%s - failed to configure renderer", __FUNCTION__);
       return EOS_ABORT;
@@ -1187,6 +1200,7 @@ int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
   if (buffer < 0)
   {
     m_droppingStats.AddOutputDropGain(pts, 1/m_fFrameRate);
+    CTraceRecorder::GetInstance().Record(TRACE_PICTURE_DROPPED, 0, 0, pts, 0.0);
     return EOS_DROPPED;
   }
 
@@ -1194,17 +1208,18 @@ int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
 
   int index = g_renderManager.AddVideoPicture(*pPicture);
 
-  // video device might not be done yet
+  // video device might not be done yet, wait for the render thread to release a buffer
   while (index < 0 && !CThread::m_bStop &&
          CDVDClock::GetAbsoluteClock(false) < iCurrentClock + iSleepTime + DVD_MSEC_TO_TIME(500) )
   {
-    Sleep(1);
+    g_renderManager.WaitForRelease(10);
     index = g_renderManager.AddVideoPicture(*pPicture);
   }
 
   if (index < 0)
   {
     m_droppingStats.AddOutputDropGain(pts, 1/m_fFrameRate);
+    CTraceRecorder::GetInstance().Record(TRACE_PICTURE_DROPPED, 0, 0, pts, 0.0);
     return EOS_DROPPED;
   }
 
@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include "DDSImage.h"
+#include "ETC1.h"
 #include "XBTF.h"
 #include <squish.h>
 #include "utils/log.h"
@@ -71,6 +72,8 @@ unsigned int CDDSImage::GetFormat() const
       return XB_FMT_DXT3;
     if (strncmp((const char *)&m_desc.pixelFormat.fourcc, "DXT5", 4) == 0)
       return XB_FMT_DXT5;
+    if (strncmp((const char *)&m_desc.pixelFormat.fourcc, "ETC1", 4) == 0)
+      return XB_FMT_ETC1;
     if (strncmp((const char *)&m_desc.pixelFormat.fourcc, "ARGB", 4) == 0)
       return XB_FMT_A8R8G8B8;
   }
@@ -116,11 +119,13 @@ bool CDDSImage::ReadFile(const std::string &inputFile)
   return true;
 }
 
-bool CDDSImage::Create(const std::string &outputFile, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE)
+bool CDDSImage::Create(const std::string &outputFile, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE, unsigned int format)
 {
   if (!brga)
     return false;
-  if (!Compress(width, height, pitch, brga, maxMSE))
+  bool compressed = format == XB_FMT_ETC1 ? CompressETC1(width, height, pitch, brga, maxMSE)
+                                          : Compress(width, height, pitch, brga, maxMSE);
+  if (!compressed)
   { // use ARGB
     Allocate(width, height, XB_FMT_A8R8G8B8);
     for (unsigned int i = 0; i < height; i++)
@@ -148,6 +153,7 @@ unsigned int CDDSImage::GetStorageRequirements(unsigned int width, unsigned int
   switch (format)
   {
   case XB_FMT_DXT1:
+  case XB_FMT_ETC1:
     return ((width + 3) / 4) * ((height + 3) / 4) * 8;
   case XB_FMT_DXT3:
   case XB_FMT_DXT5:
@@ -216,9 +222,24 @@ bool CDDSImage::Compress(unsigned int width, unsigned int height, unsigned int p
   return false;
 }
 
+bool CDDSImage::CompressETC1(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE)
+{
+  Allocate(width, height, XB_FMT_ETC1);
+  ETC1::CompressImage(brga, width, height, pitch, m_data);
+
+  double colorMSE = ETC1::ComputeMSE(brga, width, height, pitch, m_data);
+  if (!maxMSE || colorMSE < maxMSE)
+  {
+    CLog::Log(LOGDEBUG, "%s - using ETC1 (min error is: %2.2f)", __FUNCTION__, colorMSE);
+    return true;
+  }
+  CLog::Log(LOGDEBUG, "%s - no format suitable (min error is: %2.2f)", __FUNCTION__, colorMSE);
+  return false;
+}
+
 bool CDDSImage::Decompress(unsigned char *argb, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *dxt, unsigned int format)
 {
-  if (!argb || !dxt || !(format & XB_FMT_DXT_MASK))
+  if (!argb || !dxt || !(format & XB_FMT_COMPRESSED_MASK))
     return false;
 
   if (format == XB_FMT_DXT1)
@@ -227,6 +248,8 @@ bool CDDSImage::Decompress(unsigned char *argb, unsigned int width, unsigned int
     squish::DecompressImage(argb, width, height, pitch, dxt, squish::kDxt3 | squish::kSourceBGRA);
   else if (format == XB_FMT_DXT5)
     squish::DecompressImage(argb, width, height, pitch, dxt, squish::kDxt5 | squish::kSourceBGRA);
+  else if (format == XB_FMT_ETC1)
+    ETC1::DecompressImage(argb, width, height, pitch, dxt);
 
   return true;
 }
@@ -257,6 +280,8 @@ const char *CDDSImage::GetFourCC(unsigned int format)
     return "DXT3";
   case XB_FMT_DXT5:
     return "DXT5";
+  case XB_FMT_ETC1:
+    return "ETC1";
   case XB_FMT_A8R8G8B8:
   default:
     return "ARGB";
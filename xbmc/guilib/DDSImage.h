@@ -22,6 +22,7 @@
 
 #include <string>
 #include <stdint.h>
+#include "XBTF.h"
 
 class CDDSImage
 {
@@ -45,11 +46,12 @@ public:
    \param pitch pitch of the pixel buffer
    \param argb pixel buffer
    \param maxMSE maximum mean square error to allow, ignored if 0 (the default)
+   \param format compression to use, XB_FMT_DXT1 (upgrading to DXT3/5 for alpha, the default) or XB_FMT_ETC1
    \return true on successful image creation, false otherwise
    */
-  bool Create(const std::string &file, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0);
+  bool Create(const std::string &file, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0, unsigned int format = XB_FMT_DXT1);
   
-  /*! \brief Decompress a DXT1/3/5 image to the given buffer
+  /*! \brief Decompress a DXT1/3/5 or ETC1 image to the given buffer
    Assumes the buffer has been allocated to at least width*height*4
    \param argb pixel buffer to write to (at least width*height*4 bytes)
    \param width width of the pixel buffer
@@ -76,6 +78,16 @@ private:
    */
   bool Compress(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0);
 
+  /*! \brief Compress an ARGB buffer into an ETC1 image, alpha is dropped
+   \param width width of the pixel buffer
+   \param height height of the pixel buffer
+   \param pitch pitch of the pixel buffer
+   \param argb pixel buffer
+   \param maxMSE maximum mean square error to allow, ignored if 0
+   \return true on successful compression within the given maxMSE, false otherwise
+   */
+  bool CompressETC1(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE);
+
   static unsigned int GetStorageRequirements(unsigned int width, unsigned int height, unsigned int format);
   enum {
     ddsd_caps        = 0x00000001,
@@ -81,3 +81,45 @@ void CGreedyDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegion
       output.push_back(currentRegion);
   }
 }
+
+CCostMergeDirtyRegionSolver::CCostMergeDirtyRegionSolver()
+{
+  m_costNewRegion = 1.0f / 32.0f;
+}
+
+void CCostMergeDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegionList &output)
+{
+  for (unsigned int i = 0; i < input.size(); i++)
+  {
+    if (!input[i].IsEmpty())
+      output.push_back(input[i]);
+  }
+
+  float costNewRegion = m_costNewRegion * g_graphicsContext.GetViewWindow().Area();
+  while (output.size() > 1)
+  {
+    unsigned int bestFirst = 0, bestSecond = 0;
+    float bestSaving = 0.0f;
+    for (unsigned int i = 0; i < output.size(); i++)
+    {
+      for (unsigned int j = i + 1; j < output.size(); j++)
+      {
+        CDirtyRegion temporaryUnion = output[i];
+        temporaryUnion.Union(output[j]);
+        float saving = output[i].Area() + output[j].Area() + costNewRegion - temporaryUnion.Area();
+        if (saving > bestSaving)
+        {
+          bestFirst  = i;
+          bestSecond = j;
+          bestSaving = saving;
+        }
+      }
+    }
+
+    if (bestSaving <= 0.0f)
+      break;
+
+    output[bestFirst].Union(output[bestSecond]);
+    output.erase(output.begin() + bestSecond);
+  }
+}
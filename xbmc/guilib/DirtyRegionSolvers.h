@@ -48,3 +48,19 @@ private:
   float m_costNewRegion;
   float m_costPerArea;
 };
+
+/*!
+ \brief Merges the pair of regions that saves the most until no merge saves anything.
+
+ A rendering pass costs as much as redrawing a fixed part of the viewport, every pixel
+ costs the same, overlapping regions are paid twice. Unlike CGreedyDirtyRegionSolver
+ the result doesn't depend on the order the regions were marked in.
+ */
+class CCostMergeDirtyRegionSolver : public IDirtyRegionSolver
+{
+public:
+  CCostMergeDirtyRegionSolver();
+  virtual void Solve(const CDirtyRegionList &input, CDirtyRegionList &output);
+private:
+  float m_costNewRegion; // part of the viewport area a rendering pass costs
+};
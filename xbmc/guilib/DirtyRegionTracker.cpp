@@ -23,6 +23,7 @@
 #include "utils/log.h"
 #include <stdio.h>
 #include "DirtyRegionSolvers.h"
+#include "GraphicContext.h"
 
 CDirtyRegionTracker::CDirtyRegionTracker(int buffering)
 {
@@ -49,6 +50,10 @@ void CDirtyRegionTracker::SelectAlgorithm()
       CLog::Log(LOGDEBUG, "guilib: Cost reduction as algorithm for solving rendering passes");
       m_solver = new CGreedyDirtyRegionSolver();
       break;
+    case DIRTYREGION_SOLVER_COST_MERGE:
+      CLog::Log(LOGDEBUG, "guilib: Cost merging as algorithm for solving rendering passes");
+      m_solver = new CCostMergeDirtyRegionSolver();
+      break;
     case DIRTYREGION_SOLVER_UNION:
       m_solver = new CUnionDirtyRegionSolver();
       CLog::Log(LOGDEBUG, "guilib: Union as algorithm for solving rendering passes");
@@ -72,12 +77,36 @@ const CDirtyRegionList &CDirtyRegionTracker::GetMarkedRegions() const
   return m_markedRegions;
 }
 
-CDirtyRegionList CDirtyRegionTracker::GetDirtyRegions()
+CDirtyRegionList CDirtyRegionTracker::GetDirtyRegions(int bufferAge)
 {
   CDirtyRegionList output;
 
-  if (m_solver)
+  if (!m_solver)
+    return output;
+
+  if (bufferAge < 0 || g_advancedSettings.m_guiVisualizeDirtyRegions)
+  {
     m_solver->Solve(m_markedRegions, output);
+    return output;
+  }
+
+  if (bufferAge == 0 || bufferAge > m_buffering)
+  {
+    // the contents of the buffer are unknown or older than the regions we keep
+    if (bufferAge > m_buffering)
+      m_buffering = bufferAge;
+    output.push_back(CDirtyRegion(g_graphicsContext.GetViewWindow()));
+    return output;
+  }
+
+  // the buffer misses the regions marked since it was presented
+  CDirtyRegionList regions;
+  for (CDirtyRegionList::const_iterator i = m_markedRegions.begin(); i != m_markedRegions.end(); ++i)
+  {
+    if (i->GetAge() < bufferAge)
+      regions.push_back(*i);
+  }
+  m_solver->Solve(regions, output);
 
   return output;
 }
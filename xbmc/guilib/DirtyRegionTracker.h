@@ -36,7 +36,11 @@ public:
   void MarkDirtyRegion(const CDirtyRegion &region);
 
   const CDirtyRegionList &GetMarkedRegions() const;
-  CDirtyRegionList GetDirtyRegions();
+  /*! \brief Solve the regions that have to be rendered
+   \param bufferAge age of the back buffer as returned by CRenderSystemBase::GetBufferAge(), -1 to render all
+   regions marked in the last frames
+   */
+  CDirtyRegionList GetDirtyRegions(int bufferAge = -1);
   void CleanMarkedRegions();
 
 private:
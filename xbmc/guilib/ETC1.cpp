@@ -0,0 +1,327 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ETC1.h"
+
+#include <string.h>
+
+namespace
+{
+
+// intensity modifiers, index 0 and 1 are added, 2 and 3 subtracted
+const int modifierTable[8][2] = { {  2,   8 }, {  5,  17 }, {  9,  29 }, { 13,  42 },
+                                  { 18,  60 }, { 24,  80 }, { 33, 106 }, { 47, 183 } };
+
+inline int Clamp(int value)
+{
+  return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+inline int Modifier(int table, int index)
+{
+  int value = modifierTable[table][index & 1];
+  return (index & 2) ? -value : value;
+}
+
+// which sub block a pixel of the 4x4 block belongs to
+inline int SubBlock(int x, int y, bool flip)
+{
+  return flip ? (y >= 2) : (x >= 2);
+}
+
+struct SBlockPixels
+{
+  int rgb[16][3]; // indexed by x * 4 + y, the order of the index bits
+};
+
+struct SSubBlock
+{
+  int base[3];
+  int table;
+  unsigned int indices[16];
+  int error;
+};
+
+// find the best table and indices for the pixels of a sub block around a base color
+void FitSubBlock(const SBlockPixels &pixels, int sub, bool flip, SSubBlock &result)
+{
+  result.error = 0x7fffffff;
+  for (int table = 0; table < 8; table++)
+  {
+    int error = 0;
+    unsigned int indices[16] = { 0 };
+    for (int p = 0; p < 16 && error < result.error; p++)
+    {
+      if (SubBlock(p / 4, p % 4, flip) != sub)
+        continue;
+
+      int best = 0x7fffffff;
+      for (int index = 0; index < 4; index++)
+      {
+        int modifier = Modifier(table, index);
+        int e = 0;
+        for (int c = 0; c < 3; c++)
+        {
+          int d = Clamp(result.base[c] + modifier) - pixels.rgb[p][c];
+          e += d * d;
+        }
+        if (e < best)
+        {
+          best = e;
+          indices[p] = index;
+        }
+      }
+      error += best;
+    }
+    if (error < result.error)
+    {
+      result.error = error;
+      result.table = table;
+      memcpy(result.indices, indices, sizeof(indices));
+    }
+  }
+}
+
+void Average(const SBlockPixels &pixels, int sub, bool flip, float average[3])
+{
+  average[0] = average[1] = average[2] = 0.0f;
+  for (int p = 0; p < 16; p++)
+  {
+    if (SubBlock(p / 4, p % 4, flip) != sub)
+      continue;
+    for (int c = 0; c < 3; c++)
+      average[c] += pixels.rgb[p][c];
+  }
+  for (int c = 0; c < 3; c++)
+    average[c] /= 8.0f;
+}
+
+inline int Quantize(float value, int max)
+{
+  int q = (int)(value * max / 255.0f + 0.5f);
+  return q < 0 ? 0 : (q > max ? max : q);
+}
+
+void WriteBlock(unsigned char *block, const int color1[3], const int color2[3], bool differential, bool flip,
+                const SSubBlock &sub1, const SSubBlock &sub2)
+{
+  for (int c = 0; c < 3; c++)
+  {
+    if (differential)
+      block[c] = (unsigned char)((color1[c] << 3) | ((color2[c] - color1[c]) & 7));
+    else
+      block[c] = (unsigned char)((color1[c] << 4) | color2[c]);
+  }
+  block[3] = (unsigned char)((sub1.table << 5) | (sub2.table << 2) | (differential ? 2 : 0) | (flip ? 1 : 0));
+
+  unsigned int bits = 0;
+  for (int p = 0; p < 16; p++)
+  {
+    int x = p / 4, y = p % 4;
+    unsigned int index = SubBlock(x, y, flip) ? sub2.indices[p] : sub1.indices[p];
+    bits |= ((index >> 1) & 1) << (p + 16);
+    bits |= (index & 1) << p;
+  }
+  block[4] = (unsigned char)(bits >> 24);
+  block[5] = (unsigned char)(bits >> 16);
+  block[6] = (unsigned char)(bits >> 8);
+  block[7] = (unsigned char)bits;
+}
+
+// try both sub block orientations and color modes, keep the one with the smallest error
+void CompressBlock(const SBlockPixels &pixels, unsigned char *block)
+{
+  int bestError = 0x7fffffff;
+  for (int f = 0; f < 2; f++)
+  {
+    bool flip = f != 0;
+    float average[2][3];
+    Average(pixels, 0, flip, average[0]);
+    Average(pixels, 1, flip, average[1]);
+
+    for (int mode = 0; mode < 2; mode++)
+    {
+      bool differential = mode != 0;
+      int color[2][3];
+      SSubBlock sub[2];
+      bool valid = true;
+      for (int c = 0; c < 3; c++)
+      {
+        if (differential)
+        {
+          color[0][c] = Quantize(average[0][c], 31);
+          color[1][c] = Quantize(average[1][c], 31);
+          int delta = color[1][c] - color[0][c];
+          if (delta < -4 || delta > 3)
+            valid = false;
+          sub[0].base[c] = (color[0][c] << 3) | (color[0][c] >> 2);
+          sub[1].base[c] = (color[1][c] << 3) | (color[1][c] >> 2);
+        }
+        else
+        {
+          color[0][c] = Quantize(average[0][c], 15);
+          color[1][c] = Quantize(average[1][c], 15);
+          sub[0].base[c] = (color[0][c] << 4) | color[0][c];
+          sub[1].base[c] = (color[1][c] << 4) | color[1][c];
+        }
+      }
+      if (!valid)
+        continue;
+
+      FitSubBlock(pixels, 0, flip, sub[0]);
+      FitSubBlock(pixels, 1, flip, sub[1]);
+      int error = sub[0].error + sub[1].error;
+      if (error < bestError)
+      {
+        bestError = error;
+        WriteBlock(block, color[0], color[1], differential, flip, sub[0], sub[1]);
+      }
+    }
+  }
+}
+
+void DecompressBlock(unsigned char const *block, int rgb[16][3])
+{
+  bool differential = (block[3] & 2) != 0;
+  bool flip = (block[3] & 1) != 0;
+  int table[2] = { block[3] >> 5, (block[3] >> 2) & 7 };
+
+  int base[2][3];
+  for (int c = 0; c < 3; c++)
+  {
+    if (differential)
+    {
+      int c1 = block[c] >> 3;
+      int c2 = c1 + ((int)((block[c] & 7) << 29) >> 29); // sign extend the 3 bit delta
+      base[0][c] = (c1 << 3) | (c1 >> 2);
+      base[1][c] = ((c2 & 31) << 3) | ((c2 & 31) >> 2);
+    }
+    else
+    {
+      base[0][c] = (block[c] & 0xf0) | (block[c] >> 4);
+      base[1][c] = ((block[c] & 0x0f) << 4) | (block[c] & 0x0f);
+    }
+  }
+
+  unsigned int bits = (block[4] << 24) | (block[5] << 16) | (block[6] << 8) | block[7];
+  for (int p = 0; p < 16; p++)
+  {
+    int sub = SubBlock(p / 4, p % 4, flip);
+    int index = (((bits >> (p + 16)) & 1) << 1) | ((bits >> p) & 1);
+    int modifier = Modifier(table[sub], index);
+    for (int c = 0; c < 3; c++)
+      rgb[p][c] = Clamp(base[sub][c] + modifier);
+  }
+}
+
+}
+
+namespace ETC1
+{
+
+unsigned int GetStorageRequirements(unsigned int width, unsigned int height)
+{
+  return ((width + 3) / 4) * ((height + 3) / 4) * 8;
+}
+
+void CompressImage(unsigned char const *bgra, unsigned int width, unsigned int height, unsigned int pitch, unsigned char *blocks)
+{
+  for (unsigned int by = 0; by < height; by += 4)
+  {
+    for (unsigned int bx = 0; bx < width; bx += 4)
+    {
+      // pixels outside of the image repeat the edge
+      SBlockPixels pixels;
+      for (unsigned int x = 0; x < 4; x++)
+      {
+        for (unsigned int y = 0; y < 4; y++)
+        {
+          unsigned int px = bx + x < width ? bx + x : width - 1;
+          unsigned int py = by + y < height ? by + y : height - 1;
+          unsigned char const *src = bgra + py * pitch + px * 4;
+          int *rgb = pixels.rgb[x * 4 + y];
+          rgb[0] = src[2];
+          rgb[1] = src[1];
+          rgb[2] = src[0];
+        }
+      }
+      CompressBlock(pixels, blocks);
+      blocks += 8;
+    }
+  }
+}
+
+void DecompressImage(unsigned char *bgra, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *blocks)
+{
+  for (unsigned int by = 0; by < height; by += 4)
+  {
+    for (unsigned int bx = 0; bx < width; bx += 4)
+    {
+      int rgb[16][3];
+      DecompressBlock(blocks, rgb);
+      for (unsigned int x = 0; x < 4 && bx + x < width; x++)
+      {
+        for (unsigned int y = 0; y < 4 && by + y < height; y++)
+        {
+          unsigned char *dst = bgra + (by + y) * pitch + (bx + x) * 4;
+          const int *pixel = rgb[x * 4 + y];
+          dst[0] = (unsigned char)pixel[2];
+          dst[1] = (unsigned char)pixel[1];
+          dst[2] = (unsigned char)pixel[0];
+          dst[3] = 0xff;
+        }
+      }
+      blocks += 8;
+    }
+  }
+}
+
+double ComputeMSE(unsigned char const *bgra, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *blocks)
+{
+  if (!width || !height)
+    return 0.0;
+
+  double error = 0.0;
+  for (unsigned int by = 0; by < height; by += 4)
+  {
+    for (unsigned int bx = 0; bx < width; bx += 4)
+    {
+      int rgb[16][3];
+      DecompressBlock(blocks, rgb);
+      for (unsigned int x = 0; x < 4 && bx + x < width; x++)
+      {
+        for (unsigned int y = 0; y < 4 && by + y < height; y++)
+        {
+          unsigned char const *src = bgra + (by + y) * pitch + (bx + x) * 4;
+          const int *pixel = rgb[x * 4 + y];
+          for (int c = 0; c < 3; c++)
+          {
+            int d = pixel[c] - src[2 - c];
+            error += d * d;
+          }
+        }
+      }
+      blocks += 8;
+    }
+  }
+  return error / (3.0 * width * height);
+}
+
+}
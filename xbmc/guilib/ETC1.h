@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*!
+ \brief ETC1 texture compression, the format every OpenGL ES 2.0 GPU can sample from.
+
+ Images are stored in 4x4 blocks of 8 bytes (4 bits per pixel) without alpha. The interface
+ follows the one of libsquish used for DXT, pixel buffers are in BGRA byte order.
+ */
+namespace ETC1
+{
+  /*! \brief Size of the compressed image in bytes
+   */
+  unsigned int GetStorageRequirements(unsigned int width, unsigned int height);
+
+  /*! \brief Compress a BGRA image, alpha is ignored
+   \param bgra pixel buffer to compress
+   \param width width of the pixel buffer
+   \param height height of the pixel buffer
+   \param pitch pitch of the pixel buffer
+   \param blocks compressed data, at least GetStorageRequirements() bytes
+   */
+  void CompressImage(unsigned char const *bgra, unsigned int width, unsigned int height, unsigned int pitch, unsigned char *blocks);
+
+  /*! \brief Decompress an image to an opaque BGRA buffer
+   \param bgra pixel buffer to write to
+   \param width width of the pixel buffer
+   \param height height of the pixel buffer
+   \param pitch pitch of the pixel buffer
+   \param blocks compressed data
+   */
+  void DecompressImage(unsigned char *bgra, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *blocks);
+
+  /*! \brief Mean square error per color channel of the compressed image
+   */
+  double ComputeMSE(unsigned char const *bgra, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *blocks);
+}
@@ -32,6 +32,7 @@
 #include "listproviders/IListProvider.h"
 #include "settings/Settings.h"
 #include "guiinfo/GUIInfoLabels.h"
+#include "GUILargeTextureManager.h"
 
 #define HOLD_TIME_START 100
 #define HOLD_TIME_END   3000
@@ -99,7 +100,7 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
   int offset = (int)floorf(m_scroller.GetValue() / m_layout->Size(m_orientation));
 
   int cacheBefore, cacheAfter;
-  GetCacheOffsets(cacheBefore, cacheAfter);
+  GetPrefetchOffsets(cacheBefore, cacheAfter);
 
   // Free memory not used on screen
   if ((int)m_items.size() > m_itemsPerPage + cacheBefore + cacheAfter)
@@ -127,6 +128,7 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
     if (itemNo >= 0)
     {
       CGUIListItemPtr item = m_items[itemNo];
+      SetTextureDemand(current, offset);
       // render our item
       if (m_orientation == VERTICAL)
         ProcessItem(origin.x, pos, item, focused, currentTime, dirtyregions);
@@ -137,6 +139,7 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
     pos += focused ? m_focusedLayout->Size(m_orientation) : m_layout->Size(m_orientation);
     current++;
   }
+  g_largeTextureManager.SetDemand(CGUILargeTextureManager::DEMAND_VISIBLE);
 
   // when we are scrolling up, offset will become lower (integer division, see offset calc)
   // to have same behaviour when scrolling down, we need to set page control to offset+1
@@ -1298,6 +1301,28 @@ void CGUIBaseContainer::GetCacheOffsets(int &cacheBefore, int &cacheAfter) const
   }
 }
 
+void CGUIBaseContainer::GetPrefetchOffsets(int &cacheBefore, int &cacheAfter) const
+{
+  GetCacheOffsets(cacheBefore, cacheAfter);
+
+  // while scrolling, get the next page ready in time. Those items are only processed, not rendered
+  if (m_scroller.IsScrollingDown())
+    cacheAfter = std::max(cacheAfter, m_itemsPerPage);
+  else if (m_scroller.IsScrollingUp())
+    cacheBefore = std::max(cacheBefore, m_itemsPerPage);
+}
+
+void CGUIBaseContainer::SetTextureDemand(int row, int offset) const
+{
+  // the last visible row may be partially on screen
+  CGUILargeTextureManager::TEXTURE_DEMAND demand = CGUILargeTextureManager::DEMAND_VISIBLE;
+  if (row < offset)
+    demand = m_scroller.IsScrollingUp() ? CGUILargeTextureManager::DEMAND_PREFETCH : CGUILargeTextureManager::DEMAND_NEAR;
+  else if (row > offset + m_itemsPerPage)
+    demand = m_scroller.IsScrollingDown() ? CGUILargeTextureManager::DEMAND_PREFETCH : CGUILargeTextureManager::DEMAND_NEAR;
+  g_largeTextureManager.SetDemand(demand);
+}
+
 void CGUIBaseContainer::SetCursor(int cursor)
 {
   m_cursor = cursor;
@@ -173,6 +173,8 @@ protected:
 
   void UpdateScrollByLetter();
   void GetCacheOffsets(int &cacheBefore, int &cacheAfter) const;
+  void GetPrefetchOffsets(int &cacheBefore, int &cacheAfter) const;
+  void SetTextureDemand(int row, int offset) const;
   int GetCacheCount() const { return m_cacheItems; };
   bool ScrollingDown() const { return m_scroller.IsScrollingDown(); };
   bool ScrollingUp() const { return m_scroller.IsScrollingUp(); };
@@ -124,6 +124,9 @@ void CGUIControlGroup::Render()
   for (iControls it = m_children.begin(); it != m_children.end(); ++it)
   {
     CGUIControl *control = *it;
+    // controls outside of the dirty region being rendered have nothing to draw
+    if (!g_graphicsContext.IsInScissors(control->GetRenderRegion()))
+      continue;
     if (m_renderFocusedLast && control->HasFocus())
       focusedControl = control;
     else
@@ -30,6 +30,9 @@
 #include "utils/GLUtils.h"
 #include "windowing/WindowingFactory.h"
 #include "guilib/MatrixGLES.h"
+#if defined(HAS_GLES)
+#include "GUIQuadBatchGLES.h"
+#endif
 
 // stuff for freetype
 #include <ft2build.h>
@@ -163,49 +166,53 @@ void CGUIFontTTFGL::LastEnd()
   glDisable(GL_TEXTURE_2D);
 #else
   // GLES 2.0 version.
-  g_Windowing.EnableGUIShader(SM_FONTS);
-
-  CreateStaticVertexBuffers();
-
-  GLint posLoc  = g_Windowing.GUIShaderGetPos();
-  GLint colLoc  = g_Windowing.GUIShaderGetCol();
-  GLint tex0Loc = g_Windowing.GUIShaderGetCoord0();
-  GLint modelLoc = g_Windowing.GUIShaderGetModel();
-
-  // Enable the attributes used by this shader
-  glEnableVertexAttribArray(posLoc);
-  glEnableVertexAttribArray(colLoc);
-  glEnableVertexAttribArray(tex0Loc);
-
   if (m_vertex.size() > 0)
   {
-    // Deal with vertices that had to use software clipping
-    std::vector<SVertex> vecVertices( 6 * (m_vertex.size() / 4) );
-    SVertex *vertices = &vecVertices[0];
+    // Vertices that had to use software clipping are drawn along with the other GUI quads
+    CGUIQuadBatchGLES& batch = CGUIQuadBatchGLES::GetInstance();
+    batch.SetState(SM_FONTS, m_nTexture, CGUIQuadBatchGLES::BLEND_ALPHA_SEPARATE);
 
+    // characters are top left, bottom left, top right, bottom right
+    static const int order[4] = { 0, 2, 3, 1 };
     for (size_t i=0; i<m_vertex.size(); i+=4)
     {
-      *vertices++ = m_vertex[i];
-      *vertices++ = m_vertex[i+1];
-      *vertices++ = m_vertex[i+2];
-
-      *vertices++ = m_vertex[i+1];
-      *vertices++ = m_vertex[i+3];
-      *vertices++ = m_vertex[i+2];
+      SQuadVertex vertices[4];
+      for (int j = 0; j < 4; j++)
+      {
+        const SVertex &vertex = m_vertex[i + order[j]];
+        vertices[j].x = vertex.x;
+        vertices[j].y = vertex.y;
+        vertices[j].z = vertex.z;
+        vertices[j].r = vertex.r;
+        vertices[j].g = vertex.g;
+        vertices[j].b = vertex.b;
+        vertices[j].a = vertex.a;
+        vertices[j].u1 = vertex.u;
+        vertices[j].v1 = vertex.v;
+        vertices[j].u2 = vertices[j].v2 = 0.0f;
+      }
+      batch.AddQuad(vertices);
     }
-
-    vertices = &vecVertices[0];
-
-    glVertexAttribPointer(posLoc,  3, GL_FLOAT,         GL_FALSE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, x));
-    // Normalize color values. Does not affect Performance at all.
-    glVertexAttribPointer(colLoc,  4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, r));
-    glVertexAttribPointer(tex0Loc, 2, GL_FLOAT,         GL_FALSE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, u));
-
-    glDrawArrays(GL_TRIANGLES, 0, vecVertices.size());
   }
   if (m_vertexTrans.size() > 0)
   {
     // Deal with the vertices that can be hardware clipped and therefore translated
+    g_Windowing.EnableGUIShader(SM_FONTS);
+
+    CreateStaticVertexBuffers();
+
+    GLint posLoc  = g_Windowing.GUIShaderGetPos();
+    GLint colLoc  = g_Windowing.GUIShaderGetCol();
+    GLint tex0Loc = g_Windowing.GUIShaderGetCoord0();
+    GLint modelLoc = g_Windowing.GUIShaderGetModel();
+
+    // Enable the attributes used by this shader
+    glEnableVertexAttribArray(posLoc);
+    glEnableVertexAttribArray(colLoc);
+    glEnableVertexAttribArray(tex0Loc);
+
+    // the batch may have bound other textures since FirstBegin()
+    glBindTexture(GL_TEXTURE_2D, m_nTexture);
 
     // Bind our pre-calculated array to GL_ELEMENT_ARRAY_BUFFER
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementArrayHandle);
@@ -259,14 +266,14 @@ void CGUIFontTTFGL::LastEnd()
     // Unbind GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  }
 
-  // Disable the attributes used by this shader
-  glDisableVertexAttribArray(posLoc);
-  glDisableVertexAttribArray(colLoc);
-  glDisableVertexAttribArray(tex0Loc);
+    // Disable the attributes used by this shader
+    glDisableVertexAttribArray(posLoc);
+    glDisableVertexAttribArray(colLoc);
+    glDisableVertexAttribArray(tex0Loc);
 
-  g_Windowing.DisableGUIShader();
+    g_Windowing.DisableGUIShader();
+  }
 #endif
 }
 
@@ -19,6 +19,7 @@
  */
 
 #include "GUIPanelContainer.h"
+#include "GUILargeTextureManager.h"
 #include "guiinfo/GUIInfoLabels.h"
 #include "input/Key.h"
 #include "utils/StringUtils.h"
@@ -51,7 +52,7 @@ void CGUIPanelContainer::Process(unsigned int currentTime, CDirtyRegionList &dir
   int offset = (int)(m_scroller.GetValue() / m_layout->Size(m_orientation));
 
   int cacheBefore, cacheAfter;
-  GetCacheOffsets(cacheBefore, cacheAfter);
+  GetPrefetchOffsets(cacheBefore, cacheAfter);
 
   // Free memory not used on screen
   if ((int)m_items.size() > m_itemsPerPage + cacheBefore + cacheAfter)
@@ -74,6 +75,7 @@ void CGUIPanelContainer::Process(unsigned int currentTime, CDirtyRegionList &dir
       CGUIListItemPtr item = m_items[current];
       bool focused = (current == GetOffset() * m_itemsPerRow + GetCursor()) && m_bHasFocus;
 
+      SetTextureDemand(current / m_itemsPerRow, offset);
       if (m_orientation == VERTICAL)
         ProcessItem(origin.x + col * m_layout->Size(HORIZONTAL), pos, item, focused, currentTime, dirtyregions);
       else
@@ -89,6 +91,7 @@ void CGUIPanelContainer::Process(unsigned int currentTime, CDirtyRegionList &dir
     }
     current++;
   }
+  g_largeTextureManager.SetDemand(CGUILargeTextureManager::DEMAND_VISIBLE);
 
   // when we are scrolling up, offset will become lower (integer division, see offset calc)
   // to have same behaviour when scrolling down, we need to set page control to offset+1
@@ -0,0 +1,268 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#if defined(HAS_GLES)
+#include "GUIQuadBatchGLES.h"
+#endif
+#include "Texture.h"
+#include "windowing/WindowingFactory.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if defined(HAS_GLES)
+
+// how many runs back a quad may be moved to join a run of the same state
+#define MAX_RUN_LOOKBACK   16
+// indices are 16 bit
+#define MAX_QUADS_PER_DRAW 16384
+
+bool CGUIQuadBatchGLES::SState::operator==(const SState &right) const
+{
+  return shader == right.shader &&
+         texture[0] == right.texture[0] &&
+         texture[1] == right.texture[1] &&
+         blend == right.blend &&
+         memcmp(color, right.color, sizeof(color)) == 0 &&
+         memcmp(project.m_pMatrix, right.project.m_pMatrix, sizeof(project.m_pMatrix)) == 0 &&
+         memcmp(modview.m_pMatrix, right.modview.m_pMatrix, sizeof(modview.m_pMatrix)) == 0;
+}
+
+CGUIQuadBatchGLES& CGUIQuadBatchGLES::GetInstance()
+{
+  static CGUIQuadBatchGLES s_batch;
+  return s_batch;
+}
+
+CGUIQuadBatchGLES::CGUIQuadBatchGLES()
+{
+  m_numRuns = 0;
+  m_match = -1;
+  m_flushing = false;
+  m_state.shader = SM_DEFAULT;
+  m_state.texture[0] = m_state.texture[1] = 0;
+  m_state.blend = BLEND_NONE;
+  memset(m_state.color, 0, sizeof(m_state.color));
+}
+
+void CGUIQuadBatchGLES::SetState(ESHADERMETHOD shader, CBaseTexture *texture, CBaseTexture *diffuse, uint32_t color, BLEND blend)
+{
+  // the GL texture objects outlive the textures until the end of the frame,
+  // see CGUITextureManager::ReleaseHwTexture()
+  m_state.shader = shader;
+  m_state.texture[0] = texture ? static_cast<CTexture*>(texture)->GetTextureObject() : 0;
+  m_state.texture[1] = diffuse ? static_cast<CTexture*>(diffuse)->GetTextureObject() : 0;
+  m_state.blend = blend;
+  m_state.color[0] = (GLubyte)GET_R(color);
+  m_state.color[1] = (GLubyte)GET_G(color);
+  m_state.color[2] = (GLubyte)GET_B(color);
+  m_state.color[3] = (GLubyte)GET_A(color);
+  m_state.project = glMatrixProject.Get();
+  m_state.modview = glMatrixModview.Get();
+  FindRun();
+}
+
+void CGUIQuadBatchGLES::SetState(ESHADERMETHOD shader, GLuint texture, BLEND blend)
+{
+  m_state.shader = shader;
+  m_state.texture[0] = texture;
+  m_state.texture[1] = 0;
+  m_state.blend = blend;
+  memset(m_state.color, 0xff, sizeof(m_state.color));
+  m_state.project = glMatrixProject.Get();
+  m_state.modview = glMatrixModview.Get();
+  FindRun();
+}
+
+void CGUIQuadBatchGLES::FindRun()
+{
+  m_match = -1;
+  for (size_t i = m_numRuns; i > 0 && m_numRuns - i < MAX_RUN_LOOKBACK; i--)
+  {
+    const SState &state = m_runs[i - 1].state;
+    if (state == m_state)
+    {
+      m_match = (int)i - 1;
+      break;
+    }
+    // positions of quads drawn with other matrices can't be compared
+    if (memcmp(state.project.m_pMatrix, m_state.project.m_pMatrix, sizeof(m_state.project.m_pMatrix)) != 0 ||
+        memcmp(state.modview.m_pMatrix, m_state.modview.m_pMatrix, sizeof(m_state.modview.m_pMatrix)) != 0)
+      break;
+  }
+}
+
+void CGUIQuadBatchGLES::AddQuad(const SQuadVertex vertices[4])
+{
+  CRect bounds(vertices[0].x, vertices[0].y, vertices[0].x, vertices[0].y);
+  for (int i = 1; i < 4; i++)
+  {
+    bounds.x1 = std::min(bounds.x1, vertices[i].x);
+    bounds.y1 = std::min(bounds.y1, vertices[i].y);
+    bounds.x2 = std::max(bounds.x2, vertices[i].x);
+    bounds.y2 = std::max(bounds.y2, vertices[i].y);
+  }
+
+  // the quad may only join an earlier run if nothing queued after that run is below it
+  if (m_match >= 0)
+  {
+    for (size_t i = m_match + 1; i < m_numRuns; i++)
+    {
+      CRect overlap(m_runs[i].bounds);
+      if (!overlap.Intersect(bounds).IsEmpty())
+      {
+        m_match = -1;
+        break;
+      }
+    }
+  }
+
+  if (m_match < 0)
+  {
+    if (m_numRuns == m_runs.size())
+      m_runs.push_back(SRun());
+    SRun &run = m_runs[m_numRuns];
+    run.state = m_state;
+    run.bounds = bounds;
+    run.vertices.clear();
+    m_match = (int)m_numRuns++;
+  }
+
+  SRun &run = m_runs[m_match];
+  run.bounds.Union(bounds);
+  run.vertices.insert(run.vertices.end(), vertices, vertices + 4);
+}
+
+void CGUIQuadBatchGLES::Flush()
+{
+  if (m_flushing || m_numRuns == 0)
+    return;
+
+  m_flushing = true;
+
+  size_t maxQuads = 0;
+  for (size_t i = 0; i < m_numRuns; i++)
+    maxQuads = std::max(maxQuads, m_runs[i].vertices.size() / 4);
+  maxQuads = std::min(maxQuads, (size_t)MAX_QUADS_PER_DRAW);
+  for (size_t quad = m_indices.size() / 6; quad < maxQuads; quad++)
+  {
+    GLushort first = (GLushort)(quad * 4);
+    GLushort indices[6] = { first, (GLushort)(first + 1), (GLushort)(first + 2),
+                            (GLushort)(first + 2), (GLushort)(first + 3), first };
+    m_indices.insert(m_indices.end(), indices, indices + 6);
+  }
+
+  for (size_t i = 0; i < m_numRuns; i++)
+    DrawRun(m_runs[i]);
+
+  m_numRuns = 0;
+  m_match = -1;
+
+  glActiveTexture(GL_TEXTURE0);
+  glEnable(GL_BLEND);
+
+  m_flushing = false;
+}
+
+void CGUIQuadBatchGLES::DrawRun(const SRun &run)
+{
+  const SState &state = run.state;
+
+  // the quads are drawn with the matrices they were queued with
+  glMatrixProject.Push();
+  glMatrixModview.Push();
+  glMatrixProject.Get() = state.project;
+  glMatrixModview.Get() = state.modview;
+  g_Windowing.EnableGUIShader(state.shader);
+
+  if (state.texture[1])
+  {
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, state.texture[1]);
+  }
+  glActiveTexture(GL_TEXTURE0);
+  if (state.texture[0])
+    glBindTexture(GL_TEXTURE_2D, state.texture[0]);
+
+  switch (state.blend)
+  {
+  case BLEND_ALPHA:
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_BLEND);
+    break;
+  case BLEND_ALPHA_SEPARATE:
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
+    glEnable(GL_BLEND);
+    break;
+  default:
+    glDisable(GL_BLEND);
+    break;
+  }
+
+  GLint posLoc = g_Windowing.GUIShaderGetPos();
+  GLint colLoc = state.shader == SM_FONTS ? g_Windowing.GUIShaderGetCol() : -1;
+  GLint tex0Loc = state.texture[0] ? g_Windowing.GUIShaderGetCoord0() : -1;
+  GLint tex1Loc = state.texture[1] ? g_Windowing.GUIShaderGetCoord1() : -1;
+  GLint uniColLoc = g_Windowing.GUIShaderGetUniCol();
+
+  if (uniColLoc >= 0)
+    glUniform4f(uniColLoc, state.color[0] / 255.0f, state.color[1] / 255.0f, state.color[2] / 255.0f, state.color[3] / 255.0f);
+
+  glEnableVertexAttribArray(posLoc);
+  if (colLoc >= 0)
+    glEnableVertexAttribArray(colLoc);
+  if (tex0Loc >= 0)
+    glEnableVertexAttribArray(tex0Loc);
+  if (tex1Loc >= 0)
+    glEnableVertexAttribArray(tex1Loc);
+
+  size_t quads = run.vertices.size() / 4;
+  for (size_t quad = 0; quad < quads; quad += MAX_QUADS_PER_DRAW)
+  {
+    size_t count = std::min(quads - quad, (size_t)MAX_QUADS_PER_DRAW);
+    const char *vertices = (const char*)&run.vertices[quad * 4];
+
+    glVertexAttribPointer(posLoc, 3, GL_FLOAT, GL_FALSE, sizeof(SQuadVertex), vertices + offsetof(SQuadVertex, x));
+    if (colLoc >= 0)
+      glVertexAttribPointer(colLoc, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SQuadVertex), vertices + offsetof(SQuadVertex, r));
+    if (tex0Loc >= 0)
+      glVertexAttribPointer(tex0Loc, 2, GL_FLOAT, GL_FALSE, sizeof(SQuadVertex), vertices + offsetof(SQuadVertex, u1));
+    if (tex1Loc >= 0)
+      glVertexAttribPointer(tex1Loc, 2, GL_FLOAT, GL_FALSE, sizeof(SQuadVertex), vertices + offsetof(SQuadVertex, u2));
+
+    glDrawElements(GL_TRIANGLES, count * 6, GL_UNSIGNED_SHORT, &m_indices[0]);
+  }
+
+  glDisableVertexAttribArray(posLoc);
+  if (colLoc >= 0)
+    glDisableVertexAttribArray(colLoc);
+  if (tex0Loc >= 0)
+    glDisableVertexAttribArray(tex0Loc);
+  if (tex1Loc >= 0)
+    glDisableVertexAttribArray(tex1Loc);
+
+  g_Windowing.DisableGUIShader();
+  glMatrixModview.Pop();
+  glMatrixProject.Pop();
+}
+
+#endif
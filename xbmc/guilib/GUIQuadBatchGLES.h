@@ -0,0 +1,127 @@
+/*!
+\file GUIQuadBatchGLES.h
+\brief
+*/
+
+#pragma once
+
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+
+#if defined(HAS_GLES)
+
+#include "system_gl.h"
+#include "Geometry.h"
+#include "MatrixGLES.h"
+#include "rendering/gles/RenderSystemGLES.h"
+
+#include <stdint.h>
+#include <vector>
+
+class CBaseTexture;
+
+struct SQuadVertex
+{
+  float x, y, z;
+  unsigned char r, g, b, a; // only used by shaders with vertex colors (fonts)
+  float u1, v1;
+  float u2, v2;
+};
+
+/*!
+ \ingroup textures
+ \brief Collects the quads drawn by the GUI during a frame and draws them with as few draw calls as possible.
+
+ Quads sharing shader, textures, color, blending and matrices are drawn together. A quad may join
+ an earlier run of the same state unless it overlaps a quad queued after that run, so the layering
+ of the GUI is kept. Anything that changes GL state outside of the batch (scissors, viewport, other
+ shaders) has to Flush() first, CRenderSystemGLES does so for the state it manages.
+ */
+class CGUIQuadBatchGLES
+{
+public:
+  enum BLEND
+  {
+    BLEND_NONE = 0,
+    BLEND_ALPHA,         ///< glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+    BLEND_ALPHA_SEPARATE ///< as BLEND_ALPHA, keeping the destination alpha for the GUI
+  };
+
+  static CGUIQuadBatchGLES& GetInstance();
+
+  /*! \brief Set the state of the quads added next
+   \param shader GUI shader to draw with
+   \param texture texture of unit 0, NULL for untextured quads
+   \param diffuse texture of unit 1, NULL if the shader doesn't use one
+   \param color ARGB color passed as uniform to the shader
+   \param blend blending of the quads
+   */
+  void SetState(ESHADERMETHOD shader, CBaseTexture *texture, CBaseTexture *diffuse, uint32_t color, BLEND blend);
+
+  /*! \brief Set the state of the quads added next, for textures not managed by CBaseTexture
+   */
+  void SetState(ESHADERMETHOD shader, GLuint texture, BLEND blend);
+
+  /*! \brief Queue a quad, vertices are in clockwise order starting at the top left
+   */
+  void AddQuad(const SQuadVertex vertices[4]);
+
+  /*! \brief Draw all queued quads
+   */
+  void Flush();
+
+private:
+  CGUIQuadBatchGLES();
+  CGUIQuadBatchGLES(const CGUIQuadBatchGLES&);
+  CGUIQuadBatchGLES const& operator=(CGUIQuadBatchGLES const&);
+
+  struct SState
+  {
+    ESHADERMETHOD shader;
+    GLuint texture[2];
+    BLEND blend;
+    GLubyte color[4];
+    CMatrixGL project;
+    CMatrixGL modview;
+
+    bool operator==(const SState &right) const;
+  };
+
+  struct SRun
+  {
+    SState state;
+    CRect bounds; ///< of all quads of the run, to find out whether later quads may join it
+    std::vector<SQuadVertex> vertices;
+  };
+
+  void FindRun();
+  void DrawRun(const SRun &run);
+
+  std::vector<SRun> m_runs; ///< runs are reused between frames to keep their memory
+  size_t m_numRuns;
+  SState m_state;
+  int m_match;              ///< latest run of the current state, -1 if quads start a new run
+  std::vector<GLushort> m_indices;
+  bool m_flushing;
+};
+
+#endif
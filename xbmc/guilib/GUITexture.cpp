@@ -125,7 +125,7 @@ bool CGUITextureBase::AllocateOnDemand()
 {
   if (m_visible)
   { // visible, so make sure we're allocated
-    if (!IsAllocated() || (m_isAllocated == LARGE && !m_texture.size()))
+    if (!IsAllocated() || (m_isAllocated == LARGE && !m_texture.size()) || m_isAllocated == LARGE_PREVIEW)
       return AllocResources();
   }
   else
@@ -246,6 +246,7 @@ void CGUITextureBase::Render(float left, float top, float right, float bottom, f
 
   int orientation = GetOrientation();
   OrientateTexture(texture, u3, v3, orientation);
+  texture += m_texCoordsOffset;
 
   if (m_diffuse.size())
   {
@@ -255,6 +256,7 @@ void CGUITextureBase::Render(float left, float top, float right, float bottom, f
     diffuse.y1 *= m_diffuseScaleV / v3; diffuse.y2 *= m_diffuseScaleV / v3;
     diffuse += m_diffuseOffset;
     OrientateTexture(diffuse, m_diffuseU, m_diffuseV, m_info.orientation);
+    diffuse += m_diffuseAtlasOffset;
   }
 
   float x[4], y[4], z[4];
@@ -285,7 +287,7 @@ bool CGUITextureBase::AllocResources()
   if (m_info.filename.empty())
     return false;
 
-  if (m_texture.size())
+  if (m_texture.size() && m_isAllocated != LARGE_PREVIEW)
     return false; // already have our texture
 
   // reset our animstate
@@ -309,13 +311,17 @@ bool CGUITextureBase::AllocResources()
     if (m_isAllocated != NORMAL)
     { // use our large image background loader
       CTextureArray texture;
-      if (g_largeTextureManager.GetImage(m_info.filename, texture, !IsAllocated(), m_use_cache))
+      bool preview = false;
+      if (g_largeTextureManager.GetImage(m_info.filename, texture, !IsAllocated(), m_use_cache, &preview))
       {
-        m_isAllocated = LARGE;
+        m_isAllocated = preview ? LARGE_PREVIEW : LARGE;
 
         if (!texture.size()) // not ready as yet
           return false;
 
+        if (m_texture.size() && m_texture.m_textures[0] == texture.m_textures[0])
+          return false; // still waiting for the full quality image
+
         m_texture = texture;
 
         changed = true;
@@ -340,7 +346,7 @@ bool CGUITextureBase::AllocResources()
   m_frameHeight = (float)m_texture.m_height;
 
   // load the diffuse texture (if necessary)
-  if (!m_info.diffuse.empty())
+  if (!m_info.diffuse.empty() && !m_diffuse.size())
   {
     m_diffuse = g_TextureManager.Load(m_info.diffuse);
   }
@@ -360,6 +366,10 @@ bool CGUITextureBase::CalculateSize()
 
   m_texCoordsScaleU = 1.0f / m_texture.m_texWidth;
   m_texCoordsScaleV = 1.0f / m_texture.m_texHeight;
+  if (m_texture.m_texCoordsArePixels)
+    m_texCoordsOffset = CPoint((float)m_texture.m_atlasX, (float)m_texture.m_atlasY);
+  else
+    m_texCoordsOffset = CPoint(m_texture.m_atlasX * m_texCoordsScaleU, m_texture.m_atlasY * m_texCoordsScaleV);
 
   if (m_width == 0)
     m_width = m_frameWidth;
@@ -419,11 +429,13 @@ bool CGUITextureBase::CalculateSize()
     {
       m_diffuseU = float(m_diffuse.m_width);
       m_diffuseV = float(m_diffuse.m_height);
+      m_diffuseAtlasOffset = CPoint(float(m_diffuse.m_atlasX), float(m_diffuse.m_atlasY));
     }
     else
     {
       m_diffuseU = float(m_diffuse.m_width) / float(m_diffuse.m_texWidth);
       m_diffuseV = float(m_diffuse.m_height) / float(m_diffuse.m_texHeight);
+      m_diffuseAtlasOffset = CPoint(float(m_diffuse.m_atlasX) / float(m_diffuse.m_texWidth), float(m_diffuse.m_atlasY) / float(m_diffuse.m_texHeight));
     }
 
     if (m_aspect.scaleDiffuse)
@@ -450,7 +462,7 @@ bool CGUITextureBase::CalculateSize()
 
 void CGUITextureBase::FreeResources(bool immediately /* = false */)
 {
-  if (m_isAllocated == LARGE || m_isAllocated == LARGE_FAILED)
+  if (m_isAllocated == LARGE || m_isAllocated == LARGE_PREVIEW || m_isAllocated == LARGE_FAILED)
     g_largeTextureManager.ReleaseImage(m_info.filename, immediately || (m_isAllocated == LARGE_FAILED));
   else if (m_isAllocated == NORMAL && m_texture.size())
     g_TextureManager.ReleaseTexture(m_info.filename, immediately);
@@ -465,6 +477,7 @@ void CGUITextureBase::FreeResources(bool immediately /* = false */)
 
   m_texCoordsScaleU = 1.0f;
   m_texCoordsScaleV = 1.0f;
+  m_texCoordsOffset = CPoint(0, 0);
 
   // call our implementation
   Free();
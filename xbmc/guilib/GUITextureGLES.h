@@ -29,17 +29,7 @@
  */
 
 #include "GUITexture.h"
-
-#include "system_gl.h"
-#include <vector>
-
-struct PackedVertex
-{
-  float x, y, z;
-  float u1, v1;
-  float u2, v2;
-};
-typedef std::vector<PackedVertex> PackedVertices;
+#include "GUIQuadBatchGLES.h"
 
 class CGUITextureGLES : public CGUITextureBase
 {
@@ -50,11 +40,6 @@ protected:
   void Begin(color_t color);
   void Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation);
   void End();
-
-  GLubyte m_col[4];
-
-  PackedVertices m_packedVertices;
-  std::vector<GLushort> m_idx;
 };
 
 #endif
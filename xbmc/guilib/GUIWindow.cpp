@@ -21,10 +21,12 @@
 #include "system.h"
 #include "GUIWindow.h"
 #include "GUIWindowManager.h"
+#include "GUIXMLCache.h"
 #include "input/Key.h"
 #include "GUIControlFactory.h"
 #include "GUIControlGroup.h"
 #include "GUIControlProfiler.h"
+#include "TextureManager.h"
 
 #include "addons/Skin.h"
 #include "GUIInfoManager.h"
@@ -45,6 +47,22 @@
 
 using namespace KODI::MESSAGING;
 
+// collect the static textures of the controls, <texture>, <texturefocus>, <bordertexture> etc.
+static void GetTextures(const TiXmlElement *element, std::vector<std::string> &textures)
+{
+  for (const TiXmlElement *child = element->FirstChildElement(); child; child = child->NextSiblingElement())
+  {
+    if (strstr(child->Value(), "texture") != NULL)
+    {
+      const char *texture = child->GetText();
+      if (texture && !strchr(texture, '$'))
+        textures.push_back(texture);
+    }
+    else
+      GetTextures(child, textures);
+  }
+}
+
 bool CGUIWindow::icompare::operator()(const std::string &s1, const std::string &s2) const
 {
   return StringUtils::CompareNoCase(s1, s2) < 0;
@@ -134,6 +152,15 @@ bool CGUIWindow::Load(const std::string& strFileName, bool bContainsPath)
 
 bool CGUIWindow::LoadXML(const std::string &strPath, const std::string &strLowerPath)
 {
+  // use the resolved window from the cache if neither the skin nor the conditions changed
+  TiXmlElement *resolved = CGUIXMLCache::GetInstance().Get(strPath, m_xmlIncludeConditions);
+  if (resolved)
+  {
+    CLog::Log(LOGDEBUG, "Using cached resolved xml for %s", strPath.c_str());
+    g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
+    return LoadResolved(resolved);
+  }
+
   // load window xml if we don't have it stored yet
   if (!m_windowXMLRootElement)
   {
@@ -151,18 +178,30 @@ bool CGUIWindow::LoadXML(const std::string &strPath, const std::string &strLower
   else
     CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
 
-  return Load(m_windowXMLRootElement);
+  resolved = Resolve(m_windowXMLRootElement);
+  if (!resolved)
+    return false;
+  CGUIXMLCache::GetInstance().Set(strPath, resolved, m_xmlIncludeConditions);
+  return LoadResolved(resolved);
 }
 
 bool CGUIWindow::Load(TiXmlElement* pRootElement)
 {
-  if (!pRootElement)
+  TiXmlElement *resolved = Resolve(pRootElement);
+  if (!resolved)
     return false;
+  return LoadResolved(resolved);
+}
+
+TiXmlElement *CGUIWindow::Resolve(TiXmlElement *pRootElement)
+{
+  if (!pRootElement)
+    return NULL;
   
   if (strcmpi(pRootElement->Value(), "window"))
   {
     CLog::Log(LOGERROR, "file : XML file doesnt contain <window>");
-    return false;
+    return NULL;
   }
 
   // we must create copy of root element as we will manipulate it when resolving includes
@@ -175,6 +214,16 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
 
   // Resolve any includes that may be present and save conditions used to do it
   g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
+  return pRootElement;
+}
+
+bool CGUIWindow::LoadResolved(TiXmlElement *pRootElement)
+{
+  // unpack the bundled textures in the background while the controls are created
+  std::vector<std::string> textures;
+  GetTextures(pRootElement, textures);
+  g_TextureManager.PrefetchTextures(textures);
+
   // now load in the skin file
   SetDefaults();
 
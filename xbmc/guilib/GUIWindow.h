@@ -203,6 +203,8 @@ protected:
   virtual EVENT_RESULT OnMouseEvent(const CPoint &point, const CMouseEvent &event);
   virtual bool LoadXML(const std::string& strPath, const std::string &strLowerPath);  ///< Loads from the given file
   bool Load(TiXmlElement *pRootElement);                 ///< Loads from the given XML root element
+  TiXmlElement *Resolve(TiXmlElement *pRootElement);     ///< Returns a copy of the root element with the includes resolved
+  bool LoadResolved(TiXmlElement *pRootElement);         ///< Loads from a resolved root element and deletes it
   /*! \brief Check if XML file needs (re)loading
    XML file has to be (re)loaded when window is not loaded or include conditions values were changed
    */
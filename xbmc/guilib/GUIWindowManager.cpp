@@ -32,6 +32,7 @@
 #include "settings/Settings.h"
 #include "addons/Skin.h"
 #include "GUITexture.h"
+#include "windowing/WindowingFactory.h"
 #include "utils/Variant.h"
 #include "input/Key.h"
 #include "utils/StringUtils.h"
@@ -1003,6 +1004,11 @@ void CGUIWindowManager::MarkDirty(const CRect& rect)
   m_tracker.MarkDirtyRegion(rect);
 }
 
+CDirtyRegionList CGUIWindowManager::GetDirty()
+{
+  return m_tracker.GetDirtyRegions(g_Windowing.GetBufferAge());
+}
+
 void CGUIWindowManager::RenderPass() const
 {
   CGUIWindow* pWindow = GetWindow(GetActiveWindow());
@@ -1046,7 +1052,7 @@ bool CGUIWindowManager::Render()
   assert(g_application.IsCurrentThread());
   CSingleLock lock(g_graphicsContext);
 
-  CDirtyRegionList dirtyRegions = m_tracker.GetDirtyRegions();
+  CDirtyRegionList dirtyRegions = GetDirty();
 
   bool hasRendered = false;
   // If we visualize the regions we will always render the entire viewport
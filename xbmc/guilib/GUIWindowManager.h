@@ -101,7 +101,7 @@ public:
 
   /*! \brief Get the current dirty region
    */
-  CDirtyRegionList GetDirty() { return m_tracker.GetDirtyRegions(); }
+  CDirtyRegionList GetDirty();
 
   /*! \brief Rendering of the current window and any dialogs
    Render is called every frame to draw the current window and any dialogs.
@@ -0,0 +1,422 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIXMLCache.h"
+#include "GUIInfoManager.h"
+#include "FileItem.h"
+#include "addons/Skin.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "utils/Archive.h"
+#include "utils/Crc32.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/SystemInfo.h"
+#include "utils/URIUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+using namespace XFILE;
+
+#define XMLCACHE_MAGIC     "XMLCACHE"
+#define XMLCACHE_VERSION   1
+// bump when the windows are resolved or parsed differently, the stored ones are resolved again
+#define XMLCACHE_RESOLVE_VERSION 1
+#define XMLCACHE_END       "END"
+#define XMLCACHE_EXTENSION ".bin"
+
+// resolved windows kept in memory, the others are read from their files again
+#define MAX_CACHED_WINDOWS 24
+// deeper trees are taken as a broken file
+#define MAX_DEPTH          256
+
+class CGUIXMLCacheJob : public CJob
+{
+public:
+  // read the stored windows of a skin
+  CGUIXMLCacheJob(const std::string &cachePath, const std::string &skinStamp)
+    : m_cachePath(cachePath), m_skinStamp(skinStamp), m_root(NULL)
+  {
+  }
+
+  // store a window
+  CGUIXMLCacheJob(const std::string &cacheFile, const std::string &file, const CGUIXMLCache::CEntry &entry)
+    : m_cacheFile(cacheFile), m_file(file), m_stamp(entry.stamp), m_conditions(entry.conditions),
+      m_root((TiXmlElement*)entry.root->Clone())
+  {
+  }
+
+  virtual ~CGUIXMLCacheJob()
+  {
+    delete m_root;
+  }
+
+  virtual const char *GetType() const { return "skinxmlcache"; }
+
+  virtual bool DoWork()
+  {
+    if (m_root)
+      return Store();
+
+    CFileItemList items;
+    if (!CDirectory::GetDirectory(m_cachePath, items, XMLCACHE_EXTENSION, DIR_FLAG_NO_FILE_DIRS))
+      return false;
+
+    // the most recently stored windows are the most likely to be opened again
+    items.Sort(SortByDate, SortOrderDescending);
+    CGUIXMLCache &cache = CGUIXMLCache::GetInstance();
+    for (int i = 0; i < items.Size() && i < MAX_CACHED_WINDOWS; i++)
+    {
+      std::string file;
+      CGUIXMLCache::CEntry entry;
+      if (!cache.Read(items[i]->GetPath(), file, entry))
+        continue;
+
+      CSingleLock lock(cache.m_section);
+      if (cache.m_skinStamp != m_skinStamp || cache.m_entries.find(file) != cache.m_entries.end())
+      {
+        delete entry.root;
+        continue;
+      }
+      cache.Add(file, entry);
+    }
+    return true;
+  }
+
+private:
+  bool Store()
+  {
+    std::string tempFile = m_cacheFile + ".tmp";
+    {
+      CFile file;
+      if (!file.OpenForWrite(tempFile, true))
+      {
+        CLog::Log(LOGDEBUG, "%s - unable to write %s", __FUNCTION__, tempFile.c_str());
+        return false;
+      }
+      CArchive ar(&file, CArchive::store);
+      ar << std::string(XMLCACHE_MAGIC) << (int)XMLCACHE_VERSION;
+      ar << m_file << m_stamp;
+      ar << (int)m_conditions.size();
+      for (CGUIXMLCache::Conditions::const_iterator i = m_conditions.begin(); i != m_conditions.end(); ++i)
+        ar << i->first << i->second;
+      CGUIXMLCache::Serialize(ar, m_root);
+      ar << std::string(XMLCACHE_END);
+      ar.Close();
+    }
+    CFile::Delete(m_cacheFile);
+    return CFile::Rename(tempFile, m_cacheFile);
+  }
+
+  std::string m_cachePath;
+  std::string m_skinStamp;
+  std::string m_cacheFile;
+  std::string m_file;
+  std::string m_stamp;
+  CGUIXMLCache::Conditions m_conditions;
+  TiXmlElement *m_root;
+};
+
+CGUIXMLCache& CGUIXMLCache::GetInstance()
+{
+  static CGUIXMLCache s_cache;
+  return s_cache;
+}
+
+CGUIXMLCache::CGUIXMLCache()
+{
+  m_useCount = 0;
+}
+
+CGUIXMLCache::~CGUIXMLCache()
+{
+  Clear();
+}
+
+void CGUIXMLCache::Load()
+{
+  Clear();
+  if (!g_SkinInfo)
+    return;
+
+  // the stamp of the skin covers everything a window is resolved with, apart from the conditions,
+  // including the build of Kodi that resolved it
+  std::string stamp = StringUtils::Format("%d|%s|%s|%s-%s", XMLCACHE_RESOLVE_VERSION,
+                                          CSysInfo::GetVersion().c_str(), CSysInfo::GetBuildDate().c_str(),
+                                          g_SkinInfo->ID().c_str(), g_SkinInfo->Version().asString().c_str());
+  const std::vector<std::string> &includeFiles = g_SkinInfo->GetIncludeFiles();
+  for (std::vector<std::string>::const_iterator i = includeFiles.begin(); i != includeFiles.end(); ++i)
+    stamp += "|" + GetFileStamp(*i);
+
+  std::string cachePath = URIUtils::AddFileToFolder("special://temp/skincache/", g_SkinInfo->ID());
+  URIUtils::AddSlashAtEnd(cachePath);
+  if (!CDirectory::Exists(cachePath))
+  {
+    CDirectory::Create("special://temp/skincache/");
+    CDirectory::Create(cachePath);
+  }
+
+  {
+    CSingleLock lock(m_section);
+    m_skinStamp = stamp;
+    m_cachePath = cachePath;
+  }
+
+  CJobManager::GetInstance().AddJob(new CGUIXMLCacheJob(cachePath, stamp), NULL, CJob::PRIORITY_LOW);
+}
+
+void CGUIXMLCache::Clear()
+{
+  CSingleLock lock(m_section);
+  for (std::map<std::string, CEntry>::iterator i = m_entries.begin(); i != m_entries.end(); ++i)
+    delete i->second.root;
+  m_entries.clear();
+  m_skinStamp.clear();
+  m_cachePath.clear();
+}
+
+TiXmlElement *CGUIXMLCache::Get(const std::string &file, std::map<INFO::InfoPtr, bool> &xmlIncludeConditions)
+{
+  std::string fileStamp = GetFileStamp(file);
+
+  CSingleLock lock(m_section);
+  if (m_skinStamp.empty() || fileStamp.empty())
+    return NULL;
+
+  std::map<std::string, CEntry>::iterator it = m_entries.find(file);
+  if (it == m_entries.end())
+  {
+    std::string cacheFile = GetCacheFile(file);
+    lock.Leave();
+    std::string cachedFile;
+    CEntry entry;
+    if (!CFile::Exists(cacheFile) || !Read(cacheFile, cachedFile, entry))
+      return NULL;
+    lock.Enter();
+    if (cachedFile != file)
+    {
+      delete entry.root;
+      return NULL;
+    }
+    Add(file, entry);
+    it = m_entries.find(file);
+  }
+
+  CEntry &entry = it->second;
+  if (entry.stamp != m_skinStamp + "|" + fileStamp)
+    return NULL;
+
+  // the includes resolve the same way as long as their conditions have the same values
+  std::map<INFO::InfoPtr, bool> conditions;
+  for (Conditions::const_iterator i = entry.conditions.begin(); i != entry.conditions.end(); ++i)
+  {
+    INFO::InfoPtr condition = g_infoManager.Register(i->first);
+    if (!condition || condition->Get() != i->second)
+      return NULL;
+    conditions[condition] = i->second;
+  }
+
+  entry.lastUsed = ++m_useCount;
+  xmlIncludeConditions.swap(conditions);
+  return (TiXmlElement*)entry.root->Clone();
+}
+
+void CGUIXMLCache::Set(const std::string &file, const TiXmlElement *resolved, const std::map<INFO::InfoPtr, bool> &xmlIncludeConditions)
+{
+  if (!resolved)
+    return;
+
+  std::string fileStamp = GetFileStamp(file);
+
+  CSingleLock lock(m_section);
+  if (m_skinStamp.empty() || fileStamp.empty())
+    return;
+
+  CEntry entry;
+  entry.stamp = m_skinStamp + "|" + fileStamp;
+  for (std::map<INFO::InfoPtr, bool>::const_iterator i = xmlIncludeConditions.begin(); i != xmlIncludeConditions.end(); ++i)
+    entry.conditions.push_back(std::make_pair(i->first->GetExpression(), i->second));
+  entry.root = (TiXmlElement*)resolved->Clone();
+
+  CJobManager::GetInstance().AddJob(new CGUIXMLCacheJob(GetCacheFile(file), file, entry), NULL, CJob::PRIORITY_LOW);
+  Add(file, entry);
+}
+
+std::string CGUIXMLCache::GetCacheFile(const std::string &file) const
+{
+  Crc32 crc;
+  crc.ComputeFromLowerCase(file);
+  return URIUtils::AddFileToFolder(m_cachePath, StringUtils::Format("%08x%s", (unsigned int)crc, XMLCACHE_EXTENSION));
+}
+
+std::string CGUIXMLCache::GetFileStamp(const std::string &file) const
+{
+  struct __stat64 buffer;
+  if (CFile::Stat(file, &buffer) != 0)
+    return "";
+  return StringUtils::Format("%s:%" PRId64 ":%" PRId64, file.c_str(), (int64_t)buffer.st_size, (int64_t)buffer.st_mtime);
+}
+
+bool CGUIXMLCache::Read(const std::string &cacheFile, std::string &file, CEntry &entry) const
+{
+  CFile stream;
+  if (!stream.Open(cacheFile))
+    return false;
+
+  CArchive ar(&stream, CArchive::load);
+  std::string magic;
+  int version = 0;
+  ar >> magic >> version;
+  if (magic != XMLCACHE_MAGIC || version != XMLCACHE_VERSION)
+    return false;
+
+  int conditions = 0;
+  ar >> file >> entry.stamp >> conditions;
+  for (int i = 0; i < conditions; i++)
+  {
+    std::pair<std::string, bool> condition;
+    ar >> condition.first >> condition.second;
+    entry.conditions.push_back(condition);
+  }
+
+  entry.root = Deserialize(ar, 0);
+  std::string end;
+  ar >> end;
+  if (!entry.root || end != XMLCACHE_END)
+  {
+    CLog::Log(LOGDEBUG, "%s - %s is broken", __FUNCTION__, cacheFile.c_str());
+    delete entry.root;
+    entry.root = NULL;
+    return false;
+  }
+  return true;
+}
+
+void CGUIXMLCache::Add(const std::string &file, CEntry &entry)
+{
+  std::map<std::string, CEntry>::iterator it = m_entries.find(file);
+  if (it != m_entries.end())
+  {
+    delete it->second.root;
+    m_entries.erase(it);
+  }
+
+  // drop the window that wasn't used for the longest time
+  if (m_entries.size() >= MAX_CACHED_WINDOWS)
+  {
+    std::map<std::string, CEntry>::iterator oldest = m_entries.begin();
+    for (std::map<std::string, CEntry>::iterator i = m_entries.begin(); i != m_entries.end(); ++i)
+    {
+      if (i->second.lastUsed < oldest->second.lastUsed)
+        oldest = i;
+    }
+    delete oldest->second.root;
+    m_entries.erase(oldest);
+  }
+
+  entry.lastUsed = ++m_useCount;
+  m_entries[file] = entry;
+  entry.root = NULL;
+}
+
+void CGUIXMLCache::Serialize(CArchive &ar, const TiXmlElement *element)
+{
+  ar << element->ValueStr();
+
+  int attributes = 0;
+  for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+    attributes++;
+  ar << attributes;
+  for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+    ar << std::string(attribute->Name()) << std::string(attribute->Value());
+
+  // comments and other nodes don't matter to the controls
+  int children = 0;
+  for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+  {
+    if (child->ToElement() || child->ToText())
+      children++;
+  }
+  ar << children;
+  for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+  {
+    if (child->ToElement())
+    {
+      ar << 'e';
+      Serialize(ar, child->ToElement());
+    }
+    else if (child->ToText())
+      ar << (child->ToText()->CDATA() ? 'c' : 't') << child->ValueStr();
+  }
+}
+
+TiXmlElement *CGUIXMLCache::Deserialize(CArchive &ar, int depth)
+{
+  if (depth > MAX_DEPTH)
+    return NULL;
+
+  std::string value;
+  ar >> value;
+  if (value.empty())
+    return NULL;
+  TiXmlElement *element = new TiXmlElement(value);
+
+  int attributes = 0;
+  ar >> attributes;
+  for (int i = 0; i < attributes; i++)
+  {
+    std::string name;
+    ar >> name >> value;
+    element->SetAttribute(name, value);
+  }
+
+  int children = 0;
+  ar >> children;
+  for (int i = 0; i < children; i++)
+  {
+    char type = 0;
+    ar >> type;
+    if (type == 'e')
+    {
+      TiXmlElement *child = Deserialize(ar, depth + 1);
+      if (!child)
+      {
+        delete element;
+        return NULL;
+      }
+      element->LinkEndChild(child);
+    }
+    else if (type == 't' || type == 'c')
+    {
+      ar >> value;
+      TiXmlText *text = new TiXmlText(value);
+      text->SetCDATA(type == 'c');
+      element->LinkEndChild(text);
+    }
+    else
+    {
+      delete element;
+      return NULL;
+    }
+  }
+  return element;
+}
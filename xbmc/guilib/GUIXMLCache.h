@@ -0,0 +1,108 @@
+/*!
+\file GUIXMLCache.h
+\brief
+*/
+
+#pragma once
+
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "interfaces/info/InfoBool.h"
+#include "threads/CriticalSection.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class TiXmlElement;
+class CArchive;
+
+/*!
+ \ingroup windows
+ \brief Cache of skin windows with their includes resolved.
+
+ Resolving the includes, defaults, constants and expressions of a window is the bulk of the
+ work of loading it. The resolved XML is kept in memory and stored in a binary file in the
+ temp folder, together with the include conditions and the values they had. A window is taken
+ from the cache as long as the Kodi build, the skin, its include files, the window file and the
+ values of the conditions didn't change.
+ */
+class CGUIXMLCache
+{
+public:
+  static CGUIXMLCache& GetInstance();
+
+  /*! \brief Start using the cache of the current skin, the stored windows are read in the background
+   */
+  void Load();
+
+  /*! \brief Drop the windows in memory, called when the skin is unloaded
+   */
+  void Clear();
+
+  /*! \brief Get the resolved root element of a window file
+   \param file path of the window file
+   \param xmlIncludeConditions [out] conditions used to resolve the includes and their values
+   \return a copy of the resolved root element the caller has to delete, NULL if the window has to be resolved
+   */
+  TiXmlElement *Get(const std::string &file, std::map<INFO::InfoPtr, bool> &xmlIncludeConditions);
+
+  /*! \brief Store the resolved root element of a window file
+   \param file path of the window file
+   \param resolved root element after the includes were resolved
+   \param xmlIncludeConditions conditions used to resolve the includes and their values
+   */
+  void Set(const std::string &file, const TiXmlElement *resolved, const std::map<INFO::InfoPtr, bool> &xmlIncludeConditions);
+
+private:
+  CGUIXMLCache();
+  ~CGUIXMLCache();
+  CGUIXMLCache(const CGUIXMLCache&);
+  CGUIXMLCache const& operator=(CGUIXMLCache const&);
+
+  friend class CGUIXMLCacheJob;
+  friend class TestGUIXMLCache;
+
+  typedef std::vector<std::pair<std::string, bool> > Conditions;
+
+  struct CEntry
+  {
+    std::string stamp;      ///< Kodi build, skin, include files and window file the entry was resolved from
+    Conditions conditions;
+    TiXmlElement *root;
+    unsigned int lastUsed;
+  };
+
+  std::string GetCacheFile(const std::string &file) const;
+  std::string GetFileStamp(const std::string &file) const;
+  bool Read(const std::string &cacheFile, std::string &file, CEntry &entry) const;
+  void Add(const std::string &file, CEntry &entry);
+
+  static void Serialize(CArchive &ar, const TiXmlElement *element);
+  static TiXmlElement *Deserialize(CArchive &ar, int depth);
+
+  CCriticalSection m_section;
+  std::map<std::string, CEntry> m_entries;
+  std::string m_cachePath;
+  std::string m_skinStamp;
+  unsigned int m_useCount;
+};
@@ -307,6 +307,14 @@ void CGraphicContext::ResetScissors()
   g_Windowing.SetScissors(StereoCorrection(m_scissors));
 }
 
+bool CGraphicContext::IsInScissors(const CRect &rect) const
+{
+  if (rect.IsEmpty() || m_stereoView != RENDER_STEREO_VIEW_OFF)
+    return true;
+  CRect visible(m_scissors);
+  return !visible.Intersect(rect).IsEmpty();
+}
+
 const CRect CGraphicContext::GetViewWindow() const
 {
   if (m_bCalibrating || m_bFullScreenVideo)
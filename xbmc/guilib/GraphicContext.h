@@ -96,6 +96,10 @@ public:
   void SetScissors(const CRect &rect);
   void ResetScissors();
   const CRect &GetScissors() const { return m_scissors; }
+  /*! \brief Whether anything drawn inside a rect in screen coordinates can pass the scissors
+   Empty rects and the views of stereo modes are never culled, as the rect can't be trusted there.
+   */
+  bool IsInScissors(const CRect &rect) const;
 
   const CRect GetViewWindow() const;
   void SetViewWindow(float left, float top, float right, float bottom);
@@ -333,6 +333,8 @@ bool CJpegIO::Read(unsigned char* buffer, unsigned int bufSize, unsigned int min
     jpeg_calc_output_dimensions(&m_cinfo);
     m_width  = m_cinfo.output_width;
     m_height = m_cinfo.output_height;
+    m_originalWidth  = m_cinfo.image_width;
+    m_originalHeight = m_cinfo.image_height;
 
     if (m_cinfo.marker_list)
       m_orientation = GetExifOrientation(m_cinfo.marker_list->data, m_cinfo.marker_list->data_length);
@@ -340,6 +342,41 @@ bool CJpegIO::Read(unsigned char* buffer, unsigned int bufSize, unsigned int min
   }
 }
 
+bool CJpegIO::GetImageSize(unsigned char* buffer, unsigned int bufSize, unsigned int &width, unsigned int &height, unsigned int *orientation)
+{
+  struct jpeg_decompress_struct cinfo;
+  struct my_error_mgr jerr;
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = jpeg_error_exit;
+
+  if (buffer == NULL || !bufSize)
+    return false;
+
+  jpeg_create_decompress(&cinfo);
+#if JPEG_LIB_VERSION < 80
+  x_mem_src(&cinfo, buffer, bufSize);
+#else
+  jpeg_mem_src(&cinfo, buffer, bufSize);
+#endif
+
+  if (setjmp(jerr.setjmp_buffer))
+  {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+
+  // only the header is parsed
+  if (orientation)
+    jpeg_save_markers(&cinfo, JPEG_APP0 + 1, 0xFFFF);
+  jpeg_read_header(&cinfo, true);
+  width = cinfo.image_width;
+  height = cinfo.image_height;
+  if (orientation)
+    *orientation = cinfo.marker_list ? GetExifOrientation(cinfo.marker_list->data, cinfo.marker_list->data_length) : 0;
+  jpeg_destroy_decompress(&cinfo);
+  return true;
+}
+
 bool CJpegIO::Decode(unsigned char* const pixels, unsigned int width, unsigned int height, unsigned int pitch, unsigned int format)
 {
   unsigned char *dst = (unsigned char*)pixels;
@@ -357,9 +394,19 @@ bool CJpegIO::Decode(unsigned char* const pixels, unsigned int width, unsigned i
   }
   else
   {
+    // libjpeg-turbo converts to BGRA itself using its SIMD routines, so we can decode
+    // straight into the texture if the rows fit
+    bool direct = format == XB_FMT_RGB8;
+#if defined(JCS_EXTENSIONS)
+    if (format == XB_FMT_A8R8G8B8 && copyWidth == m_width)
+    {
+      m_cinfo.out_color_space = JCS_EXT_BGRA;
+      direct = true;
+    }
+#endif
     jpeg_start_decompress(&m_cinfo);
 
-    if (format == XB_FMT_RGB8)
+    if (direct)
     {
       while (m_cinfo.output_scanline < copyHeight)
       {
@@ -37,6 +37,7 @@ public:
   ~CJpegIO();
   bool           Open(const std::string& m_texturePath,  unsigned int minx=0, unsigned int miny=0, bool read=true);
   bool           Read(unsigned char* buffer, unsigned int bufSize, unsigned int minx, unsigned int miny);
+  static bool    GetImageSize(unsigned char* buffer, unsigned int bufSize, unsigned int &width, unsigned int &height, unsigned int *orientation = NULL);
   bool           CreateThumbnail(const std::string& sourceFile, const std::string& destFile, int minx, int miny, bool rotateExif);
   bool           CreateThumbnailFromMemory(unsigned char* buffer, unsigned int bufSize, const std::string& destFile, unsigned int minx, unsigned int miny);
   static bool           CreateThumbnailFromSurface(unsigned char* buffer, unsigned int width, unsigned int height, unsigned int format, unsigned int pitch, const std::string& destFile);
@@ -62,17 +62,17 @@ void CBaseTexture::Allocate(unsigned int width, unsigned int height, unsigned in
   m_textureWidth = m_imageWidth;
   m_textureHeight = m_imageHeight;
 
-  if (m_format & XB_FMT_DXT_MASK)
+  if (m_format & XB_FMT_COMPRESSED_MASK)
     while (GetPitch() < g_Windowing.GetMinDXTPitch())
       m_textureWidth += GetBlockSize();
 
-  if (!g_Windowing.SupportsNPOT((m_format & XB_FMT_DXT_MASK) != 0))
+  if (!g_Windowing.SupportsNPOT((m_format & XB_FMT_COMPRESSED_MASK) != 0))
   {
     m_textureWidth = PadPow2(m_textureWidth);
     m_textureHeight = PadPow2(m_textureHeight);
   }
-  if (m_format & XB_FMT_DXT_MASK)
-  { // DXT textures must be a multiple of 4 in width and height
+  if (m_format & XB_FMT_COMPRESSED_MASK)
+  { // DXT and ETC1 textures must be a multiple of 4 in width and height
     m_textureWidth = ((m_textureWidth + 3) / 4) * 4;
     m_textureHeight = ((m_textureHeight + 3) / 4) * 4;
   }
@@ -111,7 +111,8 @@ void CBaseTexture::Update(unsigned int width, unsigned int height, unsigned int
   if (pixels == NULL)
     return;
 
-  if (format & XB_FMT_DXT_MASK && !g_Windowing.SupportsDXT())
+  if ((format & XB_FMT_DXT_MASK && !g_Windowing.SupportsDXT()) ||
+      (format == XB_FMT_ETC1 && !g_Windowing.SupportsETC1()))
   { // compressed format that we don't support
     Allocate(width, height, XB_FMT_A8R8G8B8);
     CDDSImage::Decompress(m_pixels, std::min(width, m_textureWidth), std::min(height, m_textureHeight), GetPitch(m_textureWidth), pixels, format);
@@ -223,6 +224,8 @@ bool CBaseTexture::LoadFromFileInternal(const std::string& texturePath, unsigned
     if (image.ReadFile(texturePath))
     {
       Update(image.GetWidth(), image.GetHeight(), 0, image.GetFormat(), image.GetData(), false);
+      if (image.GetFormat() == XB_FMT_ETC1)
+        m_hasAlpha = false;
       return true;
     }
     return false;
@@ -389,6 +392,7 @@ unsigned int CBaseTexture::GetPitch(unsigned int width) const
   switch (m_format)
   {
   case XB_FMT_DXT1:
+  case XB_FMT_ETC1:
     return ((width + 3) / 4) * 8;
   case XB_FMT_DXT3:
   case XB_FMT_DXT5:
@@ -410,6 +414,7 @@ unsigned int CBaseTexture::GetRows(unsigned int height) const
   switch (m_format)
   {
   case XB_FMT_DXT1:
+  case XB_FMT_ETC1:
     return (height + 3) / 4;
   case XB_FMT_DXT3:
   case XB_FMT_DXT5:
@@ -425,6 +430,7 @@ unsigned int CBaseTexture::GetBlockSize() const
   switch (m_format)
   {
   case XB_FMT_DXT1:
+  case XB_FMT_ETC1:
     return 8;
   case XB_FMT_DXT3:
   case XB_FMT_DXT5:
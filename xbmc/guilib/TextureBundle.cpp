@@ -103,6 +103,19 @@ int CTextureBundle::LoadAnim(const std::string& Filename, CBaseTexture*** ppText
   }
 }
 
+void CTextureBundle::PrefetchTextures(const std::vector<std::string>& names)
+{
+  if (m_useXBT)
+    m_tbXBT.PrefetchTextures(names);
+}
+
+bool CTextureBundle::GetAtlasInfo(const std::string& Filename, std::string& page, int &x, int &y, int &width, int &height)
+{
+  if (m_useXBT)
+    return m_tbXBT.GetAtlasInfo(Filename, page, x, y, width, height);
+  return false;
+}
+
 void CTextureBundle::Cleanup()
 {
   m_tbXBT.Cleanup();
@@ -42,6 +42,10 @@ public:
 
   int LoadAnim(const std::string& Filename, CBaseTexture*** ppTextures, int &width, int &height, int& nLoops, int** ppDelays);
 
+  void PrefetchTextures(const std::vector<std::string>& names);
+
+  bool GetAtlasInfo(const std::string& Filename, std::string& page, int &x, int &y, int &width, int &height);
+
 private:
   CTextureBundleXPR m_tbXPR;
   CTextureBundleXBT m_tbXBT;
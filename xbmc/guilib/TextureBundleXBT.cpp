@@ -30,6 +30,10 @@
 #include "filesystem/XbtManager.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
 #include "XBTF.h"
 #include <lzo/lzo1x.h>
 
@@ -37,6 +41,105 @@
 #pragma comment(lib,"liblzo2.lib")
 #endif
 
+// upper bound for the unpacked size of prefetched textures
+#define PREFETCH_MAX_BYTES (32 * 1024 * 1024)
+
+/*!
+ \brief Unpacked frames of a bundled texture, shared between the unpack job and the bundle.
+
+ Whoever gets to the file first does the unpacking: if the GUI thread asks for a texture
+ before its job started, the job is skipped and the GUI thread unpacks it as usual.
+ */
+class CXBTFPrefetchedFile
+{
+public:
+  CXBTFPrefetchedFile() : m_state(QUEUED), m_done(true) {}
+  ~CXBTFPrefetchedFile()
+  {
+    for (std::vector<uint8_t*>::iterator i = m_frames.begin(); i != m_frames.end(); ++i)
+      delete[] *i;
+  }
+
+  //! called by the job, false if the file is no longer wanted
+  bool Start()
+  {
+    CSingleLock lock(m_section);
+    if (m_state != QUEUED)
+      return false;
+    m_state = RUNNING;
+    return true;
+  }
+
+  void Finish(std::vector<uint8_t*>& frames)
+  {
+    CSingleLock lock(m_section);
+    m_frames.swap(frames);
+    m_state = DONE;
+    m_done.Set();
+  }
+
+  //! take the file over from the job, false if the job didn't start yet (and now won't)
+  bool Claim()
+  {
+    CSingleLock lock(m_section);
+    if (m_state == QUEUED)
+    {
+      m_state = CANCELLED;
+      return false;
+    }
+    return m_state != CANCELLED;
+  }
+
+  //! wait for the job, only valid once Claim() returned true
+  void Wait()
+  {
+    m_done.Wait();
+  }
+
+  //! unpacked frame, valid once Claim() returned true, nullptr if unpacking failed
+  const uint8_t* GetFrame(size_t index)
+  {
+    Wait();
+    return index < m_frames.size() ? m_frames[index] : nullptr;
+  }
+
+private:
+  enum State { QUEUED, RUNNING, DONE, CANCELLED };
+
+  CCriticalSection m_section;
+  State m_state;
+  CEvent m_done;
+  std::vector<uint8_t*> m_frames;
+};
+
+class CXBTFUnpackJob : public CJob
+{
+public:
+  CXBTFUnpackJob(const CXBTFReaderPtr& reader, const CXBTFFile& file, const std::shared_ptr<CXBTFPrefetchedFile>& prefetched)
+    : m_reader(reader), m_file(file), m_prefetched(prefetched)
+  {
+  }
+
+  virtual const char* GetType() const { return "xbtfunpack"; }
+
+  virtual bool DoWork()
+  {
+    if (!m_prefetched->Start())
+      return false;
+
+    std::vector<uint8_t*> frames;
+    for (std::vector<CXBTFFrame>::iterator i = m_file.GetFrames().begin(); i != m_file.GetFrames().end(); ++i)
+      frames.push_back(CTextureBundleXBT::UnpackFrame(*m_reader, *i));
+    m_prefetched->Finish(frames);
+    return true;
+  }
+
+private:
+  CXBTFReaderPtr m_reader;
+  CXBTFFile m_file;
+  std::shared_ptr<CXBTFPrefetchedFile> m_prefetched;
+};
+
 CTextureBundleXBT::CTextureBundleXBT(void)
 {
   m_themeBundle = false;
@@ -139,11 +242,13 @@ bool CTextureBundleXBT::LoadTexture(const std::string& Filename, CBaseTexture**
   if (!m_XBTFReader->Get(name, file))
     return false;
 
-  if (file.GetFrames().size() == 0)
+  if (file.GetFrames().size() == 0 || file.GetFrames().at(0).IsInAtlas())
     return false;
 
+  std::shared_ptr<CXBTFPrefetchedFile> prefetched = GetPrefetched(name);
+
   CXBTFFrame& frame = file.GetFrames().at(0);
-  if (!ConvertFrameToTexture(Filename, frame, ppTexture))
+  if (!ConvertFrameToTexture(Filename, frame, prefetched ? prefetched->GetFrame(0) : nullptr, ppTexture))
   {
     return false;
   }
@@ -163,9 +268,11 @@ int CTextureBundleXBT::LoadAnim(const std::string& Filename, CBaseTexture*** ppT
   if (!m_XBTFReader->Get(name, file))
     return false;
 
-  if (file.GetFrames().size() == 0)
+  if (file.GetFrames().size() == 0 || file.GetFrames().at(0).IsInAtlas())
     return false;
 
+  std::shared_ptr<CXBTFPrefetchedFile> prefetched = GetPrefetched(name);
+
   size_t nTextures = file.GetFrames().size();
   *ppTextures = new CBaseTexture*[nTextures];
   *ppDelays = new int[nTextures];
@@ -174,7 +281,7 @@ int CTextureBundleXBT::LoadAnim(const std::string& Filename, CBaseTexture*** ppT
   {
     CXBTFFrame& frame = file.GetFrames().at(i);
 
-    if (!ConvertFrameToTexture(Filename, frame, &((*ppTextures)[i])))
+    if (!ConvertFrameToTexture(Filename, frame, prefetched ? prefetched->GetFrame(i) : nullptr, &((*ppTextures)[i])))
     {
       return false;
     }
@@ -189,58 +296,130 @@ int CTextureBundleXBT::LoadAnim(const std::string& Filename, CBaseTexture*** ppT
   return nTextures;
 }
 
-bool CTextureBundleXBT::ConvertFrameToTexture(const std::string& name, CXBTFFrame& frame, CBaseTexture** ppTexture)
+bool CTextureBundleXBT::GetAtlasInfo(const std::string& Filename, std::string& page, int &x, int &y, int &width, int &height)
 {
-  // found texture - allocate the necessary buffers
-  squish::u8 *buffer = new squish::u8[(size_t)frame.GetPackedSize()];
-  if (buffer == NULL)
-  {
-    CLog::Log(LOGERROR, "Out of memory loading texture: %s (need %" PRIu64" bytes)", name.c_str(), frame.GetPackedSize());
+  CXBTFFile file;
+  if (m_XBTFReader == nullptr || !m_XBTFReader->Get(Normalize(Filename), file))
     return false;
-  }
 
-  // load the compressed texture
-  if (!m_XBTFReader->Load(frame, buffer))
-  {
-    CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
-    delete[] buffer;
+  if (file.GetFrames().size() != 1 || !file.GetFrames().at(0).IsInAtlas())
     return false;
-  }
 
-  // check if it's packed with lzo
-  if (frame.IsPacked())
-  { // unpack
-    squish::u8 *unpacked = new squish::u8[(size_t)frame.GetUnpackedSize()];
-    if (unpacked == NULL)
-    {
-      CLog::Log(LOGERROR, "Out of memory unpacking texture: %s (need %" PRIu64" bytes)", name.c_str(), frame.GetUnpackedSize());
-      delete[] buffer;
-      return false;
-    }
-    lzo_uint s = (lzo_uint)frame.GetUnpackedSize();
-    if (lzo1x_decompress_safe(buffer, (lzo_uint)frame.GetPackedSize(), unpacked, &s, NULL) != LZO_E_OK ||
-        s != frame.GetUnpackedSize())
+  const CXBTFFrame& frame = file.GetFrames().at(0);
+  page = CXBTFFile::GetAtlasPagePath(frame.GetAtlasPage());
+  x = frame.GetAtlasX();
+  y = frame.GetAtlasY();
+  width = frame.GetWidth();
+  height = frame.GetHeight();
+
+  return true;
+}
+
+bool CTextureBundleXBT::ConvertFrameToTexture(const std::string& name, CXBTFFrame& frame, const uint8_t* unpacked, CBaseTexture** ppTexture)
+{
+  // frames that aren't packed are used straight from the mapped bundle
+  uint8_t* buffer = nullptr;
+  if (unpacked == nullptr && !frame.IsPacked())
+    unpacked = m_XBTFReader->GetData(frame);
+  if (unpacked == nullptr)
+  {
+    buffer = UnpackFrame(*m_XBTFReader, frame);
+    if (buffer == nullptr)
     {
-      CLog::Log(LOGERROR, "Error loading texture: %s: Decompression error", name.c_str());
-      delete[] buffer;
-      delete[] unpacked;
+      CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
       return false;
     }
-    delete[] buffer;
-    buffer = unpacked;
+    unpacked = buffer;
   }
 
   // create an xbmc texture
   *ppTexture = new CTexture();
-  (*ppTexture)->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), buffer);
+  (*ppTexture)->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), const_cast<uint8_t*>(unpacked));
 
   delete[] buffer;
 
   return true;
 }
 
+void CTextureBundleXBT::PrefetchTextures(const std::vector<std::string>& names)
+{
+  if (m_XBTFReader == nullptr || !m_XBTFReader->IsOpen())
+    return;
+
+  ClearPrefetched();
+
+  CSingleLock lock(m_prefetchSection);
+  uint64_t size = 0;
+  for (std::vector<std::string>::const_iterator i = names.begin(); i != names.end(); ++i)
+  {
+    std::string name = Normalize(*i);
+    CXBTFFile file;
+    if (!m_XBTFReader->Get(name, file) || file.GetFrames().empty())
+      continue;
+
+    // atlased textures are loaded with their page
+    if (file.GetFrames().at(0).IsInAtlas())
+    {
+      name = CXBTFFile::GetAtlasPagePath(file.GetFrames().at(0).GetAtlasPage());
+      if (!m_XBTFReader->Get(name, file) || file.GetFrames().empty())
+        continue;
+    }
+    if (m_prefetched.find(name) != m_prefetched.end())
+      continue;
+
+    bool packed = false;
+    for (std::vector<CXBTFFrame>::iterator frame = file.GetFrames().begin(); frame != file.GetFrames().end(); ++frame)
+    {
+      m_XBTFReader->Prefetch(*frame);
+      packed |= frame->IsPacked();
+      size += frame->GetUnpackedSize();
+    }
+
+    // unpacking in parallel is only safe on the mapped file, reads share the file position
+    if (!packed || m_XBTFReader->GetData(file.GetFrames().at(0)) == nullptr)
+      continue;
+    if (size > PREFETCH_MAX_BYTES)
+      break;
+
+    std::shared_ptr<CXBTFPrefetchedFile> prefetched(new CXBTFPrefetchedFile());
+    if (CJobManager::GetInstance().AddJob(new CXBTFUnpackJob(m_XBTFReader, file, prefetched), nullptr, CJob::PRIORITY_HIGH))
+      m_prefetched[name] = prefetched;
+  }
+}
+
+std::shared_ptr<CXBTFPrefetchedFile> CTextureBundleXBT::GetPrefetched(const std::string& name)
+{
+  std::shared_ptr<CXBTFPrefetchedFile> prefetched;
+  {
+    CSingleLock lock(m_prefetchSection);
+    std::map<std::string, std::shared_ptr<CXBTFPrefetchedFile> >::iterator i = m_prefetched.find(name);
+    if (i == m_prefetched.end())
+      return nullptr;
+    prefetched = i->second;
+    m_prefetched.erase(i);
+  }
+  if (!prefetched->Claim())
+    return nullptr;
+  return prefetched;
+}
+
+void CTextureBundleXBT::ClearPrefetched()
+{
+  CSingleLock lock(m_prefetchSection);
+  // stop the jobs that didn't start yet and let running ones finish,
+  // nothing may read from the mapped bundle once it's closed
+  for (std::map<std::string, std::shared_ptr<CXBTFPrefetchedFile> >::iterator i = m_prefetched.begin(); i != m_prefetched.end(); ++i)
+  {
+    if (i->second->Claim())
+      i->second->Wait();
+  }
+  m_prefetched.clear();
+}
+
 void CTextureBundleXBT::Cleanup()
 {
+  ClearPrefetched();
+
   if (m_XBTFReader != nullptr && m_XBTFReader->IsOpen())
   {
     XFILE::CXbtManager::GetInstance().Release(CURL(m_path));
@@ -266,32 +445,12 @@ std::string CTextureBundleXBT::Normalize(const std::string &name)
   return newName;
 }
 
-uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFrame& frame)
+static uint8_t* UnpackBuffer(const uint8_t* packedBuffer, const CXBTFFrame& frame)
 {
-  uint8_t* packedBuffer = new uint8_t[static_cast<size_t>(frame.GetPackedSize())];
-  if (packedBuffer == nullptr)
-  {
-    CLog::Log(LOGERROR, "CTextureBundleXBT: out of memory loading frame with %" PRIu64" packed bytes", frame.GetPackedSize());
-    return nullptr;
-  }
-
-  // load the compressed texture
-  if (!reader.Load(frame, packedBuffer))
-  {
-    CLog::Log(LOGERROR, "CTextureBundleXBT: error loading frame");
-    delete[] packedBuffer;
-    return nullptr;
-  }
-
-  // if the frame isn't packed there's nothing else to be done
-  if (!frame.IsPacked())
-    return packedBuffer;
-
   uint8_t* unpackedBuffer = new uint8_t[static_cast<size_t>(frame.GetUnpackedSize())];
   if (unpackedBuffer == nullptr)
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: out of memory loading frame with %" PRIu64" unpacked bytes", frame.GetPackedSize());
-    delete[] packedBuffer;
     return nullptr;
   }
 
@@ -299,7 +458,6 @@ uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFr
   if (lzo_init() != LZO_E_OK)
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: failed to initialize lzo");
-    delete[] packedBuffer;
     delete[] unpackedBuffer;
     return nullptr;
   }
@@ -308,11 +466,40 @@ uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFr
   if (lzo1x_decompress_safe(packedBuffer, static_cast<lzo_uint>(frame.GetPackedSize()), unpackedBuffer, &size, nullptr) != LZO_E_OK || size != frame.GetUnpackedSize())
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: failed to decompress frame with %" PRIu64" unpacked bytes to %" PRIu64" bytes", frame.GetPackedSize(), frame.GetUnpackedSize());
-    delete[] packedBuffer;
     delete[] unpackedBuffer;
     return nullptr;
   }
 
+  return unpackedBuffer;
+}
+
+uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFrame& frame)
+{
+  // packed frames are unpacked straight from the mapped bundle
+  const uint8_t* mappedBuffer = reader.GetData(frame);
+  if (mappedBuffer != nullptr && frame.IsPacked())
+    return UnpackBuffer(mappedBuffer, frame);
+
+  uint8_t* packedBuffer = new uint8_t[static_cast<size_t>(frame.GetPackedSize())];
+  if (packedBuffer == nullptr)
+  {
+    CLog::Log(LOGERROR, "CTextureBundleXBT: out of memory loading frame with %" PRIu64" packed bytes", frame.GetPackedSize());
+    return nullptr;
+  }
+
+  // load the compressed texture
+  if (!reader.Load(frame, packedBuffer))
+  {
+    CLog::Log(LOGERROR, "CTextureBundleXBT: error loading frame");
+    delete[] packedBuffer;
+    return nullptr;
+  }
+
+  // if the frame isn't packed there's nothing else to be done
+  if (!frame.IsPacked())
+    return packedBuffer;
+
+  uint8_t* unpackedBuffer = UnpackBuffer(packedBuffer, frame);
   delete[] packedBuffer;
 
   return unpackedBuffer;
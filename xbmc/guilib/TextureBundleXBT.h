@@ -21,10 +21,13 @@
  */
 
 #include <map>
+#include <memory>
 #include <string>
 #include "XBTFReader.h"
+#include "threads/CriticalSection.h"
 
 class CBaseTexture;
+class CXBTFPrefetchedFile;
 
 class CTextureBundleXBT
 {
@@ -44,17 +47,42 @@ public:
   int LoadAnim(const std::string& Filename, CBaseTexture*** ppTextures,
                 int &width, int &height, int& nLoops, int** ppDelays);
 
+  /*! \brief Find where a texture packed into an atlas page is
+   Atlased textures have no frames of their own and can't be loaded with LoadTexture(),
+   they are the given rectangle of the page texture.
+   \param Filename texture in the bundle
+   \param page [out] name of the atlas page in the bundle
+   \param x [out] left of the texture in the page
+   \param y [out] top of the texture in the page
+   \param width [out] width of the texture
+   \param height [out] height of the texture
+   \return true if the texture is in an atlas page, false otherwise
+   */
+  bool GetAtlasInfo(const std::string& Filename, std::string& page, int &x, int &y, int &width, int &height);
+
+  /*! \brief Get the given textures ready for loading in the background
+   Packed frames are unpacked in parallel jobs, others are paged in from the mapped bundle.
+   Textures prefetched earlier but never loaded are dropped.
+   \param names textures in the bundle, as passed to LoadTexture()
+   */
+  void PrefetchTextures(const std::vector<std::string>& names);
+
   static uint8_t* UnpackFrame(const CXBTFReader& reader, const CXBTFFrame& frame);
 
 private:
   bool OpenBundle();
-  bool ConvertFrameToTexture(const std::string& name, CXBTFFrame& frame, CBaseTexture** ppTexture);
+  bool ConvertFrameToTexture(const std::string& name, CXBTFFrame& frame, const uint8_t* unpacked, CBaseTexture** ppTexture);
+  std::shared_ptr<CXBTFPrefetchedFile> GetPrefetched(const std::string& name);
+  void ClearPrefetched();
 
   time_t m_TimeStamp;
 
   bool m_themeBundle;
   std::string m_path;
   CXBTFReaderPtr m_XBTFReader;
+
+  CCriticalSection m_prefetchSection;
+  std::map<std::string, std::shared_ptr<CXBTFPrefetchedFile> > m_prefetched;
 };
 
 
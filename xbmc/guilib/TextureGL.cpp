@@ -137,6 +137,9 @@ void CGLTexture::LoadToGPU()
   // system headers, and trust the extension list instead.
 #ifndef GL_BGRA_EXT
 #define GL_BGRA_EXT 0x80E1
+#endif
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8D64
 #endif
 
   GLint internalformat;
@@ -170,8 +173,16 @@ void CGLTexture::LoadToGPU()
       }
       break;
   }
-  glTexImage2D(GL_TEXTURE_2D, 0, internalformat, m_textureWidth, m_textureHeight, 0,
-    pixelformat, GL_UNSIGNED_BYTE, m_pixels);
+  if (m_format == XB_FMT_ETC1)
+  {
+    glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_ETC1_RGB8_OES,
+      m_textureWidth, m_textureHeight, 0, GetPitch() * GetRows(), m_pixels);
+  }
+  else
+  {
+    glTexImage2D(GL_TEXTURE_2D, 0, internalformat, m_textureWidth, m_textureHeight, 0,
+      pixelformat, GL_UNSIGNED_BYTE, m_pixels);
+  }
 
 #endif
   VerifyGLState();
@@ -21,6 +21,7 @@
 #include "TextureManager.h"
 
 #include <cassert>
+#include <cstring>
 
 #include "addons/Skin.h"
 #include "filesystem/Directory.h"
@@ -28,6 +29,7 @@
 #include "GraphicContext.h"
 #include "system.h"
 #include "Texture.h"
+#include "settings/AdvancedSettings.h"
 #include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 #include "URL.h"
@@ -57,6 +59,8 @@ CTextureArray::CTextureArray(int width, int height, int loops,  bool texCoordsAr
   m_texWidth = 0;
   m_texHeight = 0;
   m_texCoordsArePixels = false;
+  m_atlasX = 0;
+  m_atlasY = 0;
 }
 
 CTextureArray::CTextureArray()
@@ -86,6 +90,8 @@ void CTextureArray::Reset()
   m_texWidth = 0;
   m_texHeight = 0;
   m_texCoordsArePixels = false;
+  m_atlasX = 0;
+  m_atlasY = 0;
 }
 
 void CTextureArray::Add(CBaseTexture *texture, int delay)
@@ -133,6 +139,10 @@ CTextureMap::CTextureMap()
 {
   m_referenceCount = 0;
   m_memUsage = 0;
+  m_unused = false;
+  m_releaseTime = 0;
+  m_prevUnused = NULL;
+  m_nextUnused = NULL;
 }
 
 CTextureMap::CTextureMap(const std::string& textureName, int width, int height, int loops)
@@ -141,6 +151,10 @@ CTextureMap::CTextureMap(const std::string& textureName, int width, int height,
 {
   m_referenceCount = 0;
   m_memUsage = 0;
+  m_unused = false;
+  m_releaseTime = 0;
+  m_prevUnused = NULL;
+  m_nextUnused = NULL;
 }
 
 CTextureMap::~CTextureMap()
@@ -196,7 +210,11 @@ void CTextureMap::Flush()
 
 void CTextureMap::FreeTexture()
 {
-  m_texture.Free();
+  // the page owns the texture of atlased textures
+  if (!m_atlasPage.empty())
+    m_texture.Reset();
+  else
+    m_texture.Free();
 }
 
 void CTextureMap::SetHeight(int height)
@@ -214,6 +232,14 @@ bool CTextureMap::IsEmpty() const
   return m_texture.m_textures.size() == 0;
 }
 
+void CTextureMap::SetAtlas(const std::string& pageName, CBaseTexture* pageTexture, int x, int y)
+{
+  m_atlasPage = pageName;
+  m_texture.Add(pageTexture, 100);
+  m_texture.m_atlasX = x;
+  m_texture.m_atlasY = y;
+}
+
 void CTextureMap::Add(CBaseTexture* texture, int delay)
 {
   m_texture.Add(texture, delay);
@@ -229,6 +255,9 @@ CGUITextureManager::CGUITextureManager(void)
 {
   // we set the theme bundle to be the first bundle (thus prioritizing it)
   m_TexBundle[0].SetThemeBundle(true);
+  m_unusedHead = NULL;
+  m_unusedTail = NULL;
+  memset(&m_stats, 0, sizeof(m_stats));
 }
 
 CGUITextureManager::~CGUITextureManager(void)
@@ -263,14 +292,11 @@ bool CGUITextureManager::HasTexture(const std::string &textureName, std::string
 
   // Check our loaded and bundled textures - we store in bundles using \\.
   std::string bundledName = CTextureBundle::Normalize(textureName);
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  TextureMaps::const_iterator it = m_textures.find(textureName);
+  if (it != m_textures.end() && !it->second->m_unused)
   {
-    CTextureMap *pMap = m_vecTextures[i];
-    if (pMap->GetName() == textureName)
-    {
-      if (size) *size = 1;
-      return true;
-    }
+    if (size) *size = 1;
+    return true;
   }
 
   for (int i = 0; i < 2; i++)
@@ -298,28 +324,20 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
   if (!HasTexture(strTextureName, &strPath, &bundle, &size))
     return emptyTexture;
 
-  if (size) // we found the texture
+  TextureMaps::iterator it = m_textures.find(strTextureName);
+  if (it != m_textures.end())
   {
-    for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+    CTextureMap *pMap = it->second;
+    if (!pMap->m_unused)
     {
-      CTextureMap *pMap = m_vecTextures[i];
-      if (pMap->GetName() == strTextureName)
-      {
-        //CLog::Log(LOGDEBUG, "Total memusage %u", GetMemoryUsage());
-        return pMap->GetTexture();
-      }
+      m_stats.hits++;
+      return pMap->GetTexture();
     }
-    // Whoops, not there.
-    return emptyTexture;
-  }
-
-  for (ilistUnused i = m_unusedTextures.begin(); i != m_unusedTextures.end(); ++i)
-  {
-    CTextureMap* pMap = i->first;
-    if (pMap->GetName() == strTextureName && i->second > 0)
+    // reuse a released texture, unless it was released to be reloaded
+    if (pMap->m_releaseTime > 0)
     {
-      m_vecTextures.push_back(pMap);
-      m_unusedTextures.erase(i);
+      RemoveUnused(pMap);
+      m_stats.hits++;
       return pMap->GetTexture();
     }
   }
@@ -330,11 +348,34 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
   //Lock here, we will do stuff that could break rendering
   CSingleLock lock(g_graphicsContext);
 
+  // the name is taken by a texture that was released immediately
+  if (it != m_textures.end())
+    FreeTextureMap(it->second);
+
 #ifdef _DEBUG_TEXTURES
   int64_t start;
   start = CurrentHostCounter();
 #endif
 
+  // small skin images can be packed into atlas pages, they share the texture of their page
+  std::string atlasPage;
+  int atlasX = 0, atlasY = 0, atlasWidth = 0, atlasHeight = 0;
+  if (bundle >= 0 && m_TexBundle[bundle].GetAtlasInfo(strTextureName, atlasPage, atlasX, atlasY, atlasWidth, atlasHeight))
+  {
+    CTextureMap* pPage = LoadAtlasPage(bundle, atlasPage);
+    if (!pPage)
+    {
+      CLog::Log(LOGERROR, "Texture manager unable to load atlas page %s of bundled file: %s", atlasPage.c_str(), strTextureName.c_str());
+      return emptyTexture;
+    }
+
+    CTextureMap* pMap = new CTextureMap(strTextureName, atlasWidth, atlasHeight, 0);
+    pMap->SetAtlas(pPage->GetName(), pPage->m_texture.m_textures[0], atlasX, atlasY);
+    m_textures[strTextureName] = pMap;
+    m_stats.loads++;
+    return pMap->GetTexture();
+  }
+
   if (StringUtils::EndsWithNoCase(strPath, ".gif"))
   {
     CTextureMap* pMap = nullptr;
@@ -404,7 +445,10 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
 
     if (pMap)
     {
-      m_vecTextures.push_back(pMap);
+      m_textures[strTextureName] = pMap;
+      m_stats.usedBytes += pMap->GetMemoryUsage();
+      m_stats.loads++;
+      FreeOverBudget();
       return pMap->GetTexture();
     }
   } // of if (strPath.Right(4).ToLower()==".gif")
@@ -432,7 +476,10 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
 
   CTextureMap* pMap = new CTextureMap(strTextureName, width, height, 0);
   pMap->Add(pTexture, 100);
-  m_vecTextures.push_back(pMap);
+  m_textures[strTextureName] = pMap;
+  m_stats.usedBytes += pMap->GetMemoryUsage();
+  m_stats.loads++;
+  FreeOverBudget();
 
 #ifdef _DEBUG_TEXTURES
   int64_t end, freq;
@@ -447,45 +494,140 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
 }
 
 
+CTextureMap* CGUITextureManager::LoadAtlasPage(int bundle, const std::string& page)
+{
+  // both bundles may have pages of the same name
+  std::string name = StringUtils::Format("%s@%i", page.c_str(), bundle);
+
+  TextureMaps::iterator it = m_textures.find(name);
+  if (it != m_textures.end())
+  {
+    CTextureMap* pPage = it->second;
+    if (pPage->m_unused)
+      RemoveUnused(pPage);
+    pPage->GetTexture();
+    return pPage;
+  }
+
+  CBaseTexture* pTexture = NULL;
+  int width = 0, height = 0;
+  if (!m_TexBundle[bundle].LoadTexture(page, &pTexture, width, height) || !pTexture)
+    return NULL;
+
+  CTextureMap* pPage = new CTextureMap(name, width, height, 0);
+  pPage->Add(pTexture, 100);
+  pPage->GetTexture();
+  m_textures[name] = pPage;
+  m_stats.usedBytes += pPage->GetMemoryUsage();
+  m_stats.loads++;
+  FreeOverBudget();
+
+  return pPage;
+}
+
 void CGUITextureManager::ReleaseTexture(const std::string& strTextureName, bool immediately /*= false */)
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  TextureMaps::iterator it = m_textures.find(strTextureName);
+  if (it != m_textures.end() && !it->second->m_unused)
   {
-    CTextureMap* pMap = *i;
-    if (pMap->GetName() == strTextureName)
+    CTextureMap* pMap = it->second;
+    if (pMap->Release())
     {
-      if (pMap->Release())
-      {
-        //CLog::Log(LOGINFO, "  cleanup:%s", strTextureName.c_str());
-        // add to our textures to free
-        m_unusedTextures.push_back(std::make_pair(pMap, immediately ? 0 : XbmcThreads::SystemClockMillis()));
-        i = m_vecTextures.erase(i);
-      }
-      return;
+      //CLog::Log(LOGINFO, "  cleanup:%s", strTextureName.c_str());
+      // add to our textures to free
+      AddUnused(pMap, immediately ? 0 : XbmcThreads::SystemClockMillis());
     }
-    ++i;
+    return;
   }
   CLog::Log(LOGWARNING, "%s: Unable to release texture %s", __FUNCTION__, strTextureName.c_str());
 }
 
+void CGUITextureManager::AddUnused(CTextureMap *pMap, unsigned int releaseTime)
+{
+  pMap->m_unused = true;
+  pMap->m_releaseTime = releaseTime;
+  pMap->m_prevUnused = m_unusedTail;
+  pMap->m_nextUnused = NULL;
+  if (m_unusedTail)
+    m_unusedTail->m_nextUnused = pMap;
+  else
+    m_unusedHead = pMap;
+  m_unusedTail = pMap;
+
+  m_stats.usedBytes -= pMap->GetMemoryUsage();
+  m_stats.unusedBytes += pMap->GetMemoryUsage();
+}
+
+void CGUITextureManager::RemoveUnused(CTextureMap *pMap)
+{
+  if (pMap->m_prevUnused)
+    pMap->m_prevUnused->m_nextUnused = pMap->m_nextUnused;
+  else
+    m_unusedHead = pMap->m_nextUnused;
+  if (pMap->m_nextUnused)
+    pMap->m_nextUnused->m_prevUnused = pMap->m_prevUnused;
+  else
+    m_unusedTail = pMap->m_prevUnused;
+  pMap->m_prevUnused = NULL;
+  pMap->m_nextUnused = NULL;
+  pMap->m_unused = false;
+
+  m_stats.unusedBytes -= pMap->GetMemoryUsage();
+  m_stats.usedBytes += pMap->GetMemoryUsage();
+}
+
+void CGUITextureManager::FreeTextureMap(CTextureMap *pMap)
+{
+  if (pMap->m_unused)
+  {
+    RemoveUnused(pMap);
+    m_stats.evictions++;
+  }
+  m_stats.usedBytes -= pMap->GetMemoryUsage();
+
+  // atlased textures hold a reference to their page
+  if (!pMap->m_atlasPage.empty())
+  {
+    TextureMaps::iterator page = m_textures.find(pMap->m_atlasPage);
+    if (page != m_textures.end() && !page->second->m_unused && page->second->Release())
+      AddUnused(page->second, XbmcThreads::SystemClockMillis());
+  }
+
+  TextureMaps::iterator it = m_textures.find(pMap->GetName());
+  if (it != m_textures.end() && it->second == pMap)
+    m_textures.erase(it);
+  delete pMap;
+}
+
+void CGUITextureManager::FreeOverBudget()
+{
+  if (g_advancedSettings.m_guiTextureBudget <= 0)
+    return;
+
+  // drop the least recently released textures first
+  uint64_t budget = (uint64_t)g_advancedSettings.m_guiTextureBudget * 1024 * 1024;
+  while (m_unusedHead && m_stats.usedBytes + m_stats.unusedBytes > budget)
+    FreeTextureMap(m_unusedHead);
+}
+
 void CGUITextureManager::FreeUnusedTextures(unsigned int timeDelay)
 {
   unsigned int currFrameTime = XbmcThreads::SystemClockMillis();
   CSingleLock lock(g_graphicsContext);
-  for (ilistUnused i = m_unusedTextures.begin(); i != m_unusedTextures.end();)
+
+  // with a budget, released textures stay cached until it is exceeded
+  bool cache = timeDelay > 0 && g_advancedSettings.m_guiTextureBudget > 0;
+  CTextureMap *pMap = m_unusedHead;
+  while (pMap)
   {
-    if (currFrameTime - i->second >= timeDelay)
-    {
-      delete i->first;
-      i = m_unusedTextures.erase(i);
-    }
-    else
-      ++i;
+    CTextureMap *pNext = pMap->m_nextUnused;
+    if (pMap->m_releaseTime == 0 || (!cache && currFrameTime - pMap->m_releaseTime >= timeDelay))
+      FreeTextureMap(pMap);
+    pMap = pNext;
   }
+  FreeOverBudget();
 
 #if defined(HAS_GL) || defined(HAS_GLES)
   for (unsigned int i = 0; i < m_unusedHwTextures.size(); ++i)
@@ -512,14 +654,15 @@ void CGUITextureManager::Cleanup()
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  TextureMaps::iterator i = m_textures.begin();
+  while (i != m_textures.end())
   {
-    CTextureMap* pMap = *i;
+    CTextureMap* pMap = i->second;
+    ++i;
+    if (pMap->m_unused)
+      continue;
     CLog::Log(LOGWARNING, "%s: Having to cleanup texture %s", __FUNCTION__, pMap->GetName().c_str());
-    delete pMap;
-    i = m_vecTextures.erase(i);
+    FreeTextureMap(pMap);
   }
   for (int i = 0; i < 2; i++)
     m_TexBundle[i].Cleanup();
@@ -528,11 +671,13 @@ void CGUITextureManager::Cleanup()
 
 void CGUITextureManager::Dump() const
 {
-  CLog::Log(LOGDEBUG, "%s: total texturemaps size:%" PRIuS, __FUNCTION__, m_vecTextures.size());
+  CLog::Log(LOGDEBUG, "%s: total texturemaps size:%" PRIuS, __FUNCTION__, m_textures.size());
+  CLog::Log(LOGDEBUG, "%s: used:%" PRIu64" unused:%" PRIu64" bytes, hits:%" PRIu64" loads:%" PRIu64" evictions:%" PRIu64,
+            __FUNCTION__, m_stats.usedBytes, m_stats.unusedBytes, m_stats.hits, m_stats.loads, m_stats.evictions);
 
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  for (TextureMaps::const_iterator i = m_textures.begin(); i != m_textures.end(); ++i)
   {
-    const CTextureMap* pMap = m_vecTextures[i];
+    const CTextureMap* pMap = i->second;
     if (!pMap->IsEmpty())
       pMap->Dump();
   }
@@ -542,32 +687,28 @@ void CGUITextureManager::Flush()
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  TextureMaps::iterator i = m_textures.begin();
+  while (i != m_textures.end())
   {
-    CTextureMap* pMap = *i;
+    CTextureMap* pMap = i->second;
+    ++i;
+    if (pMap->m_unused)
+      continue;
     pMap->Flush();
-    if (pMap->IsEmpty() )
-    {
-      delete pMap;
-      i = m_vecTextures.erase(i);
-    }
-    else
-    {
-      ++i;
-    }
+    if (pMap->IsEmpty())
+      FreeTextureMap(pMap);
   }
 }
 
 unsigned int CGUITextureManager::GetMemoryUsage() const
 {
-  unsigned int memUsage = 0;
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
-  {
-    memUsage += m_vecTextures[i]->GetMemoryUsage();
-  }
-  return memUsage;
+  return (unsigned int)m_stats.usedBytes;
+}
+
+TextureManagerStats CGUITextureManager::GetStats() const
+{
+  CSingleLock lock(g_graphicsContext);
+  return m_stats;
 }
 
 void CGUITextureManager::SetTexturePath(const std::string &texturePath)
@@ -623,6 +764,29 @@ std::string CGUITextureManager::GetTexturePath(const std::string &textureName, b
   return "";
 }
 
+void CGUITextureManager::PrefetchTextures(const std::vector<std::string>& textureNames)
+{
+  std::vector<std::string> bundled[2];
+  for (std::vector<std::string>::const_iterator i = textureNames.begin(); i != textureNames.end(); ++i)
+  {
+    if (!CanLoad(*i) || m_textures.find(*i) != m_textures.end())
+      continue;
+
+    std::string bundledName = CTextureBundle::Normalize(*i);
+    for (int bundle = 0; bundle < 2; bundle++)
+    {
+      if (m_TexBundle[bundle].HasFile(bundledName))
+      {
+        bundled[bundle].push_back(bundledName);
+        break;
+      }
+    }
+  }
+
+  for (int bundle = 0; bundle < 2; bundle++)
+    m_TexBundle[bundle].PrefetchTextures(bundled[bundle]);
+}
+
 void CGUITextureManager::GetBundledTexturesFromPath(const std::string& texturePath, std::vector<std::string> &items)
 {
   m_TexBundle[0].GetTexturesFromPath(texturePath, items);
@@ -24,7 +24,8 @@
 */
 #pragma once
 
-#include <list>
+#include <stdint.h>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 
@@ -58,6 +59,8 @@ public:
   int m_texWidth;
   int m_texHeight;
   bool m_texCoordsArePixels;
+  int m_atlasX; ///< left of the frames within their textures, non zero for atlased textures
+  int m_atlasY; ///< top of the frames within their textures
 };
 
 /*!
@@ -85,13 +88,38 @@ public:
   bool IsEmpty() const;
   void SetHeight(int height);
   void SetWidth(int height);
+  /*! \brief Use a rectangle of an atlas page as the texture
+   The page texture is shared and owned by the map of the page.
+   */
+  void SetAtlas(const std::string& pageName, CBaseTexture* pageTexture, int x, int y);
 protected:
+  friend class CGUITextureManager;
   void FreeTexture();
 
   CTextureArray m_texture;
   std::string m_textureName;
+  std::string m_atlasPage; ///< name of the page map for atlased textures
   unsigned int m_referenceCount;
   uint32_t m_memUsage;
+
+  // intrusive list of unreferenced textures, maintained by CGUITextureManager
+  bool m_unused;
+  unsigned int m_releaseTime;
+  CTextureMap *m_prevUnused;
+  CTextureMap *m_nextUnused;
+};
+
+/*!
+ \ingroup textures
+ \brief Counters of the texture manager
+ */
+struct TextureManagerStats
+{
+  uint64_t usedBytes;   ///< memory of referenced textures
+  uint64_t unusedBytes; ///< memory of released textures that are kept for reuse
+  uint64_t hits;        ///< loads served from memory
+  uint64_t loads;       ///< loads from disk or texture bundle
+  uint64_t evictions;   ///< released textures that were freed
 };
 
 /*!
@@ -117,6 +145,7 @@ public:
   void Flush();
   std::string GetTexturePath(const std::string& textureName, bool directory = false);
   void GetBundledTexturesFromPath(const std::string& texturePath, std::vector<std::string> &items);
+  void PrefetchTextures(const std::vector<std::string>& textureNames); ///< Start unpacking bundled textures that are about to be loaded
 
   void AddTexturePath(const std::string &texturePath);    ///< Add a new path to the paths to check when loading media
   void SetTexturePath(const std::string &texturePath);    ///< Set a single path as the path to check when loading media (clear then add)
@@ -124,12 +153,20 @@ public:
 
   void FreeUnusedTextures(unsigned int timeDelay = 0); ///< Free textures (called from app thread only)
   void ReleaseHwTexture(unsigned int texture);
+  TextureManagerStats GetStats() const;
 protected:
-  std::vector<CTextureMap*> m_vecTextures;
-  std::list<std::pair<CTextureMap*, unsigned int> > m_unusedTextures;
+  void AddUnused(CTextureMap *pMap, unsigned int releaseTime);
+  void RemoveUnused(CTextureMap *pMap);
+  void FreeTextureMap(CTextureMap *pMap);
+  void FreeOverBudget();
+  CTextureMap* LoadAtlasPage(int bundle, const std::string& page);
+
+  typedef std::unordered_map<std::string, CTextureMap*> TextureMaps;
+  TextureMaps m_textures; ///< all texture maps by name, referenced or not
+  CTextureMap *m_unusedHead; ///< least recently released texture
+  CTextureMap *m_unusedTail; ///< most recently released texture
+  TextureManagerStats m_stats;
   std::vector<unsigned int> m_unusedHwTextures;
-  typedef std::vector<CTextureMap*>::iterator ivecTextures;
-  typedef std::list<std::pair<CTextureMap*, unsigned int> >::iterator ilistUnused;
   // we have 2 texture bundles (one for the base textures, one for the theme)
   CTextureBundle m_TexBundle[2];
 
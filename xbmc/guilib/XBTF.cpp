@@ -20,6 +20,7 @@
 
 #include "XBTF.h"
 
+#include <cstdio>
 #include <cstring>
 #include <utility>
 
@@ -32,6 +33,9 @@ CXBTFFrame::CXBTFFrame()
   m_offset = 0;
   m_format = XB_FMT_UNKNOWN;
   m_duration = 0;
+  m_atlasPage = 0;
+  m_atlasX = 0;
+  m_atlasY = 0;
 }
 
 uint32_t CXBTFFrame::GetWidth() const
@@ -114,7 +118,34 @@ void CXBTFFrame::SetDuration(uint32_t duration)
   m_duration = duration;
 }
 
-uint64_t CXBTFFrame::GetHeaderSize() const
+uint32_t CXBTFFrame::GetAtlasPage() const
+{
+  return m_atlasPage;
+}
+
+uint32_t CXBTFFrame::GetAtlasX() const
+{
+  return m_atlasX;
+}
+
+uint32_t CXBTFFrame::GetAtlasY() const
+{
+  return m_atlasY;
+}
+
+void CXBTFFrame::SetAtlas(uint32_t page, uint32_t x, uint32_t y)
+{
+  m_atlasPage = page;
+  m_atlasX = x;
+  m_atlasY = y;
+}
+
+bool CXBTFFrame::IsInAtlas() const
+{
+  return m_atlasPage != 0;
+}
+
+uint64_t CXBTFFrame::GetHeaderSize(bool atlas) const
 {
   uint64_t result =
     sizeof(m_width) +
@@ -125,6 +156,9 @@ uint64_t CXBTFFrame::GetHeaderSize() const
     sizeof(m_offset) +
     sizeof(m_duration);
 
+  if (atlas)
+    result += sizeof(m_atlasPage) + sizeof(m_atlasX) + sizeof(m_atlasY);
+
   return result;
 }
 
@@ -188,7 +222,7 @@ uint64_t CXBTFFile::GetUnpackedSize() const
   return size;
 }
 
-uint64_t CXBTFFile::GetHeaderSize() const
+uint64_t CXBTFFile::GetHeaderSize(bool atlas) const
 {
   uint64_t result =
     MaximumPathLength +
@@ -196,18 +230,25 @@ uint64_t CXBTFFile::GetHeaderSize() const
     sizeof(uint32_t); /* Number of frames */
 
   for (const auto& frame : m_frames)
-    result += frame.GetHeaderSize();
+    result += frame.GetHeaderSize(atlas);
 
   return result;
 }
 
+std::string CXBTFFile::GetAtlasPagePath(uint32_t page)
+{
+  char path[32];
+  snprintf(path, sizeof(path), "xbtf-atlas/page%u.png", page);
+  return path;
+}
+
 uint64_t CXBTFBase::GetHeaderSize() const
 {
   uint64_t result = XBTF_MAGIC.size() + XBTF_VERSION.size() +
     sizeof(uint32_t) /* number of files */;
 
   for (const auto& file : m_files)
-    result += file.second.GetHeaderSize();
+    result += file.second.GetHeaderSize(m_atlas);
 
   return result;
 }
@@ -26,7 +26,8 @@
 #include <stdint.h>
 
 static const std::string XBTF_MAGIC = "XBTF";
-static const std::string XBTF_VERSION = "2";
+static const std::string XBTF_VERSION = "3";
+static const std::string XBTF_VERSION_NOATLAS = "2"; ///< bundles whose frames have no atlas placement
 
 #define XB_FMT_MASK   0xffff ///< mask for format info - other flags are outside this
 #define XB_FMT_DXT_MASK   15
@@ -39,7 +40,9 @@ static const std::string XBTF_VERSION = "2";
 #define XB_FMT_A8         32
 #define XB_FMT_RGBA8      64
 #define XB_FMT_RGB8      128
+#define XB_FMT_ETC1      256 // ETC1 RGB blocks, GLES only
 #define XB_FMT_OPAQUE  65536
+#define XB_FMT_COMPRESSED_MASK (XB_FMT_DXT_MASK | XB_FMT_ETC1) ///< block compressed formats
 
 class CXBTFFrame
 {
@@ -64,11 +67,22 @@ public:
   uint64_t GetOffset() const;
   void SetOffset(uint64_t offset);
 
-  uint64_t GetHeaderSize() const;
+  uint64_t GetHeaderSize(bool atlas = true) const;
 
   uint32_t GetDuration() const;
   void SetDuration(uint32_t duration);
 
+  /*! \brief Atlas page holding the pixels of this frame
+   Frames in an atlas have no data of their own, they are the rectangle at
+   GetAtlasX(), GetAtlasY() of the size of the frame within the page.
+   \return 1 based page number, see CXBTFFile::GetAtlasPagePath(), 0 if the frame isn't in an atlas
+   */
+  uint32_t GetAtlasPage() const;
+  uint32_t GetAtlasX() const;
+  uint32_t GetAtlasY() const;
+  void SetAtlas(uint32_t page, uint32_t x, uint32_t y);
+  bool IsInAtlas() const;
+
   bool IsPacked() const;
   bool HasAlpha() const;
 
@@ -80,6 +94,9 @@ private:
   uint64_t m_unpackedSize;
   uint64_t m_offset;
   uint32_t m_duration;
+  uint32_t m_atlasPage;
+  uint32_t m_atlasX;
+  uint32_t m_atlasY;
 };
 
 class CXBTFFile
@@ -99,7 +116,10 @@ public:
 
   uint64_t GetPackedSize() const;
   uint64_t GetUnpackedSize() const;
-  uint64_t GetHeaderSize() const;
+  uint64_t GetHeaderSize(bool atlas = true) const;
+
+  //! path of the file holding the given atlas page
+  static std::string GetAtlasPagePath(uint32_t page);
 
   static const size_t MaximumPathLength = 256;
 
@@ -123,7 +143,8 @@ public:
   void UpdateFile(const CXBTFFile& file);
 
 protected:
-  CXBTFBase() { }
+  CXBTFBase() : m_atlas(true) { }
 
   std::map<std::string, CXBTFFile> m_files;
+  bool m_atlas; ///< frame headers include the atlas placement, false for version 2 bundles
 };
@@ -22,6 +22,10 @@
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
+#ifndef TARGET_WINDOWS
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include "XBTFReader.h"
 #include "guilib/XBTF.h"
@@ -68,7 +72,9 @@ static bool ReadUInt64(FILE* file, uint64_t& value)
 CXBTFReader::CXBTFReader()
   : CXBTFBase(),
     m_path(),
-    m_file(nullptr)
+    m_file(nullptr),
+    m_data(nullptr),
+    m_size(0)
 { }
 
 CXBTFReader::~CXBTFReader()
@@ -106,7 +112,12 @@ bool CXBTFReader::Open(const std::string& path)
   if (!ReadString(m_file, version, sizeof(version)))
     return false;
 
-  if (strncmp(XBTF_VERSION.c_str(), version, sizeof(version)) != 0)
+  // version 2 bundles are still read, their frames just have no atlas placement
+  if (strncmp(XBTF_VERSION.c_str(), version, sizeof(version)) == 0)
+    m_atlas = true;
+  else if (strncmp(XBTF_VERSION_NOATLAS.c_str(), version, sizeof(version)) == 0)
+    m_atlas = false;
+  else
     return false;
 
   unsigned int nofFiles;
@@ -165,6 +176,14 @@ bool CXBTFReader::Open(const std::string& path)
         return false;
       frame.SetOffset(u64);
 
+      if (m_atlas)
+      {
+        uint32_t page, x, y;
+        if (!ReadUInt32(m_file, page) || !ReadUInt32(m_file, x) || !ReadUInt32(m_file, y))
+          return false;
+        frame.SetAtlas(page, x, y);
+      }
+
       xbtfFile.GetFrames().push_back(frame);
     }
 
@@ -176,9 +195,39 @@ bool CXBTFReader::Open(const std::string& path)
   if (pos != GetHeaderSize())
     return false;
 
+  Map();
+
   return true;
 }
 
+void CXBTFReader::Map()
+{
+#ifndef TARGET_WINDOWS
+  struct stat fileStat;
+  if (fstat(fileno(m_file), &fileStat) == -1 || fileStat.st_size <= 0)
+    return;
+
+  // frames are accessed randomly, reading ahead is done per frame in Prefetch()
+  void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fileno(m_file), 0);
+  if (data == MAP_FAILED)
+    return;
+  madvise(data, static_cast<size_t>(fileStat.st_size), MADV_RANDOM);
+
+  m_data = static_cast<unsigned char*>(data);
+  m_size = static_cast<uint64_t>(fileStat.st_size);
+#endif
+}
+
+void CXBTFReader::Unmap()
+{
+#ifndef TARGET_WINDOWS
+  if (m_data != nullptr)
+    munmap(m_data, static_cast<size_t>(m_size));
+#endif
+  m_data = nullptr;
+  m_size = 0;
+}
+
 bool CXBTFReader::IsOpen() const
 {
   return m_file != nullptr;
@@ -186,6 +235,8 @@ bool CXBTFReader::IsOpen() const
 
 void CXBTFReader::Close()
 {
+  Unmap();
+
   if (m_file != nullptr)
   {
     fclose(m_file);
@@ -213,6 +264,13 @@ bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer) const
   if (m_file == nullptr)
     return false;
 
+  const unsigned char* data = GetData(frame);
+  if (data != nullptr)
+  {
+    memcpy(buffer, data, static_cast<size_t>(frame.GetPackedSize()));
+    return true;
+  }
+
 #if defined(TARGET_DARWIN) || defined(TARGET_FREEBSD) || defined(TARGET_ANDROID)
   if (fseeko(m_file, static_cast<off_t>(frame.GetOffset()), SEEK_SET) == -1)
 #else
@@ -225,3 +283,26 @@ bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer) const
 
   return true;
 }
+
+const unsigned char* CXBTFReader::GetData(const CXBTFFrame& frame) const
+{
+  if (m_data == nullptr || frame.GetOffset() > m_size || frame.GetPackedSize() > m_size - frame.GetOffset())
+    return nullptr;
+
+  return m_data + frame.GetOffset();
+}
+
+void CXBTFReader::Prefetch(const CXBTFFrame& frame) const
+{
+#ifndef TARGET_WINDOWS
+  const unsigned char* data = GetData(frame);
+  if (data == nullptr)
+    return;
+
+  // madvise() wants page aligned addresses
+  static const uintptr_t pageMask = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)) - 1;
+  uintptr_t start = reinterpret_cast<uintptr_t>(data) & ~pageMask;
+  uintptr_t end = reinterpret_cast<uintptr_t>(data) + static_cast<uintptr_t>(frame.GetPackedSize());
+  madvise(reinterpret_cast<void*>(start), static_cast<size_t>(end - start), MADV_WILLNEED);
+#endif
+}
@@ -41,9 +41,23 @@ public:
 
   bool Load(const CXBTFFrame& frame, unsigned char* buffer) const;
 
+  /*! \brief Direct access to the (packed) data of a frame
+   \return pointer into the memory mapped file or nullptr if the file isn't mapped
+   */
+  const unsigned char* GetData(const CXBTFFrame& frame) const;
+
+  /*! \brief Ask the OS to read the data of a frame ahead of its use
+   */
+  void Prefetch(const CXBTFFrame& frame) const;
+
 private:
+  void Map();
+  void Unmap();
+
   std::string m_path;
   FILE* m_file;
+  unsigned char* m_data;
+  uint64_t m_size;
 };
 
 typedef std::shared_ptr<CXBTFReader> CXBTFReaderPtr;
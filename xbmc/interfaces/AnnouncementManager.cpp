@@ -18,9 +18,12 @@
  *
  */
 
+#include <algorithm>
+
 #include "AnnouncementManager.h"
 #include "threads/SingleLock.h"
 #include <stdio.h>
+#include "utils/JSONVariantWriter.h"
 #include "utils/log.h"
 #include "utils/Variant.h"
 #include "utils/StringUtils.h"
@@ -33,9 +36,68 @@
 
 #define LOOKUP_PROPERTY "database-lookup"
 
+// number of announcements queued for an announcer before the oldest ones are dropped
+#define ANNOUNCEMENT_QUEUE_LIMIT    10000
+// number of queued announcements searched for one which is made again
+#define ANNOUNCEMENT_COALESCE_DEPTH 64
+// number of announcements delivered to an announcer before the next one's turn
+#define ANNOUNCEMENT_BATCH_SIZE     32
+
 using namespace ANNOUNCEMENT;
 
+namespace
+{
+  bool IsSameKind(const CAnnouncement &a, const CAnnouncement &b)
+  {
+    return a.GetFlag() == b.GetFlag() && a.GetMessage() == b.GetMessage() && a.GetSender() == b.GetSender();
+  }
+
+  // of announcements describing a state only the latest one is of interest
+  bool ReplacesEarlier(const CAnnouncement &announcement)
+  {
+    return (announcement.GetFlag() == Application && announcement.GetMessage() == "OnVolumeChanged") ||
+           (announcement.GetFlag() == Player && announcement.GetMessage() == "OnSeek");
+  }
+
+  // an item changed in the library is only announced once however often it changed meanwhile
+  bool IsItemUpdate(const CAnnouncement &announcement)
+  {
+    return (announcement.GetFlag() == VideoLibrary || announcement.GetFlag() == AudioLibrary) &&
+           announcement.GetMessage() == "OnUpdate";
+  }
+}
+
+CAnnouncement::CAnnouncement(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+  : m_flag(flag),
+    m_sender(sender != NULL ? sender : ""),
+    m_message(message != NULL ? message : ""),
+    m_data(data)
+{
+  m_jsonWritten[0] = m_jsonWritten[1] = false;
+}
+
+const std::string& CAnnouncement::GetDataAsJSON(bool compact) const
+{
+  CSingleLock lock(m_jsonSection);
+  int index = compact ? 1 : 0;
+  if (!m_jsonWritten[index])
+  {
+    m_json[index] = CJSONVariantWriter::Write(m_data, compact);
+    m_jsonWritten[index] = true;
+  }
+
+  return m_json[index];
+}
+
+void IAnnouncer::OnAnnouncement(const CAnnouncement &announcement)
+{
+  Announce(announcement.GetFlag(), announcement.GetSender().c_str(), announcement.GetMessage().c_str(), announcement.GetData());
+}
+
 CAnnouncementManager::CAnnouncementManager()
+  : CThread("Announcement"),
+    m_nextSubscriber(0),
+    m_dispatching(false)
 { }
 
 CAnnouncementManager::~CAnnouncementManager()
@@ -49,19 +111,55 @@ CAnnouncementManager& CAnnouncementManager::GetInstance()
   return s_instance;
 }
 
+void CAnnouncementManager::Start()
+{
+  CSingleLock lock (m_critSection);
+  if (m_dispatching)
+    return;
+
+  m_dispatching = true;
+  Create();
+}
+
 void CAnnouncementManager::Deinitialize()
 {
+  StopThread(false);
+  {
+    CSingleLock lock (m_critSection);
+    m_queued.notifyAll();
+  }
+  StopThread();
+
   CSingleLock lock (m_critSection);
-  m_announcers.clear();
+  m_dispatching = false;
+
+  // deliver what is still queued (e.g. System.OnQuit) before the announcers are dropped
+  std::vector<SubscriberPtr> subscribers(m_subscribers);
+  for (std::vector<SubscriberPtr>::iterator subscriber = subscribers.begin(); subscriber != subscribers.end(); ++subscriber)
+  {
+    std::deque<CAnnouncementPtr> queue;
+    queue.swap((*subscriber)->queue);
+    for (std::deque<CAnnouncementPtr>::const_iterator it = queue.begin(); it != queue.end() && !(*subscriber)->removed; ++it)
+      (*subscriber)->announcer->OnAnnouncement(**it);
+  }
+
+  m_subscribers.clear();
+  m_nextSubscriber = 0;
 }
 
-void CAnnouncementManager::AddAnnouncer(IAnnouncer *listener)
+void CAnnouncementManager::AddAnnouncer(IAnnouncer *listener, bool synchronous /* = false */)
 {
   if (!listener)
     return;
 
+  SubscriberPtr subscriber(new Subscriber());
+  subscriber->announcer = listener;
+  subscriber->synchronous = synchronous;
+  subscriber->removed = false;
+  subscriber->dropped = 0;
+
   CSingleLock lock (m_critSection);
-  m_announcers.push_back(listener);
+  m_subscribers.push_back(subscriber);
 }
 
 void CAnnouncementManager::RemoveAnnouncer(IAnnouncer *listener)
@@ -69,15 +167,24 @@ void CAnnouncementManager::RemoveAnnouncer(IAnnouncer *listener)
   if (!listener)
     return;
 
-  CSingleLock lock (m_critSection);
-  for (unsigned int i = 0; i < m_announcers.size(); i++)
+  SubscriberPtr subscriber;
   {
-    if (m_announcers[i] == listener)
+    CSingleLock lock (m_critSection);
+    for (std::vector<SubscriberPtr>::iterator it = m_subscribers.begin(); it != m_subscribers.end(); ++it)
     {
-      m_announcers.erase(m_announcers.begin() + i);
-      return;
+      if ((*it)->announcer == listener)
+      {
+        subscriber = *it;
+        subscriber->removed = true;
+        m_subscribers.erase(it);
+        break;
+      }
     }
   }
+
+  // wait until an announcement being delivered to it is done, unless it removes itself meanwhile
+  if (subscriber && !IsCurrentThread())
+    CSingleLock delivery (subscriber->delivery);
 }
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message)
@@ -90,12 +197,117 @@ void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, c
 {
   CLog::Log(LOGDEBUG, "CAnnouncementManager - Announcement: %s from %s", message, sender);
 
+  CAnnouncementPtr announcement(new CAnnouncement(flag, sender, message, data));
+
   CSingleLock lock (m_critSection);
 
-  // Make a copy of announers. They may be removed or even remove themselves during execution of IAnnouncer::Announce()!
-  std::vector<IAnnouncer *> announcers(m_announcers); 
-  for (unsigned int i = 0; i < announcers.size(); i++)
-    announcers[i]->Announce(flag, sender, message, data);
+  // Make a copy of the announcers. They may be removed or even remove themselves during execution of IAnnouncer::OnAnnouncement()!
+  std::vector<SubscriberPtr> subscribers(m_subscribers);
+
+  // synchronous announcers see the announcement before it is delivered to any other one
+  for (std::vector<SubscriberPtr>::iterator it = subscribers.begin(); it != subscribers.end(); ++it)
+  {
+    if (((*it)->synchronous || !m_dispatching) && !(*it)->removed)
+      (*it)->announcer->OnAnnouncement(*announcement);
+  }
+
+  if (!m_dispatching)
+    return;
+
+  for (std::vector<SubscriberPtr>::iterator it = subscribers.begin(); it != subscribers.end(); ++it)
+  {
+    if (!(*it)->synchronous && !(*it)->removed)
+      Queue(**it, announcement);
+  }
+  m_queued.notifyAll();
+}
+
+void CAnnouncementManager::Queue(Subscriber &subscriber, const CAnnouncementPtr &announcement)
+{
+  std::deque<CAnnouncementPtr> &queue = subscriber.queue;
+  if (!queue.empty())
+  {
+    // the same announcement made again before the first one was delivered
+    const CAnnouncement &last = *queue.back();
+    if (IsSameKind(last, *announcement) && last.GetData() == announcement->GetData())
+      return;
+
+    bool replaces = ReplacesEarlier(*announcement);
+    bool update = IsItemUpdate(*announcement);
+    if (replaces || update)
+    {
+      size_t depth = 0;
+      for (std::deque<CAnnouncementPtr>::iterator it = queue.end(); it != queue.begin() && depth < ANNOUNCEMENT_COALESCE_DEPTH; depth++)
+      {
+        --it;
+        if (!IsSameKind(**it, *announcement))
+          continue;
+
+        if (replaces)
+        {
+          queue.erase(it);
+          break;
+        }
+        if ((*it)->GetData() == announcement->GetData())
+          return;
+      }
+    }
+  }
+
+  if (queue.size() >= ANNOUNCEMENT_QUEUE_LIMIT)
+  {
+    queue.pop_front();
+    subscriber.dropped++;
+  }
+  queue.push_back(announcement);
+}
+
+bool CAnnouncementManager::GetNextBatch(SubscriberPtr &subscriber, std::vector<CAnnouncementPtr> &batch)
+{
+  // take turns so a slow announcer with a long queue doesn't hold up the others
+  for (size_t i = 0; i < m_subscribers.size(); i++)
+  {
+    size_t index = (m_nextSubscriber + i) % m_subscribers.size();
+    Subscriber &next = *m_subscribers[index];
+    if (next.queue.empty())
+      continue;
+
+    if (next.dropped > 0)
+    {
+      CLog::Log(LOGWARNING, "CAnnouncementManager - dropped %u announcements not delivered in time", next.dropped);
+      next.dropped = 0;
+    }
+
+    size_t count = std::min(next.queue.size(), (size_t)ANNOUNCEMENT_BATCH_SIZE);
+    batch.assign(next.queue.begin(), next.queue.begin() + count);
+    next.queue.erase(next.queue.begin(), next.queue.begin() + count);
+
+    subscriber = m_subscribers[index];
+    m_nextSubscriber = index + 1;
+    return true;
+  }
+
+  return false;
+}
+
+void CAnnouncementManager::Process()
+{
+  CSingleLock lock (m_critSection);
+  while (!m_bStop)
+  {
+    SubscriberPtr subscriber;
+    std::vector<CAnnouncementPtr> batch;
+    if (!GetNextBatch(subscriber, batch))
+    {
+      m_queued.wait(lock);
+      continue;
+    }
+
+    CSingleExit exit (m_critSection);
+    CSingleLock delivery (subscriber->delivery);
+    for (std::vector<CAnnouncementPtr>::const_iterator it = batch.begin(); it != batch.end() && !subscriber->removed; ++it)
+      subscriber->announcer->OnAnnouncement(**it);
+  }
 }
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item)
@@ -18,39 +18,98 @@
  *  <http://www.gnu.org/licenses/>.
  *
  */
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <vector>
 
 #include "IAnnouncer.h"
 #include "FileItem.h"
+#include "threads/Condition.h"
 #include "threads/CriticalSection.h"
+#include "threads/Thread.h"
 #include "utils/GlobalsHandling.h"
 
-class CVariant;
-
 namespace ANNOUNCEMENT
 {
-  class CAnnouncementManager
+  /*!
+    \brief Delivers announcements to the announcers.
+
+    Announcements are queued for every announcer and delivered by a dispatch thread, so announcing
+    doesn't wait for the announcers. Announcers are called with the announcements in the order they
+    were made. An announcement which is still queued for an announcer when the same one is made
+    again is only delivered once, and of some announcements describing a state (e.g. the volume)
+    only the latest one queued is delivered.
+
+    Announcers which have to see an announcement before any other announcer (e.g. caches) or whose
+    side effects have to be done before the announcing thread continues (e.g. switching off the TV
+    on System.OnSleep) are added as synchronous announcers and are called on the announcing thread.
+    Until Start() and after Deinitialize() all announcers are called on the announcing thread.
+    */
+  class CAnnouncementManager : public CThread
   {
   public:
     virtual ~CAnnouncementManager();
 
     static CAnnouncementManager& GetInstance();
 
+    /*!
+      \brief Start delivering announcements on the dispatch thread
+      */
+    void Start();
+
+    /*!
+      \brief Deliver the announcements still queued, stop the dispatch thread and remove all announcers
+      */
     void Deinitialize();
 
-    void AddAnnouncer(IAnnouncer *listener);
+    /*!
+      \brief Add an announcer
+      \param listener announcer to add
+      \param synchronous whether the announcer is called on the announcing thread
+      */
+    void AddAnnouncer(IAnnouncer *listener, bool synchronous = false);
+
+    /*!
+      \brief Remove an announcer, it isn't called anymore once this returns
+
+      Waits for an announcement the dispatch thread is delivering to it at that moment, unless it is
+      called from the dispatch thread itself. The caller must not hold a lock the announcer takes in
+      its Announce().
+      */
     void RemoveAnnouncer(IAnnouncer *listener);
 
     void Announce(AnnouncementFlag flag, const char *sender, const char *message);
     void Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data);
     void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item);
     void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item, CVariant &data);
+
+  protected:
+    virtual void Process();
+
   private:
     CAnnouncementManager();
     CAnnouncementManager(const CAnnouncementManager&);
     CAnnouncementManager const& operator=(CAnnouncementManager const&);
 
+    typedef struct Subscriber
+    {
+      IAnnouncer *announcer;
+      bool synchronous;
+      std::atomic<bool> removed;
+      CCriticalSection delivery; ///< held by the dispatch thread while delivering to the announcer
+      std::deque<CAnnouncementPtr> queue;
+      unsigned int dropped;
+    } Subscriber;
+    typedef std::shared_ptr<Subscriber> SubscriberPtr;
+
+    void Queue(Subscriber &subscriber, const CAnnouncementPtr &announcement);
+    bool GetNextBatch(SubscriberPtr &subscriber, std::vector<CAnnouncementPtr> &batch);
+
     CCriticalSection m_critSection;
-    std::vector<IAnnouncer *> m_announcers;
+    std::vector<SubscriberPtr> m_subscribers;
+    size_t m_nextSubscriber;
+    bool m_dispatching;
+    XbmcThreads::ConditionVariable m_queued;
   };
 }
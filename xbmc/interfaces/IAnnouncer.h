@@ -19,7 +19,12 @@
  *
  */
 
-class CVariant;
+#include <memory>
+#include <string>
+
+#include "threads/CriticalSection.h"
+#include "utils/Variant.h"
+
 namespace ANNOUNCEMENT
 {
   enum AnnouncementFlag
@@ -73,11 +78,51 @@ namespace ANNOUNCEMENT
     }
   }
 
+  /*!
+    \brief An announcement as it is queued for the announcers, shared by all announcers
+    */
+  class CAnnouncement
+  {
+  public:
+    CAnnouncement(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+
+    AnnouncementFlag GetFlag() const { return m_flag; }
+    const std::string& GetSender() const { return m_sender; }
+    const std::string& GetMessage() const { return m_message; }
+    const CVariant& GetData() const { return m_data; }
+
+    /*!
+      \brief The data written as JSON, written once for all announcers sending it somewhere
+      */
+    const std::string& GetDataAsJSON(bool compact) const;
+
+  private:
+    CAnnouncement(const CAnnouncement&);
+    CAnnouncement const& operator=(CAnnouncement const&);
+
+    AnnouncementFlag m_flag;
+    std::string m_sender;
+    std::string m_message;
+    CVariant m_data;
+
+    mutable CCriticalSection m_jsonSection;
+    mutable std::string m_json[2];
+    mutable bool m_jsonWritten[2];
+  };
+
+  typedef std::shared_ptr<const CAnnouncement> CAnnouncementPtr;
+
   class IAnnouncer
   {
   public:
     IAnnouncer() { };
     virtual ~IAnnouncer() { };
     virtual void Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data) = 0;
+
+    /*!
+      \brief Called by CAnnouncementManager for every announcement, calls Announce() unless an
+      announcer makes use of the announcement as it is shared by all announcers
+      */
+    virtual void OnAnnouncement(const CAnnouncement &announcement);
   };
 }
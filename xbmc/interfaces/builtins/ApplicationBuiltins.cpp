@@ -32,12 +32,23 @@
 #include "utils/JSONVariantParser.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
+#include "utils/TraceRecorder.h"
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
 #include <stdlib.h>
 
 using namespace KODI::MESSAGING;
 
+/*! \brief Dump the recorded playback events.
+ *  \param params (ignored)
+ */
+static int DumpTrace(const std::vector<std::string>& params)
+{
+  CTraceRecorder::GetInstance().RequestDump("requested");
+
+  return 0;
+}
+
 /*! \brief Extract an archive.
  *  \param params The parameters
  *  \details params[0] = The archive URL.
@@ -152,6 +163,7 @@ static int WakeOnLAN(const std::vector<std::string>& params)
 CBuiltins::CommandMap CApplicationBuiltins::GetOperations() const
 {
   return {
+           {"dumptrace", {"Writes the recorded playback events to the log folder", 0, DumpTrace}},
            {"extract", {"Extracts the specified archive", 1, Extract}},
            {"mute", {"Mute the player", 0, Mute}},
            {"notifyall", {"Notify all connected clients", 2, NotifyAll}},
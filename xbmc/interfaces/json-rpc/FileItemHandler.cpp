@@ -20,8 +20,11 @@
 
 #include <map>
 #include <string.h>
+#include <utility>
+#include <vector>
 
 #include "FileItemHandler.h"
+#include "JSONRPC.h"
 #include "AudioLibrary.h"
 #include "VideoLibrary.h"
 #include "FileOperations.h"
@@ -48,6 +51,55 @@ using namespace MUSIC_INFO;
 using namespace JSONRPC;
 using namespace XFILE;
 
+namespace
+{
+  // serializes the items of a list one by one while the response is written
+  class CFileItemResultItems : public IResultItems, protected CFileItemHandler
+  {
+  public:
+    CFileItemResultItems(const char *ID, bool allowFile, const CVariant &parameterObject, const std::set<std::string> &fields, CThumbLoader *thumbLoader)
+      : m_hasID(ID != NULL),
+        m_ID(ID != NULL ? ID : ""),
+        m_allowFile(allowFile),
+        m_parameterObject(parameterObject),
+        m_fields(fields),
+        m_thumbLoader(thumbLoader),
+        m_next(0)
+    { }
+
+    virtual ~CFileItemResultItems()
+    {
+      delete m_thumbLoader;
+    }
+
+    void Add(const CFileItemPtr &item) { m_items.push_back(item); }
+
+    virtual bool GetNext(CVariant &item)
+    {
+      if (m_next >= m_items.size())
+        return false;
+
+      CVariant result;
+      HandleFileItem(m_hasID ? m_ID.c_str() : NULL, m_allowFile, "item", m_items[m_next], m_parameterObject, m_fields, result, false, m_thumbLoader);
+      // written items are not needed anymore
+      m_items[m_next++].reset();
+
+      item = std::move(result["item"]);
+      return true;
+    }
+
+  private:
+    bool m_hasID;
+    std::string m_ID;
+    bool m_allowFile;
+    CVariant m_parameterObject;
+    std::set<std::string> m_fields;
+    CThumbLoader *m_thumbLoader;
+    std::vector<CFileItemPtr> m_items;
+    size_t m_next;
+  };
+}
+
 bool CFileItemHandler::GetField(const std::string &field, const CVariant &info, const CFileItemPtr &item, CVariant &result, bool &fetchedArt, CThumbLoader *thumbLoader /* = NULL */)
 {
   if (result.isMember(field) && !result[field].empty())
@@ -121,7 +173,7 @@ bool CFileItemHandler::GetField(const std::string &field, const CVariant &info,
           artObj[artIt->first] = CTextureUtils::GetWrappedImageURL(artIt->second);
       }
 
-      result["art"] = artObj;
+      result["art"] = std::move(artObj);
       return true;
     }
     
@@ -241,6 +293,21 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
       fields.insert(field->asString());
   }
 
+  // let the response serialize the items while it is written if it can
+  if (resultname && end > start && CJSONRPCResponse::CanStreamItems(result))
+  {
+    CFileItemResultItems *resultItems = new CFileItemResultItems(ID, allowFile, parameterObject, fields, thumbLoader);
+    for (int i = start; i < end; i++)
+      resultItems->Add(items.Get(i));
+
+    result[resultname] = CVariant(CVariant::VariantTypeArray);
+    CJSONRPCResponse::StreamItems(result, resultname, resultItems);
+    return;
+  }
+
+  if (resultname && end > start)
+    result[resultname].reserve(end - start);
+
   for (int i = start; i < end; i++)
   {
     CFileItemPtr item = items.Get(i);
@@ -381,9 +448,9 @@ void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char
   if (resultname)
   {
     if (append)
-      result[resultname].append(object);
+      result[resultname].append(std::move(object));
     else
-      result[resultname] = object;
+      result[resultname] = std::move(object);
   }
 }
 
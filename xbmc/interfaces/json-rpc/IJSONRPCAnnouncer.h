@@ -46,5 +46,26 @@ namespace JSONRPC
 
       return CJSONVariantWriter::Write(root, compactOutput);
     }
+
+    static std::string AnnouncementToJSONRPC(const ANNOUNCEMENT::CAnnouncement &announcement, bool compactOutput)
+    {
+      if (!compactOutput)
+        return AnnouncementToJSONRPC(announcement.GetFlag(), announcement.GetSender().c_str(), announcement.GetMessage().c_str(), announcement.GetData(), false);
+
+      // the data is written once for all announcers, only the frame around it is written here
+      std::string namespaceMethod = ANNOUNCEMENT::AnnouncementFlagToString(announcement.GetFlag());
+      namespaceMethod += ".";
+      namespaceMethod += announcement.GetMessage();
+
+      std::string output = "{\"jsonrpc\":\"2.0\",\"method\":";
+      output += CJSONVariantWriter::Write(namespaceMethod, true);
+      output += ",\"params\":{\"data\":";
+      output += announcement.GetDataAsJSON(true);
+      output += ",\"sender\":";
+      output += CJSONVariantWriter::Write(announcement.GetSender(), true);
+      output += "}}";
+
+      return output;
+    }
   };
 }
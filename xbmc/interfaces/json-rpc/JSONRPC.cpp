@@ -21,6 +21,7 @@
 #include <string.h>
 
 #include "JSONRPC.h"
+#include "JSONRPCResultCache.h"
 #include "ServiceDescription.h"
 #include "addons/Addon.h"
 #include "addons/IAddon.h"
@@ -29,6 +30,7 @@
 #include "interfaces/AnnouncementManager.h"
 #include "playlists/SmartPlayList.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/ThreadLocal.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
@@ -39,6 +41,18 @@ using namespace JSONRPC;
 
 bool CJSONRPC::m_initialized = false;
 
+namespace
+{
+  // the result of the method which is called for a streamed response on this thread
+  struct StreamContext
+  {
+    const CVariant *result;
+    CJSONRPCResponse *response;
+  };
+
+  XbmcThreads::ThreadLocal<StreamContext> streamContext;
+}
+
 void CJSONRPC::Initialize()
 {
   if (m_initialized)
@@ -110,12 +124,15 @@ void CJSONRPC::Initialize()
   for (unsigned int index = 0; index < size; index++)
     CJSONServiceDescription::AddNotification(JSONRPC_SERVICE_NOTIFICATIONS[index]);
   
+  CJSONRPCResultCache::GetInstance().Initialize();
+
   m_initialized = true;
   CLog::Log(LOGINFO, "JSONRPC v%s: Successfully initialized", CJSONServiceDescription::GetVersion());
 }
 
 void CJSONRPC::Cleanup()
 {
+  CJSONRPCResultCache::GetInstance().Deinitialize();
   CJSONServiceDescription::Cleanup();
   m_initialized = false;
 }
@@ -235,9 +252,24 @@ JSONRPC_STATUS CJSONRPC::NotifyAll(const std::string &method, ITransportLayer *t
 
 std::string CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client)
 {
-  CVariant inputroot, outputroot, result;
+  std::string str;
+  CJSONRPCResponse response;
+  if (MethodCall(inputString, transport, client, response))
+  {
+    while (response.Read(str, 65536))
+      ;
+  }
+  return str;
+}
+
+bool CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client, CJSONRPCResponse &response)
+{
+  CVariant inputroot;
   bool hasResponse = false;
 
+  response.Reset(g_advancedSettings.m_jsonOutputCompact);
+  CVariant &outputroot = response.m_response;
+
   if(g_advancedSettings.CanLogComponent(LOGJSONRPC))
     CLog::Log(LOGDEBUG, "JSONRPC: Incoming request: %s", inputString.c_str());
 
@@ -266,7 +298,7 @@ std::string CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer
       }
     }
     else
-      hasResponse = HandleMethodCall(inputroot, outputroot, transport, client);
+      hasResponse = HandleMethodCall(inputroot, outputroot, transport, client, &response);
   }
   else
   {
@@ -275,11 +307,16 @@ std::string CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer
     hasResponse = true;
   }
 
-  std::string str = hasResponse ? CJSONVariantWriter::Write(outputroot, g_advancedSettings.m_jsonOutputCompact) : "";
-  return str;
+  // streamed items are only written into a successful result which still contains their list
+  const CVariant &output = outputroot;
+  if (response.m_items.get() != NULL &&
+     (!hasResponse || !output.isMember("result") || !output["result"].isObject() || !output["result"].isMember(response.m_member)))
+    response.m_items.reset();
+
+  return hasResponse;
 }
 
-bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client)
+bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client, CJSONRPCResponse *streamed /* = NULL */)
 {
   JSONRPC_STATUS errorCode = OK;
   CVariant result;
@@ -296,7 +333,28 @@ bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITr
     CVariant params;
 
     if ((errorCode = CJSONServiceDescription::CheckCall(methodName.c_str(), request["params"], transport, client, isNotification, method, params)) == OK)
-      errorCode = method(methodName, transport, client, params, result);
+    {
+      CJSONRPCResultCache &resultCache = CJSONRPCResultCache::GetInstance();
+      bool cacheable = CJSONRPCResultCache::IsCacheable(methodName, params);
+      unsigned int generation = 0;
+
+      if (cacheable && resultCache.Get(methodName, params, result, generation))
+        errorCode = OK;
+      else
+      {
+        StreamContext context = { &result, streamed };
+        if (streamed != NULL)
+          streamContext.set(&context);
+
+        errorCode = method(methodName, transport, client, params, result);
+
+        if (streamed != NULL)
+          streamContext.set(NULL);
+
+        if (cacheable && errorCode == OK)
+          resultCache.Set(methodName, params, result, generation);
+      }
+    }
     else
       result = params;
   }
@@ -361,3 +419,118 @@ inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code
       break;
   }
 }
+
+CJSONRPCResponse::CJSONRPCResponse()
+  : m_state(StateDone)
+{ }
+
+bool CJSONRPCResponse::CanStreamItems(const CVariant &result)
+{
+  StreamContext *context = streamContext.get();
+  return context != NULL && context->result == &result && context->response->m_items.get() == NULL;
+}
+
+void CJSONRPCResponse::StreamItems(const CVariant &result, const std::string &member, IResultItems *items)
+{
+  if (!CanStreamItems(result))
+  {
+    delete items;
+    return;
+  }
+
+  CJSONRPCResponse *response = streamContext.get()->response;
+  response->m_member = member;
+  response->m_items.reset(items);
+}
+
+void CJSONRPCResponse::Reset(bool compact)
+{
+  m_response = CVariant();
+  m_member.clear();
+  m_items.reset();
+  m_writer.reset(new CJSONVariantWriter(compact));
+  m_state = StateStart;
+}
+
+bool CJSONRPCResponse::Read(std::string &output, size_t size)
+{
+  if (m_state == StateDone)
+    return false;
+
+  if (m_state == StateStart)
+  {
+    if (m_items.get() == NULL)
+    {
+      if (m_writer->WriteValue(m_response))
+        m_writer->TakeOutput(output);
+      m_state = StateDone;
+      return true;
+    }
+
+    if (!WriteStart())
+    {
+      CLog::Log(LOGERROR, "JSONRPC: Failed to write the response");
+      m_state = StateDone;
+      return true;
+    }
+    m_state = StateItems;
+  }
+
+  while (m_state == StateItems && m_writer->GetOutputSize() < size)
+  {
+    CVariant item;
+    bool ok;
+    if (m_items->GetNext(item))
+      ok = m_writer->WriteValue(item);
+    else
+    {
+      ok = WriteEnd();
+      m_state = StateDone;
+    }
+
+    if (!ok)
+    {
+      CLog::Log(LOGERROR, "JSONRPC: Failed to write the items of \"%s\"", m_member.c_str());
+      m_state = StateDone;
+    }
+  }
+
+  m_writer->TakeOutput(output);
+  return true;
+}
+
+bool CJSONRPCResponse::WriteStart()
+{
+  const CVariant &response = m_response;
+
+  bool ok = m_writer->OpenObject();
+  for (m_responseMember = response.begin_map(); ok && m_responseMember != response.end_map() && m_responseMember->first != "result"; ++m_responseMember)
+    ok = m_writer->WriteKey(m_responseMember->first) && m_writer->WriteValue(m_responseMember->second);
+  if (!ok || m_responseMember == response.end_map())
+    return false;
+
+  const CVariant &result = m_responseMember->second;
+  ok = m_writer->WriteKey(m_responseMember->first) && m_writer->OpenObject();
+  for (m_resultMember = result.begin_map(); ok && m_resultMember != result.end_map() && m_resultMember->first != m_member; ++m_resultMember)
+    ok = m_writer->WriteKey(m_resultMember->first) && m_writer->WriteValue(m_resultMember->second);
+  if (!ok || m_resultMember == result.end_map())
+    return false;
+
+  return m_writer->WriteKey(m_member) && m_writer->OpenArray();
+}
+
+bool CJSONRPCResponse::WriteEnd()
+{
+  const CVariant &response = m_response;
+  const CVariant &result = m_responseMember->second;
+
+  bool ok = m_writer->CloseArray();
+  for (++m_resultMember; ok && m_resultMember != result.end_map(); ++m_resultMember)
+    ok = m_writer->WriteKey(m_resultMember->first) && m_writer->WriteValue(m_resultMember->second);
+  ok = ok && m_writer->CloseObject();
+
+  for (++m_responseMember; ok && m_responseMember != response.end_map(); ++m_responseMember)
+    ok = m_writer->WriteKey(m_responseMember->first) && m_writer->WriteValue(m_responseMember->second);
+
+  return ok && m_writer->CloseObject();
+}
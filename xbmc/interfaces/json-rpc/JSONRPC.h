@@ -21,16 +21,101 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
 #include <stdio.h>
 #include <string>
 
 #include "JSONRPCUtils.h"
 #include "JSONServiceDescription.h"
-
-class CVariant;
+#include "utils/JSONVariantWriter.h"
+#include "utils/Variant.h"
 
 namespace JSONRPC
 {
+  /*!
+   \ingroup jsonrpc
+   \brief Items of a list result which are serialized while the response is written
+   */
+  class IResultItems
+  {
+  public:
+    virtual ~IResultItems() { }
+
+    /*!
+     \brief Serialize the next item
+     \return false once all items were returned
+     */
+    virtual bool GetNext(CVariant &item) = 0;
+  };
+
+  /*!
+   \ingroup jsonrpc
+   \brief JSON-RPC response which is written piece by piece
+
+   A method called for a single request may hand over the items of a list in
+   its result with StreamItems() instead of serializing all of them up front.
+   The response then only holds the items which are currently written, so
+   large lists neither need the serialized list nor the whole response text
+   in memory and the first bytes can be sent right away.
+   */
+  class CJSONRPCResponse
+  {
+  public:
+    CJSONRPCResponse();
+
+    /*!
+     \brief Whether the items of a list in the given result can be streamed
+     \param result Result object a method is filling
+     */
+    static bool CanStreamItems(const CVariant &result);
+
+    /*!
+     \brief Let the response serialize the list in the given result member item by item
+     \param result Result object a method is filling, CanStreamItems() must be true
+     \param member Name of the list in the result, it is written in place of the (empty) member
+     \param items Serializes the items, ownership is passed to the response
+     */
+    static void StreamItems(const CVariant &result, const std::string &member, IResultItems *items);
+
+    /*!
+     \brief Whether the response contains a list which is serialized while it is written
+     */
+    bool IsStreamed() const { return m_items.get() != NULL; }
+
+    /*!
+     \brief Write the next part of the response
+     \param output The text is appended to output
+     \param size Number of bytes to write at least unless the response ends, an item is never split
+     \return false if the whole response had already been written
+     */
+    bool Read(std::string &output, size_t size);
+
+  private:
+    friend class CJSONRPC;
+
+    CJSONRPCResponse(const CJSONRPCResponse&);
+    CJSONRPCResponse& operator=(const CJSONRPCResponse&);
+
+    void Reset(bool compact);
+    bool WriteStart();
+    bool WriteEnd();
+
+    enum State
+    {
+      StateStart,
+      StateItems,
+      StateDone
+    };
+
+    CVariant m_response;
+    std::string m_member;
+    std::unique_ptr<IResultItems> m_items;
+    std::unique_ptr<CJSONVariantWriter> m_writer;
+    State m_state;
+    CVariant::const_iterator_map m_responseMember;
+    CVariant::const_iterator_map m_resultMember;
+  };
+
   /*!
    \ingroup jsonrpc
    \brief JSON RPC handler
@@ -64,6 +149,18 @@ namespace JSONRPC
      */
     static std::string MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client);
 
+    /*
+     \brief Handles an incoming JSON-RPC request
+     \param inputString received JSON-RPC request
+     \param transport Transport protocol on which the request arrived
+     \param client Client which sent the request
+     \param response JSON-RPC response to be sent back to the client, to be read with Read()
+     \return true if there is a response to send
+
+     Same as the above but the response is written while it is sent.
+     */
+    static bool MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client, CJSONRPCResponse &response);
+
     static JSONRPC_STATUS Introspect(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Version(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Permission(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
@@ -74,7 +171,7 @@ namespace JSONRPC
   
   private:
     static void setup();
-    static bool HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client);
+    static bool HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client, CJSONRPCResponse *streamed = NULL);
     static inline bool IsProperJSONRPC(const CVariant& inputroot);
 
     inline static void BuildResponse(const CVariant& request, JSONRPC_STATUS code, const CVariant& result, CVariant& response);
@@ -0,0 +1,144 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "JSONRPCResultCache.h"
+#include "interfaces/AnnouncementManager.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+
+#define RESULT_CACHE_SIZE 16
+
+using namespace JSONRPC;
+
+CJSONRPCResultCache::CJSONRPCResultCache()
+  : m_generation(0),
+    m_initialized(false)
+{ }
+
+CJSONRPCResultCache& CJSONRPCResultCache::GetInstance()
+{
+  static CJSONRPCResultCache resultCache;
+  return resultCache;
+}
+
+void CJSONRPCResultCache::Initialize()
+{
+  {
+    CSingleLock lock(m_critSection);
+    if (m_initialized)
+      return;
+    m_initialized = true;
+  }
+
+  // announcers are called with the announcement manager locked, so don't hold our lock here.
+  // results are dropped before the announcement is delivered to clients which may request them again
+  ANNOUNCEMENT::CAnnouncementManager::GetInstance().AddAnnouncer(this, true);
+}
+
+void CJSONRPCResultCache::Deinitialize()
+{
+  {
+    CSingleLock lock(m_critSection);
+    if (!m_initialized)
+      return;
+    m_entries.clear();
+    m_generation++;
+    m_initialized = false;
+  }
+
+  ANNOUNCEMENT::CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
+}
+
+bool CJSONRPCResultCache::IsCacheable(const std::string &method, const CVariant &parameters)
+{
+  if (g_advancedSettings.m_jsonResultCacheTime == 0)
+    return false;
+
+  if (method == "player.getactiveplayers" || method == "player.getitem" ||
+      method == "application.getproperties")
+    return true;
+
+  if (method == "player.getproperties")
+  {
+    // the playing time changes without being announced
+    const CVariant &properties = parameters["properties"];
+    for (CVariant::const_iterator_array itr = properties.begin_array(); itr != properties.end_array(); ++itr)
+    {
+      std::string property = itr->asString();
+      if (property == "time" || property == "percentage" || property == "totaltime")
+        return false;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+bool CJSONRPCResultCache::Get(const std::string &method, const CVariant &parameters, CVariant &result, unsigned int &generation)
+{
+  CSingleLock lock(m_critSection);
+  generation = m_generation;
+  if (!m_initialized)
+    return false;
+
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  for (std::deque<CacheEntry>::iterator itr = m_entries.begin(); itr != m_entries.end(); ++itr)
+  {
+    if (itr->method != method || !(itr->parameters == parameters))
+      continue;
+
+    if (now - itr->time >= g_advancedSettings.m_jsonResultCacheTime)
+    {
+      m_entries.erase(itr);
+      return false;
+    }
+
+    result = itr->result;
+    return true;
+  }
+
+  return false;
+}
+
+void CJSONRPCResultCache::Set(const std::string &method, const CVariant &parameters, const CVariant &result, unsigned int generation)
+{
+  CSingleLock lock(m_critSection);
+  // something changed while the result was retrieved
+  if (!m_initialized || generation != m_generation)
+    return;
+
+  if (m_entries.size() >= RESULT_CACHE_SIZE)
+    m_entries.pop_front();
+
+  CacheEntry entry;
+  entry.method = method;
+  entry.parameters = parameters;
+  entry.result = result;
+  entry.time = XbmcThreads::SystemClockMillis();
+  m_entries.push_back(entry);
+}
+
+void CJSONRPCResultCache::Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
+  CSingleLock lock(m_critSection);
+  m_entries.clear();
+  m_generation++;
+}
@@ -0,0 +1,90 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <string>
+
+#include "interfaces/IAnnouncer.h"
+#include "threads/CriticalSection.h"
+#include "utils/Variant.h"
+
+namespace JSONRPC
+{
+  /*!
+   \ingroup jsonrpc
+   \brief Results of read-only methods which remotes poll
+
+   Remotes call methods like Player.GetActivePlayers or Player.GetProperties
+   several times a second. Their results are kept for a short time
+   (<jsonrpc><resultcachetime> in advancedsettings.xml) and are dropped as
+   soon as anything is announced, so a change is never hidden from a remote
+   which was notified about it.
+   */
+  class CJSONRPCResultCache : public ANNOUNCEMENT::IAnnouncer
+  {
+  public:
+    static CJSONRPCResultCache& GetInstance();
+
+    void Initialize();
+    void Deinitialize();
+
+    /*!
+     \brief Whether the result of the given call may be cached
+     \param method Lower case name of the method
+     \param parameters Checked parameters of the call
+     */
+    static bool IsCacheable(const std::string &method, const CVariant &parameters);
+
+    /*!
+     \brief Get the cached result of a call
+     \param generation Set to the current generation which is passed to Set()
+     \return True if a result was found
+     */
+    bool Get(const std::string &method, const CVariant &parameters, CVariant &result, unsigned int &generation);
+
+    /*!
+     \brief Cache the result of a call unless something was announced since
+     the given generation was returned by Get()
+     */
+    void Set(const std::string &method, const CVariant &parameters, const CVariant &result, unsigned int generation);
+
+    virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+
+  private:
+    CJSONRPCResultCache();
+    virtual ~CJSONRPCResultCache() { }
+    CJSONRPCResultCache(const CJSONRPCResultCache&);
+    CJSONRPCResultCache const& operator=(CJSONRPCResultCache const&);
+
+    typedef struct
+    {
+      std::string method;
+      CVariant parameters;
+      CVariant result;
+      unsigned int time;
+    } CacheEntry;
+
+    CCriticalSection m_critSection;
+    std::deque<CacheEntry> m_entries;
+    unsigned int m_generation;
+    bool m_initialized;
+  };
+}
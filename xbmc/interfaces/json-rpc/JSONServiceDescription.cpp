@@ -591,6 +591,7 @@ bool JSONSchemaTypeDefinition::Parse(const CVariant &value, bool isParameter /*
       if (approved)
         enums.push_back(*enumItr);
     }
+    compileEnums();
   }
 
   if (type != ObjectValue)
@@ -641,9 +642,21 @@ bool JSONSchemaTypeDefinition::Parse(const CVariant &value, bool isParameter /*
 
 JSONRPC_STATUS JSONSchemaTypeDefinition::Check(const CVariant &value, CVariant &outputValue, CVariant &errorData)
 {
-  if (!name.empty())
-    errorData["name"] = name;
-  SchemaValueTypeToJson(type, errorData["type"]);
+  JSONRPC_STATUS status = check(value, outputValue, errorData);
+
+  // the error data is only filled in for invalid values, valid ones are checked far more often
+  if (status != OK)
+  {
+    if (!name.empty())
+      errorData["name"] = name;
+    SchemaValueTypeToJson(type, errorData["type"]);
+  }
+
+  return status;
+}
+
+JSONRPC_STATUS JSONSchemaTypeDefinition::check(const CVariant &value, CVariant &outputValue, CVariant &errorData)
+{
   std::string errorMessage;
 
   if (referencedType != NULL && !referencedTypeSet)
@@ -910,12 +923,17 @@ JSONRPC_STATUS JSONSchemaTypeDefinition::Check(const CVariant &value, CVariant &
   if (enums.size() > 0)
   {
     bool valid = false;
-    for (std::vector<CVariant>::const_iterator enumItr = enums.begin(); enumItr != enums.end(); ++enumItr)
+    if (value.isString())
+      valid = enumStrings.find(value.asString()) != enumStrings.end();
+    else
     {
-      if (*enumItr == value)
+      for (std::vector<CVariant>::const_iterator enumItr = enums.begin(); enumItr != enums.end(); ++enumItr)
       {
-        valid = true;
-        break;
+        if (*enumItr == value)
+        {
+          valid = true;
+          break;
+        }
       }
     }
 
@@ -1145,6 +1163,16 @@ void JSONSchemaTypeDefinition::Print(bool isParameter, bool isGlobal, bool print
   }
 }
 
+void JSONSchemaTypeDefinition::compileEnums()
+{
+  enumStrings.clear();
+  for (std::vector<CVariant>::const_iterator enumItr = enums.begin(); enumItr != enums.end(); ++enumItr)
+  {
+    if (enumItr->isString())
+      enumStrings.insert(enumItr->asString());
+  }
+}
+
 void JSONSchemaTypeDefinition::Set(const JSONSchemaTypeDefinitionPtr typeDefinition)
 {
   if (typeDefinition.get() == NULL)
@@ -1370,7 +1398,7 @@ JSONRPC_STATUS JsonRpcMethod::checkParameter(const CVariant &requestParameters,
   if (ParameterExists(requestParameters, type->name, position))
   {
     // Get the parameter
-    CVariant parameterValue = GetParameter(requestParameters, type->name, position);
+    const CVariant &parameterValue = IsValueMember(requestParameters, type->name) ? requestParameters[type->name] : requestParameters[position];
 
     // Evaluate the type of the parameter
     JSONRPC_STATUS status = type->Check(parameterValue, outputParameters[type->name], errorData["stack"]);
@@ -1640,6 +1668,7 @@ bool CJSONServiceDescription::AddEnum(const std::string &name, const std::vector
       return false;
   }
   definition->enums.insert(definition->enums.begin(), values.begin(), values.end());
+  definition->compileEnums();
 
   int schemaType = (int)AnyValue;
   for (unsigned int index = 0; index < types.size(); index++)
@@ -19,6 +19,7 @@
  *
  */
 
+#include <set>
 #include <string>
 #include <vector>
 #include <limits>
@@ -51,6 +52,11 @@ namespace JSONRPC
     JSONRPC_STATUS Check(const CVariant &value, CVariant &outputValue, CVariant &errorData);
     void Print(bool isParameter, bool isGlobal, bool printDefault, bool printDescriptions, CVariant &output) const;
     void Set(const JSONSchemaTypeDefinitionPtr typeDefinition);
+
+    /*!
+     \brief Rebuilds enumStrings after enums changed
+     */
+    void compileEnums();
     
     std::string missingReference;
 
@@ -158,6 +164,12 @@ namespace JSONRPC
      */
     std::vector<CVariant> enums;
 
+    /*!
+     \brief The string values of enums for
+     looking up received values
+     */
+    std::set<std::string> enumStrings;
+
     /*!
      \brief List of possible values in an array
      */
@@ -222,6 +234,9 @@ namespace JSONRPC
      \brief Type definition for additional properties
      */
     JSONSchemaTypeDefinitionPtr additionalProperties;
+
+  private:
+    JSONRPC_STATUS check(const CVariant &value, CVariant &outputValue, CVariant &errorData);
   };
 
   /*! 
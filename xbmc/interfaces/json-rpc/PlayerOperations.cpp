@@ -40,6 +40,7 @@
 #include "pvr/channels/PVRChannelGroupsContainer.h"
 #include "pvr/recordings/PVRRecordings.h"
 #include "cores/IPlayer.h"
+#include "cores/VideoRenderers/RenderManager.h"
 #include "cores/playercorefactory/PlayerCoreConfig.h"
 #include "cores/playercorefactory/PlayerCoreFactory.h"
 #include "utils/SeekHandler.h"
@@ -1631,6 +1632,22 @@ JSONRPC_STATUS CPlayerOperations::GetPropertyValue(PlayerType player, const std:
   }
   else if (property == "live")
     result = IsPVRChannel();
+  else if (property == "renderstats")
+  {
+    switch (player)
+    {
+      case Video:
+        result = CVariant(CVariant::VariantTypeObject);
+        g_renderManager.SerializeFrameStats(result);
+        break;
+
+      case Audio:
+      case Picture:
+      default:
+        result = CVariant(CVariant::VariantTypeNull);
+        break;
+    }
+  }
   else
     return InvalidParams;
 
@@ -37,31 +37,16 @@ JSONRPC_STATUS CProfilesOperations::GetProfiles(const std::string &method, ITran
     const CProfile *profile = CProfilesManager::GetInstance().GetProfile(i);
     CFileItemPtr item(new CFileItem(profile->getName()));
     item->SetArt("thumb", profile->getThumb());
+    // returned as the "lockmode" property by HandleFileItemList()
+    if (i == 0)
+      item->SetProperty("lockmode", CProfilesManager::GetInstance().GetMasterProfile().getLockMode());
+    else
+      item->SetProperty("lockmode", profile->getLockMode());
     listItems.Add(item);
   }
 
   HandleFileItemList("profileid", false, "profiles", listItems, parameterObject, result);
 
-  for (CVariant::const_iterator_array propertyiter = parameterObject["properties"].begin_array(); propertyiter != parameterObject["properties"].end_array(); ++propertyiter)
-  {
-    if (propertyiter->isString() &&
-        propertyiter->asString() == "lockmode")
-    {
-      for (CVariant::iterator_array profileiter = result["profiles"].begin_array(); profileiter != result["profiles"].end_array(); ++profileiter)
-      {
-        std::string profilename = (*profileiter)["label"].asString();
-        int index = CProfilesManager::GetInstance().GetProfileIndex(profilename);
-        const CProfile *profile = CProfilesManager::GetInstance().GetProfile(index);
-        LockType locktype = LOCK_MODE_UNKNOWN;
-        if (index == 0)
-          locktype = CProfilesManager::GetInstance().GetMasterProfile().getLockMode();
-        else
-          locktype = profile->getLockMode();
-        (*profileiter)["lockmode"] = locktype;
-      }
-      break;
-    }
-  }
   return OK;
 }
 
@@ -33,7 +33,6 @@
 #include "XBPython.h"
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
-#include "utils/JSONVariantWriter.h"
 #include "utils/log.h"
 #include "utils/Variant.h"
 #include "Util.h"
@@ -84,6 +83,15 @@ XBPython::~XBPython()
 
 void XBPython::Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
 {
+  OnAnnouncement(CAnnouncement(flag, sender, message, data));
+}
+
+void XBPython::OnAnnouncement(const CAnnouncement &announcement)
+{
+  AnnouncementFlag flag = announcement.GetFlag();
+  const char *sender = announcement.GetSender().c_str();
+  const char *message = announcement.GetMessage().c_str();
+
   if (flag & VideoLibrary)
   {
    if (strcmp(message, "OnScanFinished") == 0)
@@ -118,7 +126,7 @@ void XBPython::Announce(AnnouncementFlag flag, const char *sender, const char *m
      OnDPMSActivated();
   }
 
-  OnNotification(sender, std::string(ANNOUNCEMENT::AnnouncementFlagToString(flag)) + "." + std::string(message), CJSONVariantWriter::Write(data, g_advancedSettings.m_jsonOutputCompact));
+  OnNotification(sender, std::string(ANNOUNCEMENT::AnnouncementFlagToString(flag)) + "." + std::string(message), announcement.GetDataAsJSON(g_advancedSettings.m_jsonOutputCompact));
 }
 
 // message all registered callbacks that we started playing
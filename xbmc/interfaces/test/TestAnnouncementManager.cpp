@@ -0,0 +1,254 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include "interfaces/AnnouncementManager.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/Variant.h"
+
+#include "gtest/gtest.h"
+
+using namespace ANNOUNCEMENT;
+
+namespace
+{
+  class CTestAnnouncer : public IAnnouncer
+  {
+  public:
+    // unblock is the event a blocked announcement waits for, pass one which outlives the announcer if it's deleted
+    CTestAnnouncer(CEvent *unblock = NULL)
+      : m_block(false),
+        m_unblock(unblock ? *unblock : m_ownUnblock)
+    { }
+
+    virtual void Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+    {
+      std::string announcement = message;
+      if (data.isInteger())
+        announcement += ":" + std::to_string(data.asInteger());
+
+      {
+        CSingleLock lock(m_critSection);
+        m_announcements.push_back(announcement);
+        m_threads.push_back(CThread::GetCurrentThreadId());
+      }
+
+      if (announcement == "Block" && m_block)
+      {
+        m_blocked.Set();
+        m_unblock.WaitMSec(10000);
+      }
+      else if (announcement == "Done")
+        m_done.Set();
+    }
+
+    std::vector<std::string> GetAnnouncements()
+    {
+      CSingleLock lock(m_critSection);
+      return m_announcements;
+    }
+
+    std::vector<ThreadIdentifier> GetThreads()
+    {
+      CSingleLock lock(m_critSection);
+      return m_threads;
+    }
+
+    bool m_block;
+    CEvent m_blocked;
+    CEvent m_done;
+    CEvent &m_unblock;
+
+  private:
+    CEvent m_ownUnblock;
+    CCriticalSection m_critSection;
+    std::vector<std::string> m_announcements;
+    std::vector<ThreadIdentifier> m_threads;
+  };
+
+  // removes an announcer and optionally deletes it, as announcers destroyed with their owner do
+  class CRemoveAnnouncer : public IRunnable
+  {
+  public:
+    CRemoveAnnouncer(CTestAnnouncer *announcer, bool destroy)
+      : m_announcer(announcer),
+        m_destroy(destroy)
+    { }
+
+    virtual void Run()
+    {
+      CAnnouncementManager::GetInstance().RemoveAnnouncer(m_announcer);
+      if (m_destroy)
+        delete m_announcer;
+      m_removed.Set();
+    }
+
+    CTestAnnouncer *m_announcer;
+    bool m_destroy;
+    CEvent m_removed;
+  };
+
+  void Announce(AnnouncementFlag flag, const char *message, int value)
+  {
+    CVariant data(value);
+    CAnnouncementManager::GetInstance().Announce(flag, "test", message, data);
+  }
+}
+
+class TestAnnouncementManager : public testing::Test
+{
+protected:
+  TestAnnouncementManager()
+  {
+    CAnnouncementManager::GetInstance().Start();
+  }
+
+  ~TestAnnouncementManager()
+  {
+    CAnnouncementManager::GetInstance().Deinitialize();
+  }
+};
+
+TEST_F(TestAnnouncementManager, Dispatch)
+{
+  CTestAnnouncer synchronous, dispatched;
+  dispatched.m_block = true;
+  CAnnouncementManager::GetInstance().AddAnnouncer(&synchronous, true);
+  CAnnouncementManager::GetInstance().AddAnnouncer(&dispatched);
+
+  // announcing doesn't wait for the dispatched announcer
+  CAnnouncementManager::GetInstance().Announce(Other, "test", "Block");
+  ASSERT_TRUE(dispatched.m_blocked.WaitMSec(5000));
+  for (int i = 0; i < 3; i++)
+    Announce(Player, "OnPlay", i);
+  CAnnouncementManager::GetInstance().Announce(Other, "test", "Done");
+
+  std::vector<std::string> announcements = synchronous.GetAnnouncements();
+  ASSERT_EQ(5U, announcements.size());
+  std::vector<ThreadIdentifier> threads = synchronous.GetThreads();
+  for (size_t i = 0; i < threads.size(); i++)
+    EXPECT_TRUE(threads[i] == CThread::GetCurrentThreadId());
+  EXPECT_EQ(1U, dispatched.GetAnnouncements().size());
+
+  dispatched.m_unblock.Set();
+  ASSERT_TRUE(dispatched.m_done.WaitMSec(5000));
+
+  EXPECT_EQ(announcements, dispatched.GetAnnouncements());
+  threads = dispatched.GetThreads();
+  for (size_t i = 0; i < threads.size(); i++)
+    EXPECT_FALSE(threads[i] == CThread::GetCurrentThreadId());
+
+  CAnnouncementManager::GetInstance().RemoveAnnouncer(&synchronous);
+  CAnnouncementManager::GetInstance().RemoveAnnouncer(&dispatched);
+}
+
+TEST_F(TestAnnouncementManager, Coalesce)
+{
+  CTestAnnouncer dispatched;
+  dispatched.m_block = true;
+  CAnnouncementManager::GetInstance().AddAnnouncer(&dispatched);
+
+  CAnnouncementManager::GetInstance().Announce(Other, "test", "Block");
+  ASSERT_TRUE(dispatched.m_blocked.WaitMSec(5000));
+
+  // only the latest volume is of interest
+  for (int i = 0; i < 20; i++)
+    Announce(Application, "OnVolumeChanged", i);
+  // the same announcement made again in a row is delivered once, the order of others is kept
+  Announce(Player, "OnPlay", 1);
+  Announce(Player, "OnPlay", 1);
+  Announce(Player, "OnPause", 1);
+  Announce(Player, "OnPlay", 1);
+  // an item updated again while its update is queued is delivered once
+  for (int i = 0; i < 5; i++)
+    Announce(VideoLibrary, "OnUpdate", i % 2);
+  CAnnouncementManager::GetInstance().Announce(Other, "test", "Done");
+
+  dispatched.m_unblock.Set();
+  ASSERT_TRUE(dispatched.m_done.WaitMSec(5000));
+
+  std::vector<std::string> expected;
+  expected.push_back("Block");
+  expected.push_back("OnVolumeChanged:19");
+  expected.push_back("OnPlay:1");
+  expected.push_back("OnPause:1");
+  expected.push_back("OnPlay:1");
+  expected.push_back("OnUpdate:0");
+  expected.push_back("OnUpdate:1");
+  expected.push_back("Done");
+  EXPECT_EQ(expected, dispatched.GetAnnouncements());
+
+  CAnnouncementManager::GetInstance().RemoveAnnouncer(&dispatched);
+}
+
+TEST_F(TestAnnouncementManager, RemoveAnnouncer)
+{
+  CTestAnnouncer removed, other;
+  removed.m_block = true;
+  CAnnouncementManager::GetInstance().AddAnnouncer(&removed);
+  CAnnouncementManager::GetInstance().AddAnnouncer(&other);
+
+  CAnnouncementManager::GetInstance().Announce(Other, "test", "Block");
+  ASSERT_TRUE(removed.m_blocked.WaitMSec(5000));
+  Announce(Player, "OnPlay", 1);
+  CAnnouncementManager::GetInstance().Announce(Other, "test", "Done");
+
+  // waits for the announcement being delivered, what is still queued isn't delivered anymore
+  CRemoveAnnouncer remover(&removed, false);
+  CThread thread(&remover, "TestRemoveAnnouncer");
+  thread.Create();
+  EXPECT_FALSE(remover.m_removed.WaitMSec(200));
+  removed.m_unblock.Set();
+  EXPECT_TRUE(remover.m_removed.WaitMSec(5000));
+  thread.StopThread();
+  ASSERT_TRUE(other.m_done.WaitMSec(5000));
+
+  std::vector<std::string> announcements = removed.GetAnnouncements();
+  ASSERT_EQ(1U, announcements.size());
+  EXPECT_EQ("Block", announcements[0]);
+  EXPECT_EQ(3U, other.GetAnnouncements().size());
+
+  CAnnouncementManager::GetInstance().RemoveAnnouncer(&other);
+}
+
+TEST_F(TestAnnouncementManager, DeleteAnnouncer)
+{
+  CEvent unblock;
+  CTestAnnouncer *announcer = new CTestAnnouncer(&unblock);
+  announcer->m_block = true;
+  CAnnouncementManager::GetInstance().AddAnnouncer(announcer);
+
+  CAnnouncementManager::GetInstance().Announce(Other, "test", "Block");
+  ASSERT_TRUE(announcer->m_blocked.WaitMSec(5000));
+
+  // removing it waits for the announcement being delivered, so it isn't deleted while it is called
+  CRemoveAnnouncer remover(announcer, true);
+  CThread thread(&remover, "TestRemoveAnnouncer");
+  thread.Create();
+  EXPECT_FALSE(remover.m_removed.WaitMSec(200));
+
+  unblock.Set();
+  EXPECT_TRUE(remover.m_removed.WaitMSec(5000));
+  thread.StopThread();
+}
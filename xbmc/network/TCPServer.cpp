@@ -22,8 +22,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
+#include <algorithm>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#if defined(TARGET_LINUX)
+#include <sys/epoll.h>
+#endif
 
 #include "settings/AdvancedSettings.h"
 #include "interfaces/json-rpc/JSONRPC.h"
@@ -57,6 +61,38 @@ using namespace JSONRPC;
 using namespace ANNOUNCEMENT;
 
 #define RECEIVEBUFFER 1024
+#define RESPONSE_CHUNK_SIZE 16384
+#define SEND_QUEUE_LOW   65536           // more of a response is written while less is queued
+#define SEND_QUEUE_MAX   (4 * 1024 * 1024) // connections with more queued are dropped
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL // a remote which went away must not raise SIGPIPE
+#else
+#define SEND_FLAGS 0
+#endif
+
+#define SOCKET_EVENT_READ  0x1
+#define SOCKET_EVENT_WRITE 0x2
+#define SOCKET_EVENT_ERROR 0x4
+
+static bool SetNonBlocking(SOCKET socket)
+{
+#ifdef TARGET_WINDOWS
+  u_long nonblocking = 1;
+  return ioctlsocket(socket, FIONBIO, &nonblocking) == 0;
+#else
+  return fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK) == 0;
+#endif
+}
+
+static bool WouldBlock()
+{
+#ifdef TARGET_WINDOWS
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
 
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
@@ -100,118 +136,251 @@ CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("TCPServer")
   m_port = port;
   m_nonlocal = nonlocal;
   m_sdpd = NULL;
+#if defined(TARGET_LINUX)
+  m_epoll = -1;
+#endif
 }
 
 void CTCPServer::Process()
 {
   m_bStop = false;
 
+  std::vector<std::pair<SOCKET, int> > events;
   while (!m_bStop)
   {
-    SOCKET          max_fd = 0;
-    fd_set          rfds;
-    struct timeval  to     = {1, 0};
-    FD_ZERO(&rfds);
+    int res = WaitForEvents(events, 1000);
+    if (res < 0)
+    {
+      CLog::Log(LOGERROR, "JSONRPC Server: Waiting for socket events failed");
+      Sleep(1000);
+      Initialize();
+      continue;
+    }
 
-    for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+    for (std::vector<std::pair<SOCKET, int> >::const_iterator it = events.begin(); it != events.end(); ++it)
     {
-      FD_SET(*it, &rfds);
-      if ((intptr_t)*it > (intptr_t)max_fd)
-        max_fd = *it;
+      if (std::find(m_servers.begin(), m_servers.end(), it->first) == m_servers.end())
+        HandleConnection(it->first, it->second);
+      else if ((it->second & SOCKET_EVENT_READ) && !AcceptConnection(it->first))
+        break; // the servers were initialized again, the other events are outdated
     }
+  }
+
+  Deinitialize();
+}
+
+int CTCPServer::WaitForEvents(std::vector<std::pair<SOCKET, int> > &events, int timeout)
+{
+  events.clear();
 
-    for (unsigned int i = 0; i < m_connections.size(); i++)
+#if defined(TARGET_LINUX)
+  struct epoll_event ready[64];
+  int res = epoll_wait(m_epoll, ready, 64, timeout);
+  if (res < 0)
+    return errno == EINTR ? 0 : res;
+
+  for (int i = 0; i < res; i++)
+  {
+    int flags = 0;
+    if (ready[i].events & EPOLLIN)
+      flags |= SOCKET_EVENT_READ;
+    if (ready[i].events & EPOLLOUT)
+      flags |= SOCKET_EVENT_WRITE;
+    if (ready[i].events & (EPOLLERR | EPOLLHUP))
+      flags |= SOCKET_EVENT_ERROR;
+    events.push_back(std::make_pair((SOCKET)ready[i].data.fd, flags));
+  }
+  return res;
+#else
+  SOCKET         max_fd = 0;
+  fd_set         rfds, wfds;
+  FD_ZERO(&rfds);
+  FD_ZERO(&wfds);
+
+  for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+  {
+    FD_SET(*it, &rfds);
+    if ((intptr_t)*it > (intptr_t)max_fd)
+      max_fd = *it;
+  }
+
+  for (std::map<SOCKET, CTCPClient*>::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+  {
+    int flags;
     {
-      FD_SET(m_connections[i]->m_socket, &rfds);
-      if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
-        max_fd = m_connections[i]->m_socket;
+      CSingleLock lock(it->second->m_critSection);
+      flags = it->second->GetEvents();
     }
+    if (flags & SOCKET_EVENT_READ)
+      FD_SET(it->first, &rfds);
+    if (flags & SOCKET_EVENT_WRITE)
+      FD_SET(it->first, &wfds);
+    if ((intptr_t)it->first > (intptr_t)max_fd)
+      max_fd = it->first;
+  }
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
-    if (res < 0)
+  // announcements queued by other threads can't wake up select(), look for them often
+  struct timeval to = { 0, std::min(timeout, 200) * 1000 };
+  int res = select((intptr_t)max_fd + 1, &rfds, &wfds, NULL, &to);
+  if (res <= 0)
+    return res;
+
+  for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+  {
+    if (FD_ISSET(*it, &rfds))
+      events.push_back(std::make_pair(*it, SOCKET_EVENT_READ));
+  }
+
+  for (std::map<SOCKET, CTCPClient*>::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+  {
+    int flags = 0;
+    if (FD_ISSET(it->first, &rfds))
+      flags |= SOCKET_EVENT_READ;
+    if (FD_ISSET(it->first, &wfds))
+      flags |= SOCKET_EVENT_WRITE;
+    if (flags != 0)
+      events.push_back(std::make_pair(it->first, flags));
+  }
+  return res;
+#endif
+}
+
+void CTCPServer::SetEvents(SOCKET socket, int events)
+{
+#if defined(TARGET_LINUX)
+  // epoll may be changed while the server thread waits for it
+  struct epoll_event event = {};
+  event.data.fd = socket;
+  if (events & SOCKET_EVENT_READ)
+    event.events |= EPOLLIN;
+  if (events & SOCKET_EVENT_WRITE)
+    event.events |= EPOLLOUT;
+  epoll_ctl(m_epoll, EPOLL_CTL_MOD, socket, &event);
+#endif
+}
+
+bool CTCPServer::AcceptConnection(SOCKET server)
+{
+  CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
+  CTCPClient *newconnection = new CTCPClient();
+  newconnection->m_socket = accept(server, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+
+  if (newconnection->m_socket == INVALID_SOCKET)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
+    delete newconnection;
+    if (EBADF == errno)
     {
-      CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
       Sleep(1000);
       Initialize();
+      return false;
     }
-    else if (res > 0)
-    {
-      for (int i = m_connections.size() - 1; i >= 0; i--)
-      {
-        int socket = m_connections[i]->m_socket;
-        if (FD_ISSET(socket, &rfds))
-        {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          bool close = false;
-          if (nread > 0)
-          {
-            std::string response;
-            if (m_connections[i]->IsNew())
-            {
-              CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
-
-              if (response.size() > 0)
-                m_connections[i]->Send(response.c_str(), response.size());
-
-              if (websocket != NULL)
-              {
-                // Replace the CTCPClient with a CWebSocketClient
-                CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
-                delete m_connections[i];
-                m_connections.erase(m_connections.begin() + i);
-                m_connections.insert(m_connections.begin() + i, websocketClient);
-              }
-            }
+    return true;
+  }
 
-            if (response.size() <= 0)
-              m_connections[i]->PushBuffer(this, buffer, nread);
+  if (!SetNonBlocking(newconnection->m_socket))
+    CLog::Log(LOGWARNING, "JSONRPC Server: Failed to make new connection non-blocking");
+  newconnection->m_server = this;
 
-            close = m_connections[i]->Closing();
-          }
-          else
-            close = true;
+#if defined(TARGET_LINUX)
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = newconnection->m_socket;
+  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, newconnection->m_socket, &event) < 0)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to watch new connection: %d", errno);
+    newconnection->Disconnect();
+    delete newconnection;
+    return true;
+  }
+#endif
 
-          if (close)
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i]->Disconnect();
-            delete m_connections[i];
-            m_connections.erase(m_connections.begin() + i);
-          }
-        }
-      }
+  CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+  CSingleLock lock(m_connectionsSection);
+  m_connections[newconnection->m_socket] = newconnection;
+  return true;
+}
 
-      for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+void CTCPServer::HandleConnection(SOCKET socket, int events)
+{
+  std::map<SOCKET, CTCPClient*>::iterator it = m_connections.find(socket);
+  if (it == m_connections.end())
+    return;
+
+  CTCPClient *client = it->second;
+  bool close = false;
+
+  if (events & SOCKET_EVENT_WRITE)
+    client->OnWritable(this);
+
+  if (events & (SOCKET_EVENT_READ | SOCKET_EVENT_ERROR))
+  {
+    char buffer[RECEIVEBUFFER] = {};
+    int  nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
+    if (nread > 0)
+    {
+      std::string response;
+      if (client->IsNew())
       {
-        if (FD_ISSET(*it, &rfds))
-        {
-          CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient *newconnection = new CTCPClient();
-          newconnection->m_socket = accept(*it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+        CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
+
+        if (response.size() > 0)
+          client->Send(response.c_str(), response.size());
 
-          if (newconnection->m_socket == INVALID_SOCKET)
+        if (websocket != NULL)
+        {
+          // Replace the CTCPClient with a CWebSocketClient
+          CWebSocketClient *websocketClient;
           {
-            CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
-            if (EBADF == errno)
+            CSingleLock lock(m_connectionsSection);
             {
-              Sleep(1000);
-              Initialize();
-              break;
+              CSingleLock clientLock(client->m_critSection);
+              websocketClient = new CWebSocketClient(websocket, *client);
             }
+            it->second = websocketClient;
           }
-          else
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
-            m_connections.push_back(newconnection);
-          }
+          delete client;
+          client = websocketClient;
         }
       }
+
+      if (response.size() <= 0)
+        client->PushBuffer(this, buffer, nread);
+
+      close = client->Closing();
     }
+    else
+      close = nread == 0 || !WouldBlock();
   }
 
-  Deinitialize();
+  if (close || client->Failed())
+  {
+    CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+    RemoveConnection(socket);
+  }
+}
+
+void CTCPServer::RemoveConnection(SOCKET socket)
+{
+  CTCPClient *client;
+  {
+    CSingleLock lock(m_connectionsSection);
+    std::map<SOCKET, CTCPClient*>::iterator it = m_connections.find(socket);
+    if (it == m_connections.end())
+      return;
+    client = it->second;
+    m_connections.erase(it);
+  }
+
+#if defined(TARGET_LINUX)
+  struct epoll_event event = {};
+  epoll_ctl(m_epoll, EPOLL_CTL_DEL, socket, &event);
+#endif
+
+  client->Disconnect();
+  // a websocket which didn't finish closing still has its socket
+  client->CTCPClient::Disconnect();
+  delete client;
 }
 
 bool CTCPServer::PrepareDownload(const char *path, CVariant &details, std::string &protocol)
@@ -231,17 +400,23 @@ int CTCPServer::GetCapabilities()
 
 void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
 {
-  std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact);
+  OnAnnouncement(CAnnouncement(flag, sender, message, data));
+}
+
+void CTCPServer::OnAnnouncement(const CAnnouncement &announcement)
+{
+  // serialized once for all connections, websocket frames are the same for all websocket connections
+  SendBuffer str(new std::string(IJSONRPCAnnouncer::AnnouncementToJSONRPC(announcement, g_advancedSettings.m_jsonOutputCompact)));
+  SendBuffer websocketFrame;
 
-  for (unsigned int i = 0; i < m_connections.size(); i++)
+  CSingleLock lock(m_connectionsSection);
+  for (std::map<SOCKET, CTCPClient*>::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
   {
-    {
-      CSingleLock lock (m_connections[i]->m_critSection);
-      if ((m_connections[i]->GetAnnouncementFlags() & flag) == 0)
-        continue;
-    }
+    CSingleLock clientLock(it->second->m_critSection);
+    if ((it->second->GetAnnouncementFlags() & announcement.GetFlag()) == 0)
+      continue;
 
-    m_connections[i]->Send(str.c_str(), str.size());
+    it->second->SendAnnouncement(str, websocketFrame);
   }
 }
 
@@ -249,11 +424,30 @@ bool CTCPServer::Initialize()
 {
   Deinitialize();
 
+#if defined(TARGET_LINUX)
+  m_epoll = epoll_create(64);
+  if (m_epoll < 0)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to create epoll instance: %d", errno);
+    return false;
+  }
+#endif
+
   bool started = false;
 
   started |= InitializeBlue();
   started |= InitializeTCP();
 
+#if defined(TARGET_LINUX)
+  for (std::vector<SOCKET>::const_iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+  {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = *it;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, *it, &event);
+  }
+#endif
+
   if (started)
   {
     CAnnouncementManager::GetInstance().AddAnnouncer(this);
@@ -448,8 +642,6 @@ bool CTCPServer::InitializeTCP()
 {
   SOCKET fd;
 
-  Deinitialize();
-
   if ((fd = CreateTCPServerSocket(m_port, !m_nonlocal, 10, "JSONRPC")) == INVALID_SOCKET)
     return false;
 
@@ -459,13 +651,19 @@ bool CTCPServer::InitializeTCP()
 
 void CTCPServer::Deinitialize()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
+  CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
+
   {
-    m_connections[i]->Disconnect();
-    delete m_connections[i];
-  }
+    CSingleLock lock(m_connectionsSection);
+    for (std::map<SOCKET, CTCPClient*>::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+    {
+      it->second->Disconnect();
+      it->second->CTCPClient::Disconnect();
+      delete it->second;
+    }
 
-  m_connections.clear();
+    m_connections.clear();
+  }
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
@@ -478,7 +676,11 @@ void CTCPServer::Deinitialize()
   m_sdpd = NULL;
 #endif
 
-  CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
+#if defined(TARGET_LINUX)
+  if (m_epoll >= 0)
+    close(m_epoll);
+  m_epoll = -1;
+#endif
 }
 
 CTCPServer::CTCPClient::CTCPClient()
@@ -486,10 +688,18 @@ CTCPServer::CTCPClient::CTCPClient()
   m_new = true;
   m_announcementflags = ANNOUNCE_ALL;
   m_socket = INVALID_SOCKET;
+  m_server = NULL;
   m_beginBrackets = 0;
   m_endBrackets = 0;
   m_beginChar = 0;
   m_endChar = 0;
+  m_sendOffset = 0;
+  m_queuedBytes = 0;
+  m_deferredBytes = 0;
+  m_responseFirst = false;
+  m_responseHasPart = false;
+  m_failed = false;
+  m_events = SOCKET_EVENT_READ;
 
   m_addrlen = sizeof(m_cliaddr);
 }
@@ -523,21 +733,169 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
-  unsigned int sent = 0;
-  do
+  Queue(SendBuffer(new std::string(data, size)));
+}
+
+void CTCPServer::CTCPClient::SendAnnouncement(const SendBuffer &message, SendBuffer &websocketFrame)
+{
+  Queue(message);
+}
+
+void CTCPServer::CTCPClient::Queue(const SendBuffer &buffer)
+{
+  CSingleLock lock (m_critSection);
+  if (m_failed || buffer->empty())
+    return;
+
+  // keep announcements from getting in between the parts of the response
+  if (m_response)
+  {
+    m_deferred.push_back(buffer);
+    m_deferredBytes += buffer->size();
+  }
+  else
+  {
+    m_sendQueue.push_back(buffer);
+    m_queuedBytes += buffer->size();
+  }
+
+  if (m_queuedBytes + m_deferredBytes > SEND_QUEUE_MAX)
+  {
+    CLog::Log(LOGWARNING, "JSONRPC Server: Connection does not read what is sent to it, dropping it");
+    m_failed = true;
+    // wakes up the server thread which closes the connection
+    shutdown(m_socket, SHUT_RDWR);
+    return;
+  }
+
+  SendQueued();
+  UpdateEvents();
+}
+
+void CTCPServer::CTCPClient::SendQueued()
+{
+  while (!m_sendQueue.empty() && !m_failed)
+  {
+    const std::string &buffer = *m_sendQueue.front();
+    int sent = send(m_socket, buffer.c_str() + m_sendOffset, buffer.size() - m_sendOffset, SEND_FLAGS);
+    if (sent < 0)
+    {
+      if (!WouldBlock())
+        m_failed = true;
+      break;
+    }
+
+    m_sendOffset += sent;
+    m_queuedBytes -= sent;
+    if (m_sendOffset < buffer.size())
+      break;
+
+    m_sendQueue.pop_front();
+    m_sendOffset = 0;
+  }
+}
+
+void CTCPServer::CTCPClient::UpdateEvents()
+{
+  // no new requests are read before the response to the last one is written
+  int events = 0;
+  if (!m_response || m_failed)
+    events |= SOCKET_EVENT_READ;
+  if (!m_sendQueue.empty() || m_response)
+    events |= SOCKET_EVENT_WRITE;
+
+  if (events != m_events)
+  {
+    m_events = events;
+    if (m_server != NULL)
+      m_server->SetEvents(m_socket, events);
+  }
+}
+
+void CTCPServer::CTCPClient::StartResponse(CJSONRPCResponse *response)
+{
+  CSingleLock lock (m_critSection);
+  m_response.reset(response);
+  m_responseFirst = true;
+  m_responseHasPart = false;
+
+  WriteResponse();
+  SendQueued();
+  UpdateEvents();
+}
+
+void CTCPServer::CTCPClient::WriteResponse()
+{
+  // only a part of the response is queued at a time, the rest is written once the client took it
+  while (m_response && m_queuedBytes < SEND_QUEUE_LOW)
+  {
+    std::string next;
+    bool more = m_response->Read(next, RESPONSE_CHUNK_SIZE);
+
+    // the previous part is only queued now that it is known whether it is the last one
+    if (m_responseHasPart)
+    {
+      QueueResponsePart(m_responsePart, m_responseFirst, !more);
+      m_responseFirst = false;
+    }
+    m_responsePart.swap(next);
+    m_responseHasPart = more;
+
+    if (!more)
+    {
+      m_response.reset();
+      m_responsePart.clear();
+      m_sendQueue.insert(m_sendQueue.end(), m_deferred.begin(), m_deferred.end());
+      m_deferred.clear();
+      m_queuedBytes += m_deferredBytes;
+      m_deferredBytes = 0;
+    }
+  }
+}
+
+void CTCPServer::CTCPClient::QueueResponsePart(const std::string &data, bool first, bool final)
+{
+  if (data.empty())
+    return;
+
+  m_sendQueue.push_back(SendBuffer(new std::string(data)));
+  m_queuedBytes += data.size();
+}
+
+void CTCPServer::CTCPClient::OnWritable(CTCPServer *host)
+{
+  bool done;
   {
     CSingleLock lock (m_critSection);
-    sent += send(m_socket, data + sent, size - sent, 0);
-  } while (sent < size);
+    bool responding = m_response.get() != NULL;
+
+    SendQueued();
+    WriteResponse();
+    SendQueued();
+    UpdateEvents();
+
+    done = responding && !m_response;
+  }
+
+  // requests which came in while the last response was written
+  if (done && !m_input.empty())
+    ProcessInput(host);
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
 {
   m_new = false;
 
-  for (int i = 0; i < length; i++)
+  m_input.append(buffer, length);
+  ProcessInput(host);
+}
+
+void CTCPServer::CTCPClient::ProcessInput(CTCPServer *host)
+{
+  size_t i = 0;
+  while (i < m_input.size() && !m_response)
   {
-    char c = buffer[i];
+    char c = m_input[i++];
 
     if (m_beginChar == 0 && c == '{')
     {
@@ -559,13 +917,19 @@ void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, in
         m_endBrackets++;
       if (m_beginBrackets > 0 && m_endBrackets > 0 && m_beginBrackets == m_endBrackets)
       {
-        std::string line = CJSONRPC::MethodCall(m_buffer, host, this);
-        Send(line.c_str(), line.size());
+        // the method is called without holding the lock, it may announce something
+        CJSONRPCResponse *response = new CJSONRPCResponse();
+        if (CJSONRPC::MethodCall(m_buffer, host, this, *response))
+          StartResponse(response);
+        else
+          delete response;
         m_beginChar = m_beginBrackets = m_endBrackets = 0;
         m_buffer.clear();
       }
     }
   }
+
+  m_input.erase(0, i);
 }
 
 void CTCPServer::CTCPClient::Disconnect()
@@ -573,6 +937,14 @@ void CTCPServer::CTCPClient::Disconnect()
   if (m_socket > 0)
   {
     CSingleLock lock (m_critSection);
+    // whatever the socket still takes, e.g. a websocket close frame
+    SendQueued();
+    m_response.reset();
+    m_sendQueue.clear();
+    m_deferred.clear();
+    m_queuedBytes = 0;
+    m_deferredBytes = 0;
+
     shutdown(m_socket, SHUT_RDWR);
     closesocket(m_socket);
     m_socket = INVALID_SOCKET;
@@ -585,12 +957,25 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_socket            = client.m_socket;
   m_cliaddr           = client.m_cliaddr;
   m_addrlen           = client.m_addrlen;
+  m_server            = client.m_server;
   m_announcementflags = client.m_announcementflags;
   m_beginBrackets     = client.m_beginBrackets;
   m_endBrackets       = client.m_endBrackets;
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_input             = client.m_input;
+  m_sendQueue         = client.m_sendQueue;
+  m_deferred          = client.m_deferred;
+  m_sendOffset        = client.m_sendOffset;
+  m_queuedBytes       = client.m_queuedBytes;
+  m_deferredBytes     = client.m_deferredBytes;
+  m_response          = client.m_response;
+  m_responsePart      = client.m_responsePart;
+  m_responseFirst     = client.m_responseFirst;
+  m_responseHasPart   = client.m_responseHasPart;
+  m_failed            = client.m_failed;
+  m_events            = client.m_events;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
@@ -624,15 +1009,42 @@ CTCPServer::CWebSocketClient& CTCPServer::CWebSocketClient::operator=(const CWeb
   return *this;
 }
 
+CTCPServer::SendBuffer CTCPServer::CWebSocketClient::GetFrame(WebSocketFrameOpcode opcode, const char *data, unsigned int size, bool first /* = true */, bool final /* = true */)
+{
+  SendBuffer buffer;
+  CWebSocketFrame *frame = m_websocket->GetFragment(opcode, data, (uint32_t)size, first, final);
+  if (frame != NULL)
+  {
+    buffer.reset(new std::string(frame->GetFrameData(), (size_t)frame->GetFrameLength()));
+    delete frame;
+  }
+
+  return buffer;
+}
+
 void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
 {
-  const CWebSocketMessage *msg = m_websocket->Send(WebSocketTextFrame, data, size);
-  if (msg == NULL || !msg->IsComplete())
-    return;
+  SendBuffer frame = GetFrame(WebSocketTextFrame, data, size);
+  if (frame)
+    Queue(frame);
+}
 
-  std::vector<const CWebSocketFrame *> frames = msg->GetFrames();
-  for (unsigned int index = 0; index < frames.size(); index++)
-    CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
+void CTCPServer::CWebSocketClient::SendAnnouncement(const SendBuffer &message, SendBuffer &websocketFrame)
+{
+  // frames sent by the server aren't masked so the frame fits every websocket connection
+  if (!websocketFrame)
+    websocketFrame = GetFrame(WebSocketTextFrame, message->c_str(), (unsigned int)message->size());
+
+  if (websocketFrame)
+    Queue(websocketFrame);
+}
+
+void CTCPServer::CWebSocketClient::QueueResponsePart(const std::string &data, bool first, bool final)
+{
+  // the response is sent as one text message made of the parts it is written in
+  SendBuffer frame = GetFrame(WebSocketTextFrame, data.c_str(), (unsigned int)data.size(), first, final);
+  if (frame)
+    CTCPClient::QueueResponsePart(*frame, first, final);
 }
 
 void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -647,8 +1059,9 @@ void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buff
       std::vector<const CWebSocketFrame *> frames = msg->GetFrames();
       if (send)
       {
+        // control frames created by the websocket are sent as they are
         for (unsigned int index = 0; index < frames.size(); index++)
-          Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
+          CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
       }
       else
       {
@@ -673,11 +1086,10 @@ void CTCPServer::CWebSocketClient::Disconnect()
     {
       const CWebSocketFrame *closeFrame = m_websocket->Close();
       if (closeFrame)
-        Send(closeFrame->GetFrameData(), (unsigned int)closeFrame->GetFrameLength());
+        CTCPClient::Send(closeFrame->GetFrameData(), (unsigned int)closeFrame->GetFrameLength());
     }
 
     if (m_websocket->GetState() == WebSocketStateClosed)
       CTCPClient::Disconnect();
   }
 }
-
@@ -19,6 +19,10 @@
  *
  */
 
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
 #include <vector>
 #include <sys/socket.h>
 
@@ -30,10 +34,25 @@
 #include "threads/Thread.h"
 #include "websocket/WebSocket.h"
 
+namespace JSONRPC
+{
+  class CJSONRPCResponse;
+}
+
 class CVariant;
 
 namespace JSONRPC
 {
+  /*!
+   \brief JSON-RPC server for raw TCP and websocket connections
+
+   One thread waits for all sockets (epoll where available, select otherwise)
+   and reads requests and writes responses without ever blocking on a single
+   connection. Everything sent to a connection goes through its send queue,
+   which is written whenever the socket takes more data. Announcements are
+   serialized once and only queued from the announcing thread, and a
+   connection which stops reading is dropped once its queue gets too long.
+   */
   class CTCPServer : public ITransportLayer, public JSONRPC::IJSONRPCAnnouncer, public CThread
   {
   public:
@@ -46,6 +65,7 @@ namespace JSONRPC
     virtual int GetCapabilities();
 
     virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+    virtual void OnAnnouncement(const ANNOUNCEMENT::CAnnouncement &announcement);
   protected:
     void Process();
   private:
@@ -55,6 +75,8 @@ namespace JSONRPC
     bool InitializeTCP();
     void Deinitialize();
 
+    typedef std::shared_ptr<const std::string> SendBuffer;
+
     class CTCPClient : public IClient
     {
     public:
@@ -70,25 +92,75 @@ namespace JSONRPC
       virtual bool SetAnnouncementFlags(int flags);
 
       virtual void Send(const char *data, unsigned int size);
+      virtual void SendAnnouncement(const SendBuffer &message, SendBuffer &websocketFrame);
       virtual void PushBuffer(CTCPServer *host, const char *buffer, int length);
       virtual void Disconnect();
 
       virtual bool IsNew() const { return m_new; }
       virtual bool Closing() const { return false; }
 
+      /*!
+       \brief Write as much as the socket takes, called when it is writable
+       */
+      void OnWritable(CTCPServer *host);
+
+      /*!
+       \brief Whether the connection has to be closed because it failed or
+       stopped reading what is sent to it
+       */
+      bool Failed() const { return m_failed; }
+
+      /*!
+       \brief Socket events (SOCKET_EVENT_*) the connection waits for
+       */
+      int GetEvents() const { return m_events; }
+
       SOCKET           m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t        m_addrlen;
       CCriticalSection m_critSection;
+      CTCPServer      *m_server;
 
     protected:
       void Copy(const CTCPClient& client);
+
+      /*!
+       \brief Queue a message, messages queued during a response follow it
+       */
+      void Queue(const SendBuffer &buffer);
+
+      /*!
+       \brief Queue one part of the current response
+       \param first Whether this is the first part of the response
+       \param final Whether this is the last part of the response
+       */
+      virtual void QueueResponsePart(const std::string &data, bool first, bool final);
+
     private:
+      void ProcessInput(CTCPServer *host);
+      void StartResponse(JSONRPC::CJSONRPCResponse *response);
+      void WriteResponse();
+      void SendQueued();
+      void UpdateEvents();
+
       bool m_new;
       int m_announcementflags;
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      std::string m_input;
+
+      std::deque<SendBuffer> m_sendQueue;
+      std::deque<SendBuffer> m_deferred;
+      size_t m_sendOffset;
+      size_t m_queuedBytes;   // bytes in m_sendQueue not sent yet
+      size_t m_deferredBytes; // bytes in m_deferred
+      std::shared_ptr<JSONRPC::CJSONRPCResponse> m_response;
+      std::string m_responsePart;
+      bool m_responseFirst;
+      bool m_responseHasPart;
+      bool m_failed;
+      int m_events;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -101,18 +173,34 @@ namespace JSONRPC
       ~CWebSocketClient();
 
       virtual void Send(const char *data, unsigned int size);
+      virtual void SendAnnouncement(const SendBuffer &message, SendBuffer &websocketFrame);
       virtual void PushBuffer(CTCPServer *host, const char *buffer, int length);
       virtual void Disconnect();
 
       virtual bool IsNew() const { return m_websocket == NULL; }
       virtual bool Closing() const { return m_websocket != NULL && m_websocket->GetState() == WebSocketStateClosed; }
 
+    protected:
+      virtual void QueueResponsePart(const std::string &data, bool first, bool final);
+
     private:
+      SendBuffer GetFrame(WebSocketFrameOpcode opcode, const char *data, unsigned int size, bool first = true, bool final = true);
+
       CWebSocket *m_websocket;
     };
 
-    std::vector<CTCPClient*> m_connections;
+    bool AcceptConnection(SOCKET server);
+    void HandleConnection(SOCKET socket, int events);
+    void RemoveConnection(SOCKET socket);
+    int  WaitForEvents(std::vector<std::pair<SOCKET, int> > &events, int timeout);
+    void SetEvents(SOCKET socket, int events);
+
+    std::map<SOCKET, CTCPClient*> m_connections;
+    CCriticalSection m_connectionsSection;
     std::vector<SOCKET> m_servers;
+#if defined(TARGET_LINUX)
+    int m_epoll;
+#endif
     int m_port;
     bool m_nonlocal;
     void* m_sdpd;
@@ -26,16 +26,21 @@
 
 #ifdef HAS_WEB_SERVER
 #include <algorithm>
+#include <limits>
 #include <memory>
 #include <stdexcept>
 #include <utility>
 
 #if defined(TARGET_POSIX)
+#include <fcntl.h>
 #include <pthread.h>
+#include <unistd.h>
 #endif
 
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "threads/SingleLock.h"
 #include "URL.h"
@@ -60,6 +65,9 @@
 
 #define MAX_POST_BUFFER_SIZE 2048
 
+#define FILE_BLOCK_SIZE       65536   // most MHD asks for at a time when sending a file
+#define FILE_READ_AHEAD_SIZE  262144  // files which aren't local are read in blocks of this size
+
 #define PAGE_FILE_NOT_FOUND "<html><head><title>File not found</title></head><body>File not found</body></html>"
 #define NOT_SUPPORTED       "<html><head><title>Not Supported</title></head><body>The method you are trying to use is not supported by this server</body></html>"
 
@@ -85,6 +93,9 @@ typedef struct {
   bool boundaryWritten;
   std::string contentType;
   uint64_t writePosition;
+  std::vector<char> readAhead;
+  uint64_t readAheadPosition;
+  size_t readAheadLength;
 } HttpFileDownloadContext;
 
 std::vector<IHTTPRequestHandler *> CWebServer::m_requestHandlers;
@@ -192,6 +203,26 @@ bool CWebServer::IsAuthenticated(CWebServer *server, struct MHD_Connection *conn
   return server->m_Credentials64Encoded.compare(StringUtils::Mid(authorization.c_str(), strlen(base))) == 0;
 }
 
+// checks whether one of the entity tags in the value of an If-None-Match header matches (weakly)
+static bool MatchesETag(const std::string &ifNoneMatch, const std::string &etag)
+{
+  std::string tag = StringUtils::StartsWith(etag, "W/") ? etag.substr(2) : etag;
+
+  std::vector<std::string> tags = StringUtils::Split(ifNoneMatch, ",");
+  for (std::vector<std::string>::iterator it = tags.begin(); it != tags.end(); ++it)
+  {
+    StringUtils::Trim(*it);
+    if (*it == "*")
+      return true;
+    if (StringUtils::StartsWith(*it, "W/"))
+      it->erase(0, 2);
+    if (*it == tag)
+      return true;
+  }
+
+  return false;
+}
+
 #if (MHD_VERSION >= 0x00040001)
 int CWebServer::AnswerToConnection(void *cls, struct MHD_Connection *connection,
                       const char *url, const char *method,
@@ -299,6 +330,29 @@ int CWebServer::AnswerToConnection(void *cls, struct MHD_Connection *connection,
                 cacheable = false;
             }
 
+            std::string etag;
+            bool hasETag = handler->GetETag(etag) && !etag.empty();
+
+            // handle If-None-Match which takes precedence over If-Modified-Since
+            std::string ifNoneMatch = GetRequestHeaderValue(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_NONE_MATCH);
+            if (cacheable && hasETag && !ifNoneMatch.empty())
+            {
+              if (MatchesETag(ifNoneMatch, etag))
+              {
+                struct MHD_Response *response = MHD_create_response_from_data(0, NULL, MHD_NO, MHD_NO);
+                if (response == NULL)
+                {
+                  CLog::Log(LOGERROR, "CWebServer: failed to create a HTTP 304 response");
+                  return MHD_NO;
+                }
+
+                return FinalizeRequest(handler, MHD_HTTP_NOT_MODIFIED, response);
+              }
+
+              // the client's copy is outdated, don't look at its date
+              cacheable = false;
+            }
+
             CDateTime lastModified;
             if (handler->GetLastModifiedDate(lastModified) && lastModified.IsValid())
             {
@@ -329,18 +383,27 @@ int CWebServer::AnswerToConnection(void *cls, struct MHD_Connection *connection,
             }
 
             // handle If-Range header but only if the Range header is present
-            if (ranged && lastModified.IsValid())
+            if (ranged)
             {
               std::string ifRange = GetRequestHeaderValue(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_RANGE);
-              if (!ifRange.empty() && lastModified.IsValid())
+              if (!ifRange.empty())
               {
-                CDateTime ifRangeDate;
-                ifRangeDate.SetFromRFC1123DateTime(ifRange);
+                // If-Range either contains an entity tag (which has to match exactly) or a date
+                if (ifRange[0] == '"' || StringUtils::StartsWith(ifRange, "W/"))
+                {
+                  if (!hasETag || ifRange != etag || StringUtils::StartsWith(etag, "W/"))
+                    ranges.Clear();
+                }
+                else if (lastModified.IsValid())
+                {
+                  CDateTime ifRangeDate;
+                  ifRangeDate.SetFromRFC1123DateTime(ifRange);
 
-                // check if the last modification is newer than the If-Range date
-                // if so we have to server the whole file instead
-                if (lastModified.GetAsUTCDateTime() > ifRangeDate)
-                  ranges.Clear();
+                  // check if the last modification is newer than the If-Range date
+                  // if so we have to server the whole file instead
+                  if (lastModified.GetAsUTCDateTime() > ifRangeDate)
+                    ranges.Clear();
+                }
               }
             }
 
@@ -506,6 +569,10 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler)
       ret = CreateMemoryDownloadResponse(handler, response);
       break;
 
+    case HTTPStreamDownload:
+      ret = CreateStreamDownloadResponse(handler, response);
+      break;
+
     case HTTPError:
       ret = CreateErrorResponse(request.connection, responseDetails.status, request.method, response);
       break;
@@ -543,6 +610,11 @@ int CWebServer::FinalizeRequest(IHTTPRequestHandler *handler, int responseStatus
   if (handler->GetLastModifiedDate(lastModified) && lastModified.IsValid())
     handler->AddResponseHeader(MHD_HTTP_HEADER_LAST_MODIFIED, lastModified.GetAsRFC1123DateTime());
 
+  // if the request handler has set an entity tag and it hasn't been set as a header, add it
+  std::string etag;
+  if (handler->CanBeCached() && handler->GetETag(etag) && !etag.empty())
+    handler->AddResponseHeader(MHD_HTTP_HEADER_ETAG, etag);
+
   // check if the request handler has set Cache-Control and add it if not
   if (!handler->HasResponseHeader(MHD_HTTP_HEADER_CACHE_CONTROL))
   {
@@ -797,6 +869,8 @@ int CWebServer::CreateFileDownloadResponse(IHTTPRequestHandler *handler, struct
     context->contentType = mimeType;
     context->boundaryWritten = false;
     context->writePosition = 0;
+    context->readAheadPosition = 0;
+    context->readAheadLength = 0;
 
     if (handler->IsRequestRanged())
     {
@@ -856,18 +930,51 @@ int CWebServer::CreateFileDownloadResponse(IHTTPRequestHandler *handler, struct
     // set the initial write position
     context->ranges.GetFirstPosition(context->writePosition);
 
-    // create the response object
-    response = MHD_create_response_from_callback(totalLength, 2048,
-                                                  &CWebServer::ContentReaderCallback,
-                                                  context.get(),
-                                                  &CWebServer::ContentReaderFreeCallback);
-    if (response == NULL)
+    bool local = URIUtils::IsHD(filePath);
+
+#if defined(TARGET_POSIX) && (MHD_VERSION >= 0x00091400)
+    // local files are sent straight from the file descriptor (using sendfile() where available)
+    bool fromFd = local && context->rangeCountTotal == 1;
+#if (MHD_VERSION < 0x00093700)
+    // without the 64 bit variant lengths and offsets beyond size_t and off_t (on 32 bit) are left to the callback
+    fromFd = fromFd && totalLength <= std::numeric_limits<size_t>::max() &&
+             context->writePosition <= static_cast<uint64_t>(std::numeric_limits<off_t>::max());
+#endif
+    if (fromFd)
     {
-      CLog::Log(LOGERROR, "CWebServer: failed to create a HTTP response for %s to be filled from %s", request.pathUrl.c_str(), filePath.c_str());
-      return MHD_NO;
+      int fd = open(CSpecialProtocol::TranslatePath(filePath).c_str(), O_RDONLY);
+      if (fd >= 0)
+      {
+#if (MHD_VERSION >= 0x00093700)
+        response = MHD_create_response_from_fd_at_offset64(totalLength, fd, context->writePosition);
+#else
+        response = MHD_create_response_from_fd_at_offset(static_cast<size_t>(totalLength), fd, static_cast<off_t>(context->writePosition));
+#endif
+        if (response == NULL)
+          close(fd);
+      }
     }
+#endif
+
+    if (response == NULL)
+    {
+      // anything else is read into large blocks ahead of what is sent
+      if (!local)
+        context->readAhead.resize(FILE_READ_AHEAD_SIZE);
+
+      // create the response object
+      response = MHD_create_response_from_callback(totalLength, FILE_BLOCK_SIZE,
+                                                    &CWebServer::ContentReaderCallback,
+                                                    context.get(),
+                                                    &CWebServer::ContentReaderFreeCallback);
+      if (response == NULL)
+      {
+        CLog::Log(LOGERROR, "CWebServer: failed to create a HTTP response for %s to be filled from %s", request.pathUrl.c_str(), filePath.c_str());
+        return MHD_NO;
+      }
 
-    context.release(); // ownership was passed to mhd
+      context.release(); // ownership was passed to mhd
+    }
 
     // add Content-Range header
     if (ranged)
@@ -892,6 +999,43 @@ int CWebServer::CreateFileDownloadResponse(IHTTPRequestHandler *handler, struct
   return MHD_YES;
 }
 
+int CWebServer::CreateStreamDownloadResponse(IHTTPRequestHandler *handler, struct MHD_Response *&response)
+{
+  if (handler == NULL)
+    return MHD_NO;
+
+  const HTTPRequest &request = handler->GetRequest();
+  std::unique_ptr<IHTTPResponseStream> stream(handler->GetResponseStream());
+  if (stream.get() == NULL)
+  {
+    CLog::Log(LOGERROR, "CWebServer: HTTP request handler didn't provide a stream for %s", request.pathUrl.c_str());
+    return MHD_NO;
+  }
+
+  // HEAD requests don't get any content
+  if (request.method == HEAD)
+  {
+    response = MHD_create_response_from_data(0, NULL, MHD_NO, MHD_NO);
+    return response != NULL ? MHD_YES : MHD_NO;
+  }
+
+#if (MHD_VERSION >= 0x00090200)
+  // the length is unknown so the content is sent chunked as soon as it is available
+  response = MHD_create_response_from_callback(MHD_SIZE_UNKNOWN, 16384,
+                                               &CWebServer::StreamReaderCallback,
+                                               stream.get(),
+                                               &CWebServer::StreamReaderFreeCallback);
+#endif
+  if (response == NULL)
+  {
+    CLog::Log(LOGERROR, "CWebServer: failed to create a HTTP response for %s to be filled from a stream", request.pathUrl.c_str());
+    return MHD_NO;
+  }
+
+  stream.release(); // ownership was passed to mhd
+  return MHD_YES;
+}
+
 int CWebServer::CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response)
 {
   size_t payloadSize = 0;
@@ -974,6 +1118,52 @@ void* CWebServer::UriRequestLogger(void *cls, const char *uri)
   return conHandler;
 }
 
+// reads at the write position, files with a read-ahead buffer are read in whole blocks of its size
+static ssize_t ReadFile(HttpFileDownloadContext *context, char *buf, size_t size)
+{
+  uint64_t position = context->writePosition;
+
+  if (context->readAhead.empty())
+  {
+    // seek to the position if necessary
+    if (context->file->GetPosition() < 0 || position != static_cast<uint64_t>(context->file->GetPosition()))
+      context->file->Seek(static_cast<uint64_t>(position));
+
+    return context->file->Read(buf, size);
+  }
+
+  // refill the read-ahead buffer with the block the position is in
+  if (position < context->readAheadPosition || position >= context->readAheadPosition + context->readAheadLength)
+  {
+    uint64_t blockPosition = position - position % context->readAhead.size();
+    if (context->file->GetPosition() < 0 || blockPosition != static_cast<uint64_t>(context->file->GetPosition()))
+    {
+      if (context->file->Seek(static_cast<int64_t>(blockPosition)) < 0)
+        return -1;
+    }
+
+    size_t length = 0;
+    while (length < context->readAhead.size())
+    {
+      ssize_t res = context->file->Read(&context->readAhead[length], context->readAhead.size() - length);
+      if (res <= 0)
+        break;
+      length += res;
+    }
+
+    context->readAheadPosition = blockPosition;
+    context->readAheadLength = length;
+    if (position >= blockPosition + length)
+      return -1;
+  }
+
+  size_t offset = static_cast<size_t>(position - context->readAheadPosition);
+  size = std::min(size, context->readAheadLength - offset);
+  memcpy(buf, &context->readAhead[offset], size);
+
+  return size;
+}
+
 #if (MHD_VERSION >= 0x00090200)
 ssize_t CWebServer::ContentReaderCallback(void *cls, uint64_t pos, char *buf, size_t max)
 #elif (MHD_VERSION >= 0x00040001)
@@ -1045,12 +1235,8 @@ int CWebServer::ContentReaderCallback(void *cls, size_t pos, char *buf, int max)
   // adjust the maximum number of read bytes
   maximum = std::min(maximum, end - context->writePosition + 1);
 
-  // seek to the position if necessary
-  if (context->file->GetPosition() < 0 || context->writePosition != static_cast<uint64_t>(context->file->GetPosition()))
-    context->file->Seek(static_cast<uint64_t>(context->writePosition));
-
   // read data from the file
-  ssize_t res = context->file->Read(buf, static_cast<size_t>(maximum));
+  ssize_t res = ReadFile(context, buf, static_cast<size_t>(maximum));
   if (res <= 0)
     return -1;
 
@@ -1083,6 +1269,32 @@ void CWebServer::ContentReaderFreeCallback(void *cls)
 #endif
 }
 
+#if (MHD_VERSION >= 0x00090200)
+ssize_t CWebServer::StreamReaderCallback(void *cls, uint64_t pos, char *buf, size_t max)
+#elif (MHD_VERSION >= 0x00040001)
+int CWebServer::StreamReaderCallback(void *cls, uint64_t pos, char *buf, int max)
+#else   //libmicrohttpd < 0.4.0
+int CWebServer::StreamReaderCallback(void *cls, size_t pos, char *buf, int max)
+#endif
+{
+  IHTTPResponseStream *stream = (IHTTPResponseStream *)cls;
+  if (stream == NULL || max <= 0)
+    return -1;
+
+  size_t read = stream->Read(buf, static_cast<size_t>(max));
+  // -1 ends the response
+  if (read == 0)
+    return -1;
+
+  return read;
+}
+
+void CWebServer::StreamReaderFreeCallback(void *cls)
+{
+  IHTTPResponseStream *stream = (IHTTPResponseStream *)cls;
+  delete stream;
+}
+
 // local helper
 static void panicHandlerForMHD(void* unused, const char* file, unsigned int line, const char *reason)
 {
@@ -1120,17 +1332,30 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
   MHD_set_panic_func(&panicHandlerForMHD, NULL);
 #endif
 
-  return MHD_start_daemon(flags |
+  unsigned int threadPoolSize = g_advancedSettings.m_webServerThreadPoolSize;
 #if (MHD_VERSION >= 0x00040002) && (MHD_VERSION < 0x00090B01)
-                          // use main thread for each connection, can only handle one request at a
-                          // time [unless you set the thread pool size]
-                          MHD_USE_SELECT_INTERNALLY
-#else
-                          // one thread per connection
-                          // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
-                          // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
-                          MHD_USE_THREAD_PER_CONNECTION
+  // these versions can only handle one request at a time without a thread pool
+  if (threadPoolSize == 0)
+    threadPoolSize = 4;
+#elif (MHD_VERSION < 0x00040002)
+  threadPoolSize = 0;
 #endif
+
+  if (threadPoolSize > 0)
+  {
+    // a fixed pool of threads polls all connections, idle keep-alive connections don't hold a thread
+    flags |= MHD_USE_SELECT_INTERNALLY;
+    CLog::Log(LOGDEBUG, "CWebServer: serving connections with %u threads", threadPoolSize);
+  }
+  else
+  {
+    // one thread per connection
+    // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
+    // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
+    flags |= MHD_USE_THREAD_PER_CONNECTION;
+  }
+
+  return MHD_start_daemon(flags
 #if (MHD_VERSION >= 0x00040001)
                           | MHD_USE_DEBUG /* Print MHD error messages to log */
 #endif 
@@ -1141,8 +1366,8 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
                           &CWebServer::AnswerToConnection,
                           this,
 
-#if (MHD_VERSION >= 0x00040002) && (MHD_VERSION < 0x00090B01)
-                          MHD_OPTION_THREAD_POOL_SIZE, 4,
+#if (MHD_VERSION >= 0x00040002)
+                          MHD_OPTION_THREAD_POOL_SIZE, threadPoolSize,
 #endif
                           MHD_OPTION_CONNECTION_LIMIT, 512,
                           MHD_OPTION_CONNECTION_TIMEOUT, timeout,
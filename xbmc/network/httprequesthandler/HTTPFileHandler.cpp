@@ -30,7 +30,8 @@ CHTTPFileHandler::CHTTPFileHandler()
     m_url(),
     m_canHandleRanges(true),
     m_canBeCached(true),
-    m_lastModified()
+    m_lastModified(),
+    m_etag()
 { }
 
 CHTTPFileHandler::CHTTPFileHandler(const HTTPRequest &request)
@@ -38,7 +39,8 @@ CHTTPFileHandler::CHTTPFileHandler(const HTTPRequest &request)
     m_url(),
     m_canHandleRanges(true),
     m_canBeCached(true),
-    m_lastModified()
+    m_lastModified(),
+    m_etag()
 { }
 
 int CHTTPFileHandler::HandleRequest()
@@ -55,6 +57,15 @@ bool CHTTPFileHandler::GetLastModifiedDate(CDateTime &lastModified) const
   return true;
 }
 
+bool CHTTPFileHandler::GetETag(std::string &etag) const
+{
+  if (m_etag.empty())
+    return false;
+
+  etag = m_etag;
+  return true;
+}
+
 void CHTTPFileHandler::SetFile(const std::string& file, int responseStatus)
 {
   m_url = file;
@@ -99,6 +110,9 @@ void CHTTPFileHandler::SetFile(const std::string& file, int responseStatus)
 #endif
         if (time != NULL)
           m_lastModified = *time;
+
+        // the modification time and the size identify the content of the file
+        m_etag = StringUtils::Format("\"%" PRIx64 "-%" PRIx64 "\"", static_cast<uint64_t>(statBuffer.st_mtime), static_cast<uint64_t>(statBuffer.st_size));
       }
     }
   }
@@ -19,8 +19,13 @@
  */
 
 #include "HTTPImageHandler.h"
+#include "TextureCache.h"
+#include "TextureDatabase.h"
 #include "URL.h"
-#include "filesystem/ImageFile.h"
+#include "Util.h"
+#include "filesystem/File.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
 #include "network/WebServer.h"
 
 CHTTPImageHandler::CHTTPImageHandler(const HTTPRequest &request)
@@ -34,10 +39,31 @@ CHTTPImageHandler::CHTTPImageHandler(const HTTPRequest &request)
   {
     file = m_request.pathUrl.substr(7);
 
-    XFILE::CImageFile imageFile;
+    // serve the cached texture itself so it is sent like any local file (conditional, ranged and
+    // straight from the file descriptor), caching the image first if needed
     const CURL pathToUrl(file);
-    if (imageFile.Exists(pathToUrl))
+    bool needsRecaching = false;
+    std::string cachedFile = CTextureCache::GetInstance().CheckCachedImage(pathToUrl.Get(), false, needsRecaching);
+    if (cachedFile.empty() && CTextureCache::CanCacheImageURL(pathToUrl))
+    {
+      // caching holds up the webserver thread, so local pictures are sent as they are and cached in
+      // the background. Embedded art, images which have to be resized and remote ones (which would be
+      // fetched twice) are cached first.
+      std::string original = CTextureUtils::UnwrapImageURL(pathToUrl.Get());
+      if (!StringUtils::StartsWith(original, "image://") && URIUtils::IsHD(original) && CUtil::IsPicture(original))
+      {
+        CTextureCache::GetInstance().BackgroundCacheImage(pathToUrl.Get());
+        cachedFile = original;
+      }
+      else
+        cachedFile = CTextureCache::GetInstance().CacheImage(pathToUrl.Get());
+    }
+
+    if (!cachedFile.empty() && XFILE::CFile::Exists(cachedFile, false))
+    {
+      file = cachedFile;
       responseStatus = MHD_HTTP_OK;
+    }
     else
       responseStatus = MHD_HTTP_NOT_FOUND;
   }
@@ -19,10 +19,13 @@
  */
 
 #include <map>
+#include <stdlib.h>
 
 #include "HTTPImageTransformationHandler.h"
+#include "TextureCache.h"
 #include "TextureCacheJob.h"
 #include "URL.h"
+#include "filesystem/File.h"
 #include "filesystem/ImageFile.h"
 #include "network/WebServer.h"
 #include "utils/Mime.h"
@@ -35,18 +38,61 @@
 
 static const std::string ImageBasePath = "/image/";
 
+static std::string GetValidator(const struct __stat64 &statBuffer)
+{
+  return StringUtils::Format("%" PRIx64 "-%" PRIx64, static_cast<uint64_t>(statBuffer.st_mtime), static_cast<uint64_t>(statBuffer.st_size));
+}
+
+static bool GetLocalTime(const struct __stat64 &statBuffer, CDateTime &lastModified)
+{
+  struct tm *time;
+#ifdef HAVE_LOCALTIME_R
+  struct tm result = {};
+  time = localtime_r((time_t*)&statBuffer.st_mtime, &result);
+#else
+  time = localtime((time_t *)&statBuffer.st_mtime);
+#endif
+  if (time == NULL)
+    return false;
+
+  lastModified = *time;
+  return true;
+}
+
+// whether a cached texture of the given size can be sent instead of resizing the image to fit into width x height
+static bool IsSuitableSize(const CTextureDetails &details, unsigned int width, unsigned int height)
+{
+  if (details.width == 0 || details.height == 0 || (width == 0 && height == 0))
+    return false;
+
+  if ((width > 0 && details.width > width) || (height > 0 && details.height > height))
+    return false;
+
+  // the resized image fills the requested size in at least one direction, a smaller texture may
+  // have been scaled down from a larger image
+  return (width > 0 && details.width + 1 >= width) || (height > 0 && details.height + 1 >= height);
+}
+
 CHTTPImageTransformationHandler::CHTTPImageTransformationHandler()
   : m_url(),
+    m_imagePath(),
+    m_validator(),
+    m_etag(),
     m_lastModified(),
-    m_buffer(NULL),
+    m_cachedFile(),
+    m_cachedResponse(),
     m_responseData()
 { }
 
 CHTTPImageTransformationHandler::CHTTPImageTransformationHandler(const HTTPRequest &request)
   : IHTTPRequestHandler(request),
     m_url(),
+    m_imagePath(),
+    m_validator(),
+    m_etag(),
     m_lastModified(),
-    m_buffer(NULL),
+    m_cachedFile(),
+    m_cachedResponse(),
     m_responseData()
 {
   m_url = m_request.pathUrl.substr(ImageBasePath.size());
@@ -69,6 +115,53 @@ CHTTPImageTransformationHandler::CHTTPImageTransformationHandler(const HTTPReque
   m_response.type = HTTPMemoryDownloadNoFreeCopy;
   m_response.status = MHD_HTTP_OK;
 
+  // get the transformation options
+  std::map<std::string, std::string> options;
+  CWebServer::GetRequestHeaderValues(m_request.connection, MHD_GET_ARGUMENT_KIND, options);
+
+  unsigned int width = 0;
+  unsigned int height = 0;
+  std::vector<std::string> urlOptions;
+  std::map<std::string, std::string>::const_iterator option = options.find(TRANSFORMATION_OPTION_WIDTH);
+  if (option != options.end())
+  {
+    urlOptions.push_back(TRANSFORMATION_OPTION_WIDTH "=" + option->second);
+    if (StringUtils::IsInteger(option->second))
+      width = strtoul(option->second.c_str(), NULL, 0);
+  }
+
+  option = options.find(TRANSFORMATION_OPTION_HEIGHT);
+  if (option != options.end())
+  {
+    urlOptions.push_back(TRANSFORMATION_OPTION_HEIGHT "=" + option->second);
+    if (StringUtils::IsInteger(option->second))
+      height = strtoul(option->second.c_str(), NULL, 0);
+  }
+
+  option = options.find(TRANSFORMATION_OPTION_SCALING_ALGORITHM);
+  if (option != options.end())
+    urlOptions.push_back(TRANSFORMATION_OPTION_SCALING_ALGORITHM "=" + option->second);
+
+  m_imagePath = m_url;
+  if (!urlOptions.empty())
+  {
+    m_imagePath += "?";
+    m_imagePath += StringUtils::Join(urlOptions, "&");
+  }
+
+  // send a texture from the texture cache if it was cached at the requested size (or at a size the
+  // image would be resized to anyway)
+  CTextureDetails details;
+  std::string cachedFile = CTextureCache::GetInstance().CheckCachedImage(m_imagePath, details);
+  if (cachedFile.empty())
+  {
+    cachedFile = CTextureCache::GetInstance().CheckCachedImage(m_url, details);
+    if (!IsSuitableSize(details, width, height))
+      cachedFile.clear();
+  }
+  if (!cachedFile.empty() && SetCachedFile(cachedFile))
+    return;
+
   // determine the content type
   std::string ext = URIUtils::GetExtension(pathToUrl.GetHostName());
   StringUtils::ToLower(ext);
@@ -76,29 +169,21 @@ CHTTPImageTransformationHandler::CHTTPImageTransformationHandler(const HTTPReque
 
   // TODO: determine the maximum age
 
-  // determine the last modified date
+  // determine the last modified date and the validator of the resized image from the cached
+  // texture or from the image itself
   struct __stat64 statBuffer;
-  if (imageFile.Stat(pathToUrl, &statBuffer) != 0)
-    return;
-
-  struct tm *time;
-#ifdef HAVE_LOCALTIME_R
-  struct tm result = {};
-  time = localtime_r((time_t*)&statBuffer.st_mtime, &result);
-#else
-  time = localtime((time_t *)&statBuffer.st_mtime);
-#endif
-  if (time == NULL)
+  if (imageFile.Stat(pathToUrl, &statBuffer) != 0 &&
+      XFILE::CFile::Stat(pathToUrl.GetHostName(), &statBuffer) != 0)
     return;
 
-  m_lastModified = *time;
+  m_validator = GetValidator(statBuffer);
+  m_etag = CHTTPResponseCache::GetETag(m_imagePath, m_validator);
+  GetLocalTime(statBuffer, m_lastModified);
 }
 
 CHTTPImageTransformationHandler::~CHTTPImageTransformationHandler()
 {
   m_responseData.clear();
-  delete m_buffer;
-  m_buffer = NULL;
 }
 
 bool CHTTPImageTransformationHandler::CanHandleRequest(const HTTPRequest &request)
@@ -117,7 +202,8 @@ bool CHTTPImageTransformationHandler::CanHandleRequest(const HTTPRequest &reques
 
 int CHTTPImageTransformationHandler::HandleRequest()
 {
-  if (m_response.type == HTTPError)
+  // errors and cached textures are sent by the webserver
+  if (m_response.type == HTTPError || m_response.type == HTTPFileDownload)
     return MHD_YES;
 
   // nothing else to do if this is a HEAD request
@@ -129,33 +215,9 @@ int CHTTPImageTransformationHandler::HandleRequest()
     return MHD_YES;
   }
 
-  // get the transformation options
-  std::map<std::string, std::string> options;
-  CWebServer::GetRequestHeaderValues(m_request.connection, MHD_GET_ARGUMENT_KIND, options);
-
-  std::vector<std::string> urlOptions;
-  std::map<std::string, std::string>::const_iterator option = options.find(TRANSFORMATION_OPTION_WIDTH);
-  if (option != options.end())
-    urlOptions.push_back(TRANSFORMATION_OPTION_WIDTH "=" + option->second);
-
-  option = options.find(TRANSFORMATION_OPTION_HEIGHT);
-  if (option != options.end())
-    urlOptions.push_back(TRANSFORMATION_OPTION_HEIGHT "=" + option->second);
-
-  option = options.find(TRANSFORMATION_OPTION_SCALING_ALGORITHM);
-  if (option != options.end())
-    urlOptions.push_back(TRANSFORMATION_OPTION_SCALING_ALGORITHM "=" + option->second);
-
-  std::string imagePath = m_url;
-  if (!urlOptions.empty())
-  {
-    imagePath += "?";
-    imagePath += StringUtils::Join(urlOptions, "&");
-  }
-
-  // resize the image into the local buffer
-  size_t bufferSize;
-  if (!CTextureCacheJob::ResizeTexture(imagePath, m_buffer, bufferSize))
+  // get the resized image from the response cache or resize it
+  m_cachedResponse = CHTTPResponseCache::GetInstance().Get(m_imagePath, m_validator, *this);
+  if (!m_cachedResponse || m_cachedResponse->data.empty())
   {
     m_response.status = MHD_HTTP_INTERNAL_SERVER_ERROR;
     m_response.type = HTTPError;
@@ -163,18 +225,22 @@ int CHTTPImageTransformationHandler::HandleRequest()
     return MHD_YES;
   }
 
+  const uint8_t *buffer = reinterpret_cast<const uint8_t*>(m_cachedResponse->data.c_str());
+  if (!m_cachedResponse->contentType.empty())
+    m_response.contentType = m_cachedResponse->contentType;
+
   // store the size of the image
-  m_response.totalLength = bufferSize;
+  m_response.totalLength = m_cachedResponse->data.size();
 
   // nothing else to do if the request is not ranged
   if (!GetRequestedRanges(m_response.totalLength))
   {
-    m_responseData.push_back(CHttpResponseRange(m_buffer, 0, m_response.totalLength - 1));
+    m_responseData.push_back(CHttpResponseRange(buffer, 0, m_response.totalLength - 1));
     return MHD_YES;
   }
 
   for (HttpRanges::const_iterator range = m_request.ranges.Begin(); range != m_request.ranges.End(); ++range)
-    m_responseData.push_back(CHttpResponseRange(m_buffer + range->GetFirstPosition(), range->GetFirstPosition(), range->GetLastPosition()));
+    m_responseData.push_back(CHttpResponseRange(buffer + range->GetFirstPosition(), range->GetFirstPosition(), range->GetLastPosition()));
 
   return MHD_YES;
 }
@@ -187,3 +253,46 @@ bool CHTTPImageTransformationHandler::GetLastModifiedDate(CDateTime &lastModifie
   lastModified = m_lastModified;
   return true;
 }
+
+bool CHTTPImageTransformationHandler::GetETag(std::string &etag) const
+{
+  if (m_etag.empty())
+    return false;
+
+  etag = m_etag;
+  return true;
+}
+
+bool CHTTPImageTransformationHandler::CreateResponse(HTTPCachedResponse &response)
+{
+  // resize the image into a local buffer
+  uint8_t *buffer = NULL;
+  size_t bufferSize;
+  if (!CTextureCacheJob::ResizeTexture(m_imagePath, buffer, bufferSize))
+    return false;
+
+  response.contentType = m_response.contentType;
+  response.data.assign(reinterpret_cast<const char*>(buffer), bufferSize);
+  delete[] buffer;
+
+  return true;
+}
+
+bool CHTTPImageTransformationHandler::SetCachedFile(const std::string &cachedFile)
+{
+  struct __stat64 statBuffer;
+  if (XFILE::CFile::Stat(cachedFile, &statBuffer) != 0)
+    return false;
+
+  m_cachedFile = cachedFile;
+  m_response.type = HTTPFileDownload;
+
+  std::string ext = URIUtils::GetExtension(cachedFile);
+  StringUtils::ToLower(ext);
+  m_response.contentType = CMime::GetMimeType(ext);
+
+  m_etag = StringUtils::Format("\"%s\"", GetValidator(statBuffer).c_str());
+  GetLocalTime(statBuffer, m_lastModified);
+
+  return true;
+}
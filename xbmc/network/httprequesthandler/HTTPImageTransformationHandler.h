@@ -23,9 +23,10 @@
 #include <string>
 
 #include "XBDateTime.h"
+#include "network/httprequesthandler/HTTPResponseCache.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
 
-class CHTTPImageTransformationHandler : public IHTTPRequestHandler
+class CHTTPImageTransformationHandler : public IHTTPRequestHandler, private IHTTPResponseCreator
 {
 public:
   CHTTPImageTransformationHandler();
@@ -39,8 +40,10 @@ public:
   virtual bool CanHandleRanges() const { return true; }
   virtual bool CanBeCached() const { return true; }
   virtual bool GetLastModifiedDate(CDateTime &lastModified) const;
+  virtual bool GetETag(std::string &etag) const;
 
   virtual HttpResponseRanges GetResponseData() const { return m_responseData; }
+  virtual std::string GetResponseFile() const { return m_cachedFile; }
 
   // priority must be higher than the one of CHTTPImageHandler
   virtual int GetPriority() const { return 6; }
@@ -49,9 +52,19 @@ protected:
   explicit CHTTPImageTransformationHandler(const HTTPRequest &request);
 
 private:
+  // implementation of IHTTPResponseCreator
+  virtual bool CreateResponse(HTTPCachedResponse &response);
+
+  bool SetCachedFile(const std::string &cachedFile);
+
   std::string m_url;
+  std::string m_imagePath;
+  std::string m_validator;
+  std::string m_etag;
   CDateTime m_lastModified;
 
-  uint8_t* m_buffer;
+  std::string m_cachedFile;
+
+  HTTPCachedResponsePtr m_cachedResponse;
   HttpResponseRanges m_responseData;
 };
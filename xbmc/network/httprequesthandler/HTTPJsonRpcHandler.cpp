@@ -18,6 +18,9 @@
  *
  */
 
+#include <algorithm>
+#include <string.h>
+
 #include "HTTPJsonRpcHandler.h"
 #include "interfaces/json-rpc/JSONRPC.h"
 #include "interfaces/json-rpc/JSONServiceDescription.h"
@@ -81,7 +84,34 @@ int CHTTPJsonRpcHandler::HandleRequest()
 
   if (isRequest)
   {
-    m_responseData = JSONRPC::CJSONRPC::MethodCall(m_requestData, m_request.webserver, &client);
+    m_responseStream.reset(new CResponseStream());
+    if (JSONRPC::CJSONRPC::MethodCall(m_requestData, m_request.webserver, &client, m_responseStream->m_response))
+    {
+#if (MHD_VERSION >= 0x00090200)
+      // large lists are written while the response is sent
+      if (m_responseStream->m_response.IsStreamed())
+      {
+        if (!jsonpCallback.empty())
+        {
+          m_responseStream->m_prefix = jsonpCallback + "(";
+          m_responseStream->m_suffix = ");";
+        }
+
+        m_requestData.clear();
+
+        m_response.type = HTTPStreamDownload;
+        m_response.status = MHD_HTTP_OK;
+        m_response.contentType = "application/json";
+        m_response.totalLength = 0;
+
+        return MHD_YES;
+      }
+#endif
+
+      while (m_responseStream->m_response.Read(m_responseData, 65536))
+        ;
+    }
+    m_responseStream.reset();
 
     if (!jsonpCallback.empty())
       m_responseData = jsonpCallback + "(" + m_responseData + ");";
@@ -121,6 +151,37 @@ HttpResponseRanges CHTTPJsonRpcHandler::GetResponseData() const
   return ranges;
 }
 
+size_t CHTTPJsonRpcHandler::CResponseStream::Read(char *buffer, size_t size)
+{
+  if (!m_prefix.empty())
+  {
+    m_buffer.swap(m_prefix);
+    m_prefix.clear();
+  }
+
+  // collect at least as much as fits into the buffer unless the response ends
+  while (!m_done && m_buffer.size() - m_position < size)
+  {
+    if (m_position > 0)
+    {
+      m_buffer.erase(0, m_position);
+      m_position = 0;
+    }
+
+    if (!m_response.Read(m_buffer, size))
+    {
+      m_buffer.append(m_suffix);
+      m_done = true;
+    }
+  }
+
+  size_t length = std::min(size, m_buffer.size() - m_position);
+  memcpy(buffer, m_buffer.c_str() + m_position, length);
+  m_position += length;
+
+  return length;
+}
+
 #if (MHD_VERSION >= 0x00040001)
 bool CHTTPJsonRpcHandler::appendPostData(const char *data, size_t size)
 #else
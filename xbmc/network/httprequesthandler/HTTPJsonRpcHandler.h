@@ -19,9 +19,11 @@
  *
  */
 
+#include <memory>
 #include <string>
 
 #include "interfaces/json-rpc/IClient.h"
+#include "interfaces/json-rpc/JSONRPC.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
 
 class CHTTPJsonRpcHandler : public IHTTPRequestHandler
@@ -36,6 +38,7 @@ public:
   virtual int HandleRequest();
 
   virtual HttpResponseRanges GetResponseData() const;
+  virtual IHTTPResponseStream* GetResponseStream() { return m_responseStream.release(); }
 
   virtual int GetPriority() const { return 5; }
 
@@ -55,6 +58,24 @@ private:
   std::string m_responseData;
   CHttpResponseRange m_responseRange;
 
+  class CResponseStream : public IHTTPResponseStream
+  {
+  public:
+    CResponseStream() : m_position(0), m_done(false) { }
+
+    virtual size_t Read(char *buffer, size_t size);
+
+    JSONRPC::CJSONRPCResponse m_response;
+    std::string m_prefix;
+    std::string m_suffix;
+
+  private:
+    std::string m_buffer;
+    size_t m_position;
+    bool m_done;
+  };
+  std::unique_ptr<CResponseStream> m_responseStream;
+
   class CHTTPClient : public JSONRPC::IClient
   {
   public:
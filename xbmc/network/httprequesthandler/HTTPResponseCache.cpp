@@ -0,0 +1,373 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <inttypes.h>
+#include <vector>
+
+#include "HTTPResponseCache.h"
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "utils/auto_buffer.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#define RESPONSE_CACHE_PATH   "special://temp/webcache/"
+#define RESPONSE_CACHE_MAGIC  "KWRC2\n"
+
+class CHTTPResponseCache::CPendingResponse
+{
+public:
+  CPendingResponse(const std::string &validator)
+    : m_validator(validator),
+      m_done(true)
+  { }
+
+  std::string m_validator;
+  HTTPCachedResponsePtr m_response;
+  CEvent m_done;
+};
+
+CHTTPResponseCache::CHTTPResponseCache()
+  : m_memorySize(0),
+    m_diskSize(0),
+    m_diskIndexLoaded(false),
+    m_useCounter(0)
+{ }
+
+CHTTPResponseCache& CHTTPResponseCache::GetInstance()
+{
+  static CHTTPResponseCache sResponseCache;
+  return sResponseCache;
+}
+
+HTTPCachedResponsePtr CHTTPResponseCache::Get(const std::string &key, const std::string &validator, IHTTPResponseCreator &creator)
+{
+  if (validator.empty())
+  {
+    std::shared_ptr<HTTPCachedResponse> response(new HTTPCachedResponse());
+    if (!creator.CreateResponse(*response))
+      return HTTPCachedResponsePtr();
+
+    return response;
+  }
+
+  std::shared_ptr<CPendingResponse> pending;
+  bool create = false;
+  {
+    CSingleLock lock(m_section);
+    HTTPCachedResponsePtr response = getFromMemory(key, validator);
+    if (response)
+      return response;
+
+    // wait for the response if another request is already creating it
+    std::map<std::string, std::shared_ptr<CPendingResponse> >::const_iterator it = m_pending.find(key);
+    if (it != m_pending.end() && it->second->m_validator == validator)
+      pending = it->second;
+    else
+    {
+      pending.reset(new CPendingResponse(validator));
+      m_pending[key] = pending;
+      create = true;
+    }
+  }
+
+  if (!create)
+  {
+    pending->m_done.Wait();
+    return pending->m_response;
+  }
+
+  HTTPCachedResponsePtr response = readFromDisk(key, validator);
+  if (!response)
+  {
+    std::shared_ptr<HTTPCachedResponse> created(new HTTPCachedResponse());
+    if (creator.CreateResponse(*created))
+    {
+      writeToDisk(key, validator, *created);
+      response = created;
+    }
+  }
+
+  {
+    CSingleLock lock(m_section);
+    if (response)
+      addToMemory(key, validator, response);
+
+    std::map<std::string, std::shared_ptr<CPendingResponse> >::iterator it = m_pending.find(key);
+    if (it != m_pending.end() && it->second == pending)
+      m_pending.erase(it);
+
+    pending->m_response = response;
+  }
+  pending->m_done.Set();
+
+  return response;
+}
+
+std::string CHTTPResponseCache::GetETag(const std::string &key, const std::string &validator)
+{
+  if (validator.empty())
+    return "";
+
+  Crc32 crc;
+  crc.Compute(key);
+  return StringUtils::Format("\"%08x-%s\"", (unsigned int)crc, validator.c_str());
+}
+
+void CHTTPResponseCache::Clear()
+{
+  CSingleLock lock(m_section);
+  m_memory.clear();
+  m_memorySize = 0;
+}
+
+HTTPCachedResponsePtr CHTTPResponseCache::getFromMemory(const std::string &key, const std::string &validator)
+{
+  std::map<std::string, MemoryEntry>::iterator it = m_memory.find(key);
+  if (it == m_memory.end())
+    return HTTPCachedResponsePtr();
+
+  // the source has changed since the response was created
+  if (it->second.validator != validator)
+  {
+    m_memorySize -= it->second.response->data.size();
+    m_memory.erase(it);
+    return HTTPCachedResponsePtr();
+  }
+
+  it->second.lastUse = ++m_useCounter;
+  return it->second.response;
+}
+
+void CHTTPResponseCache::addToMemory(const std::string &key, const std::string &validator, const HTTPCachedResponsePtr &response)
+{
+  uint64_t maxSize = static_cast<uint64_t>(g_advancedSettings.m_webServerResponseCacheMemory) * 1024 * 1024;
+  uint64_t size = response->data.size();
+  if (size > maxSize / 4)
+    return;
+
+  std::map<std::string, MemoryEntry>::iterator existing = m_memory.find(key);
+  if (existing != m_memory.end())
+  {
+    m_memorySize -= existing->second.response->data.size();
+    m_memory.erase(existing);
+  }
+
+  // drop the least recently used responses
+  while (!m_memory.empty() && m_memorySize + size > maxSize)
+  {
+    std::map<std::string, MemoryEntry>::iterator oldest = m_memory.begin();
+    for (std::map<std::string, MemoryEntry>::iterator it = m_memory.begin(); it != m_memory.end(); ++it)
+    {
+      if (it->second.lastUse < oldest->second.lastUse)
+        oldest = it;
+    }
+
+    m_memorySize -= oldest->second.response->data.size();
+    m_memory.erase(oldest);
+  }
+
+  MemoryEntry &entry = m_memory[key];
+  entry.validator = validator;
+  entry.response = response;
+  entry.lastUse = ++m_useCounter;
+  m_memorySize += size;
+}
+
+HTTPCachedResponsePtr CHTTPResponseCache::readFromDisk(const std::string &key, const std::string &validator)
+{
+  if (g_advancedSettings.m_webServerResponseCacheDisk == 0)
+    return HTTPCachedResponsePtr();
+
+  std::string file = getDiskFile(key);
+  {
+    CSingleLock lock(m_section);
+    loadDiskIndex();
+
+    std::map<std::string, DiskEntry>::iterator it = m_disk.find(file);
+    if (it == m_disk.end())
+      return HTTPCachedResponsePtr();
+
+    it->second.lastUse = ++m_useCounter;
+  }
+
+  XFILE::CFile diskFile;
+  XUTILS::auto_buffer buffer;
+  if (diskFile.LoadFile(RESPONSE_CACHE_PATH + file, buffer) <= 0)
+    return HTTPCachedResponsePtr();
+
+  // the file starts with the magic, the key, the validator, the content type and the data length on lines of their own
+  std::string header = RESPONSE_CACHE_MAGIC + key + "\n" + validator + "\n";
+  if (buffer.size() < header.size() || header.compare(0, header.size(), buffer.get(), header.size()) != 0)
+    return HTTPCachedResponsePtr();
+
+  const char *contentType = buffer.get() + header.size();
+  const char *end = buffer.get() + buffer.size();
+  const char *length = std::find(contentType, end, '\n');
+  if (length == end)
+    return HTTPCachedResponsePtr();
+  const char *data = std::find(++length, end, '\n');
+  if (data == end)
+    return HTTPCachedResponsePtr();
+
+  // a file which wasn't written completely
+  data++;
+  if (std::string(length, data - 1) != StringUtils::Format("%" PRIu64, static_cast<uint64_t>(end - data)))
+  {
+    CLog::Log(LOGWARNING, "CHTTPResponseCache: ignoring truncated %s%s", RESPONSE_CACHE_PATH, file.c_str());
+    return HTTPCachedResponsePtr();
+  }
+
+  std::shared_ptr<HTTPCachedResponse> response(new HTTPCachedResponse());
+  response->contentType.assign(contentType, length - 1);
+  response->data.assign(data, end);
+
+  return response;
+}
+
+void CHTTPResponseCache::writeToDisk(const std::string &key, const std::string &validator, const HTTPCachedResponse &response)
+{
+  uint64_t maxSize = static_cast<uint64_t>(g_advancedSettings.m_webServerResponseCacheDisk) * 1024 * 1024;
+  if (maxSize == 0)
+    return;
+
+  std::string header = RESPONSE_CACHE_MAGIC + key + "\n" + validator + "\n" + response.contentType + "\n" +
+                       StringUtils::Format("%" PRIu64 "\n", static_cast<uint64_t>(response.data.size()));
+  uint64_t size = header.size() + response.data.size();
+  if (size > maxSize / 4)
+    return;
+
+  std::string file = getDiskFile(key);
+  std::string tempFile;
+  std::vector<std::string> obsoleteFiles;
+  {
+    CSingleLock lock(m_section);
+    loadDiskIndex();
+
+    // written under a name of its own and renamed once complete, so neither a crash nor another
+    // request writing the same file leaves a partly written one behind
+    tempFile = StringUtils::Format("%s.%" PRIu64 ".tmp", file.c_str(), ++m_useCounter);
+
+    std::map<std::string, DiskEntry>::iterator existing = m_disk.find(file);
+    if (existing != m_disk.end())
+    {
+      m_diskSize -= existing->second.size;
+      m_disk.erase(existing);
+    }
+
+    // drop the least recently used files
+    while (!m_disk.empty() && m_diskSize + size > maxSize)
+    {
+      std::map<std::string, DiskEntry>::iterator oldest = m_disk.begin();
+      for (std::map<std::string, DiskEntry>::iterator it = m_disk.begin(); it != m_disk.end(); ++it)
+      {
+        if (it->second.lastUse < oldest->second.lastUse)
+          oldest = it;
+      }
+
+      obsoleteFiles.push_back(oldest->first);
+      m_diskSize -= oldest->second.size;
+      m_disk.erase(oldest);
+    }
+
+    DiskEntry &entry = m_disk[file];
+    entry.size = size;
+    entry.lastUse = ++m_useCounter;
+    m_diskSize += size;
+  }
+
+  for (std::vector<std::string>::const_iterator it = obsoleteFiles.begin(); it != obsoleteFiles.end(); ++it)
+    XFILE::CFile::Delete(RESPONSE_CACHE_PATH + *it);
+
+  XFILE::CFile diskFile;
+  bool written = diskFile.OpenForWrite(RESPONSE_CACHE_PATH + tempFile, true) &&
+                 diskFile.Write(header.c_str(), header.size()) == static_cast<ssize_t>(header.size()) &&
+                 diskFile.Write(response.data.c_str(), response.data.size()) == static_cast<ssize_t>(response.data.size());
+  diskFile.Close();
+
+  // not every platform replaces an existing file on rename
+  if (written && !XFILE::CFile::Rename(RESPONSE_CACHE_PATH + tempFile, RESPONSE_CACHE_PATH + file))
+  {
+    XFILE::CFile::Delete(RESPONSE_CACHE_PATH + file);
+    written = XFILE::CFile::Rename(RESPONSE_CACHE_PATH + tempFile, RESPONSE_CACHE_PATH + file);
+  }
+
+  if (!written)
+  {
+    CLog::Log(LOGWARNING, "CHTTPResponseCache: failed to write %s%s", RESPONSE_CACHE_PATH, file.c_str());
+    XFILE::CFile::Delete(RESPONSE_CACHE_PATH + tempFile);
+
+    CSingleLock lock(m_section);
+    std::map<std::string, DiskEntry>::iterator it = m_disk.find(file);
+    if (it != m_disk.end())
+    {
+      m_diskSize -= it->second.size;
+      m_disk.erase(it);
+    }
+  }
+}
+
+void CHTTPResponseCache::loadDiskIndex()
+{
+  if (m_diskIndexLoaded)
+    return;
+  m_diskIndexLoaded = true;
+
+  if (!XFILE::CDirectory::Exists(RESPONSE_CACHE_PATH))
+  {
+    XFILE::CDirectory::Create(RESPONSE_CACHE_PATH);
+    return;
+  }
+
+  // files left from before are dropped first
+  CFileItemList items;
+  XFILE::CDirectory::GetDirectory(RESPONSE_CACHE_PATH, items, "", XFILE::DIR_FLAG_NO_FILE_DIRS);
+  for (int i = 0; i < items.Size(); i++)
+  {
+    if (items[i]->m_bIsFolder)
+      continue;
+
+    // a file which was still being written
+    if (URIUtils::HasExtension(items[i]->GetPath(), ".tmp"))
+    {
+      XFILE::CFile::Delete(items[i]->GetPath());
+      continue;
+    }
+
+    DiskEntry &entry = m_disk[URIUtils::GetFileName(items[i]->GetPath())];
+    entry.size = items[i]->m_dwSize;
+    entry.lastUse = 0;
+    m_diskSize += entry.size;
+  }
+}
+
+std::string CHTTPResponseCache::getDiskFile(const std::string &key)
+{
+  Crc32 crc;
+  crc.Compute(key);
+  return StringUtils::Format("%08x.bin", (unsigned int)crc);
+}
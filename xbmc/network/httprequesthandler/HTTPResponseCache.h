@@ -0,0 +1,136 @@
+#pragma once
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+#include "threads/CriticalSection.h"
+
+/*!
+ * \brief Content of a cached HTTP response, never changed once it is cached.
+ */
+typedef struct HTTPCachedResponse
+{
+  std::string contentType;
+  std::string data;
+} HTTPCachedResponse;
+
+typedef std::shared_ptr<const HTTPCachedResponse> HTTPCachedResponsePtr;
+
+/*!
+ * \brief Creates the content of a HTTP response which isn't cached yet.
+ */
+class IHTTPResponseCreator
+{
+public:
+  virtual ~IHTTPResponseCreator() { }
+
+  /*!
+   * \brief Creates the content of the response.
+   *
+   * \param response Response to fill
+   * \return True if the response was created, otherwise false.
+   */
+  virtual bool CreateResponse(HTTPCachedResponse &response) = 0;
+};
+
+/*!
+ * \brief Keeps responses which are expensive to create in memory and in
+ * special://temp/webcache/.
+ *
+ * \details Responses are stored under a key (the URL and the options it was
+ * created with) together with a validator describing the source they were
+ * created from (e.g. its modification time and size). A response is only
+ * returned for the validator it was stored with, otherwise it is created
+ * again. While a response is created, requests for the same key wait for it
+ * instead of creating it as well.
+ *
+ * Both levels are bounded by the advanced settings
+ * <webserver><responsecachememory> and <responsecachedisk> (in MB), the least
+ * recently used responses are dropped first.
+ */
+class CHTTPResponseCache
+{
+public:
+  static CHTTPResponseCache& GetInstance();
+
+  /*!
+   * \brief Gets the response stored under the given key, creating it if needed.
+   *
+   * \param key Key of the response
+   * \param validator Validator of the source of the response, empty if the
+   *                  response must not be cached
+   * \param creator Creates the response if it isn't cached
+   * \return The response or NULL if it couldn't be created.
+   */
+  HTTPCachedResponsePtr Get(const std::string &key, const std::string &validator, IHTTPResponseCreator &creator);
+
+  /*!
+   * \brief Builds the entity tag of the response stored under the given key
+   * with the given validator.
+   */
+  static std::string GetETag(const std::string &key, const std::string &validator);
+
+  /*!
+   * \brief Drops all responses kept in memory.
+   */
+  void Clear();
+
+private:
+  CHTTPResponseCache();
+  CHTTPResponseCache(const CHTTPResponseCache&);
+  CHTTPResponseCache const& operator=(CHTTPResponseCache const&);
+
+  class CPendingResponse;
+
+  typedef struct MemoryEntry
+  {
+    std::string validator;
+    HTTPCachedResponsePtr response;
+    uint64_t lastUse;
+  } MemoryEntry;
+
+  typedef struct DiskEntry
+  {
+    uint64_t size;
+    uint64_t lastUse;
+  } DiskEntry;
+
+  HTTPCachedResponsePtr getFromMemory(const std::string &key, const std::string &validator);
+  void addToMemory(const std::string &key, const std::string &validator, const HTTPCachedResponsePtr &response);
+
+  HTTPCachedResponsePtr readFromDisk(const std::string &key, const std::string &validator);
+  void writeToDisk(const std::string &key, const std::string &validator, const HTTPCachedResponse &response);
+  void loadDiskIndex();
+
+  static std::string getDiskFile(const std::string &key);
+
+  CCriticalSection m_section;
+  std::map<std::string, MemoryEntry> m_memory;
+  uint64_t m_memorySize;
+  std::map<std::string, std::shared_ptr<CPendingResponse> > m_pending;
+  std::map<std::string, DiskEntry> m_disk;
+  uint64_t m_diskSize;
+  bool m_diskIndexLoaded;
+  uint64_t m_useCounter;
+};
@@ -62,7 +62,9 @@ typedef enum HTTPResponseType
   HTTPMemoryDownloadFreeNoCopy,
   // creates a HTTP response from a buffer by copying followed by freeing the buffer
   // the buffer must have been malloc'ed and not new'ed
-  HTTPMemoryDownloadFreeCopy
+  HTTPMemoryDownloadFreeCopy,
+  // creates a HTTP response of unknown length with the content read from a stream while it is sent
+  HTTPStreamDownload
 } HTTPResponseType;
 
 typedef struct HTTPRequest
@@ -84,6 +86,24 @@ typedef struct HTTPResponseDetails {
   uint64_t totalLength;
 } HTTPResponseDetails;
 
+/*!
+ * \brief Provides the content of a HTTP response while it is sent.
+ */
+class IHTTPResponseStream
+{
+public:
+  virtual ~IHTTPResponseStream() { }
+
+  /*!
+   * \brief Reads the next part of the content.
+   *
+   * \param buffer Buffer to fill
+   * \param size Size of the buffer
+   * \return Number of bytes read, 0 once all of the content was read.
+   */
+  virtual size_t Read(char *buffer, size_t size) = 0;
+};
+
 class IHTTPRequestHandler
 {
 public:
@@ -147,6 +167,14 @@ public:
   * \details This is only used if the response can be cached.
   */
   virtual bool GetLastModifiedDate(CDateTime &lastModified) const { return false; }
+
+  /*!
+  * \brief Returns the entity tag of the response data.
+  *
+  * \details This is only used if the response can be cached. The entity tag
+  * must change whenever the response data changes.
+  */
+  virtual bool GetETag(std::string &etag) const { return false; }
  
   /*!
    * \brief Returns the ranges with raw data belonging to the response.
@@ -169,6 +197,14 @@ public:
   */
   virtual std::string GetResponseFile() const { return ""; }
 
+  /*!
+  * \brief Returns the stream the content of the response is read from.
+  *
+  * \details This is only used if the response type is HTTPStreamDownload.
+  * The ownership of the stream is passed to the caller.
+  */
+  virtual IHTTPResponseStream* GetResponseStream() { return NULL; }
+
   /*!
   * \brief Returns the HTTP request handled by the HTTP request handler.
   */
@@ -0,0 +1,168 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+
+#include "filesystem/File.h"
+#include "network/httprequesthandler/HTTPResponseCache.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Thread.h"
+#include "utils/auto_buffer.h"
+#include "utils/Crc32.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+#define RESPONSE_TEST_THREADS 8
+
+class CountingCreator : public IHTTPResponseCreator
+{
+public:
+  CountingCreator() : m_created(0) { }
+
+  virtual bool CreateResponse(HTTPCachedResponse &response)
+  {
+    m_created++;
+    // take long enough for the other requests to arrive meanwhile
+    XbmcThreads::ThreadSleep(100);
+
+    response.contentType = "image/jpeg";
+    response.data = "resized";
+    return true;
+  }
+
+  std::atomic<int> m_created;
+};
+
+class ResponseThread : public CThread
+{
+public:
+  ResponseThread(CountingCreator &creator)
+    : CThread("ResponseThread"),
+      m_creator(creator)
+  { }
+
+  HTTPCachedResponsePtr m_response;
+
+protected:
+  virtual void Process()
+  {
+    m_response = CHTTPResponseCache::GetInstance().Get("image://test-stampede/?width=100", "1-1", m_creator);
+  }
+
+private:
+  CountingCreator &m_creator;
+};
+
+class TestHTTPResponseCache : public testing::Test
+{
+protected:
+  // responses left on disk by earlier runs must not be found
+  virtual void SetUp()
+  {
+    m_diskSize = g_advancedSettings.m_webServerResponseCacheDisk;
+    g_advancedSettings.m_webServerResponseCacheDisk = 0;
+    CHTTPResponseCache::GetInstance().Clear();
+  }
+
+  virtual void TearDown()
+  {
+    g_advancedSettings.m_webServerResponseCacheDisk = m_diskSize;
+    CHTTPResponseCache::GetInstance().Clear();
+  }
+
+  unsigned int m_diskSize;
+};
+
+TEST_F(TestHTTPResponseCache, CreatesOnceForConcurrentRequests)
+{
+  CountingCreator creator;
+  ResponseThread *threads[RESPONSE_TEST_THREADS];
+  for (int i = 0; i < RESPONSE_TEST_THREADS; i++)
+  {
+    threads[i] = new ResponseThread(creator);
+    threads[i]->Create();
+  }
+  for (int i = 0; i < RESPONSE_TEST_THREADS; i++)
+    threads[i]->StopThread();
+
+  EXPECT_EQ(1, creator.m_created);
+  for (int i = 0; i < RESPONSE_TEST_THREADS; i++)
+  {
+    ASSERT_TRUE(threads[i]->m_response != NULL);
+    EXPECT_STREQ("resized", threads[i]->m_response->data.c_str());
+    delete threads[i];
+  }
+}
+
+TEST_F(TestHTTPResponseCache, CreatesAgainForChangedSource)
+{
+  CountingCreator creator;
+  CHTTPResponseCache &cache = CHTTPResponseCache::GetInstance();
+
+  ASSERT_TRUE(cache.Get("image://test-validator/?width=100", "1-1", creator) != NULL);
+  ASSERT_TRUE(cache.Get("image://test-validator/?width=100", "1-1", creator) != NULL);
+  EXPECT_EQ(1, creator.m_created);
+
+  // another validator means the source has changed
+  ASSERT_TRUE(cache.Get("image://test-validator/?width=100", "2-1", creator) != NULL);
+  EXPECT_EQ(2, creator.m_created);
+
+  // responses without a validator aren't cached
+  ASSERT_TRUE(cache.Get("image://test-validator/?width=100", "", creator) != NULL);
+  EXPECT_EQ(3, creator.m_created);
+
+  EXPECT_STRNE(CHTTPResponseCache::GetETag("image://test-validator/?width=100", "1-1").c_str(),
+               CHTTPResponseCache::GetETag("image://test-validator/?width=100", "2-1").c_str());
+}
+
+TEST_F(TestHTTPResponseCache, IgnoresTruncatedFile)
+{
+  CountingCreator creator;
+  CHTTPResponseCache &cache = CHTTPResponseCache::GetInstance();
+  g_advancedSettings.m_webServerResponseCacheDisk = 64;
+
+  Crc32 crc;
+  crc.Compute("image://test-truncated/?width=100");
+  std::string file = StringUtils::Format("special://temp/webcache/%08x.bin", (unsigned int)crc);
+  XFILE::CFile::Delete(file);
+
+  ASSERT_TRUE(cache.Get("image://test-truncated/?width=100", "1-1", creator) != NULL);
+  EXPECT_EQ(1, creator.m_created);
+
+  // read back from disk
+  cache.Clear();
+  ASSERT_TRUE(cache.Get("image://test-truncated/?width=100", "1-1", creator) != NULL);
+  EXPECT_EQ(1, creator.m_created);
+
+  // a write cut short leaves the header intact
+  XFILE::CFile diskFile;
+  XUTILS::auto_buffer buffer;
+  ASSERT_GT(diskFile.LoadFile(file, buffer), 3);
+  ASSERT_TRUE(diskFile.OpenForWrite(file, true));
+  ASSERT_EQ((ssize_t)buffer.size() - 3, diskFile.Write(buffer.get(), buffer.size() - 3));
+  diskFile.Close();
+
+  cache.Clear();
+  HTTPCachedResponsePtr response = cache.Get("image://test-truncated/?width=100", "1-1", creator);
+  ASSERT_TRUE(response != NULL);
+  EXPECT_EQ(2, creator.m_created);
+  EXPECT_STREQ("resized", response->data.c_str());
+}
@@ -0,0 +1,206 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#include <gtest/gtest.h>
+#include "system.h"
+#include "interfaces/AnnouncementManager.h"
+#include "interfaces/json-rpc/JSONRPC.h"
+#include "network/TCPServer.h"
+#include "threads/SystemClock.h"
+#include "utils/StringUtils.h"
+#include "utils/Variant.h"
+
+using namespace ANNOUNCEMENT;
+
+#define TCPSERVER_PORT          23457
+#define TCPSERVER_CLIENTS       1000
+#define TCPSERVER_ANNOUNCEMENTS 50
+#define TCPSERVER_TIMEOUT       10000
+
+#define TEST_REQUEST_PING       "{ \"jsonrpc\": \"2.0\", \"method\": \"JSONRPC.Ping\", \"id\": 1 }"
+
+/*!
+ Simulates many remotes connected to the JSON-RPC TCP server, all of them
+ receiving the same notifications.
+ */
+class TestTCPServer : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    JSONRPC::CJSONRPC::Initialize();
+    ASSERT_TRUE(JSONRPC::CTCPServer::StartServer(TCPSERVER_PORT, false));
+  }
+
+  virtual void TearDown()
+  {
+    for (std::vector<int>::const_iterator it = sockets.begin(); it != sockets.end(); ++it)
+      close(*it);
+    sockets.clear();
+
+    JSONRPC::CTCPServer::StopServer(true);
+    JSONRPC::CJSONRPC::Cleanup();
+  }
+
+  // every remote takes a socket here and one in the server
+  static int GetMaxClients()
+  {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+      return 100;
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    getrlimit(RLIMIT_NOFILE, &limit);
+
+    return std::min((int)TCPSERVER_CLIENTS, ((int)limit.rlim_cur - 100) / 2);
+  }
+
+  int Connect()
+  {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+      return -1;
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(TCPSERVER_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+      close(fd);
+      return -1;
+    }
+
+    sockets.push_back(fd);
+    return fd;
+  }
+
+  static size_t Count(const std::string &data, const std::string &text)
+  {
+    size_t count = 0;
+    for (size_t pos = data.find(text); pos != std::string::npos; pos = data.find(text, pos + text.size()))
+      count++;
+    return count;
+  }
+
+  // reads until the text was received the given number of times
+  static bool Receive(int fd, std::string &data, const std::string &text, size_t count)
+  {
+    XbmcThreads::EndTime timeout(TCPSERVER_TIMEOUT);
+    while (Count(data, text) < count)
+    {
+      struct pollfd pfd = { fd, POLLIN, 0 };
+      if (timeout.IsTimePast() || poll(&pfd, 1, timeout.MillisLeft()) <= 0)
+        return false;
+
+      char buffer[65536];
+      int length = recv(fd, buffer, sizeof(buffer), 0);
+      if (length <= 0)
+        return false;
+      data.append(buffer, length);
+    }
+
+    return true;
+  }
+
+  static void Announce(const char *message, const CVariant &value)
+  {
+    CVariant data;
+    data["value"] = value;
+    CAnnouncementManager::GetInstance().Announce(Other, "xbmc", message, data);
+  }
+
+  std::vector<int> sockets;
+};
+
+TEST_F(TestTCPServer, AnnounceToManyClients)
+{
+  int clients = GetMaxClients();
+  std::vector<std::string> received(clients);
+
+  for (int i = 0; i < clients; i++)
+  {
+    int fd = Connect();
+    ASSERT_NE(-1, fd);
+    ASSERT_EQ((ssize_t)strlen(TEST_REQUEST_PING), send(fd, TEST_REQUEST_PING, strlen(TEST_REQUEST_PING), 0));
+  }
+
+  // once every remote got its response all of them are known to the server
+  for (int i = 0; i < clients; i++)
+    ASSERT_TRUE(Receive(sockets[i], received[i], "pong", 1));
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (int i = 0; i < TCPSERVER_ANNOUNCEMENTS; i++)
+    Announce("TestTCPServer", i);
+  unsigned int announced = XbmcThreads::SystemClockMillis() - start;
+
+  for (int i = 0; i < clients; i++)
+    ASSERT_TRUE(Receive(sockets[i], received[i], "Other.TestTCPServer", TCPSERVER_ANNOUNCEMENTS)) << "remote " << i;
+
+  // the notifications arrive in the order they were announced
+  size_t pos = 0;
+  for (int i = 0; i < TCPSERVER_ANNOUNCEMENTS; i++)
+  {
+    pos = received[0].find(StringUtils::Format("\"value\":%d", i), pos);
+    ASSERT_NE(std::string::npos, pos);
+  }
+
+  RecordProperty("clients", clients);
+  RecordProperty("announce_ms", announced);
+  RecordProperty("delivery_ms", XbmcThreads::SystemClockMillis() - start);
+}
+
+TEST_F(TestTCPServer, StalledClient)
+{
+  int stalled = Connect();
+  ASSERT_NE(-1, stalled);
+  int reading = Connect();
+  ASSERT_NE(-1, reading);
+
+  std::string received;
+  ASSERT_EQ((ssize_t)strlen(TEST_REQUEST_PING), send(reading, TEST_REQUEST_PING, strlen(TEST_REQUEST_PING), 0));
+  ASSERT_TRUE(Receive(reading, received, "pong", 1));
+
+  // far more than the server queues for a remote which doesn't read, announcing must not block on it
+  std::string blob(65536, 'x');
+  for (int i = 0; i < 300; i++)
+  {
+    Announce("TestTCPServer", blob);
+    ASSERT_TRUE(Receive(reading, received, "Other.TestTCPServer", 1));
+    received.clear();
+  }
+
+  // the stalled remote was dropped, it gets what was sent before and then the connection ends
+  std::string stalledReceived;
+  EXPECT_FALSE(Receive(stalled, stalledReceived, "never sent", 1));
+  EXPECT_LT(Count(stalledReceived, "Other.TestTCPServer"), 300u);
+
+  ASSERT_EQ((ssize_t)strlen(TEST_REQUEST_PING), send(reading, TEST_REQUEST_PING, strlen(TEST_REQUEST_PING), 0));
+  EXPECT_TRUE(Receive(reading, received, "pong", 1));
+}
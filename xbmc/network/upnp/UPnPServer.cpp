@@ -17,6 +17,9 @@
  *  <http://www.gnu.org/licenses/>.
  *
  */
+#include <memory>
+#include <vector>
+
 #include <Platinum/Source/Platinum/Platinum.h>
 
 #include "UPnPServer.h"
@@ -35,6 +38,10 @@
 #include "music/tags/MusicInfoTag.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
 #include "utils/log.h"
 #include "utils/md5.h"
 #include "utils/SortUtils.h"
@@ -50,6 +57,13 @@
 
 NPT_SET_LOCAL_LOGGER("xbmc.upnp.server")
 
+// number of DIDL fragments of library items kept between requests
+#define UPNP_DIDL_CACHE_SIZE 20000
+// a response is built by up to UPNP_BUILD_THREADS threads (the requesting one
+// and jobs), each range of items holding at least UPNP_BUILD_MIN_ITEMS items
+#define UPNP_BUILD_THREADS   4
+#define UPNP_BUILD_MIN_ITEMS 16
+
 using namespace ANNOUNCEMENT;
 using namespace XFILE;
 
@@ -65,12 +79,154 @@ const char* audio_containers[] = { "musicdb://genres/", "musicdb://artists/", "m
 const char* video_containers[] = { "library://video/movies/titles.xml/", "library://video/tvshows/titles.xml/",
                                    "videodb://recentlyaddedmovies/", "videodb://recentlyaddedepisodes/"  };
 
+/*----------------------------------------------------------------------
+|   CUPnPServer::CDidlBuilder
+|
+|   Builds the DIDL fragments of a range of items into didls (one for each
+|   item of the range). Each builder uses its own thumb loader (and so its
+|   own database connections), so they can run in parallel.
++---------------------------------------------------------------------*/
+class CUPnPServer::CDidlBuilder
+{
+public:
+    CDidlBuilder(CUPnPServer&                  server,
+                 CFileItemList&                items,
+                 unsigned long                 start,
+                 unsigned long                 end,
+                 const char*                   filter,
+                 const PLT_HttpRequestContext& context,
+                 const char*                   parent_id,
+                 const std::string&            key_prefix,
+                 NPT_String*                   didls) :
+        m_Server(server),
+        m_Items(items),
+        m_Start(start),
+        m_End(end),
+        m_Filter(filter),
+        m_Context(context),
+        m_ParentId(parent_id),
+        m_KeyPrefix(key_prefix),
+        m_Didls(didls)
+    {
+    }
+
+    // leaves the fragment empty for items which can't be built
+    void Run()
+    {
+        NPT_Reference<CThumbLoader> thumb_loader;
+        bool thumb_loader_created = false;
+
+        for (unsigned long i = m_Start; i < m_End; ++i) {
+            CFileItemPtr item = m_Items[i];
+            std::string key = m_KeyPrefix + item->GetPath();
+            NPT_String& didl = m_Didls[i - m_Start];
+
+            unsigned int generation;
+            if (m_Server.GetCachedDidl(key, didl, generation))
+                continue;
+
+            // only needed when something has to be built
+            if (!thumb_loader_created) {
+                thumb_loader = CreateThumbLoader(m_Items.GetPath());
+                thumb_loader_created = true;
+            }
+
+            PLT_MediaObjectReference object(m_Server.Build(item, true, m_Context, thumb_loader, m_ParentId));
+            if (object.IsNull() || NPT_FAILED(PLT_Didl::ToDidl(*object.AsPointer(), m_Filter, didl))) {
+                didl = "";
+                continue;
+            }
+
+            m_Server.CacheDidl(key, *item, didl, generation);
+        }
+    }
+
+private:
+    CUPnPServer&                  m_Server;
+    CFileItemList&                m_Items;
+    unsigned long                 m_Start;
+    unsigned long                 m_End;
+    const char*                   m_Filter;
+    const PLT_HttpRequestContext& m_Context;
+    const char*                   m_ParentId;
+    std::string                   m_KeyPrefix;
+    NPT_String*                   m_Didls;
+};
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::CDidlBuilders
+|
+|   The ranges of a response, taken one after the other by the requesting
+|   thread and the jobs helping it. Jobs starting after the requesting
+|   thread took the last range find nothing to do, so the requesting thread
+|   only waits for ranges in progress and not for jobs to be started.
++---------------------------------------------------------------------*/
+class CUPnPServer::CDidlBuilders
+{
+public:
+    CDidlBuilders() : m_Next(0), m_Running(0) {}
+
+    void Add(CDidlBuilder* builder) { m_Builders.push_back(std::unique_ptr<CDidlBuilder>(builder)); }
+    size_t Size() const { return m_Builders.size(); }
+
+    // builds the next range not taken yet, false once all are taken
+    bool RunNext()
+    {
+        CSingleLock lock(m_Section);
+        if (m_Next >= m_Builders.size())
+            return false;
+        CDidlBuilder* builder = m_Builders[m_Next++].get();
+        ++m_Running;
+        {
+            CSingleExit exit(m_Section);
+            builder->Run();
+        }
+        if (--m_Running == 0)
+            m_Done.notifyAll();
+        return true;
+    }
+
+    void WaitRunning()
+    {
+        CSingleLock lock(m_Section);
+        while (m_Running > 0)
+            m_Done.wait(lock);
+    }
+
+private:
+    std::vector<std::unique_ptr<CDidlBuilder> > m_Builders;
+    size_t                                      m_Next;
+    unsigned int                                m_Running;
+    CCriticalSection                            m_Section;
+    XbmcThreads::ConditionVariable              m_Done;
+};
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::CDidlBuildJob
++---------------------------------------------------------------------*/
+class CUPnPServer::CDidlBuildJob : public CJob
+{
+public:
+    CDidlBuildJob(const std::shared_ptr<CDidlBuilders>& builders) : m_Builders(builders) {}
+
+    virtual const char* GetType() const { return "upnpdidlbuild"; }
+    virtual bool DoWork()
+    {
+        while (m_Builders->RunNext()) {}
+        return true;
+    }
+
+private:
+    std::shared_ptr<CDidlBuilders> m_Builders;
+};
+
 /*----------------------------------------------------------------------
 |   CUPnPServer::CUPnPServer
 +---------------------------------------------------------------------*/
 CUPnPServer::CUPnPServer(const char* friendly_name, const char* uuid /*= NULL*/, int port /*= 0*/) :
     PLT_MediaConnect(friendly_name, false, uuid, port),
     PLT_FileMediaConnectDelegate("/", "/"),
+    m_DidlGeneration(0),
     m_scanning(g_application.IsMusicScanning() || g_application.IsVideoScanning())
 {
 }
@@ -427,6 +583,7 @@ CUPnPServer::Announce(AnnouncementFlag flag, const char *sender, const char *mes
             m_scanning = true;
         }
         else if (!strcmp(message, "OnScanFinished") || !strcmp(message, "OnCleanFinished")) {
+            ClearDidlCache();
             OnScanCompleted(flag);
         }
     }
@@ -441,6 +598,8 @@ CUPnPServer::Announce(AnnouncementFlag flag, const char *sender, const char *mes
             item_type = data["type"].asString();
         }
 
+        InvalidateDidl(item_type, item_id);
+
         // we always update 'recently added' nodes along with the specific container,
         // as we don't differentiate 'updates' from 'adds' in RPC interface
         if (flag == VideoLibrary) {
@@ -449,6 +608,9 @@ CUPnPServer::Announce(AnnouncementFlag flag, const char *sender, const char *mes
                 if (!db.Open()) return;
                 int show_id = db.GetTvShowForEpisode(item_id);
                 int season_id = db.GetSeasonForEpisode(item_id);
+                // watched counts of the show and the season
+                InvalidateDidl(MediaTypeTvShow, show_id);
+                InvalidateDidl(MediaTypeSeason, season_id);
                 UpdateContainer(StringUtils::Format("videodb://tvshows/titles/%d/", show_id));
                 UpdateContainer(StringUtils::Format("videodb://tvshows/titles/%d/%d/?tvshowid=%d", show_id, season_id, show_id));
                 UpdateContainer("videodb://recentlyaddedepisodes/");
@@ -643,6 +805,27 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
         return NPT_FAILURE;
     }
 
+    // Don't pass parent_id if action is Search not BrowseDirectChildren, as
+    // we want the engine to determine the best parent id, not necessarily the one
+    // passed
+    NPT_String action_name = action->GetActionDesc().GetName();
+    const char* build_parent_id = (action_name.Compare("Search", true)==0)?NULL:parent_id.GetChars();
+
+    // large library listings are paged by the database instead of being listed in full
+    if (requested_count > 0 &&
+        GetPagedItems((const char*)parent_id, starting_index, std::min(requested_count, m_MaxReturnedItems), items)) {
+        return BuildResponse(
+            action,
+            items,
+            filter,
+            starting_index,
+            requested_count,
+            sort_criteria,
+            context,
+            build_parent_id,
+            (NPT_Int32)items.GetProperty("total").asInteger());
+    }
+
     items.SetPath(std::string(parent_id));
 
     // guard against loading while saving to the same cache file
@@ -706,10 +889,6 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
       }
     }
 
-    // Don't pass parent_id if action is Search not BrowseDirectChildren, as
-    // we want the engine to determine the best parent id, not necessarily the one
-    // passed
-    NPT_String action_name = action->GetActionDesc().GetName();
     return BuildResponse(
         action,
         items,
@@ -718,11 +897,14 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
         requested_count,
         sort_criteria,
         context,
-        (action_name.Compare("Search", true)==0)?NULL:parent_id.GetChars());
+        build_parent_id);
 }
 
 /*----------------------------------------------------------------------
 |   CUPnPServer::BuildResponse
+|
+|   total_matches is passed when items only holds the requested range of
+|   a paged listing
 +---------------------------------------------------------------------*/
 NPT_Result
 CUPnPServer::BuildResponse(PLT_ActionReference&          action,
@@ -732,7 +914,8 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
                            NPT_UInt32                    requested_count,
                            const char*                   sort_criteria,
                            const PLT_HttpRequestContext& context,
-                           const char*                   parent_id /* = NULL */)
+                           const char*                   parent_id /* = NULL */,
+                           NPT_Int32                     total_matches /* = -1 */)
 {
     NPT_COMPILER_UNUSED(sort_criteria);
 
@@ -741,24 +924,6 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
         starting_index,
         requested_count);
 
-    // we will reuse this ThumbLoader for all items
-    NPT_Reference<CThumbLoader> thumb_loader;
-
-    if (URIUtils::IsVideoDb(items.GetPath()) ||
-        StringUtils::StartsWithNoCase(items.GetPath(), "library://video/") ||
-        StringUtils::StartsWithNoCase(items.GetPath(), "special://profile/playlists/video/")) {
-
-        thumb_loader = NPT_Reference<CThumbLoader>(new CVideoThumbLoader());
-    }
-    else if (URIUtils::IsMusicDb(items.GetPath()) ||
-        StringUtils::StartsWithNoCase(items.GetPath(), "special://profile/playlists/music/")) {
-
-        thumb_loader = NPT_Reference<CThumbLoader>(new CMusicThumbLoader());
-    }
-    if (!thumb_loader.IsNull()) {
-        thumb_loader->OnLoaderStart();
-    }
-
     // this isn't pretty but needed to properly hide the addons node from clients
     if (StringUtils::StartsWith(items.GetPath(), "library")) {
         for (int i=0; i<items.Size(); i++) {
@@ -770,29 +935,63 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
 
     // won't return more than UPNP_MAX_RETURNED_ITEMS items at a time to keep things smooth
     // 0 requested means as many as possible
-    NPT_UInt32 max_count  = (requested_count == 0)?m_MaxReturnedItems:std::min((unsigned long)requested_count, (unsigned long)m_MaxReturnedItems);
-    NPT_UInt32 stop_index = std::min((unsigned long)(starting_index + max_count), (unsigned long)items.Size()); // don't return more than we can
+    NPT_UInt32 max_count   = (requested_count == 0)?m_MaxReturnedItems:std::min((unsigned long)requested_count, (unsigned long)m_MaxReturnedItems);
+    NPT_UInt32 first_index = (total_matches < 0)?starting_index:0; // a paged listing starts with the first requested item
+    NPT_UInt32 stop_index  = std::min((unsigned long)(first_index + max_count), (unsigned long)items.Size()); // don't return more than we can
 
     NPT_Cardinal count = 0;
-    NPT_Cardinal total = items.Size();
+    NPT_Cardinal total = (total_matches < 0)?items.Size():total_matches;
+
+    // fragments are taken from the cache or built on a few threads at once,
+    // each of the threads building a consecutive range of the items
+    std::vector<NPT_String> didls(stop_index > first_index ? stop_index - first_index : 0);
+    if (!didls.empty()) {
+        std::string key_prefix = StringUtils::Format("%s\n%s\n%s:%d\n",
+            filter ? filter : "",
+            parent_id ? parent_id : "",
+            (const char*)context.GetLocalAddress().GetIpAddress().ToString(),
+            context.GetLocalAddress().GetPort());
+
+        // the client's headers decide about quirks and mime types
+        const NPT_String* user_agent = context.GetRequest().GetHeaders().GetHeaderValue(NPT_HTTP_HEADER_USER_AGENT);
+        const NPT_String* server     = context.GetRequest().GetHeaders().GetHeaderValue(NPT_HTTP_HEADER_SERVER);
+        key_prefix += StringUtils::Format("%s\n%s\n",
+            user_agent ? user_agent->GetChars() : "",
+            server ? server->GetChars() : "");
+
+        unsigned long threads = std::min((unsigned long)UPNP_BUILD_THREADS,
+                                         (unsigned long)(didls.size() + UPNP_BUILD_MIN_ITEMS - 1) / UPNP_BUILD_MIN_ITEMS);
+        unsigned long range = (didls.size() + threads - 1) / threads;
+
+        std::shared_ptr<CDidlBuilders> builders(new CDidlBuilders());
+        for (unsigned long start = first_index; start < stop_index; start += range) {
+            unsigned long end = std::min((unsigned long)stop_index, start + range);
+            builders->Add(new CDidlBuilder(
+                *this, items, start, end, filter, context, parent_id, key_prefix, &didls[start - first_index]));
+        }
+
+        // this thread builds ranges as well, whatever jobs haven't taken when it's done with one
+        for (size_t i = 1; i < builders->Size(); ++i)
+            CJobManager::GetInstance().AddJob(new CDidlBuildJob(builders), NULL, CJob::PRIORITY_NORMAL);
+        while (builders->RunNext()) {}
+        builders->WaitRunning();
+    }
+
+    NPT_Size length = NPT_StringLength(didl_header) + NPT_StringLength(didl_footer);
+    for (size_t i = 0; i < didls.size(); ++i)
+        length += didls[i].GetLength();
+
+    // Neptunes string growing is dead slow for small additions
     NPT_String didl = didl_header;
-    PLT_MediaObjectReference object;
-    for (unsigned long i=starting_index; i<stop_index; ++i) {
-        object = Build(items[i], true, context, thumb_loader, parent_id);
-        if (object.IsNull()) {
+    didl.Reserve(length);
+    for (size_t i = 0; i < didls.size(); ++i) {
+        if (didls[i].IsEmpty()) {
             // don't tell the client this item ever existed
             --total;
             continue;
         }
 
-        NPT_String tmp;
-        NPT_CHECK(PLT_Didl::ToDidl(*object.AsPointer(), filter, tmp));
-
-        // Neptunes string growing is dead slow for small additions
-        if (didl.GetCapacity() < tmp.GetLength() + didl.GetLength()) {
-            didl.Reserve((tmp.GetLength() + didl.GetLength())*2);
-        }
-        didl += tmp;
+        didl += didls[i];
         ++count;
     }
 
@@ -809,6 +1008,182 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
     return NPT_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+|   CUPnPServer::GetPagedItems
+|
+|   Lists only the requested range of the large library listings, ordered
+|   as DefaultSortItems() orders the whole listing. The number of items of
+|   the whole listing is set as the "total" property. The video titles are
+|   browsed through their library nodes, which list the same items as the
+|   videodb paths they are mapped to.
+|
+|   return true if the listing was paged
++---------------------------------------------------------------------*/
+bool
+CUPnPServer::GetPagedItems(const std::string& path,
+                           NPT_UInt32         starting_index,
+                           NPT_UInt32         count,
+                           CFileItemList&     items)
+{
+    std::string db_path = path;
+    if (path == "library://video/movies/titles.xml/")
+        db_path = "videodb://movies/titles/";
+    else if (path == "library://video/tvshows/titles.xml/")
+        db_path = "videodb://tvshows/titles/";
+    else if (path == "library://video/musicvideos/titles.xml/")
+        db_path = "videodb://musicvideos/titles/";
+
+    bool video = db_path == "videodb://movies/titles/" ||
+                 db_path == "videodb://tvshows/titles/" ||
+                 db_path == "videodb://musicvideos/titles/";
+    bool music = db_path == "musicdb://songs/" ||
+                 db_path == "musicdb://albums/" ||
+                 db_path == "musicdb://artists/";
+    if (count == 0 || (!video && !music))
+        return false;
+
+    items.SetPath(db_path);
+
+    SortDescription sorting;
+    CGUIViewState* viewState = CGUIViewState::GetViewState(video ? WINDOW_VIDEO_NAV : -1, items);
+    if (viewState) {
+        sorting = viewState->GetSortMethod();
+        delete viewState;
+    }
+    sorting.limitStart = starting_index;
+    sorting.limitEnd = starting_index + count;
+
+    bool success = false;
+    if (video) {
+        CVideoDatabase db;
+        if (!db.Open())
+            return false;
+
+        if (db_path == "videodb://movies/titles/")
+            success = db.GetMoviesNav(db_path, items, -1, -1, -1, -1, -1, -1, -1, -1, sorting);
+        else if (db_path == "videodb://tvshows/titles/")
+            success = db.GetTvShowsNav(db_path, items, -1, -1, -1, -1, -1, -1, sorting);
+        else
+            success = db.GetMusicVideosNav(db_path, items, -1, -1, -1, -1, -1, -1, -1, sorting);
+    } else {
+        CMusicDatabase db;
+        if (!db.Open())
+            return false;
+
+        if (db_path == "musicdb://songs/")
+            success = db.GetSongsNav(db_path, items, -1, -1, -1, sorting);
+        else if (db_path == "musicdb://albums/")
+            success = db.GetAlbumsNav(db_path, items, -1, -1, CDatabase::Filter(), sorting);
+        else
+            success = db.GetArtistsNav(db_path, items, !CSettings::GetInstance().GetBool(CSettings::SETTING_MUSICLIBRARY_SHOWCOMPILATIONARTISTS),
+                                       -1, -1, -1, CDatabase::Filter(), sorting);
+    }
+
+    if (!success || !items.HasProperty("total")) {
+        items.Clear();
+        return false;
+    }
+
+    items.SetPath(db_path);
+    return true;
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::GetCachedDidl
+|
+|   generation is set to pass to CacheDidl() after building the item, so
+|   it isn't cached when it was updated meanwhile
++---------------------------------------------------------------------*/
+bool
+CUPnPServer::GetCachedDidl(const std::string& key, NPT_String& didl, unsigned int& generation)
+{
+    NPT_AutoLock lock(m_DidlMutex);
+    generation = m_DidlGeneration;
+
+    std::map<std::string, DidlCacheEntry>::iterator itr = m_DidlCache.find(key);
+    if (itr == m_DidlCache.end())
+        return false;
+
+    m_DidlLru.splice(m_DidlLru.begin(), m_DidlLru, itr->second.lru);
+    didl = itr->second.didl;
+    return true;
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::CacheDidl
++---------------------------------------------------------------------*/
+void
+CUPnPServer::CacheDidl(const std::string& key, const CFileItem& item, const NPT_String& didl, unsigned int generation)
+{
+    // only library items are announced when they change
+    std::string media_type;
+    int db_id = -1;
+    if (item.HasVideoInfoTag() && item.GetVideoInfoTag()->m_iDbId > 0) {
+        media_type = item.GetVideoInfoTag()->m_type;
+        db_id = item.GetVideoInfoTag()->m_iDbId;
+    }
+    else if (item.HasMusicInfoTag() && item.GetMusicInfoTag()->GetDatabaseId() > 0) {
+        media_type = item.GetMusicInfoTag()->GetType();
+        db_id = item.GetMusicInfoTag()->GetDatabaseId();
+    }
+    if (media_type.empty())
+        return;
+
+    NPT_AutoLock lock(m_DidlMutex);
+    if (generation != m_DidlGeneration)
+        return;
+
+    std::map<std::string, DidlCacheEntry>::iterator itr = m_DidlCache.find(key);
+    if (itr != m_DidlCache.end()) {
+        m_DidlLru.splice(m_DidlLru.begin(), m_DidlLru, itr->second.lru);
+        m_DidlIndex.erase(itr->second.index);
+    } else {
+        m_DidlLru.push_front(key);
+        itr = m_DidlCache.insert(std::make_pair(key, DidlCacheEntry())).first;
+        itr->second.lru = m_DidlLru.begin();
+    }
+    itr->second.didl = didl;
+    itr->second.index = m_DidlIndex.insert(std::make_pair(std::make_pair(media_type, db_id), key));
+
+    while (m_DidlCache.size() > UPNP_DIDL_CACHE_SIZE) {
+        itr = m_DidlCache.find(m_DidlLru.back());
+        m_DidlIndex.erase(itr->second.index);
+        m_DidlCache.erase(itr);
+        m_DidlLru.pop_back();
+    }
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::InvalidateDidl
++---------------------------------------------------------------------*/
+void
+CUPnPServer::InvalidateDidl(const std::string& media_type, int db_id)
+{
+    NPT_AutoLock lock(m_DidlMutex);
+    ++m_DidlGeneration;
+
+    std::pair<DidlIndex::iterator, DidlIndex::iterator> range = m_DidlIndex.equal_range(std::make_pair(media_type, db_id));
+    for (DidlIndex::iterator index = range.first; index != range.second; ++index) {
+        std::map<std::string, DidlCacheEntry>::iterator itr = m_DidlCache.find(index->second);
+        m_DidlLru.erase(itr->second.lru);
+        m_DidlCache.erase(itr);
+    }
+    m_DidlIndex.erase(range.first, range.second);
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::ClearDidlCache
++---------------------------------------------------------------------*/
+void
+CUPnPServer::ClearDidlCache()
+{
+    NPT_AutoLock lock(m_DidlMutex);
+    ++m_DidlGeneration;
+    m_DidlCache.clear();
+    m_DidlLru.clear();
+    m_DidlIndex.clear();
+}
+
 /*----------------------------------------------------------------------
 |   FindSubCriteria
 +---------------------------------------------------------------------*/
@@ -1306,6 +1681,25 @@ CUPnPServer::DefaultSortItems(CFileItemList& items)
   }
 }
 
+NPT_Reference<CThumbLoader>
+CUPnPServer::CreateThumbLoader(const std::string& path)
+{
+  NPT_Reference<CThumbLoader> thumb_loader;
+
+  if (URIUtils::IsVideoDb(path) ||
+      StringUtils::StartsWithNoCase(path, "library://video/") ||
+      StringUtils::StartsWithNoCase(path, "special://profile/playlists/video/"))
+    thumb_loader = NPT_Reference<CThumbLoader>(new CVideoThumbLoader());
+  else if (URIUtils::IsMusicDb(path) ||
+           StringUtils::StartsWithNoCase(path, "special://profile/playlists/music/"))
+    thumb_loader = NPT_Reference<CThumbLoader>(new CMusicThumbLoader());
+
+  if (!thumb_loader.IsNull())
+    thumb_loader->OnLoaderStart();
+
+  return thumb_loader;
+}
+
 NPT_Result
 CUPnPServer::AddSubtitleUriForSecResponse(NPT_String movie_md5, NPT_String subtitle_uri)
 {
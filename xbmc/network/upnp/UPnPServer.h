@@ -18,6 +18,8 @@
  *
  */
 #pragma once
+#include <list>
+#include <map>
 #include <utility>
 #include <Platinum/Source/Devices/MediaConnect/PltMediaConnect.h>
 
@@ -105,6 +107,10 @@ public:
 
 
 private:
+    class CDidlBuilder;
+    class CDidlBuilders;
+    class CDidlBuildJob;
+
     void OnScanCompleted(int type);
     void UpdateContainer(const std::string& id);
     void PropagateUpdates();
@@ -121,11 +127,23 @@ private:
                                    NPT_UInt32                    requested_count,
                                    const char*                   sort_criteria,
                                    const PLT_HttpRequestContext& context,
-                                   const char*                   parent_id /* = NULL */);
+                                   const char*                   parent_id /* = NULL */,
+                                   NPT_Int32                     total_matches = -1);
+    bool             GetPagedItems(const std::string& path,
+                                   NPT_UInt32                    starting_index,
+                                   NPT_UInt32                    count,
+                                   CFileItemList&                items);
+
+    // DIDL fragments of library items, dropped when the item is updated
+    bool GetCachedDidl(const std::string& key, NPT_String& didl, unsigned int& generation);
+    void CacheDidl(const std::string& key, const CFileItem& item, const NPT_String& didl, unsigned int generation);
+    void InvalidateDidl(const std::string& media_type, int db_id);
+    void ClearDidlCache();
 
     // class methods
     static bool SortItems(CFileItemList& items, const char* sort_criteria);
     static void DefaultSortItems(CFileItemList& items);
+    static NPT_Reference<CThumbLoader> CreateThumbLoader(const std::string& path);
     static NPT_String GetParentFolder(NPT_String file_path) {
         int index = file_path.ReverseFind("\\");
         if (index == -1) return "";
@@ -138,6 +156,21 @@ private:
     NPT_Mutex                       m_FileMutex;
     NPT_Map<NPT_String, NPT_String> m_FileMap;
 
+    // keys of the cached fragments by media type and database id of their item
+    typedef std::multimap<std::pair<std::string, int>, std::string> DidlIndex;
+
+    typedef struct DidlCacheEntry {
+        NPT_String                       didl;
+        DidlIndex::iterator              index;
+        std::list<std::string>::iterator lru;
+    } DidlCacheEntry;
+
+    NPT_Mutex                               m_DidlMutex;
+    std::map<std::string, DidlCacheEntry>   m_DidlCache;
+    DidlIndex                               m_DidlIndex;
+    std::list<std::string>                  m_DidlLru; // most recently used first
+    unsigned int                            m_DidlGeneration;
+
     std::map<std::string, std::pair<bool, unsigned long> > m_UpdateIDs;
     bool m_scanning;
 public:
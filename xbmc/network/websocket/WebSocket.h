@@ -124,6 +124,13 @@ public:
   virtual bool Handshake(const char* data, size_t length, std::string &response) = 0;
   virtual const CWebSocketMessage* Handle(const char* &buffer, size_t &length, bool &send);
   virtual const CWebSocketMessage* Send(WebSocketFrameOpcode opcode, const char* data = NULL, uint32_t length = 0);
+  /*!
+   \brief Creates a frame carrying one part of a fragmented message, the caller owns the frame
+   \param opcode Opcode of the message, only the first fragment carries it
+   \param first Whether this is the first fragment of the message
+   \param final Whether this is the last fragment of the message
+   */
+  virtual CWebSocketFrame* GetFragment(WebSocketFrameOpcode opcode, const char* data, uint32_t length, bool first, bool final);
   virtual const CWebSocketFrame* Ping(const char* data = NULL) const = 0;
   virtual const CWebSocketFrame* Pong(const char* data = NULL) const = 0;
   virtual const CWebSocketFrame* Close(WebSocketCloseReason reason = WebSocketCloseNormal, const std::string &message = "") = 0;
@@ -94,9 +94,10 @@ CPeripheralCecAdapter::CPeripheralCecAdapter(const PeripheralScanResult& scanRes
 
 CPeripheralCecAdapter::~CPeripheralCecAdapter(void)
 {
+  // announcements are delivered with the announcement manager's lock held, don't hold ours when removing
+  CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
   {
     CSingleLock lock(m_critSection);
-    CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
     m_bStop = true;
   }
 
@@ -368,7 +369,8 @@ void CPeripheralCecAdapter::Process(void)
     m_bActiveSourceBeforeStandby = false;
   }
 
-  CAnnouncementManager::GetInstance().AddAnnouncer(this);
+  // standby on System.OnSleep has to be done before the box suspends
+  CAnnouncementManager::GetInstance().AddAnnouncer(this, true);
 
   m_queryThread = new CPeripheralCecAdapterUpdateThread(this, &m_configuration);
   m_queryThread->Create(false);
@@ -1670,10 +1672,10 @@ void CPeripheralCecAdapter::OnDeviceRemoved(void)
 bool CPeripheralCecAdapter::ReopenConnection(void)
 {
   // stop running thread
+  CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
   {
     CSingleLock lock(m_critSection);
     m_iExitCode = EXITCODE_RESTARTAPP;
-    CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
     StopThread(false);
   }
   StopThread();
@@ -45,6 +45,13 @@
 #include "interfaces/AnnouncementManager.h"
 #include "pictures/GUIViewStatePictures.h"
 #include "pictures/PictureThumbLoader.h"
+#include "filesystem/File.h"
+#include "guilib/JpegIO.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+
+#include <algorithm>
+#include <set>
 
 using namespace XFILE;
 using namespace KODI::MESSAGING;
@@ -62,6 +69,10 @@ using namespace KODI::MESSAGING;
 
 #define ROTATION_SNAP_RANGE              10.0f
 
+#define PRELOAD_PICTURES                     3  // decoded ahead of the next picture
+#define PRELOAD_PARALLEL                     2  // decoded at the same time
+#define PRELOAD_MEMORY_BUDGET  (128*1024*1024)  // for decoded pictures not shown yet
+
 #define FPS                                 25
 
 #define BAR_IMAGE                            1
@@ -72,6 +83,224 @@ using namespace KODI::MESSAGING;
 
 static float zoomamount[10] = { 1.0f, 1.2f, 1.5f, 2.0f, 2.8f, 4.0f, 6.0f, 9.0f, 13.5f, 20.0f };
 
+/*! \brief Pictures decoded ahead of the slideshow by jobs, shared with the jobs so they may outlive the loader
+ */
+class CSlideShowPreloadQueue : public std::enable_shared_from_this<CSlideShowPreloadQueue>
+{
+public:
+  enum STATE { NOT_QUEUED = 0, DECODING, DECODED };
+
+  CSlideShowPreloadQueue()
+    : m_size(0)
+    , m_running(0)
+    , m_maxWidth(0)
+    , m_maxHeight(0)
+    , m_stopped(false)
+  {
+  }
+
+  ~CSlideShowPreloadQueue()
+  {
+    Stop();
+  }
+
+  void Set(const std::vector<std::string> &fileNames, int maxWidth, int maxHeight)
+  {
+    CSingleLock lock(m_section);
+    if (m_stopped)
+      return;
+    // pictures handed out aren't decoded again as long as they are asked for
+    std::set<std::string> taken;
+    m_wanted.clear();
+    for (std::vector<std::string>::const_iterator i = fileNames.begin(); i != fileNames.end(); ++i)
+    {
+      if (m_taken.find(*i) != m_taken.end())
+        taken.insert(*i);
+      else
+        m_wanted.push_back(*i);
+    }
+    m_taken.swap(taken);
+    m_maxWidth = maxWidth;
+    m_maxHeight = maxHeight;
+
+    // drop what won't be shown, running decodes are dropped once they are done
+    for (Pictures::iterator i = m_pictures.begin(); i != m_pictures.end();)
+    {
+      if (!i->second.decoding && (!IsWanted(i->first) || !i->second.Fits(maxWidth, maxHeight)))
+      {
+        delete i->second.texture;
+        m_size -= i->second.size;
+        m_pictures.erase(i++);
+      }
+      else
+        ++i;
+    }
+    StartDecodes();
+  }
+
+  STATE Take(const std::string &fileName, int maxWidth, int maxHeight, CBaseTexture *&texture)
+  {
+    CSingleLock lock(m_section);
+    Pictures::iterator i = m_pictures.find(fileName);
+    if (i != m_pictures.end() && i->second.Fits(maxWidth, maxHeight) && i->second.decoding)
+      return DECODING;
+
+    // the picture is decoded by the caller otherwise, it mustn't be decoded ahead again
+    m_wanted.erase(std::remove(m_wanted.begin(), m_wanted.end(), fileName), m_wanted.end());
+    m_taken.insert(fileName);
+    if (i == m_pictures.end() || !i->second.Fits(maxWidth, maxHeight))
+      return NOT_QUEUED;
+
+    texture = i->second.texture;
+    m_size -= i->second.size;
+    m_pictures.erase(i);
+    StartDecodes();
+    return DECODED;
+  }
+
+  bool WaitDecoded(unsigned int milliSeconds)
+  {
+    return m_decoded.WaitMSec(milliSeconds);
+  }
+
+  bool IsWanted(const std::string &fileName, int maxWidth, int maxHeight)
+  {
+    CSingleLock lock(m_section);
+    return !m_stopped && maxWidth == m_maxWidth && maxHeight == m_maxHeight && IsWanted(fileName);
+  }
+
+  void OnDecoded(const std::string &fileName, int maxWidth, int maxHeight, CBaseTexture *texture)
+  {
+    CSingleLock lock(m_section);
+    m_running--;
+    Pictures::iterator i = m_pictures.find(fileName);
+    if (i != m_pictures.end() && i->second.decoding && i->second.Fits(maxWidth, maxHeight))
+    {
+      m_size -= i->second.size;
+      if (!m_stopped && IsWanted(fileName) && maxWidth == m_maxWidth && maxHeight == m_maxHeight)
+      {
+        // failed pictures stay queued, so they aren't decoded again
+        i->second.decoding = false;
+        i->second.texture = texture;
+        i->second.size = texture ? texture->GetPitch() * texture->GetRows() : 0;
+        m_size += i->second.size;
+        texture = NULL;
+      }
+      else
+        m_pictures.erase(i);
+    }
+    delete texture;
+    StartDecodes();
+    lock.Leave();
+    m_decoded.Set();
+  }
+
+  void Stop()
+  {
+    CSingleLock lock(m_section);
+    m_stopped = true;
+    m_wanted.clear();
+    m_taken.clear();
+    for (Pictures::iterator i = m_pictures.begin(); i != m_pictures.end(); ++i)
+    {
+      if (i->second.decoding)
+        CJobManager::GetInstance().CancelJob(i->second.jobID);
+      else
+        delete i->second.texture;
+    }
+    m_pictures.clear();
+    m_size = 0;
+    lock.Leave();
+    m_decoded.Set();
+  }
+
+private:
+  struct CPicture
+  {
+    CBaseTexture *texture;
+    bool decoding;
+    unsigned int jobID;
+    size_t size;      ///< of the decoded picture, estimated while decoding
+    int maxWidth;
+    int maxHeight;
+
+    bool Fits(int width, int height) const { return maxWidth == width && maxHeight == height; }
+  };
+  typedef std::map<std::string, CPicture> Pictures;
+
+  bool IsWanted(const std::string &fileName) const
+  {
+    return std::find(m_wanted.begin(), m_wanted.end(), fileName) != m_wanted.end();
+  }
+
+  void StartDecodes();
+
+  CCriticalSection m_section;
+  CEvent m_decoded;
+  Pictures m_pictures;
+  std::vector<std::string> m_wanted;
+  std::set<std::string> m_taken;
+  size_t m_size;
+  int m_running;
+  int m_maxWidth;
+  int m_maxHeight;
+  bool m_stopped;
+};
+
+class CSlideShowDecodeJob : public CJob
+{
+public:
+  CSlideShowDecodeJob(const std::shared_ptr<CSlideShowPreloadQueue> &queue, const std::string &fileName, int maxWidth, int maxHeight)
+    : m_queue(queue)
+    , m_fileName(fileName)
+    , m_maxWidth(maxWidth)
+    , m_maxHeight(maxHeight)
+  {
+  }
+
+  virtual const char *GetType() const { return "slideshowdecode"; }
+
+  virtual bool DoWork()
+  {
+    CBaseTexture *texture = NULL;
+    // the slideshow may have moved on while the job was queued
+    if (m_queue->IsWanted(m_fileName, m_maxWidth, m_maxHeight))
+      texture = CBackgroundPicLoader::DecodePic(m_fileName, m_maxWidth, m_maxHeight);
+    m_queue->OnDecoded(m_fileName, m_maxWidth, m_maxHeight, texture);
+    return texture != NULL;
+  }
+
+private:
+  std::shared_ptr<CSlideShowPreloadQueue> m_queue;
+  std::string m_fileName;
+  int m_maxWidth;
+  int m_maxHeight;
+};
+
+void CSlideShowPreloadQueue::StartDecodes()
+{
+  size_t estimate = (size_t)m_maxWidth * m_maxHeight * 4;
+  for (std::vector<std::string>::const_iterator i = m_wanted.begin(); i != m_wanted.end() && m_running < PRELOAD_PARALLEL; ++i)
+  {
+    if (m_pictures.find(*i) != m_pictures.end())
+      continue;
+    // the picture shown next is always decoded
+    if (!m_pictures.empty() && m_size + estimate > PRELOAD_MEMORY_BUDGET)
+      break;
+
+    CPicture picture;
+    picture.texture = NULL;
+    picture.decoding = true;
+    picture.size = estimate;
+    picture.maxWidth = m_maxWidth;
+    picture.maxHeight = m_maxHeight;
+    picture.jobID = CJobManager::GetInstance().AddJob(new CSlideShowDecodeJob(shared_from_this(), *i, m_maxWidth, m_maxHeight), NULL);
+    m_pictures[*i] = picture;
+    m_size += estimate;
+    m_running++;
+  }
+}
+
 CBackgroundPicLoader::CBackgroundPicLoader()
   : CThread("BgPicLoader")
   , m_iPic{0}
@@ -80,12 +309,14 @@ CBackgroundPicLoader::CBackgroundPicLoader()
   , m_maxHeight{0}
   , m_isLoading{false}
   , m_pCallback{nullptr}
+  , m_preload{std::make_shared<CSlideShowPreloadQueue>()}
 {
 }
 
 CBackgroundPicLoader::~CBackgroundPicLoader()
 {
   StopThread();
+  m_preload->Stop();
 }
 
 void CBackgroundPicLoader::Create(CGUIWindowSlideShow *pCallback)
@@ -99,6 +330,7 @@ void CBackgroundPicLoader::Process()
 {
   unsigned int totalTime = 0;
   unsigned int count = 0;
+  unsigned int preloaded = 0;
   while (!m_bStop)
   { // loop around forever, waiting for the app to call LoadPic
     if (AbortableWait(m_loadPic,10) == WAIT_SIGNALED)
@@ -106,7 +338,15 @@ void CBackgroundPicLoader::Process()
       if (m_pCallback)
       {
         unsigned int start = XbmcThreads::SystemClockMillis();
-        CBaseTexture* texture = CTexture::LoadFromFile(m_strFileName, m_maxWidth, m_maxHeight);
+        // take the picture from the preload queue, waiting for it if it's being decoded
+        CBaseTexture* texture = NULL;
+        CSlideShowPreloadQueue::STATE state;
+        while ((state = m_preload->Take(m_strFileName, m_maxWidth, m_maxHeight, texture)) == CSlideShowPreloadQueue::DECODING && !m_bStop)
+          m_preload->WaitDecoded(50);
+        if (state == CSlideShowPreloadQueue::DECODED)
+          preloaded++;
+        else
+          texture = DecodePic(m_strFileName, m_maxWidth, m_maxHeight);
         totalTime += XbmcThreads::SystemClockMillis() - start;
         count++;
         // tell our parent
@@ -114,6 +354,8 @@ void CBackgroundPicLoader::Process()
         if (texture)
         {
           bFullSize = ((int)texture->GetWidth() < m_maxWidth) && ((int)texture->GetHeight() < m_maxHeight);
+          if (!bFullSize && texture->GetWidth() >= texture->GetOriginalWidth() && texture->GetHeight() >= texture->GetOriginalHeight())
+            bFullSize = true;
           if (!bFullSize)
           {
             int iSize = texture->GetWidth() * texture->GetHeight() - MAX_PICTURE_SIZE;
@@ -131,8 +373,8 @@ void CBackgroundPicLoader::Process()
     }
   }
   if (count > 0)
-    CLog::Log(LOGDEBUG, "Time for loading %u images: %u ms, average %u ms",
-              count, totalTime, totalTime / count);
+    CLog::Log(LOGDEBUG, "Time for loading %u images (%u decoded ahead): %u ms, average %u ms",
+              count, preloaded, totalTime, totalTime / count);
 }
 
 void CBackgroundPicLoader::LoadPic(int iPic, int iSlideNumber, const std::string &strFileName, const int maxWidth, const int maxHeight)
@@ -146,6 +388,35 @@ void CBackgroundPicLoader::LoadPic(int iPic, int iSlideNumber, const std::string
   m_loadPic.Set();
 }
 
+void CBackgroundPicLoader::Preload(const std::vector<std::string> &fileNames, const int maxWidth, const int maxHeight)
+{
+  m_preload->Set(fileNames, maxWidth, maxHeight);
+}
+
+CBaseTexture *CBackgroundPicLoader::DecodePic(const std::string &strFileName, int maxWidth, int maxHeight)
+{
+  // JPEGs turned by 90 degrees are shown with width and height swapped, so they are decoded
+  // to cover the screen that way. The orientation is read from the EXIF header only.
+  if (URIUtils::HasExtension(strFileName, ".jpg|.jpeg|.jpe"))
+  {
+    XFILE::CFile file;
+    XFILE::auto_buffer buf;
+    unsigned int width, height, orientation;
+    if (file.LoadFile(strFileName, buf) > 0 &&
+        CJpegIO::GetImageSize((unsigned char*)buf.get(), buf.size(), width, height, &orientation))
+    {
+      if (orientation >= 5 && orientation <= 8)
+        std::swap(maxWidth, maxHeight);
+      CBaseTexture *texture = CTexture::LoadFromFileInMemory((unsigned char*)buf.get(), buf.size(), "image/jpeg", maxWidth, maxHeight);
+      if (texture)
+        return texture;
+    }
+  }
+  // libjpeg decodes at the smallest scale covering the size, other loaders shrink pictures to fit
+  // into it, which would lose the resolution of panoramas. They are decoded as large as possible.
+  return CTexture::LoadFromFile(strFileName, g_Windowing.GetMaxTextureSize(), g_Windowing.GetMaxTextureSize());
+}
+
 CGUIWindowSlideShow::CGUIWindowSlideShow(void)
     : CGUIWindow(WINDOW_SLIDESHOW, "SlideShow.xml")
 {
@@ -244,6 +515,7 @@ void CGUIWindowSlideShow::Reset()
   m_iZoomFactor = 1;
   m_fZoom = 1.0f;
   m_fInitialZoom = 0.0f;
+  m_fLoadedZoom = 1.0f;
   m_iCurrentSlide = 0;
   m_iNextSlide = 1;
   m_iCurrentPic = 0;
@@ -522,11 +794,29 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
                      (float)res.iHeight * m_fZoom,
                      maxWidth, maxHeight);
       m_pBackgroundLoader->LoadPic(m_iCurrentPic, m_iCurrentSlide, picturePath, maxWidth, maxHeight);
+      m_fLoadedZoom = m_fZoom;
       m_iLastFailedNextSlide = -1;
       m_bLoadNextPic = false;
     }
   }
 
+  // decode the current picture again for the zoom level, the decoded one only covers the screen
+  if (m_Image[m_iCurrentPic].IsLoaded() && !m_Image[m_iCurrentPic].FullSize() && m_fZoom > m_fLoadedZoom &&
+      !m_Image[m_iCurrentPic].DrawNextImage() && !m_pBackgroundLoader->IsLoading())
+  {
+    std::string picturePath = GetPicturePath(m_slides->Get(m_iCurrentSlide).get());
+    if (!picturePath.empty())
+    {
+      CLog::Log(LOGDEBUG, "Loading the current image %d for zoom %.1f: %s", m_iCurrentSlide, m_fZoom, picturePath.c_str());
+      int maxWidth, maxHeight;
+      GetCheckedSize((float)res.iWidth * m_fZoom,
+                     (float)res.iHeight * m_fZoom,
+                     maxWidth, maxHeight);
+      m_pBackgroundLoader->LoadPic(m_iCurrentPic, m_iCurrentSlide, picturePath, maxWidth, maxHeight);
+    }
+    m_fLoadedZoom = m_fZoom;
+  }
+
   // check if we should discard an already loaded next slide
   if (m_Image[1 - m_iCurrentPic].IsLoaded() && m_Image[1 - m_iCurrentPic].SlideNumber() != m_iNextSlide)
     m_Image[1 - m_iCurrentPic].Close();
@@ -551,6 +841,19 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
     }
   }
 
+  // decode the pictures after the current one ahead, at the size LoadPic() asks for them
+  {
+    int maxWidth, maxHeight;
+    GetCheckedSize((float)res.iWidth * m_fZoom,
+                   (float)res.iHeight * m_fZoom,
+                   maxWidth, maxHeight);
+    PreloadSlides(maxWidth, maxHeight);
+  }
+
+  // upload the next picture while the current one is shown, not when the transition starts
+  if (m_Image[1 - m_iCurrentPic].IsLoaded() && !m_Image[m_iCurrentPic].DrawNextImage())
+    m_Image[1 - m_iCurrentPic].LoadToGPU();
+
   if (m_slides->Get(m_iCurrentSlide)->IsVideo() && bSlideShow)
   {
     if (!PlayVideo())
@@ -644,6 +947,7 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
 
     m_iZoomFactor = 1;
     m_fZoom = 1.0f;
+    m_fLoadedZoom = 1.0f;
     m_fRotate = 0.0f;
   }
 
@@ -666,6 +970,22 @@ void CGUIWindowSlideShow::Render()
   CGUIWindow::Render();
 }
 
+void CGUIWindowSlideShow::PreloadSlides(int maxWidth, int maxHeight)
+{
+  std::vector<std::string> fileNames;
+  int step = m_iDirection >= 0 ? 1 : -1;
+  int slide = m_iNextSlide;
+  for (int i = 0; i <= PRELOAD_PICTURES && slide != m_iCurrentSlide; i++)
+  {
+    // video thumbs are only looked up when they are shown
+    const CFileItemPtr item = m_slides->Get(slide);
+    if (!item->IsVideo() && !item->HasProperty("unplayable"))
+      fileNames.push_back(item->GetPath());
+    slide = (slide + step + m_slides->Size()) % m_slides->Size();
+  }
+  m_pBackgroundLoader->Preload(fileNames, maxWidth, maxHeight);
+}
+
 int CGUIWindowSlideShow::GetNextSlide()
 {
   if (m_slides->Size() <= 1)
@@ -1022,6 +1342,7 @@ bool CGUIWindowSlideShow::OnMessage(CGUIMessage& message)
             AnnouncePlayerPlay(m_slides->Get(m_iCurrentSlide));
             m_iZoomFactor = 1;
             m_fZoom = 1.0f;
+            m_fLoadedZoom = 1.0f;
             m_fRotate = 0.0f;
           }
         }
@@ -1150,6 +1471,12 @@ void CGUIWindowSlideShow::OnLoadPic(int iPic, int iSlideNumber, const std::strin
       return;
     }
     CLog::Log(LOGDEBUG, "Finished background loading slot %d, %d: %s", iPic, iSlideNumber, m_slides->Get(iSlideNumber)->GetPath().c_str());
+    if (m_Image[iPic].IsLoaded() && m_Image[iPic].SlideNumber() == iSlideNumber && iPic == m_iCurrentPic)
+    { // decoded again for zooming
+      m_Image[iPic].UpdateTexture(pTexture);
+      m_Image[iPic].SetOriginalSize(pTexture->GetOriginalWidth(), pTexture->GetOriginalHeight(), bFullSize);
+      return;
+    }
     m_Image[iPic].SetTexture(iSlideNumber, pTexture, GetDisplayEffect(iSlideNumber));
     m_Image[iPic].SetOriginalSize(pTexture->GetOriginalWidth(), pTexture->GetOriginalHeight(), bFullSize);
     
@@ -1296,8 +1623,9 @@ void CGUIWindowSlideShow::AddItems(const std::string &strPath, path_set *recursi
 
 void CGUIWindowSlideShow::GetCheckedSize(float width, float height, int &maxWidth, int &maxHeight)
 {
-  maxWidth = g_Windowing.GetMaxTextureSize();
-  maxHeight = g_Windowing.GetMaxTextureSize();
+  // pictures are decoded for the screen, zooming in decodes the current one again
+  maxWidth = std::min((int)(width + 0.5f), (int)g_Windowing.GetMaxTextureSize());
+  maxHeight = std::min((int)(height + 0.5f), (int)g_Windowing.GetMaxTextureSize());
 }
 
 std::string CGUIWindowSlideShow::GetPicturePath(CFileItem *item)
@@ -20,7 +20,9 @@
  *
  */
 
+#include <memory>
 #include <set>
+#include <vector>
 #include "guilib/GUIWindow.h"
 #include "threads/Thread.h"
 #include "threads/CriticalSection.h"
@@ -33,6 +35,7 @@ class CFileItemList;
 class CVariant;
 
 class CGUIWindowSlideShow;
+class CSlideShowPreloadQueue;
 
 class CBackgroundPicLoader : public CThread
 {
@@ -46,6 +49,17 @@ public:
   int SlideNumber() const { return m_iSlideNumber; }
   int Pic() const { return m_iPic; }
 
+  /*! \brief Decode the pictures following the next one in parallel, so LoadPic() finds them ready
+   \param fileNames pictures in the order they are shown, decoded pictures no longer listed are dropped
+   \param maxWidth width of the screen area the pictures are decoded for
+   \param maxHeight height of the screen area the pictures are decoded for
+   */
+  void Preload(const std::vector<std::string> &fileNames, const int maxWidth, const int maxHeight);
+
+  /*! \brief Decode a picture to fit the given size, turned pictures are decoded to fit it once turned
+   */
+  static CBaseTexture *DecodePic(const std::string &strFileName, int maxWidth, int maxHeight);
+
 private:
   void Process();
   int m_iPic;
@@ -58,6 +72,7 @@ private:
   bool m_isLoading;
 
   CGUIWindowSlideShow *m_pCallback;
+  std::shared_ptr<CSlideShowPreloadQueue> m_preload;
 };
 
 class CGUIWindowSlideShow : public CGUIWindow
@@ -120,6 +135,7 @@ private:
   void GetCheckedSize(float width, float height, int &maxWidth, int &maxHeight);
   std::string GetPicturePath(CFileItem *item);
   int  GetNextSlide();
+  void PreloadSlides(int maxWidth, int maxHeight);
 
   void AnnouncePlayerPlay(const CFileItemPtr& item);
   void AnnouncePlayerPause(const CFileItemPtr& item);
@@ -137,6 +153,7 @@ private:
   int m_iZoomFactor;
   float m_fZoom;
   float m_fInitialZoom;
+  float m_fLoadedZoom; // zoom the current picture was decoded for
 
   bool m_bShuffled;
   bool m_bSlideShow;
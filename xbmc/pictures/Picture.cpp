@@ -214,36 +214,16 @@ bool CPicture::CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, ui
   uint32_t &dest_width, uint32_t &dest_height, const std::string &dest,
   CPictureScalingAlgorithm::Algorithm scalingAlgorithm /* = CPictureScalingAlgorithm::NoAlgorithm */)
 {
-  // if no max width or height is specified, don't resize
-  if (dest_width == 0)
-    dest_width = width;
-  if (dest_height == 0)
-    dest_height = height;
   if (scalingAlgorithm == CPictureScalingAlgorithm::NoAlgorithm)
     scalingAlgorithm = g_advancedSettings.m_imageScalingAlgorithm;
 
-  uint32_t max_height = g_advancedSettings.m_imageRes;
-  if (g_advancedSettings.m_fanartRes > g_advancedSettings.m_imageRes)
-  { // 16x9 images larger than the fanart res use that rather than the image res
-    if (fabsf((float)width / (float)height / (16.0f/9.0f) - 1.0f) <= 0.01f && height >= g_advancedSettings.m_fanartRes)
-    {
-      max_height = g_advancedSettings.m_fanartRes;
-    }
-  }
-  uint32_t max_width = max_height * 16/9;
-
-  dest_height = std::min(dest_height, max_height);
-  dest_width  = std::min(dest_width, max_width);
+  GetCacheSize(width, height, dest_width, dest_height);
 
-  if (width > dest_width || height > dest_height || orientation)
+  if (dest_width != width || dest_height != height || orientation)
   {
     bool success = false;
 
-    dest_width = std::min(width, dest_width);
-    dest_height = std::min(height, dest_height);
-
     // create a buffer large enough for the resulting image
-    GetScale(width, height, dest_width, dest_height);
     uint32_t *buffer = new uint32_t[dest_width * dest_height];
     if (buffer)
     {
@@ -262,13 +242,45 @@ bool CPicture::CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, ui
   }
   else
   { // no orientation needed
-    dest_width = width;
-    dest_height = height;
     return CreateThumbnailFromSurface(pixels, width, height, pitch, dest);
   }
   return false;
 }
 
+void CPicture::GetCacheSize(uint32_t width, uint32_t height, uint32_t &dest_width, uint32_t &dest_height)
+{
+  // if no max width or height is specified, don't resize
+  if (dest_width == 0)
+    dest_width = width;
+  if (dest_height == 0)
+    dest_height = height;
+
+  uint32_t max_height = g_advancedSettings.m_imageRes;
+  if (g_advancedSettings.m_fanartRes > g_advancedSettings.m_imageRes)
+  { // 16x9 images larger than the fanart res use that rather than the image res
+    if (fabsf((float)width / (float)height / (16.0f/9.0f) - 1.0f) <= 0.01f && height >= g_advancedSettings.m_fanartRes)
+    {
+      max_height = g_advancedSettings.m_fanartRes;
+    }
+  }
+  uint32_t max_width = max_height * 16/9;
+
+  dest_height = std::min(dest_height, max_height);
+  dest_width  = std::min(dest_width, max_width);
+
+  if (width > dest_width || height > dest_height)
+  {
+    dest_width = std::min(width, dest_width);
+    dest_height = std::min(height, dest_height);
+    GetScale(width, height, dest_width, dest_height);
+  }
+  else
+  {
+    dest_width = width;
+    dest_height = height;
+  }
+}
+
 bool CPicture::CreateTiledThumb(const std::vector<std::string> &files, const std::string &thumb)
 {
   if (!files.size())
@@ -257,6 +257,13 @@ void CSlideShowPic::UpdateTexture(CBaseTexture* pTexture)
   m_bIsDirty = true;
 }
 
+void CSlideShowPic::LoadToGPU()
+{
+  CSingleLock lock(m_textureAccess);
+  if (m_pImage)
+    m_pImage->LoadToGPU();
+}
+
 static CRect GetRectangle(const float x[4], const float y[4])
 {
   CRect rect;
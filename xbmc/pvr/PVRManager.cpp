@@ -99,7 +99,7 @@ CPVRManager::CPVRManager(void) :
     m_progressHandle(NULL),
     m_managerState(ManagerStateStopped)
 {
-  CAnnouncementManager::GetInstance().AddAnnouncer(this);
+  CAnnouncementManager::GetInstance().AddAnnouncer(this, true);
   ResetProperties();
 }
 
@@ -57,6 +57,11 @@ bool CRenderSystemBase::SupportsDXT() const
   return (m_renderCaps & RENDER_CAPS_DXT) == RENDER_CAPS_DXT;
 }
 
+bool CRenderSystemBase::SupportsETC1() const
+{
+  return (m_renderCaps & RENDER_CAPS_ETC1) == RENDER_CAPS_ETC1;
+}
+
 bool CRenderSystemBase::SupportsBGRA() const
 {
   return (m_renderCaps & RENDER_CAPS_BGRA) == RENDER_CAPS_BGRA;
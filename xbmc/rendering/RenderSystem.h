@@ -50,7 +50,8 @@ enum
   RENDER_CAPS_NPOT     = (1 << 1),
   RENDER_CAPS_DXT_NPOT = (1 << 2),
   RENDER_CAPS_BGRA     = (1 << 3),
-  RENDER_CAPS_BGRA_APPLE = (1 << 4)
+  RENDER_CAPS_BGRA_APPLE = (1 << 4),
+  RENDER_CAPS_ETC1     = (1 << 5)
 };
 
 enum
@@ -107,6 +108,16 @@ public:
   virtual bool ClearBuffers(color_t color) = 0;
   virtual bool IsExtSupported(const char* extension) = 0;
 
+  /*! \brief Age of the back buffer rendered to in this frame, valid after BeginRender()
+   \return -1 if unknown, 0 if the contents are undefined, otherwise the number of frames since the buffer was presented
+   */
+  virtual int GetBufferAge() const { return -1; }
+
+  /*! \brief Limit the update of the back buffer in this frame to the given regions
+   Has to be called after BeginRender() and before anything is drawn, nothing may be drawn outside of the regions.
+   */
+  virtual void SetDamageRegion(const CDirtyRegionList &dirty) { }
+
   virtual void SetVSync(bool vsync) = 0;
   bool GetVSync() { return m_bVSync; }
 
@@ -143,6 +154,7 @@ public:
   const std::string& GetRenderRenderer() const { return m_RenderRenderer; }
   const std::string& GetRenderVersionString() const { return m_RenderVersion; }
   bool SupportsDXT() const;
+  bool SupportsETC1() const;
   bool SupportsBGRA() const;
   bool SupportsBGRAApple() const;
   bool SupportsNPOT(bool dxt) const;
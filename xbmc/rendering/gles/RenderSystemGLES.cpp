@@ -27,6 +27,7 @@
 #include "settings/AdvancedSettings.h"
 #include "RenderSystemGLES.h"
 #include "guilib/MatrixGLES.h"
+#include "guilib/GUIQuadBatchGLES.h"
 #include "windowing/WindowingFactory.h"
 #include "utils/log.h"
 #include "utils/GLUtils.h"
@@ -130,6 +131,11 @@ bool CRenderSystemGLES::InitRenderSystem()
     m_renderCaps |= RENDER_CAPS_BGRA_APPLE;
   }
 
+  if (IsExtSupported("GL_OES_compressed_ETC1_RGB8_texture"))
+  {
+    m_renderCaps |= RENDER_CAPS_ETC1;
+  }
+
 
 
   m_bRenderCreated = true;
@@ -218,6 +224,8 @@ bool CRenderSystemGLES::EndRender()
   if (!m_bRenderCreated)
     return false;
 
+  CGUIQuadBatchGLES::GetInstance().Flush();
+
   return true;
 }
 
@@ -226,6 +234,8 @@ bool CRenderSystemGLES::ClearBuffers(color_t color)
   if (!m_bRenderCreated)
     return false;
 
+  CGUIQuadBatchGLES::GetInstance().Flush();
+
   float r = GET_R(color) / 255.0f;
   float g = GET_G(color) / 255.0f;
   float b = GET_B(color) / 255.0f;
@@ -281,6 +291,9 @@ bool CRenderSystemGLES::PresentRender(const CDirtyRegionList &dirty)
   if (!m_bRenderCreated)
     return false;
 
+  // draw the GUI quads still queued before the buffers are swapped
+  CGUIQuadBatchGLES::GetInstance().Flush();
+
   if (m_iVSyncMode != 0 && m_iSwapRate != 0) 
   {
     int64_t curr, diff, freq;
@@ -377,6 +390,8 @@ void CRenderSystemGLES::CaptureStateBlock()
   if (!m_bRenderCreated)
     return;
 
+  CGUIQuadBatchGLES::GetInstance().Flush();
+
   glMatrixProject.Push();
   glMatrixModview.Push();
   glMatrixTexture.Push();
@@ -533,6 +548,8 @@ void CRenderSystemGLES::SetViewPort(CRect& viewPort)
   if (!m_bRenderCreated)
     return;
 
+  CGUIQuadBatchGLES::GetInstance().Flush();
+
   glScissor((GLint) viewPort.x1, (GLint) (m_height - viewPort.y1 - viewPort.Height()), (GLsizei) viewPort.Width(), (GLsizei) viewPort.Height());
   glViewport((GLint) viewPort.x1, (GLint) (m_height - viewPort.y1 - viewPort.Height()), (GLsizei) viewPort.Width(), (GLsizei) viewPort.Height());
   m_viewPort[0] = viewPort.x1;
@@ -567,6 +584,7 @@ void CRenderSystemGLES::SetScissors(const CRect &rect)
 {
   if (!m_bRenderCreated)
     return;
+  CGUIQuadBatchGLES::GetInstance().Flush();
   GLint x1 = MathUtils::round_int(rect.x1);
   GLint y1 = MathUtils::round_int(rect.y1);
   GLint x2 = MathUtils::round_int(rect.x2);
@@ -618,6 +636,8 @@ void CRenderSystemGLES::InitialiseGUIShader()
 
 void CRenderSystemGLES::EnableGUIShader(ESHADERMETHOD method)
 {
+  // quads queued with the previous state have to be drawn before it changes
+  CGUIQuadBatchGLES::GetInstance().Flush();
   m_method = method;
   if (m_pGUIshader[m_method])
   {
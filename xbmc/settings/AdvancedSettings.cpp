@@ -42,6 +42,7 @@
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/SystemInfo.h"
+#include "utils/TraceRecorder.h"
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
 #include "utils/XMLUtils.h"
@@ -176,6 +177,7 @@ void CAdvancedSettings::Initialize()
   m_mediacodecForceSoftwareRendring = false;
 
   m_videoDefaultLatency = 0.0;
+  m_videoRenderBuffers.clear();
 
   m_musicUseTimeSeeking = true;
   m_musicTimeSeekForward = 10;
@@ -353,6 +355,11 @@ void CAdvancedSettings::Initialize()
 
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
+  m_jsonResultCacheTime = 500;
+
+  m_webServerThreadPoolSize = 0;
+  m_webServerResponseCacheMemory = 16;
+  m_webServerResponseCacheDisk = 64;
 
   m_enableMultimediaKeys = false;
 
@@ -360,6 +367,7 @@ void CAdvancedSettings::Initialize()
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiDirtyRegionNoFlipTimeout = 0;
+  m_guiTextureBudget = 0;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
 
@@ -385,6 +393,9 @@ void CAdvancedSettings::Initialize()
   m_logLevelHint = m_logLevel = LOG_LEVEL_NORMAL;
   m_extraLogEnabled = false;
   m_extraLogLevels = 0;
+  m_logMaxSize = 64;
+  m_traceEvents = 32768;
+  m_traceDumpOnStutter = false;
 
   #if defined(TARGET_DARWIN)
     std::string logDir = getenv("HOME");
@@ -418,6 +429,8 @@ bool CAdvancedSettings::Load()
   if (!m_discStubExtensions.empty())
     m_videoExtensions += "|" + m_discStubExtensions;
 
+  CTraceRecorder::GetInstance().Configure(m_traceEvents, m_traceDumpOnStutter);
+
   return true;
 }
 
@@ -700,6 +713,28 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
       // Get default global display latency
       XMLUtils::GetFloat(pVideoLatency, "delay", m_videoDefaultLatency, -600.0f, 600.0f);
     }
+
+    // Store per codec render buffer counts, <codec name="h264">4</codec>
+    TiXmlElement* pRenderBuffers = pElement->FirstChildElement("renderbuffers");
+    if (pRenderBuffers)
+    {
+      TiXmlElement* pCodec = pRenderBuffers->FirstChildElement("codec");
+      while (pCodec)
+      {
+        const char* name = pCodec->Attribute("name");
+        int buffers = pCodec->FirstChild() ? atoi(pCodec->FirstChild()->Value()) : 0;
+        if (name && *name && buffers >= 2)
+        {
+          std::string codec = name;
+          StringUtils::ToLower(codec);
+          m_videoRenderBuffers[codec] = buffers;
+        }
+        else
+          CLog::Log(LOGWARNING, "Ignoring malformed <renderbuffers> codec entry");
+
+        pCodec = pCodec->NextSiblingElement("codec");
+      }
+    }
   }
 
   pElement = pRootElement->FirstChildElement("musiclibrary");
@@ -765,6 +800,15 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
   {
     XMLUtils::GetBoolean(pElement, "compactoutput", m_jsonOutputCompact);
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
+    XMLUtils::GetUInt(pElement, "resultcachetime", m_jsonResultCacheTime);
+  }
+
+  pElement = pRootElement->FirstChildElement("webserver");
+  if (pElement)
+  {
+    XMLUtils::GetUInt(pElement, "threadpoolsize", m_webServerThreadPoolSize, 0, 64);
+    XMLUtils::GetUInt(pElement, "responsecachememory", m_webServerResponseCacheMemory, 1, 1024);
+    XMLUtils::GetUInt(pElement, "responsecachedisk", m_webServerResponseCacheDisk, 0, 4096);
   }
 
   pElement = pRootElement->FirstChildElement("samba");
@@ -801,6 +845,16 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     CLog::SetLogLevel(g_advancedSettings.m_logLevel);
   }
 
+  if (XMLUtils::GetInt(pRootElement, "logmaxsize", m_logMaxSize, 0, 4096))
+    CLog::SetMaxLogSize((size_t)m_logMaxSize * 1024 * 1024);
+
+  pElement = pRootElement->FirstChildElement("trace");
+  if (pElement)
+  {
+    XMLUtils::GetInt(pElement, "events", m_traceEvents, 0, 1048576);
+    XMLUtils::GetBoolean(pElement, "dumponstutter", m_traceDumpOnStutter);
+  }
+
   XMLUtils::GetString(pRootElement, "cddbaddress", m_cddbAddress);
 
   //airtunes + airplay
@@ -1127,6 +1181,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetInt(pElement, "texturebudget",             m_guiTextureBudget, 0, INT_MAX);
   }
 
   std::string seekSteps;
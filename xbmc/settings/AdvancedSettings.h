@@ -19,6 +19,7 @@
  *
  */
 
+#include <map>
 #include <set>
 #include <string>
 #include <utility>
@@ -191,6 +192,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     std::vector<RefreshOverride> m_videoAdjustRefreshOverrides;
     std::vector<RefreshVideoLatency> m_videoRefreshLatency;
     float m_videoDefaultLatency;
+    std::map<std::string, int> m_videoRenderBuffers; ///< preferred render buffer count per codec name
     bool m_videoDisableBackgroundDeinterlace;
     int  m_videoCaptureUseOcclusionQuery;
     bool m_DXVACheckCompatibility;
@@ -216,6 +218,9 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_logLevelHint;
     bool m_extraLogEnabled;
     int m_extraLogLevels;
+    int m_logMaxSize; ///< MB the log may grow to before it is rotated, 0 to never rotate
+    int m_traceEvents; ///< playback events kept by CTraceRecorder, 0 to not record them
+    bool m_traceDumpOnStutter;
     std::string m_cddbAddress;
 
     //airtunes + airplay
@@ -352,6 +357,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    int  m_guiTextureBudget; ///< MB of GUI textures to keep cached after release, 0 frees them after a delay
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
@@ -360,6 +366,11 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
+    unsigned int m_jsonResultCacheTime; ///< ms read-only json-rpc results are reused, 0 to disable
+
+    unsigned int m_webServerThreadPoolSize; ///< threads serving web server connections, 0 for one thread per connection
+    unsigned int m_webServerResponseCacheMemory; ///< MB of created web server responses (e.g. resized images) kept in memory
+    unsigned int m_webServerResponseCacheDisk; ///< MB of created web server responses kept on disk, 0 to disable
 
     bool m_enableMultimediaKeys;
     std::vector<std::string> m_settingsFiles;
@@ -0,0 +1,170 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/File.h"
+#include "guilib/DDSImage.h"
+#include "guilib/ETC1.h"
+#include "guilib/XBTF.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define IMAGE_WIDTH  30
+#define IMAGE_HEIGHT 18
+
+namespace
+{
+  // a smooth gradient, as in most photos and artwork
+  std::vector<unsigned char> CreateImage(unsigned int width, unsigned int height)
+  {
+    std::vector<unsigned char> bgra(width * height * 4);
+    for (unsigned int y = 0; y < height; y++)
+    {
+      for (unsigned int x = 0; x < width; x++)
+      {
+        unsigned char *pixel = &bgra[(y * width + x) * 4];
+        pixel[0] = (unsigned char)(40 + x * 4);
+        pixel[1] = (unsigned char)(200 - y * 6);
+        pixel[2] = (unsigned char)(60 + x * 2 + y * 3);
+        pixel[3] = 0xff;
+      }
+    }
+    return bgra;
+  }
+
+  // pixel of a decompressed 4x4 block in BGRA
+  const unsigned char *Pixel(const unsigned char *bgra, int x, int y)
+  {
+    return bgra + (y * 4 + x) * 4;
+  }
+}
+
+TEST(TestETC1, DecompressIndividualBlock)
+{
+  // base colors 0x88 and 0x44, tables 0 and 1, side by side sub blocks
+  const unsigned char block[8] = { 0x84, 0x84, 0x84, 0x04, 0x80, 0x00, 0x80, 0x01 };
+  unsigned char bgra[4 * 4 * 4];
+  ETC1::DecompressImage(bgra, 4, 4, 16, block);
+
+  // index 0 adds the small modifier
+  EXPECT_EQ(0x88 + 2, Pixel(bgra, 1, 1)[0]);
+  EXPECT_EQ(0x44 + 5, Pixel(bgra, 2, 1)[2]);
+  // index 1 adds the large one
+  EXPECT_EQ(0x88 + 8, Pixel(bgra, 0, 0)[1]);
+  // index 3 subtracts the large one
+  EXPECT_EQ(0x44 - 17, Pixel(bgra, 3, 3)[0]);
+  EXPECT_EQ(0xff, Pixel(bgra, 3, 3)[3]);
+}
+
+TEST(TestETC1, DecompressDifferentialBlock)
+{
+  // base color 16 (0x84) with a delta of -1 (0x7b), table 0, sub blocks on top of each other
+  const unsigned char block[8] = { 0x87, 0x87, 0x87, 0x03, 0x00, 0x00, 0x00, 0x00 };
+  unsigned char bgra[4 * 4 * 4];
+  ETC1::DecompressImage(bgra, 4, 4, 16, block);
+
+  for (int x = 0; x < 4; x++)
+  {
+    EXPECT_EQ(0x84 + 2, Pixel(bgra, x, 1)[2]);
+    EXPECT_EQ(0x7b + 2, Pixel(bgra, x, 2)[2]);
+  }
+}
+
+TEST(TestETC1, RoundTrip)
+{
+  std::vector<unsigned char> image = CreateImage(IMAGE_WIDTH, IMAGE_HEIGHT);
+  std::vector<unsigned char> blocks(ETC1::GetStorageRequirements(IMAGE_WIDTH, IMAGE_HEIGHT));
+  ASSERT_EQ(((IMAGE_WIDTH + 3) / 4) * ((IMAGE_HEIGHT + 3) / 4) * 8U, blocks.size());
+
+  ETC1::CompressImage(&image[0], IMAGE_WIDTH, IMAGE_HEIGHT, IMAGE_WIDTH * 4, &blocks[0]);
+
+  std::vector<unsigned char> decoded(image.size());
+  ETC1::DecompressImage(&decoded[0], IMAGE_WIDTH, IMAGE_HEIGHT, IMAGE_WIDTH * 4, &blocks[0]);
+
+  int maxError = 0;
+  for (size_t i = 0; i < image.size(); i++)
+    maxError = std::max(maxError, abs(image[i] - decoded[i]));
+  EXPECT_LE(maxError, 16);
+  EXPECT_LT(ETC1::ComputeMSE(&image[0], IMAGE_WIDTH, IMAGE_HEIGHT, IMAGE_WIDTH * 4, &blocks[0]), 16.0);
+}
+
+TEST(TestETC1, SolidColor)
+{
+  std::vector<unsigned char> image(4 * 4 * 4);
+  for (size_t i = 0; i < image.size(); i += 4)
+  {
+    image[i] = 0x20;
+    image[i + 1] = 0x80;
+    image[i + 2] = 0xc0;
+    image[i + 3] = 0xff;
+  }
+
+  unsigned char block[8];
+  ETC1::CompressImage(&image[0], 4, 4, 16, block);
+
+  // off by no more than the 5 bit base color quantization and the closest modifier
+  std::vector<unsigned char> decoded(image.size());
+  ETC1::DecompressImage(&decoded[0], 4, 4, 16, block);
+  for (size_t i = 0; i < image.size(); i++)
+    EXPECT_NEAR(image[i], decoded[i], 8);
+}
+
+TEST(TestDDSImage, WriteRead)
+{
+  XFILE::CFile *file = XBMC_CREATETEMPFILE(".dds");
+  ASSERT_NE(nullptr, file);
+  file->Close();
+
+  std::vector<unsigned char> image = CreateImage(IMAGE_WIDTH, IMAGE_HEIGHT);
+  static const unsigned int formats[] = { XB_FMT_ETC1, XB_FMT_DXT1 };
+  for (unsigned int i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+  {
+    CDDSImage written;
+    ASSERT_TRUE(written.Create(XBMC_TEMPFILEPATH(file), IMAGE_WIDTH, IMAGE_HEIGHT, IMAGE_WIDTH * 4, &image[0], 0, formats[i]));
+
+    CDDSImage read;
+    ASSERT_TRUE(read.ReadFile(XBMC_TEMPFILEPATH(file)));
+    EXPECT_EQ((unsigned int)IMAGE_WIDTH, read.GetWidth());
+    EXPECT_EQ((unsigned int)IMAGE_HEIGHT, read.GetHeight());
+    EXPECT_EQ(formats[i], read.GetFormat());
+    ASSERT_EQ(written.GetSize(), read.GetSize());
+    EXPECT_EQ(0, memcmp(written.GetData(), read.GetData(), read.GetSize()));
+
+    std::vector<unsigned char> decoded(image.size());
+    EXPECT_TRUE(CDDSImage::Decompress(&decoded[0], IMAGE_WIDTH, IMAGE_HEIGHT, IMAGE_WIDTH * 4, read.GetData(), read.GetFormat()));
+    EXPECT_EQ(0xff, decoded[3]);
+  }
+
+  // without compression the pixels are stored as they are
+  CDDSImage argb;
+  ASSERT_TRUE(argb.Create(XBMC_TEMPFILEPATH(file), IMAGE_WIDTH, IMAGE_HEIGHT, IMAGE_WIDTH * 4, &image[0], 0.001, XB_FMT_ETC1));
+  CDDSImage read;
+  ASSERT_TRUE(read.ReadFile(XBMC_TEMPFILEPATH(file)));
+  EXPECT_EQ((unsigned int)XB_FMT_A8R8G8B8, read.GetFormat());
+  ASSERT_EQ(image.size(), read.GetSize());
+  EXPECT_EQ(0, memcmp(&image[0], read.GetData(), image.size()));
+
+  XBMC_DELETETEMPFILE(file);
+}
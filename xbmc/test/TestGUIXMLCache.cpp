@@ -0,0 +1,118 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/File.h"
+#include "guilib/GUIXMLCache.h"
+#include "utils/Archive.h"
+#include "utils/XBMCTinyXML.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+class TestGUIXMLCache : public testing::Test
+{
+protected:
+  TestGUIXMLCache()
+  {
+    file = XBMC_CREATETEMPFILE(".bin");
+  }
+  ~TestGUIXMLCache()
+  {
+    EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+  }
+
+  // store the element and read it back
+  TiXmlElement *RoundTrip(const TiXmlElement *element)
+  {
+    CArchive arstore(file, CArchive::store);
+    CGUIXMLCache::Serialize(arstore, element);
+    arstore.Close();
+
+    EXPECT_EQ(0, file->Seek(0, SEEK_SET));
+    CArchive arload(file, CArchive::load);
+    TiXmlElement *result = CGUIXMLCache::Deserialize(arload, 0);
+    arload.Close();
+    return result;
+  }
+
+  static TiXmlElement *Deserialize(CArchive &ar, int depth)
+  {
+    return CGUIXMLCache::Deserialize(ar, depth);
+  }
+
+  XFILE::CFile *file;
+};
+
+TEST_F(TestGUIXMLCache, RoundTrip)
+{
+  ASSERT_NE(nullptr, file);
+  CXBMCTinyXML doc;
+  doc.Parse("<window id=\"1\" type=\"dialog\">"
+              "<!-- dropped -->"
+              "<control type=\"label\" id=\"2\">"
+                "<label>$INFO[ListItem.Label]</label>"
+                "<visible>Control.HasFocus(3)</visible>"
+              "</control>"
+              "<onload><![CDATA[SetFocus(2)]]></onload>"
+              "<controls/>"
+            "</window>");
+  ASSERT_NE(nullptr, doc.RootElement());
+
+  TiXmlElement *root = RoundTrip(doc.RootElement());
+  ASSERT_NE(nullptr, root);
+
+  EXPECT_STREQ("window", root->Value());
+  EXPECT_STREQ("1", root->Attribute("id"));
+  EXPECT_STREQ("dialog", root->Attribute("type"));
+
+  const TiXmlElement *control = root->FirstChildElement("control");
+  ASSERT_NE(nullptr, control);
+  EXPECT_EQ(control, root->FirstChild());
+  EXPECT_STREQ("label", control->Attribute("type"));
+  EXPECT_STREQ("2", control->Attribute("id"));
+  EXPECT_STREQ("$INFO[ListItem.Label]", control->FirstChildElement("label")->GetText());
+  EXPECT_STREQ("Control.HasFocus(3)", control->FirstChildElement("visible")->GetText());
+
+  const TiXmlElement *onload = root->FirstChildElement("onload");
+  ASSERT_NE(nullptr, onload);
+  ASSERT_NE(nullptr, onload->FirstChild()->ToText());
+  EXPECT_TRUE(onload->FirstChild()->ToText()->CDATA());
+  EXPECT_STREQ("SetFocus(2)", onload->GetText());
+
+  const TiXmlElement *controls = root->FirstChildElement("controls");
+  ASSERT_NE(nullptr, controls);
+  EXPECT_EQ(nullptr, controls->FirstChild());
+  EXPECT_EQ(nullptr, controls->NextSibling());
+  delete root;
+}
+
+TEST_F(TestGUIXMLCache, BrokenData)
+{
+  ASSERT_NE(nullptr, file);
+  // a window with an unknown kind of child node
+  CArchive arstore(file, CArchive::store);
+  arstore << std::string("window") << 0 << 1 << 'x' << std::string("text");
+  arstore.Close();
+
+  ASSERT_EQ(0, file->Seek(0, SEEK_SET));
+  CArchive arload(file, CArchive::load);
+  EXPECT_EQ(nullptr, Deserialize(arload, 0));
+  arload.Close();
+}
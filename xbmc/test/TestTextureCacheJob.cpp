@@ -0,0 +1,145 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TextureCacheJob.h"
+#include "filesystem/File.h"
+#include "guilib/JpegIO.h"
+#include "guilib/Texture.h"
+#include "guilib/XBTF.h"
+#include "pictures/Picture.h"
+#include "threads/SystemClock.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+#define IMAGE_WIDTH  2560
+#define IMAGE_HEIGHT 1600
+#define BENCHMARK_RUNS 10
+
+class TestTextureCacheJob : public ::testing::Test
+{
+protected:
+  TestTextureCacheJob()
+  {
+    // a 16:10 photo, so neither the image nor the fanart size matches
+    std::vector<uint32_t> pixels(IMAGE_WIDTH * IMAGE_HEIGHT);
+    for (unsigned int y = 0; y < IMAGE_HEIGHT; y++)
+    {
+      for (unsigned int x = 0; x < IMAGE_WIDTH; x++)
+        pixels[y * IMAGE_WIDTH + x] = 0xff000000 | ((x * 255 / IMAGE_WIDTH) << 16) | ((y * 255 / IMAGE_HEIGHT) << 8) | ((x ^ y) & 0xff);
+    }
+
+    m_file = XBMC_CREATETEMPFILE(".jpg");
+    if (m_file)
+    {
+      m_file->Close();
+      CJpegIO::CreateThumbnailFromSurface((unsigned char *)&pixels[0], IMAGE_WIDTH, IMAGE_HEIGHT, XB_FMT_A8R8G8B8,
+                                          IMAGE_WIDTH * 4, XBMC_TEMPFILEPATH(m_file));
+    }
+  }
+
+  ~TestTextureCacheJob()
+  {
+    if (m_file)
+      XBMC_DELETETEMPFILE(m_file);
+  }
+
+  double ImagesPerSecond(unsigned int width, unsigned int height, bool fitToCache)
+  {
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    for (int i = 0; i < BENCHMARK_RUNS; i++)
+      delete CTextureCacheJob::LoadImage(XBMC_TEMPFILEPATH(m_file), width, height, "", true, fitToCache);
+    unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+    return BENCHMARK_RUNS * 1000.0 / std::max(elapsed, 1U);
+  }
+
+  XFILE::CFile *m_file;
+};
+
+TEST_F(TestTextureCacheJob, GetImageSize)
+{
+  ASSERT_NE(nullptr, m_file);
+
+  XFILE::CFile file;
+  XFILE::auto_buffer buf;
+  ASSERT_GT(file.LoadFile(XBMC_TEMPFILEPATH(m_file), buf), 0);
+
+  unsigned int width = 0, height = 0;
+  EXPECT_TRUE(CJpegIO::GetImageSize((unsigned char *)buf.get(), buf.size(), width, height));
+  EXPECT_EQ((unsigned int)IMAGE_WIDTH, width);
+  EXPECT_EQ((unsigned int)IMAGE_HEIGHT, height);
+
+  // the test image has no EXIF header
+  unsigned int orientation = 1;
+  EXPECT_TRUE(CJpegIO::GetImageSize((unsigned char *)buf.get(), buf.size(), width, height, &orientation));
+  EXPECT_EQ(0u, orientation);
+
+  EXPECT_FALSE(CJpegIO::GetImageSize((unsigned char *)buf.get(), 16, width, height));
+}
+
+TEST_F(TestTextureCacheJob, DecodeAtCacheSize)
+{
+  ASSERT_NE(nullptr, m_file);
+
+  // thumbs fit in 256x256, i.e. 256x160, the smallest IDCT scale above that is 1/8
+  CBaseTexture *texture = CTextureCacheJob::LoadImage(XBMC_TEMPFILEPATH(m_file), 256, 256, "", true, true);
+  ASSERT_NE(nullptr, texture);
+  EXPECT_EQ((unsigned int)IMAGE_WIDTH / 8, texture->GetWidth());
+  EXPECT_EQ((unsigned int)IMAGE_HEIGHT / 8, texture->GetHeight());
+  EXPECT_EQ((unsigned int)IMAGE_WIDTH, texture->GetOriginalWidth());
+  delete texture;
+}
+
+TEST_F(TestTextureCacheJob, DecodeWithoutSize)
+{
+  ASSERT_NE(nullptr, m_file);
+
+  // without a size the image is decoded at the smallest IDCT scale covering the cache size
+  uint32_t cacheWidth = 0, cacheHeight = 0;
+  CPicture::GetCacheSize(IMAGE_WIDTH, IMAGE_HEIGHT, cacheWidth, cacheHeight);
+
+  CBaseTexture *texture = CTextureCacheJob::LoadImage(XBMC_TEMPFILEPATH(m_file), 0, 0, "", true, true);
+  ASSERT_NE(nullptr, texture);
+  EXPECT_GE(texture->GetWidth(), cacheWidth);
+  EXPECT_GE(texture->GetHeight(), cacheHeight);
+  EXPECT_LE(texture->GetWidth(), (unsigned int)IMAGE_WIDTH);
+  EXPECT_EQ(texture->GetWidth() * IMAGE_HEIGHT, texture->GetHeight() * IMAGE_WIDTH);
+  delete texture;
+
+  // unless it isn't fit to the cache
+  texture = CTextureCacheJob::LoadImage(XBMC_TEMPFILEPATH(m_file), 0, 0, "", true, false);
+  ASSERT_NE(nullptr, texture);
+  EXPECT_EQ((unsigned int)IMAGE_WIDTH, texture->GetWidth());
+  EXPECT_EQ((unsigned int)IMAGE_HEIGHT, texture->GetHeight());
+  delete texture;
+}
+
+// run with --gtest_also_run_disabled_tests, the results are reported as test properties
+TEST_F(TestTextureCacheJob, DISABLED_Benchmark)
+{
+  ASSERT_NE(nullptr, m_file);
+
+  RecordProperty("FullImagesPerSecond", (int)ImagesPerSecond(0, 0, false));
+  RecordProperty("FanartImagesPerSecond", (int)ImagesPerSecond(0, 0, true));
+  RecordProperty("ThumbImagesPerSecond", (int)ImagesPerSecond(256, 256, true));
+}
@@ -23,57 +23,126 @@
 #include "JSONVariantWriter.h"
 #include "utils/Variant.h"
 
-std::string CJSONVariantWriter::Write(const CVariant &value, bool compact)
+namespace
 {
-  std::string output;
-
-  yajl_gen g = yajl_gen_alloc(NULL);
-  yajl_gen_config(g, yajl_gen_beautify, compact ? 0 : 1);
-  yajl_gen_config(g, yajl_gen_indent_string, "\t");
-
-  // Set locale to classic ("C") to ensure valid JSON numbers
-#ifndef TARGET_WINDOWS
-  const char *currentLocale = setlocale(LC_NUMERIC, NULL);
-  std::string backupLocale;
-  if (currentLocale != NULL && (currentLocale[0] != 'C' || currentLocale[1] != 0))
+  // Sets the locale to classic ("C") while numbers are written to ensure valid JSON numbers
+  class CClassicNumericLocale
   {
-    backupLocale = currentLocale;
-    setlocale(LC_NUMERIC, "C");
-  }
+  public:
+    CClassicNumericLocale()
+    {
+#ifndef TARGET_WINDOWS
+      const char *currentLocale = setlocale(LC_NUMERIC, NULL);
+      if (currentLocale != NULL && (currentLocale[0] != 'C' || currentLocale[1] != 0))
+      {
+        m_backupLocale = currentLocale;
+        setlocale(LC_NUMERIC, "C");
+      }
 #else  // TARGET_WINDOWS
-  const wchar_t* const currentLocale = _wsetlocale(LC_NUMERIC, NULL);
-  std::wstring backupLocale;
-  if (currentLocale != NULL && (currentLocale[0] != L'C' || currentLocale[1] != 0))
-  {
-    backupLocale = currentLocale;
-    _wsetlocale(LC_NUMERIC, L"C");
-  }
+      const wchar_t* const currentLocale = _wsetlocale(LC_NUMERIC, NULL);
+      if (currentLocale != NULL && (currentLocale[0] != L'C' || currentLocale[1] != 0))
+      {
+        m_backupLocale = currentLocale;
+        _wsetlocale(LC_NUMERIC, L"C");
+      }
 #endif // TARGET_WINDOWS
+    }
 
-  if (InternalWrite(g, value))
-  {
-    const unsigned char * buffer;
-
-    size_t length;
-    yajl_gen_get_buf(g, &buffer, &length);
-    output = std::string((const char *)buffer, length);
-  }
-
-  // Re-set locale to what it was before using yajl
+    ~CClassicNumericLocale()
+    {
+      // Re-set locale to what it was before using yajl
 #ifndef TARGET_WINDOWS
-  if (!backupLocale.empty())
-    setlocale(LC_NUMERIC, backupLocale.c_str());
+      if (!m_backupLocale.empty())
+        setlocale(LC_NUMERIC, m_backupLocale.c_str());
 #else  // TARGET_WINDOWS
-  if (!backupLocale.empty())
-    _wsetlocale(LC_NUMERIC, backupLocale.c_str());
+      if (!m_backupLocale.empty())
+        _wsetlocale(LC_NUMERIC, m_backupLocale.c_str());
 #endif // TARGET_WINDOWS
+    }
+
+  private:
+#ifndef TARGET_WINDOWS
+    std::string m_backupLocale;
+#else
+    std::wstring m_backupLocale;
+#endif
+  };
+}
+
+std::string CJSONVariantWriter::Write(const CVariant &value, bool compact)
+{
+  std::string output;
 
-  yajl_gen_clear(g);
-  yajl_gen_free(g);
+  CJSONVariantWriter writer(compact);
+  if (writer.WriteValue(value))
+    writer.TakeOutput(output);
 
   return output;
 }
 
+CJSONVariantWriter::CJSONVariantWriter(bool compact)
+{
+  m_generator = yajl_gen_alloc(NULL);
+  yajl_gen_config(m_generator, yajl_gen_beautify, compact ? 0 : 1);
+  yajl_gen_config(m_generator, yajl_gen_indent_string, "\t");
+}
+
+CJSONVariantWriter::~CJSONVariantWriter()
+{
+  yajl_gen_clear(m_generator);
+  yajl_gen_free(m_generator);
+}
+
+bool CJSONVariantWriter::WriteValue(const CVariant &value)
+{
+  CClassicNumericLocale locale;
+  return InternalWrite(m_generator, value);
+}
+
+bool CJSONVariantWriter::OpenObject()
+{
+  return yajl_gen_status_ok == yajl_gen_map_open(m_generator);
+}
+
+bool CJSONVariantWriter::WriteKey(const std::string &key)
+{
+  return yajl_gen_status_ok == yajl_gen_string(m_generator, (const unsigned char*)key.c_str(), key.size());
+}
+
+bool CJSONVariantWriter::CloseObject()
+{
+  return yajl_gen_status_ok == yajl_gen_map_close(m_generator);
+}
+
+bool CJSONVariantWriter::OpenArray()
+{
+  return yajl_gen_status_ok == yajl_gen_array_open(m_generator);
+}
+
+bool CJSONVariantWriter::CloseArray()
+{
+  return yajl_gen_status_ok == yajl_gen_array_close(m_generator);
+}
+
+size_t CJSONVariantWriter::GetOutputSize() const
+{
+  const unsigned char *buffer;
+  size_t length = 0;
+  yajl_gen_get_buf(m_generator, &buffer, &length);
+  return length;
+}
+
+void CJSONVariantWriter::TakeOutput(std::string &output)
+{
+  const unsigned char *buffer;
+  size_t length = 0;
+  yajl_gen_get_buf(m_generator, &buffer, &length);
+  output.append((const char *)buffer, length);
+
+  // only drops the text, the state of the document is kept
+  yajl_gen_clear(m_generator);
+}
+
 bool CJSONVariantWriter::InternalWrite(yajl_gen g, const CVariant &value)
 {
   bool success = false;
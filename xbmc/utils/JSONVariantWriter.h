@@ -24,10 +24,44 @@
 
 class CVariant;
 
+/*!
+ \brief Writes CVariant values as JSON.
+
+ Besides writing a whole value at once the writer can be used to generate a
+ document piece by piece, e.g. to send a large array item by item. The text
+ generated so far is taken out with TakeOutput() whenever enough of it was
+ collected, so only the part that was not sent yet is kept in memory.
+ */
 class CJSONVariantWriter
 {
 public:
   static std::string Write(const CVariant &value, bool compact);
+
+  explicit CJSONVariantWriter(bool compact);
+  ~CJSONVariantWriter();
+
+  bool WriteValue(const CVariant &value);
+  bool OpenObject();
+  bool WriteKey(const std::string &key);
+  bool CloseObject();
+  bool OpenArray();
+  bool CloseArray();
+
+  /*!
+   \brief Number of bytes generated and not taken out yet
+   */
+  size_t GetOutputSize() const;
+
+  /*!
+   \brief Append the generated text to the given string and drop it from the writer
+   */
+  void TakeOutput(std::string &output);
+
 private:
+  CJSONVariantWriter(const CJSONVariantWriter&);
+  CJSONVariantWriter& operator=(const CJSONVariantWriter&);
+
   static bool InternalWrite(yajl_gen g, const CVariant &value);
+
+  yajl_gen m_generator;
 };
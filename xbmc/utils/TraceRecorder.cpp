@@ -0,0 +1,218 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TraceRecorder.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+#include "utils/log.h"
+#include "utils/TimeUtils.h"
+
+#include <string.h>
+
+#define TRACE_DUMP_FILE     "special://logpath/kodi-trace.trc"
+#define TRACE_DUMP_OLD_FILE "special://logpath/kodi-trace.old.trc"
+#define TRACE_STUTTER_INTERVAL 60000000000ULL // ns between dumps on stutter
+
+class CTraceDumpJob : public CJob
+{
+public:
+  CTraceDumpJob(const std::string &reason) : m_reason(reason) {}
+
+  virtual const char *GetType() const { return "tracedump"; }
+
+  virtual bool DoWork()
+  {
+    if (XFILE::CFile::Exists(TRACE_DUMP_FILE))
+      XFILE::CFile::Rename(TRACE_DUMP_FILE, TRACE_DUMP_OLD_FILE);
+    return CTraceRecorder::GetInstance().Dump(TRACE_DUMP_FILE, m_reason);
+  }
+
+private:
+  std::string m_reason;
+};
+
+CTraceRecorder::CTraceRecorder()
+  : m_slots(NULL)
+  , m_mask(0)
+  , m_enabled(false)
+  , m_next(0)
+  , m_lastStutter(0)
+  , m_dumpOnStutter(false)
+  , m_startCounter(0)
+  , m_nsPerTick(0.0)
+  , m_startTime(0)
+{
+}
+
+CTraceRecorder::~CTraceRecorder()
+{
+  m_enabled = false;
+  delete[] m_slots;
+}
+
+CTraceRecorder& CTraceRecorder::GetInstance()
+{
+  static CTraceRecorder recorder;
+  return recorder;
+}
+
+void CTraceRecorder::Configure(unsigned int events, bool dumpOnStutter)
+{
+  CSingleLock lock(m_section);
+  m_dumpOnStutter = dumpOnStutter;
+
+  if (events == 0)
+  {
+    m_enabled = false;
+    return;
+  }
+
+  if (!m_slots)
+  {
+    uint64_t size = 1;
+    while (size < events)
+      size <<= 1;
+
+    m_slots = new CSlot[size];
+    for (uint64_t i = 0; i < size; i++)
+      m_slots[i].sequence.store(0, std::memory_order_relaxed);
+    m_mask = size - 1;
+
+    m_startCounter = CurrentHostCounter();
+    m_nsPerTick = 1000000000.0 / CurrentHostFrequency();
+    m_startTime = time(NULL);
+    CLog::Log(LOGDEBUG, "CTraceRecorder - recording the last %u playback events", (unsigned int)size);
+  }
+  m_enabled = true;
+}
+
+uint64_t CTraceRecorder::GetTime() const
+{
+  return (uint64_t)((CurrentHostCounter() - m_startCounter) * m_nsPerTick);
+}
+
+void CTraceRecorder::Add(TraceEventType type, int stream, int arg, double value1, double value2)
+{
+  uint64_t pos = m_next.fetch_add(1, std::memory_order_relaxed);
+  CSlot &slot = m_slots[pos & m_mask];
+
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.event.time = GetTime();
+  slot.event.thread = (uint64_t)CThread::GetCurrentThreadId();
+  slot.event.value1 = value1;
+  slot.event.value2 = value2;
+  slot.event.type = (uint16_t)type;
+  slot.event.stream = (uint16_t)stream;
+  slot.event.arg = arg;
+
+  slot.sequence.store(pos + 1, std::memory_order_release);
+}
+
+std::vector<STraceEvent> CTraceRecorder::GetEvents() const
+{
+  std::vector<STraceEvent> events;
+  if (!m_slots)
+    return events;
+
+  uint64_t end = m_next.load(std::memory_order_acquire);
+  uint64_t begin = end > m_mask + 1 ? end - m_mask - 1 : 0;
+  events.reserve((size_t)(end - begin));
+
+  for (uint64_t pos = begin; pos < end; pos++)
+  {
+    const CSlot &slot = m_slots[pos & m_mask];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+      continue; // still written or already overwritten
+
+    STraceEvent event;
+    memcpy(&event, &slot.event, sizeof(event));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == pos + 1)
+      events.push_back(event);
+  }
+  return events;
+}
+
+bool CTraceRecorder::Dump(const std::string &file, const std::string &reason)
+{
+  std::vector<STraceEvent> events = GetEvents();
+
+  XFILE::CFile out;
+  if (!out.OpenForWrite(file, true))
+  {
+    CLog::Log(LOGERROR, "CTraceRecorder::Dump - unable to write %s", file.c_str());
+    return false;
+  }
+
+  char magic[8] = TRACE_DUMP_MAGIC;
+  uint32_t version = TRACE_DUMP_VERSION;
+  uint32_t eventSize = sizeof(STraceEvent);
+  int64_t startTime = m_startTime;
+  uint64_t dumpTime = m_slots ? GetTime() : 0;
+  uint32_t count = events.size();
+  uint32_t reasonSize = reason.size();
+
+  bool ok = out.Write(magic, sizeof(magic)) == sizeof(magic)
+         && out.Write(&version, sizeof(version)) == sizeof(version)
+         && out.Write(&eventSize, sizeof(eventSize)) == sizeof(eventSize)
+         && out.Write(&startTime, sizeof(startTime)) == sizeof(startTime)
+         && out.Write(&dumpTime, sizeof(dumpTime)) == sizeof(dumpTime)
+         && out.Write(&count, sizeof(count)) == sizeof(count)
+         && out.Write(&reasonSize, sizeof(reasonSize)) == sizeof(reasonSize)
+         && out.Write(reason.c_str(), reasonSize) == (ssize_t)reasonSize;
+  if (ok && count > 0)
+    ok = out.Write(&events[0], count * sizeof(STraceEvent)) == (ssize_t)(count * sizeof(STraceEvent));
+  out.Close();
+
+  if (ok)
+    CLog::Log(LOGNOTICE, "CTraceRecorder::Dump - wrote %u events to %s (%s)", count, file.c_str(), reason.c_str());
+  else
+    CLog::Log(LOGERROR, "CTraceRecorder::Dump - failed to write %s", file.c_str());
+  return ok;
+}
+
+void CTraceRecorder::RequestDump(const std::string &reason)
+{
+  if (!m_slots)
+    return;
+
+  Record(TRACE_MARKER, 0, 0, 0.0, 0.0);
+  CJobManager::GetInstance().AddJob(new CTraceDumpJob(reason), NULL, CJob::PRIORITY_LOW);
+}
+
+void CTraceRecorder::Stutter(const std::string &reason)
+{
+  if (!m_dumpOnStutter || !IsEnabled())
+    return;
+
+  uint64_t now = GetTime();
+  uint64_t last = m_lastStutter.load(std::memory_order_relaxed);
+  if (last != 0 && now - last < TRACE_STUTTER_INTERVAL)
+    return;
+  if (!m_lastStutter.compare_exchange_strong(last, now))
+    return;
+
+  RequestDump(reason);
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+
+/*!
+ \brief Types of the events recorded during playback.
+
+ The values are part of the dump format, new types are only appended.
+ Player times (pts, dts, clock) are in DVD_TIME_BASE units, render times in seconds. Only
+ packets use the stream field.
+ */
+enum TraceEventType
+{
+  TRACE_MARKER = 0,          ///< a dump was requested, the reason is stored in the dump header
+  TRACE_PACKET_DEMUXED = 1,  ///< stream: StreamType, arg: size, value1: dts, value2: pts
+  TRACE_PICTURE_DECODED = 2, ///< arg: picture flags, value1: pts, value2: duration
+  TRACE_PICTURE_QUEUED = 3,  ///< arg: frames queued, value1: pts, value2: present time
+  TRACE_PICTURE_PRESENTED = 4, ///< arg: render buffer, value1: pts, value2: seconds late
+  TRACE_PICTURE_DROPPED = 5, ///< arg: 0 dropped by the player, 1 skipped by the renderer, value1: pts
+  TRACE_AUDIO_WRITTEN = 6,   ///< arg: frames, value1: pts in ms, value2: sink delay in seconds
+  TRACE_CLOCK_ADJUSTED = 7,  ///< arg: 0 discontinuity, 1 speed adjust, value1: clock or adjust, value2: error
+  TRACE_CACHE_LEVEL = 8      ///< arg: queued ms, value1: level (0-1), value2: seconds cached ahead
+};
+
+/*!
+ \brief One recorded event, 40 bytes, written to dumps as is
+ */
+struct STraceEvent
+{
+  uint64_t time;   ///< nanoseconds since the recorder was configured
+  uint64_t thread; ///< id of the recording thread
+  double value1;
+  double value2;
+  uint16_t type;   ///< TraceEventType
+  uint16_t stream;
+  int32_t arg;
+};
+
+#define TRACE_DUMP_MAGIC   "KODITRC"
+#define TRACE_DUMP_VERSION 1
+
+/*!
+ \brief Records playback events into a fixed ring in memory.
+
+ Recording an event claims a slot with one atomic increment and stores the event, no lock is
+ taken and nothing is allocated, so the recorder is left on. When the ring is full the oldest
+ events are overwritten. Every slot carries the sequence number of the event in it, dumps skip
+ slots that are overwritten while they are copied.
+
+ The ring is dumped to special://logpath/kodi-trace.trc on request or, when enabled, on stutter.
+ tools/TraceConvert/kodi-trace.py converts dumps to the Chrome trace format or CSV.
+ */
+class CTraceRecorder
+{
+public:
+  static CTraceRecorder& GetInstance();
+
+  /*! \brief Set up recording, the ring is allocated once and keeps its size until restart
+   \param events number of events kept, rounded up to a power of two, 0 to stop recording
+   \param dumpOnStutter whether Stutter() dumps the ring
+   */
+  void Configure(unsigned int events, bool dumpOnStutter);
+
+  bool IsEnabled() const { return m_enabled.load(std::memory_order_acquire); }
+
+  /*! \brief Number of events the ring holds, 0 before recording was set up
+   */
+  size_t GetCapacity() const { return m_slots ? (size_t)(m_mask + 1) : 0; }
+
+  inline void Record(TraceEventType type, int stream, int arg, double value1, double value2)
+  {
+    if (m_enabled.load(std::memory_order_acquire))
+      Add(type, stream, arg, value1, value2);
+  }
+
+  /*! \brief Dump the ring in the background
+   \param reason stored in the dump header
+   */
+  void RequestDump(const std::string &reason);
+
+  /*! \brief Called when playback stuttered, dumps the ring at most once a minute if enabled
+   */
+  void Stutter(const std::string &reason);
+
+  /*! \brief Write the events in the ring to a file
+   \return true if the file was written
+   */
+  bool Dump(const std::string &file, const std::string &reason);
+
+  /*! \brief Copy of the events in the ring, oldest first
+   */
+  std::vector<STraceEvent> GetEvents() const;
+
+private:
+  CTraceRecorder();
+  ~CTraceRecorder();
+  CTraceRecorder(const CTraceRecorder&);
+  CTraceRecorder const& operator=(CTraceRecorder const&);
+
+  struct CSlot
+  {
+    std::atomic<uint64_t> sequence; ///< position of the event plus one, 0 while it is written
+    STraceEvent event;
+  };
+
+  void Add(TraceEventType type, int stream, int arg, double value1, double value2);
+  uint64_t GetTime() const;
+
+  CCriticalSection m_section;
+  CSlot *m_slots;
+  uint64_t m_mask;
+  std::atomic<bool> m_enabled;
+  std::atomic<uint64_t> m_next;
+  std::atomic<uint64_t> m_lastStutter;
+  bool m_dumpOnStutter;
+  int64_t m_startCounter;
+  double m_nsPerTick;
+  time_t m_startTime;
+};
@@ -132,6 +132,7 @@ CVariant CVariant::ConstNullVariant = CVariant::VariantTypeConstNull;
 CVariant::CVariant(VariantType type)
 {
   m_type = type;
+  m_stringStorage = StringBlock;
 
   switch (type)
   {
@@ -148,7 +149,7 @@ CVariant::CVariant(VariantType type)
       m_data.dvalue = 0.0;
       break;
     case VariantTypeString:
-      m_data.string = new std::string();
+      setString("", 0);
       break;
     case VariantTypeWideString:
       m_data.wstring = new std::wstring();
@@ -168,96 +169,115 @@ CVariant::CVariant(VariantType type)
 CVariant::CVariant(int integer)
 {
   m_type = VariantTypeInteger;
+  m_stringStorage = StringBlock;
   m_data.integer = integer;
 }
 
 CVariant::CVariant(int64_t integer)
 {
   m_type = VariantTypeInteger;
+  m_stringStorage = StringBlock;
   m_data.integer = integer;
 }
 
 CVariant::CVariant(unsigned int unsignedinteger)
 {
   m_type = VariantTypeUnsignedInteger;
+  m_stringStorage = StringBlock;
   m_data.unsignedinteger = unsignedinteger;
 }
 
 CVariant::CVariant(uint64_t unsignedinteger)
 {
   m_type = VariantTypeUnsignedInteger;
+  m_stringStorage = StringBlock;
   m_data.unsignedinteger = unsignedinteger;
 }
 
 CVariant::CVariant(double value)
 {
   m_type = VariantTypeDouble;
+  m_stringStorage = StringBlock;
   m_data.dvalue = value;
 }
 
 CVariant::CVariant(float value)
 {
   m_type = VariantTypeDouble;
+  m_stringStorage = StringBlock;
   m_data.dvalue = (double)value;
 }
 
 CVariant::CVariant(bool boolean)
 {
   m_type = VariantTypeBoolean;
+  m_stringStorage = StringBlock;
   m_data.boolean = boolean;
 }
 
 CVariant::CVariant(const char *str)
 {
   m_type = VariantTypeString;
-  m_data.string = new std::string(str);
+  setString(str, strlen(str));
 }
 
 CVariant::CVariant(const char *str, unsigned int length)
 {
   m_type = VariantTypeString;
-  m_data.string = new std::string(str, length);
+  setString(str, length);
 }
 
 CVariant::CVariant(const std::string &str)
 {
   m_type = VariantTypeString;
-  m_data.string = new std::string(str);
+  setString(str.c_str(), str.size());
 }
 
 CVariant::CVariant(std::string &&str)
 {
   m_type = VariantTypeString;
-  m_data.string = new std::string(std::move(str));
+  if (str.size() < SmallStringSize)
+    setString(str.c_str(), str.size());
+  else
+  {
+    // take over the buffer instead of copying it into a new block
+    m_stringStorage = StringMoved;
+    m_data.movedString = new std::string(std::move(str));
+  }
 }
 
 CVariant::CVariant(const wchar_t *str)
 {
   m_type = VariantTypeWideString;
+  m_stringStorage = StringBlock;
   m_data.wstring = new std::wstring(str);
 }
 
 CVariant::CVariant(const wchar_t *str, unsigned int length)
 {
   m_type = VariantTypeWideString;
+  m_stringStorage = StringBlock;
   m_data.wstring = new std::wstring(str, length);
 }
 
 CVariant::CVariant(const std::wstring &str)
 {
   m_type = VariantTypeWideString;
+  m_stringStorage = StringBlock;
   m_data.wstring = new std::wstring(str);
 }
 
 CVariant::CVariant(std::wstring &&str)
 {
   m_type = VariantTypeWideString;
+  m_stringStorage = StringBlock;
   m_data.wstring = new std::wstring(std::move(str));
 }
 
 CVariant::CVariant(const std::vector<std::string> &strArray)
 {
   m_type = VariantTypeArray;
+  m_stringStorage = StringBlock;
   m_data.array = new VariantArray;
   m_data.array->reserve(strArray.size());
   for (const auto& item : strArray)
@@ -267,20 +287,23 @@ CVariant::CVariant(const std::vector<std::string> &strArray)
 CVariant::CVariant(const std::map<std::string, std::string> &strMap)
 {
   m_type = VariantTypeObject;
+  m_stringStorage = StringBlock;
   m_data.map = new VariantMap;
   for (std::map<std::string, std::string>::const_iterator it = strMap.begin(); it != strMap.end(); ++it)
-    m_data.map->insert(make_pair(it->first, CVariant(it->second)));
+    m_data.map->insert(m_data.map->end(), make_pair(it->first, CVariant(it->second)));
 }
 
 CVariant::CVariant(const std::map<std::string, CVariant> &variantMap)
 {
   m_type = VariantTypeObject;
+  m_stringStorage = StringBlock;
   m_data.map = new VariantMap(variantMap.begin(), variantMap.end());
 }
 
 CVariant::CVariant(const CVariant &variant)
 {
   m_type = VariantTypeNull;
+  m_stringStorage = StringBlock;
   *this = variant;
 }
 
@@ -289,6 +312,7 @@ CVariant::CVariant(CVariant&& rhs)
   //Set this so that operator= don't try and run cleanup
   //when we're not initialized.
   m_type = VariantTypeNull;
+  m_stringStorage = StringBlock;
 
   *this = std::move(rhs);
 }
@@ -300,8 +324,10 @@ CVariant::~CVariant()
 
 void CVariant::cleanup()
 {
-  if (m_type == VariantTypeString)
-    delete m_data.string;
+  if (m_type == VariantTypeString && m_stringStorage == StringBlock)
+    delete[] m_data.string.data;
+  else if (m_type == VariantTypeString && m_stringStorage == StringMoved)
+    delete m_data.movedString;
   else if (m_type == VariantTypeWideString)
     delete m_data.wstring;
   else if (m_type == VariantTypeArray)
@@ -309,6 +335,50 @@ void CVariant::cleanup()
   else if (m_type == VariantTypeObject)
     delete m_data.map;
   m_type = VariantTypeNull;
+  m_stringStorage = StringBlock;
+}
+
+void CVariant::setString(const char *str, size_t length)
+{
+  if (length < SmallStringSize)
+  {
+    m_stringStorage = StringSmall;
+    memcpy(m_data.smallString, str, length);
+    m_data.smallString[length] = '\0';
+    m_data.smallString[SmallStringSize - 1] = (char)(SmallStringSize - 1 - length);
+  }
+  else
+  {
+    m_stringStorage = StringBlock;
+    m_data.string.data = new char[length + 1];
+    memcpy(m_data.string.data, str, length);
+    m_data.string.data[length] = '\0';
+    m_data.string.length = length;
+  }
+}
+
+const char *CVariant::stringData() const
+{
+  if (m_stringStorage == StringSmall)
+    return m_data.smallString;
+  if (m_stringStorage == StringMoved)
+    return m_data.movedString->c_str();
+  return m_data.string.data;
+}
+
+size_t CVariant::stringLength() const
+{
+  if (m_stringStorage == StringSmall)
+    return SmallStringSize - 1 - m_data.smallString[SmallStringSize - 1];
+  if (m_stringStorage == StringMoved)
+    return m_data.movedString->size();
+  return m_data.string.length;
+}
+
+bool CVariant::stringEquals(const char *str) const
+{
+  size_t length = strlen(str);
+  return stringLength() == length && memcmp(stringData(), str, length) == 0;
 }
 
 bool CVariant::isInteger() const
@@ -372,7 +442,7 @@ int64_t CVariant::asInteger(int64_t fallback) const
     case VariantTypeDouble:
       return (int64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2int64(*m_data.string, fallback);
+      return str2int64(std::string(stringData(), stringLength()), fallback);
     case VariantTypeWideString:
       return str2int64(*m_data.wstring, fallback);
     default:
@@ -393,7 +463,7 @@ uint64_t CVariant::asUnsignedInteger(uint64_t fallback) const
     case VariantTypeDouble:
       return (uint64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2uint64(*m_data.string, fallback);
+      return str2uint64(std::string(stringData(), stringLength()), fallback);
     case VariantTypeWideString:
       return str2uint64(*m_data.wstring, fallback);
     default:
@@ -414,7 +484,7 @@ double CVariant::asDouble(double fallback) const
     case VariantTypeUnsignedInteger:
       return (double)m_data.unsignedinteger;
     case VariantTypeString:
-      return str2double(*m_data.string, fallback);
+      return str2double(std::string(stringData(), stringLength()), fallback);
     case VariantTypeWideString:
       return str2double(*m_data.wstring, fallback);
     default:
@@ -435,7 +505,7 @@ float CVariant::asFloat(float fallback) const
     case VariantTypeUnsignedInteger:
       return (float)m_data.unsignedinteger;
     case VariantTypeString:
-      return (float)str2double(*m_data.string, fallback);
+      return (float)str2double(std::string(stringData(), stringLength()), fallback);
     case VariantTypeWideString:
       return (float)str2double(*m_data.wstring, fallback);
     default:
@@ -458,7 +528,7 @@ bool CVariant::asBoolean(bool fallback) const
     case VariantTypeDouble:
       return (m_data.dvalue != 0);
     case VariantTypeString:
-      if (m_data.string->empty() || m_data.string->compare("0") == 0 || m_data.string->compare("false") == 0)
+      if (stringLength() == 0 || stringEquals("0") || stringEquals("false"))
         return false;
       return true;
     case VariantTypeWideString:
@@ -477,7 +547,7 @@ std::string CVariant::asString(const std::string &fallback /* = "" */) const
   switch (m_type)
   {
     case VariantTypeString:
-      return *m_data.string;
+      return std::string(stringData(), stringLength());
     case VariantTypeBoolean:
       return m_data.boolean ? "true" : "false";
     case VariantTypeInteger:
@@ -542,6 +612,20 @@ CVariant &CVariant::operator[](const std::string &key)
     return ConstNullVariant;
 }
 
+CVariant &CVariant::operator[](std::string &&key)
+{
+  if (m_type == VariantTypeNull)
+  {
+    m_type = VariantTypeObject;
+    m_data.map = new VariantMap;
+  }
+
+  if (m_type == VariantTypeObject)
+    return (*m_data.map)[std::move(key)];
+  else
+    return ConstNullVariant;
+}
+
 const CVariant &CVariant::operator[](const std::string &key) const
 {
   VariantMap::const_iterator it;
@@ -591,7 +675,7 @@ CVariant &CVariant::operator=(const CVariant &rhs)
     m_data.dvalue = rhs.m_data.dvalue;
     break;
   case VariantTypeString:
-    m_data.string = new std::string(*rhs.m_data.string);
+    setString(rhs.stringData(), rhs.stringLength());
     break;
   case VariantTypeWideString:
     m_data.wstring = new std::wstring(*rhs.m_data.wstring);
@@ -618,21 +702,13 @@ CVariant& CVariant::operator=(CVariant&& rhs)
   if (m_type != VariantTypeNull)
     cleanup();
 
+  // the data is either a value, an inline string or a pointer that changes owner
   m_type = rhs.m_type;
-  m_data = std::move(rhs.m_data);
-
-  //Should be enough to just set m_type here
-  //but better safe than sorry, could probably lead to coverity warnings
-  if (rhs.m_type == VariantTypeString)
-    rhs.m_data.string = nullptr;
-  else if (rhs.m_type == VariantTypeWideString)
-    rhs.m_data.wstring = nullptr;
-  else if (rhs.m_type == VariantTypeArray)
-    rhs.m_data.array = nullptr;
-  else if (rhs.m_type == VariantTypeObject)
-    rhs.m_data.map = nullptr;
+  m_stringStorage = rhs.m_stringStorage;
+  memcpy(&m_data, &rhs.m_data, sizeof(m_data));
 
   rhs.m_type = VariantTypeNull;
+  rhs.m_stringStorage = StringBlock;
 
   return *this;
 }
@@ -652,7 +728,8 @@ bool CVariant::operator==(const CVariant &rhs) const
     case VariantTypeDouble:
       return m_data.dvalue == rhs.m_data.dvalue;
     case VariantTypeString:
-      return *m_data.string == *rhs.m_data.string;
+      return stringLength() == rhs.stringLength() &&
+             memcmp(stringData(), rhs.stringData(), stringLength()) == 0;
     case VariantTypeWideString:
       return *m_data.wstring == *rhs.m_data.wstring;
     case VariantTypeArray:
@@ -701,10 +778,22 @@ void CVariant::append(CVariant&& variant)
   push_back(std::move(variant));
 }
 
+void CVariant::reserve(unsigned int count)
+{
+  if (m_type == VariantTypeNull)
+  {
+    m_type = VariantTypeArray;
+    m_data.array = new VariantArray;
+  }
+
+  if (m_type == VariantTypeArray)
+    m_data.array->reserve(count);
+}
+
 const char *CVariant::c_str() const
 {
   if (m_type == VariantTypeString)
-    return m_data.string->c_str();
+    return stringData();
   else
     return NULL;
 }
@@ -712,13 +801,17 @@ const char *CVariant::c_str() const
 void CVariant::swap(CVariant &rhs)
 {
   VariantType  temp_type = m_type;
-  VariantUnion temp_data = m_data;
+  StringStorage temp_storage = m_stringStorage;
+  VariantUnion temp_data;
+  memcpy(&temp_data, &m_data, sizeof(m_data));
 
   m_type = rhs.m_type;
-  m_data = rhs.m_data;
+  m_stringStorage = rhs.m_stringStorage;
+  memcpy(&m_data, &rhs.m_data, sizeof(m_data));
 
   rhs.m_type = temp_type;
-  rhs.m_data = temp_data;
+  rhs.m_stringStorage = temp_storage;
+  memcpy(&rhs.m_data, &temp_data, sizeof(m_data));
 }
 
 CVariant::iterator_array CVariant::begin_array()
@@ -792,7 +885,7 @@ unsigned int CVariant::size() const
   else if (m_type == VariantTypeArray)
     return m_data.array->size();
   else if (m_type == VariantTypeString)
-    return m_data.string->size();
+    return stringLength();
   else if (m_type == VariantTypeWideString)
     return m_data.wstring->size();
   else
@@ -806,7 +899,7 @@ bool CVariant::empty() const
   else if (m_type == VariantTypeArray)
     return m_data.array->empty();
   else if (m_type == VariantTypeString)
-    return m_data.string->empty();
+    return stringLength() == 0;
   else if (m_type == VariantTypeWideString)
     return m_data.wstring->empty();
   else if (m_type == VariantTypeNull)
@@ -822,7 +915,11 @@ void CVariant::clear()
   else if (m_type == VariantTypeArray)
     m_data.array->clear();
   else if (m_type == VariantTypeString)
-    m_data.string->clear();
+  {
+    cleanup();
+    m_type = VariantTypeString;
+    setString("", 0);
+  }
   else if (m_type == VariantTypeWideString)
     m_data.wstring->clear();
 }
@@ -31,6 +31,13 @@ uint64_t str2uint64(const std::wstring &str, uint64_t fallback = 0);
 double str2double(const std::string &str, double fallback = 0.0);
 double str2double(const std::wstring &str, double fallback = 0.0);
 
+/*!
+ \brief Value of one of the JSON types, used for JSON-RPC, announcements and serialization.
+
+ Strings of up to 15 bytes are stored inline and longer ones in a single heap block, so most
+ string values don't allocate. Objects are kept in a std::map, callers rely on references into
+ an object staying valid while keys are added and on iterating the keys in order.
+ */
 class CVariant
 {
 public:
@@ -94,6 +101,7 @@ public:
   float asFloat(float fallback = 0.0f) const;
 
   CVariant &operator[](const std::string &key);
+  CVariant &operator[](std::string &&key);
   const CVariant &operator[](const std::string &key) const;
   CVariant &operator[](unsigned int position);
   const CVariant &operator[](unsigned int position) const;
@@ -108,6 +116,10 @@ public:
   void append(const CVariant &variant);
   void append(CVariant &&variant);
 
+  /*! \brief Reserve room for the given number of array items, turns a null variant into an array
+   */
+  void reserve(unsigned int count);
+
   const char *c_str() const;
 
   void swap(CVariant &rhs);
@@ -145,18 +157,39 @@ public:
 
 private:
   void cleanup();
+  void setString(const char *str, size_t length);
+  const char *stringData() const;
+  size_t stringLength() const;
+  bool stringEquals(const char *str) const;
+
+  enum { SmallStringSize = 16 }; ///< including the terminating zero
+
+  enum StringStorage
+  {
+    StringBlock,  ///< m_data.string, a heap block holding a copy
+    StringSmall,  ///< m_data.smallString, stored inline
+    StringMoved   ///< m_data.movedString, a string that was moved in
+  };
+
   union VariantUnion
   {
     int64_t integer;
     uint64_t unsignedinteger;
     bool boolean;
     double dvalue;
-    std::string *string;
+    char smallString[SmallStringSize]; ///< last byte holds the unused length, 0 when full
+    struct
+    {
+      char *data;
+      size_t length;
+    } string;
+    std::string *movedString;
     std::wstring *wstring;
     VariantArray *array;
     VariantMap *map;
   };
 
   VariantType m_type;
+  StringStorage m_stringStorage;
   VariantUnion m_data;
 };
@@ -20,6 +20,7 @@
 
 #include "log.h"
 #include "system.h"
+#include "threads/Event.h"
 #include "threads/SingleLock.h"
 #include "threads/Thread.h"
 #include "utils/StringUtils.h"
@@ -35,15 +36,153 @@ static const char* const logLevelNames[] =
 // s_globals is used as static global with CLog global variables
 #define s_globals XBMC_GLOBAL_USE(CLog).m_globalInstance
 
+#define LOG_QUEUE_SIZE      4096  // lines, must be a power of 2
+#define LOG_WRITE_INTERVAL   100  // ms the writer sleeps when nothing is queued
+
+/*!
+ \brief Bounded queue of log lines with a writer thread
+
+ Any thread may push lines, only the writer pops them. Every slot carries a sequence number that
+ tells whether it is free to be written or ready to be read, so neither side takes a lock.
+ */
+class CLogQueue : public CThread
+{
+public:
+  CLogQueue()
+    : CThread("LogWriter")
+    , m_slots(new CSlot[LOG_QUEUE_SIZE])
+    , m_pushPos(0)
+    , m_popPos(0)
+    , m_dropped(0)
+    , m_idle(false)
+    , m_writing(false)
+  {
+    for (size_t i = 0; i < LOG_QUEUE_SIZE; i++)
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  ~CLogQueue()
+  {
+    Stop();
+    delete[] m_slots;
+  }
+
+  void Start()
+  {
+    m_writing = true;
+    Create();
+  }
+
+  void Stop()
+  {
+    m_writing = false;
+    StopThread();
+  }
+
+  bool IsWriting() const { return m_writing; }
+
+  void Push(int level, std::string &line)
+  {
+    size_t pos = m_pushPos.load(std::memory_order_relaxed);
+    CSlot *slot;
+    for (;;)
+    {
+      slot = &m_slots[pos & (LOG_QUEUE_SIZE - 1)];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+      if (diff == 0)
+      {
+        if (m_pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+      { // the writer is a whole queue behind
+        m_dropped++;
+        return;
+      }
+      else
+        pos = m_pushPos.load(std::memory_order_relaxed);
+    }
+
+    slot->level = level;
+    slot->threadId = (uint64_t)CThread::GetCurrentThreadId();
+    slot->time = time(NULL);
+    slot->line.swap(line);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    if (m_idle.load(std::memory_order_relaxed))
+      m_wakeUp.Set();
+  }
+
+  bool Pop(int &level, uint64_t &threadId, time_t &time, std::string &line)
+  {
+    CSlot *slot = &m_slots[m_popPos & (LOG_QUEUE_SIZE - 1)];
+    if (slot->sequence.load(std::memory_order_acquire) != m_popPos + 1)
+      return false;
+
+    level = slot->level;
+    threadId = slot->threadId;
+    time = slot->time;
+    line.swap(slot->line);
+    slot->line.clear();
+    slot->sequence.store(m_popPos + LOG_QUEUE_SIZE, std::memory_order_release);
+    m_popPos++;
+    return true;
+  }
+
+  unsigned int TakeDropped()
+  {
+    return m_dropped.exchange(0);
+  }
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      CLog::WriteQueued();
+      m_idle = true;
+      AbortableWait(m_wakeUp, LOG_WRITE_INTERVAL);
+      m_idle = false;
+    }
+    CLog::WriteQueued();
+  }
+
+private:
+  struct CSlot
+  {
+    std::atomic<size_t> sequence;
+    int level;
+    uint64_t threadId;
+    time_t time;
+    std::string line;
+  };
+
+  CSlot *m_slots;
+  std::atomic<size_t> m_pushPos;
+  size_t m_popPos; ///< only used by the writer, under CLogGlobals::critSec
+  std::atomic<unsigned int> m_dropped;
+  std::atomic<bool> m_idle;
+  std::atomic<bool> m_writing;
+  CEvent m_wakeUp;
+};
+
 CLog::CLog()
 {}
 
 CLog::~CLog()
-{}
+{
+  delete m_globalInstance.m_queue.exchange(NULL);
+}
 
 void CLog::Close()
 {
+  CLogQueue *queue = s_globals.m_queue;
+  if (queue)
+    queue->Stop();
+
   CSingleLock waitLock(s_globals.critSec);
+  WriteQueued();
   s_globals.m_platform.CloseLogFile();
   s_globals.m_repeatLine.clear();
 }
@@ -75,32 +214,66 @@ void CLog::LogFunction(int loglevel, const char* functionName, const char* forma
 
 void CLog::LogString(int logLevel, const std::string& logString)
 {
-  CSingleLock waitLock(s_globals.critSec);
   std::string strData(logString);
   StringUtils::TrimRight(strData);
-  if (!strData.empty())
+  if (strData.empty())
+    return;
+
+  // severe errors are written right away, the application may be about to go down
+  CLogQueue *queue = s_globals.m_queue;
+  if (queue && queue->IsWriting() && (logLevel & LOGMASK) < LOGSEVERE)
   {
-    if (s_globals.m_repeatLogLevel == logLevel && s_globals.m_repeatLine == strData)
-    {
-      s_globals.m_repeatCount++;
-      return;
-    }
-    else if (s_globals.m_repeatCount)
-    {
-      std::string strData2 = StringUtils::Format("Previous line repeats %d times.",
-                                                s_globals.m_repeatCount);
-      PrintDebugString(strData2);
-      WriteLogString(s_globals.m_repeatLogLevel, strData2);
-      s_globals.m_repeatCount = 0;
-    }
-    
-    s_globals.m_repeatLine = strData;
-    s_globals.m_repeatLogLevel = logLevel;
+    queue->Push(logLevel, strData);
+    return;
+  }
+
+  CSingleLock waitLock(s_globals.critSec);
+  WriteQueued();
+  WriteLine(logLevel, (uint64_t)CThread::GetCurrentThreadId(), time(NULL), strData);
+}
 
-    PrintDebugString(strData);
+void CLog::WriteQueued()
+{
+  CLogQueue *queue = s_globals.m_queue;
+  if (!queue)
+    return;
 
-    WriteLogString(logLevel, strData);
+  CSingleLock waitLock(s_globals.critSec);
+  int logLevel;
+  uint64_t threadId;
+  time_t time;
+  std::string line;
+  while (queue->Pop(logLevel, threadId, time, line))
+    WriteLine(logLevel, threadId, time, line);
+
+  unsigned int dropped = queue->TakeDropped();
+  if (dropped)
+    WriteLine(LOGWARNING, (uint64_t)CThread::GetCurrentThreadId(), ::time(NULL),
+              StringUtils::Format("%u log lines dropped, the log queue was full", dropped));
+}
+
+void CLog::WriteLine(int logLevel, uint64_t threadId, time_t time, const std::string& line)
+{
+  if (s_globals.m_repeatLogLevel == logLevel && s_globals.m_repeatLine == line)
+  {
+    s_globals.m_repeatCount++;
+    return;
+  }
+  else if (s_globals.m_repeatCount)
+  {
+    std::string strData2 = StringUtils::Format("Previous line repeats %d times.",
+                                              s_globals.m_repeatCount);
+    PrintDebugString(strData2);
+    WriteLogString(s_globals.m_repeatLogLevel, threadId, time, strData2);
+    s_globals.m_repeatCount = 0;
   }
+
+  s_globals.m_repeatLine = line;
+  s_globals.m_repeatLogLevel = logLevel;
+
+  PrintDebugString(line);
+
+  WriteLogString(logLevel, threadId, time, line);
 }
 
 bool CLog::Init(const std::string& path)
@@ -112,7 +285,18 @@ bool CLog::Init(const std::string& path)
 
   std::string appName = CCompileInfo::GetAppName();
   StringUtils::ToLower(appName);
-  return s_globals.m_platform.OpenLogFile(path + appName + ".log", path + appName + ".old.log");
+  s_globals.m_logFile = path + appName + ".log";
+  s_globals.m_oldLogFile = path + appName + ".old.log";
+  s_globals.m_rotatedLogFile = path + appName + ".1.log";
+  s_globals.m_logSize = 0;
+  if (!s_globals.m_platform.OpenLogFile(s_globals.m_logFile, s_globals.m_oldLogFile))
+    return false;
+
+  if (!s_globals.m_queue)
+    s_globals.m_queue = new CLogQueue();
+  if (!s_globals.m_queue.load()->IsWriting())
+    s_globals.m_queue.load()->Start();
+  return true;
 }
 
 void CLog::MemDump(char *pData, int length)
@@ -169,6 +353,12 @@ void CLog::SetExtraLogLevels(int level)
   s_globals.m_extraLogLevels = level;
 }
 
+void CLog::SetMaxLogSize(size_t maxSize)
+{
+  CSingleLock waitLock(s_globals.critSec);
+  s_globals.m_maxLogSize = maxSize;
+}
+
 bool CLog::IsLogLevelLogged(int loglevel)
 {
   const int extras = (loglevel & ~LOGMASK);
@@ -196,7 +386,7 @@ void CLog::PrintDebugString(const std::string& line)
 #endif // defined(_DEBUG) || defined(PROFILE)
 }
 
-bool CLog::WriteLogString(int logLevel, const std::string& logString)
+bool CLog::WriteLogString(int logLevel, uint64_t threadId, time_t time, const std::string& logString)
 {
   static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%" PRIu64" %7s: ";
 
@@ -205,14 +395,28 @@ bool CLog::WriteLogString(int logLevel, const std::string& logString)
   StringUtils::Replace(strData, "\n", "\n                                            ");
 
   int hour, minute, second;
-  s_globals.m_platform.GetCurrentLocalTime(hour, minute, second);
+  s_globals.m_platform.ToLocalTime(time, hour, minute, second);
   
   strData = StringUtils::Format(prefixFormat,
                                   hour,
                                   minute,
                                   second,
-                                  (uint64_t)CThread::GetCurrentThreadId(),
+                                  threadId,
                                   levelNames[logLevel]) + strData;
 
-  return s_globals.m_platform.WriteStringToLog(strData);
+  if (!s_globals.m_platform.WriteStringToLog(strData))
+    return false;
+
+  // keep the previous part once the log grows too large, the old log of the previous session isn't touched
+  s_globals.m_logSize += strData.size() + 1;
+  if (s_globals.m_maxLogSize && s_globals.m_logSize > s_globals.m_maxLogSize)
+  {
+    s_globals.m_platform.CloseLogFile();
+    s_globals.m_logSize = 0;
+    if (!s_globals.m_platform.OpenLogFile(s_globals.m_logFile, s_globals.m_rotatedLogFile))
+      return false;
+    s_globals.m_platform.WriteStringToLog(StringUtils::Format(prefixFormat, hour, minute, second, threadId, levelNames[LOGNOTICE]) +
+                                          "Log rotated, the previous part is in " + s_globals.m_rotatedLogFile);
+  }
+  return true;
 }
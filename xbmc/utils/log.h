@@ -20,7 +20,10 @@
  *
  */
 
+#include <atomic>
+#include <stdint.h>
 #include <string>
+#include <time.h>
 
 #if defined(TARGET_POSIX)
 #include "posix/PosixInterfaceForCLog.h"
@@ -36,6 +39,15 @@ typedef class CWin32InterfaceForCLog PlatformInterfaceForCLog;
 
 #include "utils/params_check_macros.h"
 
+class CLogQueue;
+
+/*!
+ \brief Application log
+
+ Lines are formatted by the logging thread and queued without locking, a writer thread adds the
+ prefix and writes them to the log file. Lines are dropped and counted when the queue is full.
+ Severe and fatal lines, and lines logged before Init() or after Close(), are written directly.
+ */
 class CLog
 {
 public:
@@ -53,11 +65,18 @@ public:
   static void SetExtraLogLevels(int level);
   static bool IsLogLevelLogged(int loglevel);
 
+  /*! \brief Rotate the log file once it grows beyond the given size
+   The previous part is kept as <appname>.1.log, the log of the previous session stays <appname>.old.log.
+   \param maxSize size in bytes, 0 to never rotate
+   */
+  static void SetMaxLogSize(size_t maxSize);
+
 protected:
   class CLogGlobals
   {
   public:
-    CLogGlobals(void) : m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0) {}
+    CLogGlobals(void) : m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0),
+                        m_logSize(0), m_maxLogSize(64 * 1024 * 1024), m_queue(NULL) {}
     ~CLogGlobals() {}
     PlatformInterfaceForCLog m_platform;
     int         m_repeatCount;
@@ -65,11 +84,20 @@ protected:
     std::string m_repeatLine;
     int         m_logLevel;
     int         m_extraLogLevels;
+    std::string m_logFile;
+    std::string m_oldLogFile;
+    std::string m_rotatedLogFile;
+    size_t      m_logSize;
+    size_t      m_maxLogSize;
+    std::atomic<CLogQueue*> m_queue; // created by the first Init(), kept until exit
     CCriticalSection critSec;
   };
   class CLogGlobals m_globalInstance; // used as static global variable
+  friend class CLogQueue;
   static void LogString(int logLevel, const std::string& logString);
-  static bool WriteLogString(int logLevel, const std::string& logString);
+  static void WriteQueued();
+  static void WriteLine(int logLevel, uint64_t threadId, time_t time, const std::string& line);
+  static bool WriteLogString(int logLevel, uint64_t threadId, time_t time, const std::string& logString);
 };
 
 
@@ -96,9 +96,13 @@ void CPosixInterfaceForCLog::PrintDebugString(const std::string &debugString)
 
 void CPosixInterfaceForCLog::GetCurrentLocalTime(int &hour, int &minute, int &second)
 {
-  time_t curTime;
+  ToLocalTime(time(NULL), hour, minute, second);
+}
+
+void CPosixInterfaceForCLog::ToLocalTime(time_t time, int &hour, int &minute, int &second)
+{
   struct tm localTime;
-  if (time(&curTime) != -1 && localtime_r(&curTime, &localTime) != NULL)
+  if (time != -1 && localtime_r(&time, &localTime) != NULL)
   {
     hour   = localTime.tm_hour;
     minute = localTime.tm_min;
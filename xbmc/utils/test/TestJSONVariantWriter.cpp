@@ -31,3 +31,37 @@ TEST(TestJSONVariantWriter, Write)
   str = CJSONVariantWriter::Write(variant, false);
   EXPECT_STREQ("null\n", str.c_str());
 }
+
+TEST(TestJSONVariantWriter, WritePieces)
+{
+  CVariant items(CVariant::VariantTypeArray);
+  for (int i = 0; i < 3; i++)
+  {
+    CVariant item;
+    item["id"] = i;
+    item["label"] = "item";
+    items.append(item);
+  }
+  CVariant document;
+  document["items"] = items;
+  document["total"] = 3;
+
+  CJSONVariantWriter writer(true);
+  std::string str;
+  EXPECT_TRUE(writer.OpenObject());
+  EXPECT_TRUE(writer.WriteKey("items"));
+  EXPECT_TRUE(writer.OpenArray());
+  for (CVariant::const_iterator_array it = items.begin_array(); it != items.end_array(); ++it)
+  {
+    EXPECT_TRUE(writer.WriteValue(*it));
+    writer.TakeOutput(str);
+    EXPECT_EQ(0U, writer.GetOutputSize());
+  }
+  EXPECT_TRUE(writer.CloseArray());
+  EXPECT_TRUE(writer.WriteKey("total"));
+  EXPECT_TRUE(writer.WriteValue(3));
+  EXPECT_TRUE(writer.CloseObject());
+  writer.TakeOutput(str);
+
+  EXPECT_STREQ(CJSONVariantWriter::Write(document, true).c_str(), str.c_str());
+}
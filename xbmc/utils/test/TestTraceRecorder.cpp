@@ -0,0 +1,131 @@
+/*
+ *      Copyright (C) 2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/Thread.h"
+#include "utils/TraceRecorder.h"
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+#define TRACE_TEST_THREADS 4
+#define TRACE_TEST_EVENTS  1000
+
+class TraceThread : public CThread
+{
+public:
+  TraceThread(int id) : CThread("TraceThread"), m_id(id) {}
+
+protected:
+  virtual void Process()
+  {
+    for (int i = 0; i < TRACE_TEST_EVENTS; i++)
+      CTraceRecorder::GetInstance().Record(TRACE_CACHE_LEVEL, m_id, i, 0.5, 1.0);
+  }
+
+private:
+  int m_id;
+};
+
+TEST(TestTraceRecorder, Record)
+{
+  CTraceRecorder &recorder = CTraceRecorder::GetInstance();
+  recorder.Configure(8192, false);
+  ASSERT_TRUE(recorder.IsEnabled());
+
+  TraceThread *threads[TRACE_TEST_THREADS];
+  for (int i = 0; i < TRACE_TEST_THREADS; i++)
+  {
+    threads[i] = new TraceThread(100 + i);
+    threads[i]->Create();
+  }
+  for (int i = 0; i < TRACE_TEST_THREADS; i++)
+  {
+    threads[i]->StopThread();
+    delete threads[i];
+  }
+
+  // events of every thread are kept in the order they were recorded
+  std::vector<STraceEvent> events = recorder.GetEvents();
+  int next[TRACE_TEST_THREADS] = { 0 };
+  for (std::vector<STraceEvent>::const_iterator it = events.begin(); it != events.end(); ++it)
+  {
+    if (it->type != TRACE_CACHE_LEVEL || it->stream < 100 || it->stream >= 100 + TRACE_TEST_THREADS)
+      continue;
+    int &expected = next[it->stream - 100];
+    EXPECT_EQ(expected, it->arg);
+    expected = it->arg + 1;
+  }
+  for (int i = 0; i < TRACE_TEST_THREADS; i++)
+    EXPECT_EQ(TRACE_TEST_EVENTS, next[i]);
+}
+
+TEST(TestTraceRecorder, Wrap)
+{
+  CTraceRecorder &recorder = CTraceRecorder::GetInstance();
+  recorder.Configure(8192, false);
+
+  size_t size = recorder.GetCapacity();
+  for (int i = 0; i < 3 * (int)size; i++)
+    recorder.Record(TRACE_PICTURE_QUEUED, 0, i, 0.0, 0.0);
+
+  // only the latest events are kept
+  std::vector<STraceEvent> events = recorder.GetEvents();
+  ASSERT_EQ(size, events.size());
+  EXPECT_EQ(3 * (int)size - 1, events.back().arg);
+  EXPECT_EQ(2 * (int)size, events.front().arg);
+  for (size_t i = 1; i < events.size(); i++)
+    EXPECT_LE(events[i - 1].time, events[i].time);
+}
+
+TEST(TestTraceRecorder, Dump)
+{
+  CTraceRecorder &recorder = CTraceRecorder::GetInstance();
+  recorder.Configure(8192, false);
+  recorder.Record(TRACE_CLOCK_ADJUSTED, 0, 1, 0.01, 0.0);
+
+  std::string file = CSpecialProtocol::TranslatePath("special://temp/") + "kodi-trace-test.trc";
+  ASSERT_TRUE(recorder.Dump(file, "test"));
+
+  XFILE::CFile in;
+  ASSERT_TRUE(in.Open(file));
+  char magic[8];
+  uint32_t version, eventSize, count, reasonSize;
+  int64_t startTime;
+  uint64_t dumpTime;
+  EXPECT_EQ(8, in.Read(magic, sizeof(magic)));
+  EXPECT_STREQ(TRACE_DUMP_MAGIC, magic);
+  in.Read(&version, sizeof(version));
+  in.Read(&eventSize, sizeof(eventSize));
+  in.Read(&startTime, sizeof(startTime));
+  in.Read(&dumpTime, sizeof(dumpTime));
+  in.Read(&count, sizeof(count));
+  in.Read(&reasonSize, sizeof(reasonSize));
+  EXPECT_EQ((uint32_t)TRACE_DUMP_VERSION, version);
+  EXPECT_EQ(sizeof(STraceEvent), eventSize);
+  EXPECT_LT(0u, count);
+  EXPECT_EQ(4u, reasonSize);
+  EXPECT_EQ((int64_t)(40 + reasonSize + count * eventSize), in.GetLength());
+  in.Close();
+
+  EXPECT_TRUE(XFILE::CFile::Delete(file));
+}
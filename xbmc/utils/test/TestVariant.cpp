@@ -18,6 +18,7 @@
  *
  */
 
+#include "utils/TimeUtils.h"
 #include "utils/Variant.h"
 
 #include "gtest/gtest.h"
@@ -75,6 +76,58 @@ TEST(TestVariant, VariantTypeString)
   EXPECT_STREQ("VariantTypeString3", c.asString().c_str());
 }
 
+TEST(TestVariant, VariantTypeStringStorage)
+{
+  // inline up to 15 bytes, on the heap from 16
+  CVariant small("123456789012345"), large("1234567890123456"), empty("");
+  CVariant zero(std::string("a\0b", 3));
+
+  EXPECT_EQ(15u, small.size());
+  EXPECT_EQ(16u, large.size());
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(3u, zero.size());
+  EXPECT_EQ(std::string("a\0b", 3), zero.asString());
+
+  CVariant copy(large), moved(std::move(small));
+  EXPECT_EQ(large, copy);
+  EXPECT_STREQ("123456789012345", moved.c_str());
+  EXPECT_TRUE(small.isNull());
+
+  copy.swap(moved);
+  EXPECT_STREQ("123456789012345", copy.c_str());
+  EXPECT_STREQ("1234567890123456", moved.c_str());
+
+  moved = copy;
+  EXPECT_EQ(copy, moved);
+  EXPECT_NE(CVariant("1234567890123456"), moved);
+  moved.clear();
+  EXPECT_TRUE(moved.isString());
+  EXPECT_TRUE(moved.empty());
+}
+
+TEST(TestVariant, VariantTypeStringMove)
+{
+  std::string small("123456789012345"), large("1234567890123456789012345678901234567890");
+  CVariant a(std::move(small)), b(std::move(large));
+
+  EXPECT_STREQ("123456789012345", a.c_str());
+  EXPECT_STREQ("1234567890123456789012345678901234567890", b.c_str());
+  EXPECT_EQ(40u, b.size());
+  EXPECT_TRUE(large.empty());
+
+  CVariant copy(b);
+  EXPECT_EQ(b, copy);
+  copy.swap(a);
+  EXPECT_STREQ("1234567890123456789012345678901234567890", a.c_str());
+  EXPECT_STREQ("123456789012345", copy.c_str());
+
+  CVariant moved(std::move(b));
+  EXPECT_TRUE(b.isNull());
+  EXPECT_EQ(a, moved);
+  moved.clear();
+  EXPECT_TRUE(moved.empty());
+}
+
 TEST(TestVariant, VariantTypeWideString)
 {
   CVariant a(L"VariantTypeWideString");
@@ -348,3 +401,73 @@ TEST(TestVariant, isMember)
   EXPECT_TRUE(a.isMember("key1"));
   EXPECT_FALSE(a.isMember("key2"));
 }
+
+TEST(TestVariant, MovedResult)
+{
+  // shape of a VideoLibrary.GetMovies response
+  CVariant result;
+  result["movies"].reserve(100);
+  for (int i = 0; i < 100; i++)
+  {
+    CVariant movie;
+    movie["movieid"] = i;
+    movie["label"] = "A movie title of some length";
+    movie["year"] = 2000 + i % 16;
+    movie["file"] = "smb://server/share/movies/A movie title of some length (2015).mkv";
+    movie["genre"].push_back("Drama");
+    movie["genre"].push_back("Comedy");
+    movie["art"]["poster"] = "image://smb%3a%2f%2fserver%2fposter.jpg/";
+    result["movies"].push_back(std::move(movie));
+    EXPECT_TRUE(movie.isNull());
+  }
+
+  ASSERT_EQ(100u, result["movies"].size());
+  EXPECT_EQ(42, result["movies"][42]["movieid"].asInteger());
+  EXPECT_EQ(2010, result["movies"][42]["year"].asInteger());
+  EXPECT_STREQ("Comedy", result["movies"][42]["genre"][1].c_str());
+  EXPECT_STREQ("image://smb%3a%2f%2fserver%2fposter.jpg/", result["movies"][99]["art"]["poster"].c_str());
+
+  CVariant copy(result);
+  EXPECT_EQ(result, copy);
+
+  copy.clear();
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(100u, result["movies"].size());
+}
+
+// run with --gtest_also_run_disabled_tests, the times are reported in us as test properties
+TEST(TestVariant, DISABLED_Benchmark)
+{
+  // shape of a VideoLibrary.GetMovies response with 10000 movies
+  int64_t start = CurrentHostCounter();
+  CVariant result;
+  result["movies"].reserve(10000);
+  for (int i = 0; i < 10000; i++)
+  {
+    CVariant movie;
+    movie["movieid"] = i;
+    movie["label"] = "A movie title of some length";
+    movie["year"] = 2000 + i % 16;
+    movie["rating"] = 7.5;
+    movie["playcount"] = 0;
+    movie["file"] = "smb://server/share/movies/A movie title of some length (2015).mkv";
+    movie["genre"].push_back("Drama");
+    movie["genre"].push_back("Comedy");
+    movie["art"]["poster"] = "image://smb%3a%2f%2fserver%2fposter.jpg/";
+    movie["art"]["fanart"] = "image://smb%3a%2f%2fserver%2ffanart.jpg/";
+    result["movies"].push_back(std::move(movie));
+  }
+  int64_t built = CurrentHostCounter();
+
+  CVariant copy(result);
+  int64_t copied = CurrentHostCounter();
+
+  copy.clear();
+  result.clear();
+  int64_t cleared = CurrentHostCounter();
+
+  int64_t frequency = CurrentHostFrequency();
+  RecordProperty("build_us", (int)((built - start) * 1000000 / frequency));
+  RecordProperty("copy_us", (int)((copied - built) * 1000000 / frequency));
+  RecordProperty("clear_us", (int)((cleared - copied) * 1000000 / frequency));
+}
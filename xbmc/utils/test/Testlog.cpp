@@ -24,12 +24,31 @@
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
 #include "utils/StringUtils.h"
+#include "threads/Thread.h"
 #include "CompileInfo.h"
 
 #include "test/TestUtils.h"
 
 #include "gtest/gtest.h"
 
+#include <vector>
+
+class LogThread : public CThread
+{
+public:
+  LogThread(int index) : CThread("LogThread"), m_index(index) {}
+
+protected:
+  virtual void Process()
+  {
+    for (int i = 0; i < 100; i++)
+      CLog::Log(LOGDEBUG, "thread %d line %d", m_index, i);
+  }
+
+private:
+  int m_index;
+};
+
 class Testlog : public testing::Test
 {
 protected:
@@ -151,3 +170,73 @@ TEST_F(Testlog, SetLogLevel)
   CLog::Close();
   EXPECT_TRUE(XFILE::CFile::Delete(logfile));
 }
+
+TEST_F(Testlog, LogFromThreads)
+{
+  std::string logfile, logstring;
+  char buf[100];
+  unsigned int bytesread;
+  XFILE::CFile file;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+
+  std::vector<LogThread*> threads;
+  for (int i = 0; i < 4; i++)
+  {
+    threads.push_back(new LogThread(i));
+    threads.back()->Create();
+  }
+  for (std::vector<LogThread*>::iterator i = threads.begin(); i != threads.end(); ++i)
+  {
+    (*i)->StopThread();
+    delete *i;
+  }
+  // Close() writes the queued lines
+  CLog::Close();
+
+  EXPECT_TRUE(file.Open(logfile));
+  while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+  {
+    buf[bytesread] = '\0';
+    logstring.append(buf);
+  }
+  file.Close();
+
+  for (int i = 0; i < 4; i++)
+  {
+    EXPECT_NE(std::string::npos, logstring.find(StringUtils::Format("DEBUG: thread %d line 0", i)));
+    EXPECT_NE(std::string::npos, logstring.find(StringUtils::Format("DEBUG: thread %d line 99", i)));
+  }
+  EXPECT_EQ(std::string::npos, logstring.find("log lines dropped"));
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
+TEST_F(Testlog, Rotate)
+{
+  std::string logfile, oldlogfile;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  oldlogfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".old.log";
+  XFILE::CFile::Delete(oldlogfile);
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+  CLog::SetMaxLogSize(4096);
+
+  for (int i = 0; i < 100; i++)
+    CLog::Log(LOGDEBUG, "rotated log message %d", i);
+  CLog::Close();
+  CLog::SetMaxLogSize(64 * 1024 * 1024);
+
+  struct __stat64 buffer;
+  EXPECT_EQ(0, XFILE::CFile::Stat(logfile, &buffer));
+  EXPECT_LT(buffer.st_size, 4096 + 256);
+  EXPECT_TRUE(XFILE::CFile::Exists(oldlogfile));
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+  EXPECT_TRUE(XFILE::CFile::Delete(oldlogfile));
+}
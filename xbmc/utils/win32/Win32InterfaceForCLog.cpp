@@ -118,3 +118,16 @@ void CWin32InterfaceForCLog::GetCurrentLocalTime(int& hour, int& minute, int& se
   minute = time.wMinute;
   second = time.wSecond;
 }
+
+void CWin32InterfaceForCLog::ToLocalTime(time_t time, int& hour, int& minute, int& second)
+{
+  struct tm localTime;
+  if (time != -1 && localtime_s(&localTime, &time) == 0)
+  {
+    hour = localTime.tm_hour;
+    minute = localTime.tm_min;
+    second = localTime.tm_sec;
+  }
+  else
+    hour = minute = second = 0;
+}
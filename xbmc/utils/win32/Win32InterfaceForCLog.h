@@ -20,6 +20,7 @@
 */
 
 #include <string>
+#include <time.h>
 
 typedef void* HANDLE; // forward declaration, to avoid inclusion of whole Windows.h
 
@@ -33,6 +34,7 @@ public:
   bool WriteStringToLog(const std::string& logString);
   void PrintDebugString(const std::string& debugString);
   static void GetCurrentLocalTime(int& hour, int& minute, int& second);
+  static void ToLocalTime(time_t time, int& hour, int& minute, int& second);
 private:
   HANDLE m_hFile;
 };
@@ -434,9 +434,12 @@ void CGUIWindowFullScreen::FrameMove()
                                        , clockspeed - 100.0
                                        , g_renderManager.GetVSyncState().c_str());
 
-      strGeneralFPS = StringUtils::Format("%s\nW( %s )\n%s"
+      std::string strRender = StringUtils::Format("R( %s )", g_renderManager.GetFrameStats().GetDebugString().c_str());
+
+      strGeneralFPS = StringUtils::Format("%s\nW( %s )\n%s\n%s"
                                           , strGeneral.c_str()
-                                          , strCores.c_str(), strClock.c_str() );
+                                          , strCores.c_str(), strClock.c_str()
+                                          , strRender.c_str() );
 
       CGUIMessage msg(GUI_MSG_LABEL_SET, GetID(), LABEL_ROW3);
       msg.SetLabel(strGeneralFPS);
@@ -40,6 +40,10 @@
 #include "EGLNativeTypeAmlogic.h"
 #include "EGLWrapper.h"
 
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT 0x313D
+#endif
+
 #define CheckError() m_result = eglGetError(); if(m_result != EGL_SUCCESS) CLog::Log(LOGERROR, "EGL error in %s: %x",__FUNCTION__, m_result);
 
 CEGLWrapper::CEGLWrapper()
@@ -321,6 +325,15 @@ bool CEGLWrapper::GetSurfaceSize(EGLDisplay display, EGLSurface surface, EGLint
   return true;
 }
 
+bool CEGLWrapper::GetBufferAge(EGLDisplay display, EGLSurface surface, EGLint *age)
+{
+  if (!age || (display == EGL_NO_DISPLAY) || (surface == EGL_NO_SURFACE))
+    return false;
+
+  // EGL_EXT_buffer_age and EGL_KHR_partial_update share the attribute
+  return eglQuerySurface(display, surface, EGL_BUFFER_AGE_EXT, age);
+}
+
 bool CEGLWrapper::BindContext(EGLDisplay display, EGLSurface surface, EGLContext context)
 {
   EGLBoolean status;
@@ -40,6 +40,7 @@
 #include "EGLQuirks.h"
 #include <vector>
 #include <float.h>
+#include <math.h>
 ////////////////////////////////////////////////////////////////////////////////////////////
 CWinSystemEGL::CWinSystemEGL() : CWinSystemBase()
 {
@@ -55,6 +56,12 @@ CWinSystemEGL::CWinSystemEGL() : CWinSystemBase()
 
   m_egl               = NULL;
   m_iVSyncMode        = 0;
+
+  m_hasBufferAge          = false;
+  m_bufferAge             = -1;
+  m_hasDamage             = false;
+  m_setDamageRegion       = NULL;
+  m_swapBuffersWithDamage = NULL;
 }
 
 CWinSystemEGL::~CWinSystemEGL()
@@ -104,10 +111,16 @@ bool CWinSystemEGL::InitWindowSystem()
     return false;
   }
 
+  m_extensions = m_egl->GetExtensions(m_display);
+  InitDamageExtensions();
+
   EGLint surface_type = EGL_WINDOW_BIT;
-  // for the non-trivial dirty region modes, we need the EGL buffer to be preserved across updates
-  if (g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_COST_REDUCTION ||
-      g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_UNION)
+  // for the non-trivial dirty region modes, we need the EGL buffer to be preserved across updates,
+  // unless the age of the buffers tells which regions they miss
+  if (!m_hasBufferAge &&
+      (g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_COST_REDUCTION ||
+       g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_COST_MERGE ||
+       g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_UNION))
     surface_type |= EGL_SWAP_BEHAVIOR_PRESERVED_BIT;
 
   EGLint configAttrs [] = {
@@ -140,7 +153,6 @@ bool CWinSystemEGL::InitWindowSystem()
     CreateWindow(temp);
   }
 
-  m_extensions = m_egl->GetExtensions(m_display);
   return CWinSystemBase::InitWindowSystem();
 }
 
@@ -228,8 +240,10 @@ bool CWinSystemEGL::CreateWindow(RESOLUTION_INFO &res)
 
 
   // for the non-trivial dirty region modes, we need the EGL buffer to be preserved across updates
-  if (g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_COST_REDUCTION ||
-      g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_UNION)
+  if (!m_hasBufferAge &&
+      (g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_COST_REDUCTION ||
+       g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_COST_MERGE ||
+       g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_UNION))
   {
     if (!m_egl->SurfaceAttrib(m_display, m_surface, EGL_SWAP_BEHAVIOR, EGL_BUFFER_PRESERVED))
       CLog::Log(LOGDEBUG, "%s: Could not set EGL_SWAP_BEHAVIOR",__FUNCTION__);
@@ -444,8 +458,87 @@ bool CWinSystemEGL::IsExtSupported(const char* extension)
   return (m_extensions.find(name) != std::string::npos || CRenderSystemGLES::IsExtSupported(extension));
 }
 
+void CWinSystemEGL::InitDamageExtensions()
+{
+  m_hasBufferAge = IsExtSupported("EGL_EXT_buffer_age") || IsExtSupported("EGL_KHR_partial_update");
+
+  m_setDamageRegion = NULL;
+  if (IsExtSupported("EGL_KHR_partial_update"))
+    m_setDamageRegion = (DamageProc)CEGLWrapper::GetProcAddress("eglSetDamageRegionKHR");
+
+  m_swapBuffersWithDamage = NULL;
+  if (IsExtSupported("EGL_KHR_swap_buffers_with_damage"))
+    m_swapBuffersWithDamage = (DamageProc)CEGLWrapper::GetProcAddress("eglSwapBuffersWithDamageKHR");
+  else if (IsExtSupported("EGL_EXT_swap_buffers_with_damage"))
+    m_swapBuffersWithDamage = (DamageProc)CEGLWrapper::GetProcAddress("eglSwapBuffersWithDamageEXT");
+
+  CLog::Log(LOGDEBUG, "%s: buffer age %s, partial update %s, swap with damage %s", __FUNCTION__,
+            m_hasBufferAge ? "yes" : "no", m_setDamageRegion ? "yes" : "no", m_swapBuffersWithDamage ? "yes" : "no");
+}
+
+void CWinSystemEGL::RegionsToRects(const CDirtyRegionList &dirty, std::vector<EGLint> &rects) const
+{
+  // EGL rects are x, y, width, height with the origin at the bottom left of the surface
+  rects.clear();
+  for (CDirtyRegionList::const_iterator i = dirty.begin(); i != dirty.end(); ++i)
+  {
+    CRect rect(*i);
+    rect.Intersect(CRect(0, 0, (float)m_nWidth, (float)m_nHeight));
+    if (rect.IsEmpty())
+      continue;
+    EGLint x1 = (EGLint)floorf(rect.x1);
+    EGLint y1 = (EGLint)floorf(rect.y1);
+    EGLint x2 = (EGLint)ceilf(rect.x2);
+    EGLint y2 = (EGLint)ceilf(rect.y2);
+    rects.push_back(x1);
+    rects.push_back(m_nHeight - y2);
+    rects.push_back(x2 - x1);
+    rects.push_back(y2 - y1);
+  }
+}
+
+bool CWinSystemEGL::BeginRender()
+{
+  if (!CRenderSystemGLES::BeginRender())
+    return false;
+
+  EGLint age;
+  if (m_hasBufferAge && m_egl->GetBufferAge(m_display, m_surface, &age))
+    m_bufferAge = age;
+  else
+    m_bufferAge = -1;
+  m_hasDamage = false;
+
+  return true;
+}
+
+void CWinSystemEGL::SetDamageRegion(const CDirtyRegionList &dirty)
+{
+  // nothing outside of the regions changes, they can be passed on to the compositor when swapping
+  m_hasDamage = true;
+  if (!m_setDamageRegion)
+    return;
+
+  std::vector<EGLint> rects;
+  RegionsToRects(dirty, rects);
+  if (rects.empty())
+    return;
+
+  if (!m_setDamageRegion(m_display, m_surface, &rects[0], rects.size() / 4))
+    CLog::Log(LOGDEBUG, "%s: Could not set the damage region", __FUNCTION__);
+}
+
 bool CWinSystemEGL::PresentRenderImpl(const CDirtyRegionList &dirty)
 {
+  if (m_swapBuffersWithDamage && m_hasDamage && !dirty.empty() &&
+      m_display != EGL_NO_DISPLAY && m_surface != EGL_NO_SURFACE)
+  {
+    // let the compositor only update the parts of the screen that changed
+    std::vector<EGLint> rects;
+    RegionsToRects(dirty, rects);
+    if (!rects.empty() && m_swapBuffersWithDamage(m_display, m_surface, &rects[0], rects.size() / 4))
+      return true;
+  }
   m_egl->SwapBuffers(m_display, m_surface);
   return true;
 }
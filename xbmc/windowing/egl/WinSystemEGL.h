@@ -47,6 +47,10 @@ public:
   virtual bool  IsExtSupported(const char* extension);
   virtual bool  CanDoWindowed() { return false; }
 
+  virtual bool  BeginRender();
+  virtual int   GetBufferAge() const { return m_bufferAge; }
+  virtual void  SetDamageRegion(const CDirtyRegionList &dirty);
+
   virtual void  ShowOSMouse(bool show);
   virtual bool  HasCursor();
 
@@ -71,6 +75,8 @@ protected:
   virtual void  SetVSyncImpl(bool enable);
 
   bool          CreateWindow(RESOLUTION_INFO &res);
+  void          InitDamageExtensions();
+  void          RegionsToRects(const CDirtyRegionList &dirty, std::vector<EGLint> &rects) const;
 
   int                   m_displayWidth;
   int                   m_displayHeight;
@@ -82,6 +88,13 @@ protected:
 
   CEGLWrapper           *m_egl;
   std::string           m_extensions;
+
+  typedef EGLBoolean (EGLAPIENTRYP DamageProc)(EGLDisplay display, EGLSurface surface, EGLint *rects, EGLint count);
+  bool                  m_hasBufferAge;
+  int                   m_bufferAge;
+  bool                  m_hasDamage;
+  DamageProc            m_setDamageRegion;
+  DamageProc            m_swapBuffersWithDamage;
   CCriticalSection             m_resourceSection;
   std::vector<IDispResource*>  m_resources;
 };